@@ -1,10 +1,7 @@
 
 #include "vt_fw_oem.h"
-
-vt_can_bitrate_type_t bitrate0 = VT_BITRATE_UNKNOWN;
-#ifdef USING_GATEWAY
-vt_can_bitrate_type_t bitrate1 = VT_BITRATE_500;
-#endif
+#include "vt_osal.h"
+#include "vt_autodetect.h"
 
 int main(void)
 {
@@ -15,46 +12,31 @@ int main(void)
   vt_rtc_init(VT_RTC_TIMER, &vt_rtcTimer_StartTime, &vt_rtcTimer_AlarmConfig);
   /* Initialize PIT */
   vt_timer_init(VT_INST_PIT, &vt_pit_ChnConfig0);
-  /* Initialize firewall OEM */
-  vt_fw_oem_init();
+  /* Initialize firewall OEM, the agent does not run without the memory of its subsystems */
+  if(vt_fw_oem_init() != VT_STATUS_SUCCESS)
+  {
+	  vt_all_leds_on();
+	  while(1);
+  }
   /* Initialize CAN bus */
   vt_init_can(VT_INST_CAN0, VT_BITRATE_500, vt_rcv_callback, NULL);
 #ifdef USING_GATEWAY
   vt_init_can(VT_INST_CAN1, VT_BITRATE_500, vt_rcv_callback, NULL);
-  vt_start_rcv(VT_INST_CAN1);
+#endif
+  /* Initialize wakeup of the main loop */
+  vt_osal_init();
+  /* Detect the bitrate of the ports together, each one runs as soon as its bitrate is found */
+  vt_autodetect_start(VT_INST_CAN0);
+#ifdef USING_GATEWAY
+  vt_autodetect_start(VT_INST_CAN1);
 #endif
 
   while(1)
   {
-#ifdef USING_GATEWAY
-	  if((bitrate0 != VT_BITRATE_UNKNOWN ) && (bitrate1 != VT_BITRATE_UNKNOWN ))
-#else
-	  if(bitrate0 != VT_BITRATE_UNKNOWN )
-#endif
-	  {
-		  vt_fw_process();
-  	  }
-	  else
-	  {
-		  if(bitrate0 == VT_BITRATE_UNKNOWN )
-		  {
-			  bitrate0 = vt_autodetect_bitrate(VT_INST_CAN0, 0);
-			  if(bitrate0 < VT_BITRATE_UNKNOWN)
-			  {
-				  vt_start_rcv(VT_INST_CAN0);
-			  }
-		  }
-#ifdef USING_GATEWAY
-		  if(bitrate1 == VT_BITRATE_UNKNOWN )
-		  {
-			  bitrate1 = vt_autodetect_bitrate(VT_INST_CAN1, 0);
-			  if(bitrate1 < VT_BITRATE_UNKNOWN)
-			  {
-				  vt_start_rcv(VT_INST_CAN1);
-			  }
-		  }
-#endif
-	  }
+	  /* Sleep until a frame, the RTC window, the next time based work or the next candidate bitrate */
+	  uint32_t deadline = vt_fw_process_until_idle();
+	  deadline = vt_autodetect_process(deadline);
+	  vt_osal_wait(vt_timer_us_until(deadline));
   }
   /* Add another close code at here */
 } 
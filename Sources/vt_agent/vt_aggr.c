@@ -0,0 +1,241 @@
+/*
+ * vt_aggr.c
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_aggr.h"
+
+/*------------------------------------------------------------------*
+ *                          Define Macro                            *
+ *------------------------------------------------------------------*/
+#define VT_AGGR_TABLE_MASK (VT_AGGR_TABLE_SIZE - 1U)
+
+#if (VT_AGGR_TABLE_SIZE & VT_AGGR_TABLE_MASK) != 0
+#error "VT_AGGR_TABLE_SIZE must be a power of 2"
+#endif
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief State of a (rule, CAN Id) key. Times are slot ticks.
+ */
+typedef struct _vt_aggr_entry_t
+{
+	uint32_t can_id;
+	uint32_t rule_id;
+	uint32_t window_start;   /*!< start of the current summary interval */
+	uint32_t first_ts;       /*!< first folded hit of the interval */
+	uint32_t last_ts;        /*!< last folded hit of the interval */
+	uint32_t count;          /*!< folded hits of the interval */
+	uint32_t bucket_start;   /*!< start of the current one second bucket */
+	uint32_t bucket_count;   /*!< hits of the current bucket */
+	uint32_t peak;           /*!< hits of the busiest bucket of the interval */
+	uint8_t rule_type;
+	uint8_t used;
+}vt_aggr_entry_t;
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+static vt_aggr_entry_t *aggr_table = NULL;
+static uint32_t aggr_interval = 0;
+static uint32_t aggr_ticks_per_second = 0;
+static uint32_t aggr_cursor = 0;
+static vt_aggr_stats_t aggr_stats;
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will hash a (rule, CAN Id) key.
+ * @param [in]   *result - pointer to vt_fw_match_result_t structure.
+ * @return       first slot to probe.
+ */
+static uint32_t _vt_aggr_hash(const vt_fw_match_result_t *result)
+{
+	uint32_t key = result->can_id ^ (result->rule_id << 11) ^ ((uint32_t)result->rule_type << 29);
+
+	/* Fibonacci hashing, the top bits are the best mixed */
+	return (key * 2654435761UL) >> 16;
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will create the aggregation table with storage carved from an arena.
+ * @param [in]   arena - is arena of a subsystem.
+ * @param [in]   interval - is summary interval in slot ticks.
+ * @param [in]   ticks_per_second - is number of slot ticks per second.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_INVALID or VT_STATUS_NO_MEM.
+ */
+vt_status_t vt_aggr_init(vt_arena_id_t arena, uint32_t interval, uint32_t ticks_per_second)
+{
+	vt_status_t status;
+	void *ptr;
+
+	if(interval == 0 || ticks_per_second == 0)
+		return VT_STATUS_INVALID;
+
+	status = vt_arena_alloc(arena, VT_AGGR_TABLE_SIZE * sizeof(vt_aggr_entry_t), &ptr);
+	if(status != VT_STATUS_SUCCESS)
+		return status;
+
+	aggr_table = (vt_aggr_entry_t *)ptr;
+	memset(aggr_table, 0, VT_AGGR_TABLE_SIZE * sizeof(vt_aggr_entry_t));
+	aggr_interval = interval;
+	aggr_ticks_per_second = ticks_per_second;
+	aggr_cursor = 0;
+	memset(&aggr_stats, 0, sizeof(aggr_stats));
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will change the summary interval.
+ * @param [in]   interval - is summary interval in slot ticks.
+ * @return       none.
+ */
+void vt_aggr_set_interval(uint32_t interval)
+{
+	if(interval > 0)
+		aggr_interval = interval;
+}
+
+/*!
+ * @brief  This API will account a blacklist or monitor record.
+ * @param [in]   *event - pointer to vt_event_t structure.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_EXIST or VT_STATUS_FULL.
+ */
+vt_status_t vt_aggr_hit(const vt_event_t *event)
+{
+	const vt_fw_match_result_t *result = &event->u.result;
+	vt_aggr_entry_t *entry, *free_entry = NULL;
+	uint32_t slot, i;
+	uint32_t now = event->time_stamp;
+
+	/* Without a table every hit is reported */
+	if(aggr_table == NULL)
+		return VT_STATUS_SUCCESS;
+
+	aggr_stats.hits++;
+	slot = _vt_aggr_hash(result);
+	/* Keys are never moved, so the whole probe window is checked rather than stopping at a free slot */
+	for(i = 0; i < VT_AGGR_MAX_PROBE; i++)
+	{
+		entry = &aggr_table[(slot + i) & VT_AGGR_TABLE_MASK];
+		if(!entry->used)
+		{
+			if(free_entry == NULL)
+				free_entry = entry;
+			continue;
+		}
+		if((entry->can_id == result->can_id) && (entry->rule_id == result->rule_id) && (entry->rule_type == result->rule_type))
+		{
+			if(entry->count == 0)
+				entry->first_ts = now;
+			entry->last_ts = now;
+			entry->count++;
+			if((now - entry->bucket_start) >= aggr_ticks_per_second)
+			{
+				entry->bucket_start = now;
+				entry->bucket_count = 0;
+			}
+			entry->bucket_count++;
+			if(entry->bucket_count > entry->peak)
+				entry->peak = entry->bucket_count;
+			aggr_stats.suppressed++;
+			return VT_STATUS_EXIST;
+		}
+	}
+
+	if(free_entry == NULL)
+	{
+		aggr_stats.overflow++;
+		return VT_STATUS_FULL;
+	}
+
+	/* First hit of the key: the caller reports it, the interval starts now */
+	free_entry->can_id = result->can_id;
+	free_entry->rule_id = result->rule_id;
+	free_entry->rule_type = result->rule_type;
+	free_entry->window_start = now;
+	free_entry->count = 0;
+	free_entry->bucket_start = now;
+	free_entry->bucket_count = 1;
+	free_entry->peak = 1;
+	free_entry->used = 1;
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will push summaries of keys whose interval expired.
+ * @param [in]   now - is current slot tick count.
+ * @return       none.
+ */
+void vt_aggr_flush(uint32_t now)
+{
+	vt_aggr_entry_t *entry;
+	vt_event_t event;
+	uint32_t i;
+
+	if(aggr_table == NULL)
+		return;
+
+	for(i = 0; i < VT_AGGR_FLUSH_SLOTS; i++)
+	{
+		entry = &aggr_table[aggr_cursor];
+		aggr_cursor = (aggr_cursor + 1) & VT_AGGR_TABLE_MASK;
+		if(!entry->used || ((now - entry->window_start) < aggr_interval))
+			continue;
+
+		/* A quiet key is forgotten, its next hit is reported at once again */
+		if(entry->count == 0)
+		{
+			entry->used = 0;
+			continue;
+		}
+
+		event.type = VT_EVENT_SUMMARY;
+		event.time_stamp = now;
+		event.u.summary.rule_type = entry->rule_type;
+		event.u.summary.rule_id = entry->rule_id;
+		event.u.summary.can_id = entry->can_id;
+		event.u.summary.count = entry->count;
+		event.u.summary.first_ts = entry->first_ts;
+		event.u.summary.last_ts = entry->last_ts;
+		/* Buckets last one second, so the busiest bucket is the peak rate in hits per second */
+		event.u.summary.peak_rate = entry->peak;
+		if(vt_event_push(&event) == VT_STATUS_SUCCESS)
+			aggr_stats.summaries++;
+
+		entry->window_start = now;
+		entry->count = 0;
+		entry->peak = 0;
+	}
+}
+
+/*!
+ * @brief  This API will get counters of the aggregation stage.
+ * @param [out]  *stats - pointer to vt_aggr_stats_t structure.
+ * @return       none.
+ */
+void vt_aggr_get_stats(vt_aggr_stats_t *stats)
+{
+	if(stats == NULL)
+		return;
+	*stats = aggr_stats;
+}
+
+#ifdef __cplusplus
+}
+#endif
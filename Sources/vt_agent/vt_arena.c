@@ -0,0 +1,189 @@
+/*
+ * vt_arena.c
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_arena.h"
+#ifdef VT_ARENA_HEAP
+#include <errno.h>
+#include <stddef.h>
+#endif
+
+/*------------------------------------------------------------------*
+ *                          Define Macro                            *
+ *------------------------------------------------------------------*/
+#define VT_ARENA_ROUND_UP(x) (((x) + (VT_ARENA_ALIGN - 1U)) & ~((uintptr_t)VT_ARENA_ALIGN - 1U))
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef struct _vt_arena_t
+{
+	uint8_t *base;
+	uint32_t size;
+	uint32_t used;
+	uint32_t high_water;
+	uint32_t failed;
+	uint8_t sealed;
+}vt_arena_t;
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+static vt_arena_t arenas[VT_ARENA_MAX];
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will hand a caller-provided memory block to a subsystem arena.
+ * @param [in]   id - is arena of a subsystem.
+ * @param [in]   *buff - pointer to memory block.
+ * @param [in]   size - size of memory block in bytes.
+ * @return       status.
+ */
+vt_status_t vt_arena_init(vt_arena_id_t id, void *buff, uint32_t size)
+{
+	uintptr_t start, end;
+
+	if(id >= VT_ARENA_MAX)
+		return VT_STATUS_INVALID;
+	if(buff == NULL)
+		return VT_STATUS_NULL;
+
+	/* Align the start of the block, the lost bytes are not counted in size */
+	start = VT_ARENA_ROUND_UP((uintptr_t)buff);
+	end = (uintptr_t)buff + size;
+	if(start >= end)
+		return VT_STATUS_SMALL_BUFF;
+
+	arenas[id].base = (uint8_t *)start;
+	arenas[id].size = (uint32_t)(end - start);
+	arenas[id].used = 0;
+	arenas[id].high_water = 0;
+	arenas[id].failed = 0;
+	arenas[id].sealed = 0;
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will carve a block from an arena.
+ * @param [in]   id - is arena of a subsystem.
+ * @param [in]   size - size of block in bytes.
+ * @param [out]  **ptr - pointer to the block, NULL when the allocation fails.
+ * @return       status.
+ */
+vt_status_t vt_arena_alloc(vt_arena_id_t id, uint32_t size, void **ptr)
+{
+	vt_arena_t *arena;
+	uint32_t need;
+
+	if(ptr == NULL)
+		return VT_STATUS_NULL;
+	*ptr = NULL;
+	if(id >= VT_ARENA_MAX)
+		return VT_STATUS_INVALID;
+
+	arena = &arenas[id];
+	if(arena->base == NULL)
+		return VT_STATUS_UNREADY;
+
+	need = (size + (VT_ARENA_ALIGN - 1U)) & ~(VT_ARENA_ALIGN - 1U);
+	if((arena->sealed) || (need < size) || (need > (arena->size - arena->used)))
+	{
+		arena->failed++;
+		return VT_STATUS_NO_MEM;
+	}
+
+	*ptr = &arena->base[arena->used];
+	arena->used += need;
+	if(arena->used > arena->high_water)
+		arena->high_water = arena->used;
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will release every block of an arena. The high-water mark is kept.
+ * @param [in]   id - is arena of a subsystem.
+ * @return       none.
+ */
+void vt_arena_reset(vt_arena_id_t id)
+{
+	if(id < VT_ARENA_MAX)
+		arenas[id].used = 0;
+}
+
+/*!
+ * @brief  This API will seal an arena at the end of init.
+ * @param [in]   id - is arena of a subsystem.
+ * @return       none.
+ */
+void vt_arena_seal(vt_arena_id_t id)
+{
+	if(id < VT_ARENA_MAX)
+		arenas[id].sealed = 1;
+}
+
+/*!
+ * @brief  This API will get used bytes and high-water mark of an arena.
+ * @param [in]   id - is arena of a subsystem.
+ * @param [out]  *stats - pointer to vt_arena_stats_t structure.
+ * @return       status.
+ */
+vt_status_t vt_arena_get_stats(vt_arena_id_t id, vt_arena_stats_t *stats)
+{
+	if(stats == NULL)
+		return VT_STATUS_NULL;
+	if(id >= VT_ARENA_MAX)
+		return VT_STATUS_INVALID;
+
+	stats->size = arenas[id].size;
+	stats->used = arenas[id].used;
+	stats->high_water = arenas[id].high_water;
+	stats->failed = arenas[id].failed;
+
+	return VT_STATUS_SUCCESS;
+}
+
+#ifdef VT_ARENA_HEAP
+/*!
+ * @brief  Heap growth hook of the C library. The firewall core library allocates with malloc, so the heap is served
+ *         from VT_ARENA_CORE only. Once the arena is sealed the heap cannot grow and malloc fails deterministically.
+ * @param [in]   incr - number of bytes to grow (or shrink) the heap.
+ * @return       previous end of heap, or (void *)-1 with errno set to ENOMEM.
+ */
+void *_sbrk(ptrdiff_t incr)
+{
+	vt_arena_t *arena = &arenas[VT_ARENA_CORE];
+	uint8_t *prev;
+
+	if((arena->base == NULL) || ((incr > 0) && (arena->sealed)) ||
+	   ((incr > 0) && ((uint32_t)incr > (arena->size - arena->used))) ||
+	   ((incr < 0) && ((uint32_t)(-incr) > arena->used)))
+	{
+		arena->failed++;
+		errno = ENOMEM;
+		return (void *)-1;
+	}
+
+	prev = &arena->base[arena->used];
+	arena->used = (uint32_t)((int32_t)arena->used + (int32_t)incr);
+	if(arena->used > arena->high_water)
+		arena->high_water = arena->used;
+
+	return prev;
+}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
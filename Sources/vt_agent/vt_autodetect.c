@@ -0,0 +1,247 @@
+/*
+ * vt_autodetect.c
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_autodetect.h"
+#include "vt_fw_oem.h"
+#include "vt_osal.h"
+#include "vt_atomic.h"
+
+/*------------------------------------------------------------------*
+ *                          Define Macro                            *
+ *------------------------------------------------------------------*/
+#define VT_AUTODETECT_RATE_TICKS    ((VT_AUTODETECT_RATE_MS * 1000U) / VT_PIT_PERIOD)
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief Detection of a port. The counters are written by the RX interrupt and read by the main loop.
+ */
+typedef struct _vt_autodetect_port_t
+{
+	volatile uint32_t state;        /*!< vt_autodetect_state_t */
+	volatile uint32_t rx;           /*!< frames received at the candidate */
+	volatile uint32_t errors;       /*!< error events at the candidate */
+	uint32_t index;                 /*!< candidate in autodetect_rates */
+	uint32_t deadline;              /*!< slot tick count the candidate is given up at */
+	uint32_t start;                 /*!< slot tick count of vt_autodetect_start() */
+	uint32_t ticks;
+	uint32_t candidates;
+	uint32_t rejected;
+	uint32_t timeouts;
+	vt_can_bitrate_type_t bitrate;
+}vt_autodetect_port_t;
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+/* Order of vt_autodetect_bitrate(), the most common bitrates first */
+static const vt_can_bitrate_type_t autodetect_rates[VT_BITRATE_UNKNOWN] = {VT_BITRATE_500, VT_BITRATE_125, VT_BITRATE_250, VT_BITRATE_800, VT_BITRATE_1M};
+static vt_autodetect_port_t autodetect_ports[VT_MAX_CAN_NUMBER];
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will make a port listen at its current candidate bitrate.
+ * @param [in]   inst_can - CAN number (e.g: 0, 1, 2).
+ * @param [in]   now - is current slot tick count.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_ERROR.
+ */
+static vt_status_t _vt_autodetect_listen(uint8_t inst_can, uint32_t now)
+{
+	vt_autodetect_port_t *port = &autodetect_ports[inst_can];
+
+	if(vt_re_init_can_mode(inst_can, autodetect_rates[port->index], 1) != STATUS_SUCCESS)
+		return VT_STATUS_ERROR;
+	/* Disable filter to receive all coming CAN message */
+	vt_disable_filter_rxfifo(inst_can);
+	/* Events of the previous candidate ended with the re-initialization */
+	VT_ATOMIC_STORE(&port->rx, 0U);
+	VT_ATOMIC_STORE(&port->errors, 0U);
+	port->deadline = now + VT_AUTODETECT_RATE_TICKS;
+	port->candidates++;
+	return VT_STATUS_SUCCESS;
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will start the detection of a port initialized with vt_init_can().
+ * @param [in]   inst_can - CAN number (e.g: 0, 1, 2).
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_INVALID or VT_STATUS_ERROR.
+ */
+vt_status_t vt_autodetect_start(uint8_t inst_can)
+{
+	vt_autodetect_port_t *port;
+	vt_status_t status;
+
+	if(inst_can >= VT_MAX_CAN_NUMBER)
+		return VT_STATUS_INVALID;
+
+	port = &autodetect_ports[inst_can];
+	memset(port, 0, sizeof(vt_autodetect_port_t));
+	port->bitrate = VT_BITRATE_UNKNOWN;
+	port->start = vt_timer_get_ticks();
+	/* Probing first, so the events of the candidate are never taken by the firewall */
+	VT_ATOMIC_STORE(&port->state, (uint32_t)VT_AUTODETECT_PROBING);
+	status = _vt_autodetect_listen(inst_can, port->start);
+	if(status != VT_STATUS_SUCCESS)
+		VT_ATOMIC_STORE(&port->state, (uint32_t)VT_AUTODETECT_IDLE);
+	return status;
+}
+
+/*!
+ * @brief  This API will take an event of a port, from vt_rcv_callback().
+ * @param [in]   inst_can - CAN number (e.g: 0, 1, 2).
+ * @param [in]   eventType - is type of the event.
+ * @return       1 if the port is being detected and the event was taken, 0 otherwise.
+ */
+uint8_t vt_autodetect_event(uint8_t inst_can, flexcan_event_type_t eventType)
+{
+	vt_autodetect_port_t *port;
+
+	if(inst_can >= VT_MAX_CAN_NUMBER)
+		return 0;
+	port = &autodetect_ports[inst_can];
+	if(VT_ATOMIC_LOAD(&port->state) != VT_AUTODETECT_PROBING)
+		return 0;
+
+	switch(eventType)
+	{
+	case FLEXCAN_EVENT_RXFIFO_COMPLETE:
+		/* The frame only tells the bitrate, the next one is received into the other buffer */
+		(void)vt_get_msg(inst_can);
+		VT_ATOMIC_ADD(&port->rx, 1U);
+		vt_osal_signal_from_isr();
+		break;
+	case FLEXCAN_EVENT_RXFIFO_WARNING:
+	case FLEXCAN_EVENT_RXFIFO_OVERFLOW:
+		VT_ATOMIC_ADD(&port->rx, 1U);
+		vt_osal_signal_from_isr();
+		break;
+	case FLEXCAN_EVENT_ERROR:
+		if(VT_ATOMIC_ADD(&port->errors, 1U) + 1U == VT_AUTODETECT_ERRORS)
+			vt_osal_signal_from_isr();
+		break;
+	default:
+		break;
+	}
+	return 1;
+}
+
+/*!
+ * @brief  This API will move every port being detected on, from the main loop.
+ * @param [in]   deadline - is slot tick count the caller wakes up at.
+ * @return       the earlier of deadline and the deadline of the candidates listening.
+ */
+uint32_t vt_autodetect_process(uint32_t deadline)
+{
+	vt_autodetect_port_t *port;
+	uint32_t now = vt_timer_get_ticks();
+	uint8_t inst;
+
+	for(inst = 0; inst < VT_MAX_CAN_NUMBER; inst++)
+	{
+		port = &autodetect_ports[inst];
+		if(VT_ATOMIC_LOAD(&port->state) != VT_AUTODETECT_PROBING)
+			continue;
+
+		if(VT_ATOMIC_LOAD(&port->rx) > 0)
+		{
+			/* A frame is only received at the bitrate of the bus */
+			port->bitrate = autodetect_rates[port->index];
+			port->ticks = now - port->start;
+			(void)vt_re_init_can(inst, port->bitrate);
+			vt_disable_filter_rxfifo(inst);
+			VT_ATOMIC_STORE(&port->state, (uint32_t)VT_AUTODETECT_DONE);
+			continue;
+		}
+
+		if(VT_ATOMIC_LOAD(&port->errors) >= VT_AUTODETECT_ERRORS)
+			port->rejected++;
+		else if((int32_t)(now - port->deadline) >= 0)
+			port->timeouts++;
+		else
+		{
+			if((int32_t)(port->deadline - deadline) < 0)
+				deadline = port->deadline;
+			continue;
+		}
+
+		/* A quiet bus tells nothing, the candidates are tried again */
+		port->index = (port->index + 1U) % (uint32_t)VT_BITRATE_UNKNOWN;
+		if(_vt_autodetect_listen(inst, now) != VT_STATUS_SUCCESS)
+		{
+			VT_ATOMIC_STORE(&port->state, (uint32_t)VT_AUTODETECT_IDLE);
+			continue;
+		}
+		if((int32_t)(port->deadline - deadline) < 0)
+			deadline = port->deadline;
+	}
+
+	return deadline;
+}
+
+/*!
+ * @brief  This API will get the bitrate of a port.
+ * @param [in]   inst_can - CAN number (e.g: 0, 1, 2).
+ * @return       vt_can_bitrate_type_t, VT_BITRATE_UNKNOWN while the port is being detected.
+ */
+vt_can_bitrate_type_t vt_autodetect_get_bitrate(uint8_t inst_can)
+{
+	if(inst_can >= VT_MAX_CAN_NUMBER || VT_ATOMIC_LOAD(&autodetect_ports[inst_can].state) != VT_AUTODETECT_DONE)
+		return VT_BITRATE_UNKNOWN;
+	return autodetect_ports[inst_can].bitrate;
+}
+
+/*!
+ * @brief  This API will check a port is being detected.
+ * @param [in]   inst_can - CAN number (e.g: 0, 1, 2).
+ * @return       1 if it is, 0 otherwise.
+ */
+uint8_t vt_autodetect_probing(uint8_t inst_can)
+{
+	if(inst_can >= VT_MAX_CAN_NUMBER)
+		return 0;
+	return (VT_ATOMIC_LOAD(&autodetect_ports[inst_can].state) == VT_AUTODETECT_PROBING) ? 1U : 0U;
+}
+
+/*!
+ * @brief  This API will get the state of the detection of a port.
+ * @param [in]   inst_can - CAN number (e.g: 0, 1, 2).
+ * @param [out]  *stats - pointer to vt_autodetect_stats_t structure.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL or VT_STATUS_INVALID.
+ */
+vt_status_t vt_autodetect_get_stats(uint8_t inst_can, vt_autodetect_stats_t *stats)
+{
+	vt_autodetect_port_t *port;
+
+	if(stats == NULL)
+		return VT_STATUS_NULL;
+	if(inst_can >= VT_MAX_CAN_NUMBER)
+		return VT_STATUS_INVALID;
+
+	port = &autodetect_ports[inst_can];
+	stats->state = (uint8_t)VT_ATOMIC_LOAD(&port->state);
+	stats->bitrate = (uint8_t)((stats->state == VT_AUTODETECT_DONE) ? port->bitrate : VT_BITRATE_UNKNOWN);
+	stats->candidates = port->candidates;
+	stats->rejected = port->rejected;
+	stats->timeouts = port->timeouts;
+	stats->ticks = port->ticks;
+	return VT_STATUS_SUCCESS;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -13,6 +13,11 @@
 #include "vt_can.h"
 #include "vt_timer.h"
 #include "vt_fw_oem.h"
+#include "vt_fw_ctx.h"
+#include "vt_fw_dual.h"
+#include "vt_atomic.h"
+#include "vt_probe.h"
+#include "vt_autodetect.h"
 
 /*------------------------------------------------------------------*
  *                          Define Macro                            *
@@ -32,8 +37,9 @@ extern "C" {
 /*------------------------------------------------------------------*
  *                        Private Data Types                        *
  *------------------------------------------------------------------*/
-flexcan_msgbuff_t msg_buff[2];
-static volatile uint8_t active_buff = 0;
+/* Double buffer of each port, the last one is shared by instances past VT_MAX_CAN_NUMBER */
+flexcan_msgbuff_t msg_buff[VT_MAX_CAN_NUMBER + 1][2];
+static volatile uint8_t active_buff[VT_MAX_CAN_NUMBER + 1];
 
 static const flexcan_time_segment_t bitRateTable[] = {
     { 7, 4, 1, 19, 1},  /* 125 kHz */
@@ -42,6 +48,7 @@ static const flexcan_time_segment_t bitRateTable[] = {
     { 4, 1, 1,  4, 1},  /* 800 kHz */
     { 7, 6, 3,  1, 1},  /* 1   MHz */
 };
+#if USING_CAN_FD
 /* PE clock 40MHz bitRate for can fd */
 static const flexcan_time_segment_t bitRateCbtTable[] = {
 	{ 7, 4, 1, 19, 1},  /* 125 kHz */
@@ -50,6 +57,7 @@ static const flexcan_time_segment_t bitRateCbtTable[] = {
 	{ 4, 1, 1,  4, 1},  /* 800 kHz */
 	{ 7, 6, 3,  1, 1},  /* 1   MHz */
 };
+#endif
 
 static flexcan_user_config_t vt_can_InitConfig = {
     .fd_enable = false,
@@ -80,6 +88,9 @@ static flexcan_user_config_t vt_can_InitConfig = {
 
 static flexcan_id_table_t id_filter_table = {.idFilter = rxFifoFilter, .isExtendedFrame = 0, .isRemoteFrame = 0};
 static volatile uint8_t tx_led = 0, rx_led = 0;
+static uint8_t rxfifo_bulk_load = 0;
+/* One entry per port, the last one collects events of instances past VT_MAX_CAN_NUMBER */
+static vt_can_stats_t can_stats[VT_MAX_CAN_NUMBER + 1];
 /*------------------------------------------------------------------*
  *                        Global Data Types                         *
  *------------------------------------------------------------------*/
@@ -91,6 +102,7 @@ uint16_t rxfifo_count = 0;
  *                 Private Function Prototypes                      *
  *------------------------------------------------------------------*/
 static inline flexcan_msgbuff_t * _vt_get_msg(uint8_t inst_can);
+static inline flexcan_msgbuff_t * _vt_rx_buff(uint8_t inst_can);
 static inline int _vt_can_bsearch(uint32_t *id_table, int size, uint32_t can_id);
 
 /*------------------------------------------------------------------*
@@ -99,29 +111,86 @@ static inline int _vt_can_bsearch(uint32_t *id_table, int size, uint32_t can_id)
 void vt_rcv_callback(uint8_t instance, flexcan_event_type_t eventType, flexcan_state_t *flexcanState)
 {
 	flexcan_msgbuff_t * msg = NULL;
+	vt_can_stats_t *stats = &can_stats[(instance < VT_MAX_CAN_NUMBER) ? instance : VT_MAX_CAN_NUMBER];
+#if !VT_FW_DUAL_CORE
+	vt_fw_ctx_t *ctx = vt_fw_ctx_of_bus(instance);
+#ifdef USING_GATEWAY
+	uint8_t malicious;
+	uint32_t ingress = 0;
+#endif
+#endif
+	VT_PROBE_START(probe_callback);
 	(void)flexcanState;
 
+	/* A port being detected listens at a candidate bitrate, its frames are not for the firewall */
+	if(vt_autodetect_event(instance, eventType))
+	{
+		if(eventType == FLEXCAN_EVENT_ERROR)
+			VT_ATOMIC_ADD(&stats->errors, 1);
+		VT_PROBE_END(VT_PROBE_RCV_CALLBACK, probe_callback);
+		return;
+	}
+
 	switch(eventType)
 	{
 	case FLEXCAN_EVENT_RXFIFO_COMPLETE:
+#if VT_FW_DUAL_CORE
+		VT_ATOMIC_ADD(&stats->rx_frames, 1);
+		msg = _vt_get_msg(instance);
+		/* Checked on the firewall core, forwarded when its verdict comes back */
+		vt_fw_dual_rx(instance, msg);
+		vt_fw_dual_verdict_process();
+		vt_fw_oem_signal(1);
+		rx_led = 1;
+		break;
+#else
+#if defined(USING_GATEWAY) && VT_LATENCY_ENABLE
+		ingress = vt_probe_now();
+#endif
+		VT_ATOMIC_ADD(&stats->rx_frames, 1);
 		msg = _vt_get_msg(instance);
 #ifdef USING_GATEWAY
-		if(vt_fw_can_msg_is_malicious(msg->msgId, msg->dataLen, msg->data) == 0)
-			vt_fw_oem_add_message_to_forward_queue(instance, msg);
+		{
+			VT_PROBE_START(probe_malicious);
+			malicious = vt_fw_ctx_can_msg_is_malicious(ctx, msg->msgId, msg->dataLen, msg->data);
+			VT_PROBE_END(VT_PROBE_FW_IS_MALICIOUS, probe_malicious);
+		}
+		if(malicious == 0)
+			vt_fw_oem_add_message_to_forward_queue(instance, msg, ingress);
 #endif
 
-		vt_fw_rcv_msg(msg->msgId, msg->dataLen, msg->data);
+		{
+			VT_PROBE_START(probe_rcv_msg);
+			vt_fw_ctx_rcv_msg(ctx, msg->msgId, msg->dataLen, msg->data);
+			VT_PROBE_END(VT_PROBE_FW_RCV_MSG, probe_rcv_msg);
+		}
+		vt_fw_oem_signal(1);
 		rx_led = 1;
 		break;
+#endif
 	case FLEXCAN_EVENT_TX_COMPLETE:
 #ifdef USING_GATEWAY
 		vt_fw_oem_get_and_send_message(instance);
 #endif
+#if VT_FW_DUAL_CORE
+		vt_fw_dual_verdict_process();
+#endif
+		VT_ATOMIC_ADD(&stats->tx_frames, 1);
 		tx_led = 1;
 		break;
+	case FLEXCAN_EVENT_RXFIFO_OVERFLOW:
+		VT_ATOMIC_ADD(&stats->rx_fifo_overflow, 1);
+		break;
+	case FLEXCAN_EVENT_RXFIFO_WARNING:
+		VT_ATOMIC_ADD(&stats->rx_fifo_warning, 1);
+		break;
+	case FLEXCAN_EVENT_ERROR:
+		VT_ATOMIC_ADD(&stats->errors, 1);
+		break;
 	default:
 		break;
 	}
+	VT_PROBE_END(VT_PROBE_RCV_CALLBACK, probe_callback);
 }
 
 
@@ -174,13 +243,26 @@ static inline int _vt_can_bsearch(uint32_t *id_table, int size, uint32_t can_id)
 static inline flexcan_msgbuff_t * _vt_get_msg(uint8_t inst_can)
 {
 	flexcan_msgbuff_t * msg = NULL;
+	uint8_t port = (inst_can < VT_MAX_CAN_NUMBER) ? inst_can : VT_MAX_CAN_NUMBER;
 
-	msg = &msg_buff[active_buff];
-	active_buff = !active_buff;
-	FLEXCAN_DRV_RxFifo(inst_can, &msg_buff[active_buff]);
+	msg = &msg_buff[port][active_buff[port]];
+	active_buff[port] = !active_buff[port];
+	FLEXCAN_DRV_RxFifo(inst_can, &msg_buff[port][active_buff[port]]);
 	return msg;
 }
 
+/*!
+ * @brief  This API will get the buffer of a CAN port that receives the next message.
+ * @param [in]      inst_can - CAN number (e.g: 0, 1, 2).
+ * @return          a pointer to a local message buffer.
+ */
+static inline flexcan_msgbuff_t * _vt_rx_buff(uint8_t inst_can)
+{
+	uint8_t port = (inst_can < VT_MAX_CAN_NUMBER) ? inst_can : VT_MAX_CAN_NUMBER;
+
+	return &msg_buff[port][active_buff[port]];
+}
+
 /*------------------------------------------------------------------*
  *                         Public Functions                         *
  *------------------------------------------------------------------*/
@@ -192,19 +274,14 @@ static inline flexcan_msgbuff_t * _vt_get_msg(uint8_t inst_can)
  */
 flexcan_msgbuff_t * vt_get_msg(uint8_t inst_can)
 {
-	flexcan_msgbuff_t * msg = NULL;
-
-	msg = &msg_buff[active_buff];
-	active_buff = !active_buff;
-	FLEXCAN_DRV_RxFifo(inst_can, &msg_buff[active_buff]);
-	return msg;
+	return _vt_get_msg(inst_can);
 }
 
 /*!
  * @brief  This API will initialize a CAN port.
  * @param [in]      inst_can - CAN number (e.g: 0, 1, 2).
  * @param [in]      bitrate - is a CAN bit rate in vt_can_bitrate_type_t (e.g: VT_BITRATE_125, VT_BITRATE_500).
- * @param [in]      callback - callback function.
+ * @param [in]      callback - callback function, of the events and of the errors.
  * @param [in]      *callbackParam - pointer to parameter.
  * @return          STATUS_SUCCESS, STATUS_FLEXCAN_MB_OUT_OF_RANGE,
  *                  or STATUS_ERROR.
@@ -223,8 +300,10 @@ status_t vt_init_can(uint8_t inst_can, vt_can_bitrate_type_t bitrate, flexcan_ca
 	vt_can_InitConfig.bitrate = bitRateTable[(int)btr];
 
 	result = FLEXCAN_DRV_Init(inst_can, &vt_can_State, (const flexcan_user_config_t *)&vt_can_InitConfig);
+	/* Errors only come through the error callback, the bitrate detection rejects a candidate on them */
+	FLEXCAN_DRV_InstallErrorCallback(inst_can, callback, callbackParam);
 
-	FLEXCAN_DRV_RxFifo(inst_can, &msg_buff[active_buff]);
+	FLEXCAN_DRV_RxFifo(inst_can, _vt_rx_buff(inst_can));
 
 	return result;
 }
@@ -237,6 +316,19 @@ status_t vt_init_can(uint8_t inst_can, vt_can_bitrate_type_t bitrate, flexcan_ca
  *                  or STATUS_ERROR.
  */
 status_t vt_re_init_can(uint8_t inst_can, vt_can_bitrate_type_t bitrate)
+{
+	return vt_re_init_can_mode(inst_can, bitrate, 0);
+}
+
+/*!
+ * @brief  This API will re-initialize a CAN port in normal or listen-only mode.
+ * @param [in]      inst_can - CAN number (e.g: 0, 1, 2).
+ * @param [in]      bitrate - is a CAN bit rate in vt_can_bitrate_type_t (e.g: VT_BITRATE_125, VT_BITRATE_500).
+ * @param [in]      listen_only - 1 to neither acknowledge nor send, 0 for normal mode.
+ * @return          STATUS_SUCCESS, STATUS_FLEXCAN_MB_OUT_OF_RANGE,
+ *                  or STATUS_ERROR.
+ */
+status_t vt_re_init_can_mode(uint8_t inst_can, vt_can_bitrate_type_t bitrate, uint8_t listen_only)
 {
 	vt_can_bitrate_type_t btr = VT_BITRATE_500;
 	status_t result = STATUS_ERROR;
@@ -244,9 +336,14 @@ status_t vt_re_init_can(uint8_t inst_can, vt_can_bitrate_type_t bitrate)
 	if(bitrate < VT_BITRATE_UNKNOWN)
 		btr = bitrate;
 	vt_can_InitConfig.bitrate = bitRateTable[(int)btr];
+	/* The configuration is shared by the ports, the next init is in normal mode again */
+	vt_can_InitConfig.flexcanMode = listen_only ? FLEXCAN_LISTEN_ONLY_MODE : FLEXCAN_NORMAL_MODE;
 	result = FLEXCAN_DRV_Init(inst_can, &vt_can_State, (const flexcan_user_config_t *)&vt_can_InitConfig);
+	vt_can_InitConfig.flexcanMode = FLEXCAN_NORMAL_MODE;
+	/* The init uninstalls the error callback */
+	FLEXCAN_DRV_InstallErrorCallback(inst_can, vt_can_State.callback, vt_can_State.callbackParam);
 
-	FLEXCAN_DRV_RxFifo(inst_can, &msg_buff[active_buff]);
+	FLEXCAN_DRV_RxFifo(inst_can, _vt_rx_buff(inst_can));
 	return result;
 }
 
@@ -413,6 +510,7 @@ status_t vt_send_can_msg(uint8_t inst_can, flexcan_msgbuff_t *msgbuff, flexcan_m
 				} while(++z < 10000);
 			}
 			FLEXCAN_DRV_AbortTransfer(inst_can, i);
+			vt_can_count_tx_abort(inst_can);
 			can_error = -1;
 		}
 	}
@@ -429,6 +527,22 @@ int vt_add_can_id_to_rxfifo_filter(uint32_t value)
 {
 	int i = -1,z;
 
+	if(rxfifo_bulk_load)
+	{
+		/* Append unsorted, vt_commit_rxfifo_filter_bulk_load() sorts once. A duplicate takes no entry */
+		for(z = 0; z < rxfifo_count; z++)
+		{
+			if(rxFifoFilter[z] == value)
+				return z;
+		}
+		if(rxfifo_count < VT_MAX_FILTER_BUFFER)
+		{
+			i = rxfifo_count;
+			rxFifoFilter[rxfifo_count++] = value;
+		}
+		return i;
+	}
+
 	i = _vt_can_bsearch(rxFifoFilter, rxfifo_count, value);
 	if(i < 0)
 	{
@@ -448,6 +562,42 @@ int vt_add_can_id_to_rxfifo_filter(uint32_t value)
 	return i;
 }
 
+/*!
+ * @brief  This API will start a bulk load of Rxfifo filter table. The next calls of vt_add_can_id_to_rxfifo_filter
+ *          append the can id without sorting until vt_commit_rxfifo_filter_bulk_load is called. A can id already
+ *          in the table is not appended again, its position is returned.
+ * @param [in]      none .
+ * @return          none
+ */
+void vt_begin_rxfifo_filter_bulk_load(void)
+{
+	rxfifo_bulk_load = 1;
+}
+
+/*!
+ * @brief  This API will finish a bulk load of Rxfifo filter table. The table is sorted once and the unused entries
+ *          are filled with the last can id.
+ * @param [in]      none .
+ * @return          number of can id in Rxfifo table
+ */
+int vt_commit_rxfifo_filter_bulk_load(void)
+{
+	int z;
+
+	rxfifo_bulk_load = 0;
+	if(rxfifo_count == 0)
+		return 0;
+
+	/* Duplicates were refused on append */
+	qsort(rxFifoFilter, rxfifo_count, sizeof(uint32_t), vt_can_id_compare);
+
+	for(z = rxfifo_count; z < VT_MAX_FILTER_BUFFER; z++)
+	{
+		rxFifoFilter[z] = rxFifoFilter[rxfifo_count - 1];
+	}
+	return rxfifo_count;
+}
+
 /*!
  * @brief  This API will clear all can id of Rxfifo table.
  * @param [in]      none .
@@ -462,6 +612,7 @@ void vt_clear_filter_buffer(void)
 		rxFifoFilter[i] = 0x00000000;
 	}
 	rxfifo_count = 0;
+	rxfifo_bulk_load = 0;
 }
 
 /*!
@@ -471,7 +622,7 @@ void vt_clear_filter_buffer(void)
  */
 void vt_start_rcv(uint8_t inst_can)
 {
-	  FLEXCAN_DRV_RxFifo(inst_can, &msg_buff[active_buff]);
+	  FLEXCAN_DRV_RxFifo(inst_can, _vt_rx_buff(inst_can));
 }
 
 /*!
@@ -507,6 +658,43 @@ void vt_update_can_led(void)
 	}
 }
 
+/*!
+ * @brief  This API will get counters of a CAN port.
+ * @param [in]      inst_can - CAN number (e.g: 0, 1, 2).
+ * @param [out]     *stats - pointer to vt_can_stats_t structure.
+ * @return          VT_STATUS_SUCCESS, VT_STATUS_NULL or VT_STATUS_INVALID.
+ */
+vt_status_t vt_can_get_stats(uint8_t inst_can, vt_can_stats_t *stats)
+{
+	vt_can_stats_t *src;
+
+	if(stats == NULL)
+		return VT_STATUS_NULL;
+	if(inst_can >= VT_MAX_CAN_NUMBER)
+		return VT_STATUS_INVALID;
+
+	/* Each counter is read atomically, the set is not a snapshot of one instant */
+	src = &can_stats[inst_can];
+	stats->rx_frames = VT_ATOMIC_LOAD(&src->rx_frames);
+	stats->tx_frames = VT_ATOMIC_LOAD(&src->tx_frames);
+	stats->rx_fifo_overflow = VT_ATOMIC_LOAD(&src->rx_fifo_overflow);
+	stats->rx_fifo_warning = VT_ATOMIC_LOAD(&src->rx_fifo_warning);
+	stats->tx_aborts = VT_ATOMIC_LOAD(&src->tx_aborts);
+	stats->errors = VT_ATOMIC_LOAD(&src->errors);
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will count a transmission aborted or refused by the driver.
+ * @param [in]      inst_can - CAN number (e.g: 0, 1, 2).
+ * @return          none.
+ */
+void vt_can_count_tx_abort(uint8_t inst_can)
+{
+	VT_ATOMIC_ADD(&can_stats[(inst_can < VT_MAX_CAN_NUMBER) ? inst_can : VT_MAX_CAN_NUMBER].tx_aborts, 1);
+}
+
 /*------------------------------------------------------------------*
  *                       Test Function                              *
  *------------------------------------------------------------------*/
@@ -522,10 +710,12 @@ void vt_test_rxfifo_filter(uint8_t inst_can)
 	uint32_t can_id = 1;
 	int i = 0;
 
+	vt_begin_rxfifo_filter_bulk_load();
 	for(i = 0; i < VT_MAX_FILTER_BUFFER; i++)
 	{
 		vt_add_can_id_to_rxfifo_filter(can_id++);
 	}
+	vt_commit_rxfifo_filter_bulk_load();
 	vt_set_filter_rxfifo(inst_can);
 }
 
@@ -0,0 +1,306 @@
+/*
+ * vt_event.c
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_event.h"
+#include "vt_atomic.h"
+
+/*------------------------------------------------------------------*
+ *                          Define Macro                            *
+ *------------------------------------------------------------------*/
+#define VT_EVENT_RING_MASK (VT_EVENT_RING_SIZE - 1U)
+
+#if (VT_EVENT_RING_SIZE & VT_EVENT_RING_MASK) != 0
+#error "VT_EVENT_RING_SIZE must be a power of 2"
+#endif
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief Slot of the ring. seq tells who owns the slot: seq == pos means free for the producer of position pos,
+ *        seq == pos + 1 means the record of position pos is published for the consumer.
+ */
+typedef struct _vt_event_slot_t
+{
+	uint32_t seq;
+	vt_event_t event;
+}vt_event_slot_t;
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+static vt_event_slot_t *event_ring = NULL;
+static uint32_t event_head = 0;          /*!< next position to reserve, shared by producers */
+static uint32_t event_tail = 0;          /*!< next position to consume, consumer only */
+static vt_event_stats_t event_stats;
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will format traffic status to a string.
+ * @param [out]  *st - pointer to string buffer.
+ * @param [in]   len - size of string buffer.
+ * @param [in]   *traffic - pointer to vt_event_traffic_t structure.
+ * @return       none.
+ */
+static void _vt_event_format_traffic_status(char *st, int len, const vt_event_traffic_t *traffic)
+{
+	vt_car_status_t car_status = traffic->car_status;
+	vt_rate_t slot_rate = traffic->slot_rate;
+	vt_rate_t pattern_rate = traffic->pattern_rate;
+	uint32_t count_frames = traffic->count_frames;
+	int size = 0;
+
+	memset(st,'\0', len);
+
+	if(car_status == VT_CAR_IDLE_STAT)
+	{
+		snprintf(st, len, "The CAN bus traffic is idle\r\n");
+	}
+	else
+	{
+		if((car_status & VT_CAR_NORMAL_STAT) == VT_CAR_NORMAL_STAT)
+		{
+			snprintf(st, len, "- Slot rate: %lu.%02lu%%\r\n- Pattern rate: %lu.%02lu%% all frame: %lu\r\nThe CAN bus traffic is normal\r\n", VT_RATE_PERCENT(slot_rate), VT_RATE_PERCENT_FRAC(slot_rate), VT_RATE_PERCENT(pattern_rate), VT_RATE_PERCENT_FRAC(pattern_rate), count_frames);
+		}
+
+		if((car_status & VT_CAR_ABNORMAL_OVER_STAT) == VT_CAR_ABNORMAL_OVER_STAT)
+		{
+			snprintf(st, len, "- Slot rate: %lu.%02lu%%\r\n- Pattern rate: %lu.%02lu%% all frame: %lu\r\nThe CAN bus traffic is abnormal - overload frames\r\n", VT_RATE_PERCENT(slot_rate), VT_RATE_PERCENT_FRAC(slot_rate), VT_RATE_PERCENT(pattern_rate), VT_RATE_PERCENT_FRAC(pattern_rate), count_frames);
+		}
+
+		if((car_status & VT_CAR_ABNORMAL_STAT) == VT_CAR_ABNORMAL_STAT)
+		{
+			snprintf(st, len, "- Slot rate: %lu.%02lu%%\r\n- Pattern rate: %lu.%02lu%% all frame: %lu\r\nThe CAN bus traffic is abnormal\r\n", VT_RATE_PERCENT(slot_rate), VT_RATE_PERCENT_FRAC(slot_rate), VT_RATE_PERCENT(pattern_rate), VT_RATE_PERCENT_FRAC(pattern_rate), count_frames);
+		}
+
+		if((car_status & VT_CAR_ABNORMAL_DS_TP_STAT) == VT_CAR_ABNORMAL_DS_TP_STAT)
+		{
+			size = strlen(st);
+			if(size == 0)
+				snprintf(st, len, "- Slot rate: %lu.%02lu%%\r\n- Pattern rate: %lu.%02lu%% all frame: %lu\r\nThe CAN bus traffic is abnormal - diagnostic\r\n", VT_RATE_PERCENT(slot_rate), VT_RATE_PERCENT_FRAC(slot_rate), VT_RATE_PERCENT(pattern_rate), VT_RATE_PERCENT_FRAC(pattern_rate), count_frames);
+			else
+				snprintf(&st[size - 2], (len - size), " - diagnostic\r\n");
+		}
+
+		if((car_status & VT_CAR_ABNORMAL_MALICIOUS) == VT_CAR_ABNORMAL_MALICIOUS)
+		{
+			size = strlen(st);
+			if(size == 0)
+				snprintf(st, len, "- Slot rate: %lu.%02lu%%\r\n- Pattern rate: %lu.%02lu%% all frame: %lu\r\nThe CAN bus traffic is abnormal - malicious\r\n", VT_RATE_PERCENT(slot_rate), VT_RATE_PERCENT_FRAC(slot_rate), VT_RATE_PERCENT(pattern_rate), VT_RATE_PERCENT_FRAC(pattern_rate), count_frames);
+			else
+				snprintf(&st[size - 2], (len - size), " - malicious\r\n");
+		}
+
+		if((car_status & VT_CAR_IDLE_STAT) == VT_CAR_IDLE_STAT)
+		{
+			size = strlen(st);
+			snprintf(&st[size -2 ], (len - size), " - idle\r\n");
+		}
+	}
+}
+
+/*!
+ * @brief  This API will format matched of vector data to a string.
+ * @param [out]  *st - pointer to string buffer.
+ * @param [in]   len - size of string buffer.
+ * @param [in]   *vector_t - pointer to vt_event_vector_t structure.
+ * @return       none.
+ */
+static void _vt_event_format_vector(char *st, int len, const vt_event_vector_t *vector_t)
+{
+	memset(st,'\0', len);
+	if(vector_t->matched_flag > 0)
+	{
+		snprintf(st, len, "- Vector rate: %lu/%lu = %lu.%02lu%% - all vectors: %lu\r\n", vector_t->count_vector_in_rl, vector_t->count_vector_in_rt, VT_RATE_PERCENT(vector_t->matched_rate), VT_RATE_PERCENT_FRAC(vector_t->matched_rate), vector_t->count_all_vector);
+	}
+	else
+	{
+		if(vector_t->matched_rate >= VT_RATE(96U, 100U))
+			snprintf(st, len, "- Vector rate: %lu/%lu = %lu.%04lu%% - all vectors: %lu is too small\r\n", vector_t->count_vector_in_rl, vector_t->count_vector_in_rt, VT_RATE_WHOLE(vector_t->matched_rate), VT_RATE_FRAC(vector_t->matched_rate), vector_t->count_all_vector);
+		else
+			snprintf(st, len, "- Vector rate: %lu/%lu = %lu.%02lu%% - all vectors: %lu\r\n", vector_t->count_vector_in_rl, vector_t->count_vector_in_rt, VT_RATE_PERCENT(vector_t->matched_rate), VT_RATE_PERCENT_FRAC(vector_t->matched_rate), vector_t->count_all_vector);
+	}
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will create the event ring with storage carved from an arena.
+ * @param [in]   arena - is arena of a subsystem.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_NO_MEM.
+ */
+vt_status_t vt_event_init(vt_arena_id_t arena)
+{
+	vt_status_t status;
+	void *ptr;
+	uint32_t i;
+
+	status = vt_arena_alloc(arena, VT_EVENT_RING_SIZE * sizeof(vt_event_slot_t), &ptr);
+	if(status != VT_STATUS_SUCCESS)
+		return status;
+
+	event_ring = (vt_event_slot_t *)ptr;
+	for(i = 0; i < VT_EVENT_RING_SIZE; i++)
+	{
+		event_ring[i].seq = i;
+	}
+	event_head = 0;
+	event_tail = 0;
+	memset(&event_stats, 0, sizeof(event_stats));
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will push a record to the event ring.
+ * @param [in]   *event - pointer to vt_event_t structure.
+ * @return       VT_STATUS_SUCCESS, or VT_STATUS_FULL when the record is dropped.
+ */
+vt_status_t vt_event_push(const vt_event_t *event)
+{
+	vt_event_slot_t *slot;
+	uint32_t pos, seq;
+	int32_t diff;
+
+	if(event_ring == NULL)
+		return VT_STATUS_UNREADY;
+
+	pos = VT_ATOMIC_LOAD(&event_head);
+	for(;;)
+	{
+		slot = &event_ring[pos & VT_EVENT_RING_MASK];
+		seq = VT_ATOMIC_LOAD(&slot->seq);
+		diff = (int32_t)(seq - pos);
+		if(diff == 0)
+		{
+			/* Slot is free, reserve it. On failure pos is reloaded with the current head */
+			if(VT_ATOMIC_CAS(&event_head, &pos, pos + 1))
+				break;
+		}
+		else if(diff < 0)
+		{
+			/* The consumer has not released this slot yet: ring is full */
+			VT_ATOMIC_ADD(&event_stats.dropped, 1);
+			return VT_STATUS_FULL;
+		}
+		else
+		{
+			pos = VT_ATOMIC_LOAD(&event_head);
+		}
+	}
+
+	slot->event = *event;
+	VT_ATOMIC_STORE(&slot->seq, pos + 1);
+	VT_ATOMIC_ADD(&event_stats.pushed, 1);
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will get the oldest record from the event ring.
+ * @param [out]  *event - pointer to vt_event_t structure.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_EMPTY.
+ */
+vt_status_t vt_event_pop(vt_event_t *event)
+{
+	vt_event_slot_t *slot;
+
+	if(event_ring == NULL)
+		return VT_STATUS_UNREADY;
+
+	slot = &event_ring[event_tail & VT_EVENT_RING_MASK];
+	if(VT_ATOMIC_LOAD(&slot->seq) != (event_tail + 1))
+		return VT_STATUS_EMPTY;
+
+	*event = slot->event;
+	/* Hand the slot back to the producers of the next lap */
+	VT_ATOMIC_STORE(&slot->seq, event_tail + VT_EVENT_RING_SIZE);
+	event_tail++;
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will count a record as handed to the transport.
+ * @param [in]   none.
+ * @return       none.
+ */
+void vt_event_mark_sent(void)
+{
+	event_stats.sent++;
+}
+
+/*!
+ * @brief  This API will get counters of the event ring.
+ * @param [out]  *stats - pointer to vt_event_stats_t structure.
+ * @return       none.
+ */
+void vt_event_get_stats(vt_event_stats_t *stats)
+{
+	if(stats == NULL)
+		return;
+	stats->pushed = VT_ATOMIC_LOAD(&event_stats.pushed);
+	stats->dropped = VT_ATOMIC_LOAD(&event_stats.dropped);
+	stats->sent = event_stats.sent;
+}
+
+/*!
+ * @brief  This API will format an event record to a string.
+ * @param [in]   *event - pointer to vt_event_t structure.
+ * @param [out]  *st - pointer to string buffer.
+ * @param [in]   len - size of string buffer.
+ * @return       length of string.
+ */
+int vt_event_format(const vt_event_t *event, char *st, int len)
+{
+	switch(event->type)
+	{
+	case VT_EVENT_TRAFFIC_STATUS:
+		_vt_event_format_traffic_status(st, len, &event->u.traffic);
+		break;
+	case VT_EVENT_VECTOR:
+		_vt_event_format_vector(st, len, &event->u.vector);
+		break;
+	case VT_EVENT_BLACKLIST:
+	case VT_EVENT_MONITOR:
+		vt_fw_format_result(&event->u.result, st, len);
+		break;
+	case VT_EVENT_DROPPED:
+		snprintf(st, len, "- Events dropped: %lu\r\n", event->u.dropped);
+		break;
+	case VT_EVENT_SUMMARY:
+		snprintf(st, len, "- %s repeated: ID 0x%03lX hits %lu in ticks %lu..%lu peak %lu/s\r\n",
+		         vt_fw_rule_name(event->u.summary.rule_type), event->u.summary.can_id, event->u.summary.count,
+		         event->u.summary.first_ts, event->u.summary.last_ts, event->u.summary.peak_rate);
+		break;
+	case VT_EVENT_PROBE:
+		snprintf(st, len, "- Probe %s: %lu calls min %lu ns max %lu ns p99 %lu ns\r\n", vt_probe_name(event->u.probe.probe),
+		         event->u.probe.count, event->u.probe.min_ns, event->u.probe.max_ns, event->u.probe.p99_ns);
+		break;
+	case VT_EVENT_MISSING:
+		snprintf(st, len, "- Missing frames: ID 0x%03lX silent since tick %lu, timeout %lu ticks\r\n", event->u.missing.can_id,
+		         event->u.missing.last_ts, event->u.missing.timeout);
+		break;
+	default:
+		st[0] = '\0';
+		break;
+	}
+	return (int)strlen(st);
+}
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,372 @@
+/*
+ * vt_fw_ctx.c
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include <string.h>
+#include "vt_fw_ctx.h"
+#include "vt_missing.h"
+#include "vt_timer.h"
+#include "vt_atomic.h"
+
+/*------------------------------------------------------------------*
+ *                          Define Macro                            *
+ *------------------------------------------------------------------*/
+#define VT_FW_CTX_DEFAULT   0U
+#define VT_FW_CTX_ALL_BUSES ((1UL << VT_FW_CTX_BUSES) - 1UL)
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief Context. Frame counters are written by the RX interrupts of its buses, the rest by the main loop.
+ */
+struct _vt_fw_ctx_t
+{
+	uint8_t used;
+	uint32_t bus_mask;
+	volatile vt_fw_blacklist_callback blacklist_cb;
+	volatile vt_fw_monitor_callback monitor_cb;
+	uint32_t frames;                /*!< frames of the current window */
+	vt_fw_ctx_stats_t stats;
+};
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+static vt_fw_ctx_t fw_ctx[VT_FW_CTX_MAX];
+/* Context of each bus, read by the RX interrupts */
+static uint8_t fw_ctx_of_bus[VT_FW_CTX_BUSES];
+/* Context of the frame the firewall core is checking, NULL outside vt_fw_ctx_can_msg_is_malicious() */
+static vt_fw_ctx_t *volatile fw_ctx_current = NULL;
+/* Callbacks of the whole core */
+static volatile vt_fw_vector_callback fw_vector_cb = NULL;
+static volatile vt_fw_traffic_status_callback fw_traffic_cb = NULL;
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will clear a context.
+ * @param [in]   *ctx - pointer to vt_fw_ctx_t structure.
+ * @param [in]   bus_mask - is set of buses.
+ * @return       none.
+ */
+static void _vt_fw_ctx_reset(vt_fw_ctx_t *ctx, uint32_t bus_mask)
+{
+	memset(ctx, 0, sizeof(vt_fw_ctx_t));
+	ctx->used = 1;
+	ctx->bus_mask = bus_mask;
+}
+
+/*!
+ * @brief  This API will get the context a detection of the firewall core goes to.
+ * @param [in]   none.
+ * @return       pointer to vt_fw_ctx_t structure.
+ */
+static vt_fw_ctx_t *_vt_fw_ctx_of_detection(void)
+{
+	vt_fw_ctx_t *ctx = fw_ctx_current;
+
+	/* Detections of the time windows are not tied to a bus */
+	if(ctx == NULL || !ctx->used)
+		ctx = &fw_ctx[VT_FW_CTX_DEFAULT];
+	return ctx;
+}
+
+/*!
+ * @brief  This API will hand a vector result of the firewall core to the global callback.
+ * @param [in]   *vector_t - pointer to vt_vector_result_t structure.
+ * @return       status of the callback, VT_STATUS_SUCCESS without callback.
+ */
+static vt_status_t _vt_fw_ctx_vector(vt_vector_result_t *vector_t)
+{
+	vt_fw_vector_callback callback = fw_vector_cb;
+
+	if(callback == NULL)
+		return VT_STATUS_SUCCESS;
+	return callback(vector_t);
+}
+
+/*!
+ * @brief  This API will close a window for every context and hand its traffic status to the global callback.
+ * @param [in]   car_status - is traffic status.
+ * @param [in]   slot_rate - is slot rate of CAN traffic bus.
+ * @param [in]   pattern_rate - is pattern rate of CAN traffic bus.
+ * @param [in]   count_id - is CAN frames of the window.
+ * @return       none.
+ */
+static void _vt_fw_ctx_traffic_status(vt_car_status_t car_status, float slot_rate, float pattern_rate, uint32_t count_id)
+{
+	vt_fw_traffic_status_callback callback = fw_traffic_cb;
+	uint32_t i;
+
+	for(i = 0; i < VT_FW_CTX_MAX; i++)
+	{
+		if(fw_ctx[i].used)
+			VT_ATOMIC_STORE(&fw_ctx[i].stats.window_frames, VT_ATOMIC_EXCHANGE(&fw_ctx[i].frames, 0U));
+	}
+	if(callback != NULL)
+		callback(car_status, slot_rate, pattern_rate, count_id);
+}
+
+/*!
+ * @brief  This API will hand a blacklist detection of the firewall core to its context.
+ * @param [in]   *detail_result - pointer to vt_fw_detail_result_t structure.
+ * @return       status of the callback, VT_STATUS_SUCCESS without callback.
+ */
+static vt_status_t _vt_fw_ctx_blacklist(vt_fw_detail_result_t *detail_result)
+{
+	vt_fw_ctx_t *ctx = _vt_fw_ctx_of_detection();
+	vt_fw_blacklist_callback callback = ctx->blacklist_cb;
+
+	if(callback == NULL)
+		return VT_STATUS_SUCCESS;
+	VT_ATOMIC_ADD(&ctx->stats.blacklist_hits, 1);
+	return callback(detail_result);
+}
+
+/*!
+ * @brief  This API will hand a monitor detection of the firewall core to its context.
+ * @param [in]   *detail_result - pointer to vt_fw_detail_result_t structure.
+ * @return       status of the callback, VT_STATUS_SUCCESS without callback.
+ */
+static vt_status_t _vt_fw_ctx_monitor(vt_fw_detail_result_t *detail_result)
+{
+	vt_fw_ctx_t *ctx = _vt_fw_ctx_of_detection();
+	vt_fw_monitor_callback callback = ctx->monitor_cb;
+
+	if(callback == NULL)
+		return VT_STATUS_SUCCESS;
+	VT_ATOMIC_ADD(&ctx->stats.monitor_hits, 1);
+	return callback(detail_result);
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will reset every context and route the callbacks of the firewall core to them.
+ * @param [in]   none.
+ * @return       none.
+ */
+void vt_fw_ctx_init(void)
+{
+	uint32_t i;
+
+	memset(fw_ctx, 0, sizeof(fw_ctx));
+	fw_ctx_current = NULL;
+	fw_vector_cb = NULL;
+	fw_traffic_cb = NULL;
+	_vt_fw_ctx_reset(&fw_ctx[VT_FW_CTX_DEFAULT], VT_FW_CTX_ALL_BUSES);
+	for(i = 0; i < VT_FW_CTX_BUSES; i++)
+	{
+		VT_ATOMIC_STORE(&fw_ctx_of_bus[i], (uint8_t)VT_FW_CTX_DEFAULT);
+	}
+
+	vt_fw_install_vector_callback(_vt_fw_ctx_vector);
+	vt_fw_install_traffic_status_callback(_vt_fw_ctx_traffic_status);
+	vt_fw_install_blacklist_callback(_vt_fw_ctx_blacklist);
+	vt_fw_install_monitor_callback(_vt_fw_ctx_monitor);
+}
+
+/*!
+ * @brief  This API will get the default context.
+ * @param [in]   none.
+ * @return       pointer to vt_fw_ctx_t structure.
+ */
+vt_fw_ctx_t *vt_fw_ctx_default(void)
+{
+	return &fw_ctx[VT_FW_CTX_DEFAULT];
+}
+
+/*!
+ * @brief  This API will open a context owning a set of buses, taken from the default context.
+ * @param [in]   bus_mask - is set of buses, VT_FW_CTX_BUS(bus) ORed.
+ * @return       pointer to vt_fw_ctx_t structure, or NULL.
+ */
+vt_fw_ctx_t *vt_fw_ctx_open(uint32_t bus_mask)
+{
+	vt_fw_ctx_t *ctx = NULL;
+	uint32_t i;
+
+	if(bus_mask == 0 || (bus_mask & ~VT_FW_CTX_ALL_BUSES) != 0)
+		return NULL;
+	if((bus_mask & fw_ctx[VT_FW_CTX_DEFAULT].bus_mask) != bus_mask)
+		return NULL;
+	for(i = VT_FW_CTX_DEFAULT + 1U; i < VT_FW_CTX_MAX && ctx == NULL; i++)
+	{
+		if(!fw_ctx[i].used)
+			ctx = &fw_ctx[i];
+	}
+	if(ctx == NULL)
+		return NULL;
+
+	_vt_fw_ctx_reset(ctx, bus_mask);
+	fw_ctx[VT_FW_CTX_DEFAULT].bus_mask &= ~bus_mask;
+	/* Frames of the buses go to the new context from the next RX interrupt on */
+	for(i = 0; i < VT_FW_CTX_BUSES; i++)
+	{
+		if(bus_mask & VT_FW_CTX_BUS(i))
+			VT_ATOMIC_STORE(&fw_ctx_of_bus[i], (uint8_t)(ctx - fw_ctx));
+	}
+	return ctx;
+}
+
+/*!
+ * @brief  This API will close a context, its buses go back to the default context.
+ * @param [in]   *ctx - pointer to vt_fw_ctx_t structure.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL or VT_STATUS_INVALID.
+ */
+vt_status_t vt_fw_ctx_close(vt_fw_ctx_t *ctx)
+{
+	uint32_t i;
+
+	if(ctx == NULL)
+		return VT_STATUS_NULL;
+	if(ctx == &fw_ctx[VT_FW_CTX_DEFAULT] || ctx < fw_ctx || ctx >= &fw_ctx[VT_FW_CTX_MAX] || !ctx->used)
+		return VT_STATUS_INVALID;
+
+	for(i = 0; i < VT_FW_CTX_BUSES; i++)
+	{
+		if(ctx->bus_mask & VT_FW_CTX_BUS(i))
+			VT_ATOMIC_STORE(&fw_ctx_of_bus[i], (uint8_t)VT_FW_CTX_DEFAULT);
+	}
+	fw_ctx[VT_FW_CTX_DEFAULT].bus_mask |= ctx->bus_mask;
+	ctx->used = 0;
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will get the context owning a bus.
+ * @param [in]   bus - is CAN number (e.g: 0, 1, 2).
+ * @return       pointer to vt_fw_ctx_t structure.
+ */
+vt_fw_ctx_t *vt_fw_ctx_of_bus(uint8_t bus)
+{
+	if(bus >= VT_FW_CTX_BUSES)
+		return &fw_ctx[VT_FW_CTX_DEFAULT];
+	return &fw_ctx[VT_ATOMIC_LOAD(&fw_ctx_of_bus[bus])];
+}
+
+/*!
+ * @brief  This API will add a CAN message of a bus of the context to the firewall queue.
+ * @param [in]   *ctx - pointer to vt_fw_ctx_t structure.
+ * @param [in]   id - is CAN ID.
+ * @param [in]   len - length of data buffer.
+ * @param [in]   *databuff - a pointer to data array.
+ * @return       none.
+ */
+void vt_fw_ctx_rcv_msg(vt_fw_ctx_t *ctx, uint32_t id, uint8_t len, uint8_t *databuff)
+{
+	if(ctx != NULL)
+	{
+		VT_ATOMIC_ADD(&ctx->stats.rx_frames, 1);
+		VT_ATOMIC_ADD(&ctx->frames, 1);
+	}
+	vt_missing_rcv(id, vt_timer_get_ticks());
+	vt_fw_rcv_msg(id, len, databuff);
+}
+
+/*!
+ * @brief  This API will check a CAN message of a bus of the context against the malicious frames.
+ * @param [in]   *ctx - pointer to vt_fw_ctx_t structure.
+ * @param [in]   msgId - is CAN ID.
+ * @param [in]   dataLen - length of data buffer.
+ * @param [in]   *databuff - a pointer to data array.
+ * @return       1 if malicious, 0 otherwise.
+ */
+uint8_t vt_fw_ctx_can_msg_is_malicious(vt_fw_ctx_t *ctx, uint32_t msgId, uint8_t dataLen, uint8_t *databuff)
+{
+	vt_fw_ctx_t *previous = fw_ctx_current;
+	uint8_t malicious;
+
+	/* The core calls back before it returns, a nested RX interrupt puts back the context it found */
+	fw_ctx_current = ctx;
+	malicious = vt_fw_can_msg_is_malicious(msgId, dataLen, databuff);
+	fw_ctx_current = previous;
+
+	if(malicious && ctx != NULL)
+		VT_ATOMIC_ADD(&ctx->stats.malicious_frames, 1);
+	return malicious;
+}
+
+/*!
+ * @brief  This API will install the vector callback, global to every context.
+ * @param [in]   callback - callback function, NULL removes it.
+ * @return       none.
+ */
+void vt_fw_ctx_install_global_vector_callback(vt_fw_vector_callback callback)
+{
+	fw_vector_cb = callback;
+}
+
+/*!
+ * @brief  This API will install the traffic status callback, global to every context.
+ * @param [in]   callback - callback function, NULL removes it.
+ * @return       none.
+ */
+void vt_fw_ctx_install_global_traffic_status_callback(vt_fw_traffic_status_callback callback)
+{
+	fw_traffic_cb = callback;
+}
+
+/*!
+ * @brief  This API will install the blacklist callback of a context.
+ * @param [in]   *ctx - pointer to vt_fw_ctx_t structure.
+ * @param [in]   callback - callback function, NULL removes it.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_NULL.
+ */
+vt_status_t vt_fw_ctx_install_blacklist_callback(vt_fw_ctx_t *ctx, vt_fw_blacklist_callback callback)
+{
+	if(ctx == NULL)
+		return VT_STATUS_NULL;
+	ctx->blacklist_cb = callback;
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will install the monitor callback of a context.
+ * @param [in]   *ctx - pointer to vt_fw_ctx_t structure.
+ * @param [in]   callback - callback function, NULL removes it.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_NULL.
+ */
+vt_status_t vt_fw_ctx_install_monitor_callback(vt_fw_ctx_t *ctx, vt_fw_monitor_callback callback)
+{
+	if(ctx == NULL)
+		return VT_STATUS_NULL;
+	ctx->monitor_cb = callback;
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will get counters of a context.
+ * @param [in]   *ctx - pointer to vt_fw_ctx_t structure.
+ * @param [out]  *stats - pointer to vt_fw_ctx_stats_t structure.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_NULL.
+ */
+vt_status_t vt_fw_ctx_get_stats(vt_fw_ctx_t *ctx, vt_fw_ctx_stats_t *stats)
+{
+	if(ctx == NULL || stats == NULL)
+		return VT_STATUS_NULL;
+
+	*stats = ctx->stats;
+	stats->bus_mask = ctx->bus_mask;
+	stats->rx_frames = VT_ATOMIC_LOAD(&ctx->stats.rx_frames);
+	stats->malicious_frames = VT_ATOMIC_LOAD(&ctx->stats.malicious_frames);
+	stats->window_frames = VT_ATOMIC_LOAD(&ctx->stats.window_frames);
+	stats->blacklist_hits = VT_ATOMIC_LOAD(&ctx->stats.blacklist_hits);
+	stats->monitor_hits = VT_ATOMIC_LOAD(&ctx->stats.monitor_hits);
+	return VT_STATUS_SUCCESS;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,208 @@
+/*
+ * vt_fw_dual.c
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_fw_dual.h"
+#include "vt_fw_oem.h"
+#include "vt_fw_ctx.h"
+#include "vt_atomic.h"
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+/* CAN core to firewall core */
+static VT_IPC_SHARED vt_ipc_channel_t frame_channel;
+static VT_IPC_SHARED vt_ipc_frame_t frame_buff[VT_FW_DUAL_CHANNEL_SIZE] VT_IPC_ALIGNED;
+/* Firewall core to CAN core */
+static VT_IPC_SHARED vt_ipc_channel_t verdict_channel;
+static VT_IPC_SHARED vt_ipc_frame_t verdict_buff[VT_FW_DUAL_CHANNEL_SIZE] VT_IPC_ALIGNED;
+
+/* Written by the CAN core only */
+static uint32_t stats_frames = 0;
+static uint32_t stats_verdicts = 0;
+static uint32_t stats_malicious = 0;
+static vt_probe_hist_t round_trip;
+/* Written by the firewall core only */
+static VT_IPC_SHARED uint32_t stats_checked VT_IPC_ALIGNED = 0;
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will empty both channels and clear the counters.
+ * @param [in]   none.
+ * @return       none.
+ */
+void vt_fw_dual_init(void)
+{
+	vt_ipc_init(&frame_channel, frame_buff, VT_FW_DUAL_CHANNEL_SIZE);
+	vt_ipc_init(&verdict_channel, verdict_buff, VT_FW_DUAL_CHANNEL_SIZE);
+	VT_ATOMIC_STORE(&stats_frames, 0U);
+	VT_ATOMIC_STORE(&stats_verdicts, 0U);
+	VT_ATOMIC_STORE(&stats_malicious, 0U);
+	VT_ATOMIC_STORE(&stats_checked, 0U);
+	vt_probe_hist_reset(&round_trip);
+}
+
+/*!
+ * @brief  This API will hand a received frame to the firewall core, in the RX interrupt of the CAN core.
+ * @param [in]   instance - is CAN number (e.g: 0, 1, 2).
+ * @param [in]   *msg - is pointer to flexcan message.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_FULL.
+ */
+vt_status_t vt_fw_dual_rx(uint8_t instance, const flexcan_msgbuff_t *msg)
+{
+	vt_ipc_frame_t frame;
+	vt_status_t status;
+
+	frame.time_stamp = vt_probe_now();
+	frame.instance = instance;
+	frame.verdict = 0;
+	frame.frame.msgId = msg->msgId;
+	frame.frame.dataLen = (msg->dataLen > VT_MAX_DATA_BYTE_LENGTH) ? VT_MAX_DATA_BYTE_LENGTH : msg->dataLen;
+	memcpy(frame.frame.data, msg->data, frame.frame.dataLen);
+
+	/* The RX interrupt of another instance pushes too */
+	VT_FW_DUAL_LOCK();
+	status = vt_ipc_push(&frame_channel, &frame);
+	VT_FW_DUAL_UNLOCK();
+	if(status != VT_STATUS_SUCCESS)
+		return VT_STATUS_FULL;
+	VT_ATOMIC_ADD(&stats_frames, 1);
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will check the frames of the frame channel and hand back their verdicts, in the main loop of the
+ *         firewall core before vt_fw_process(), vt_fw_process_until_idle() calls it. It stops when the verdict
+ *         channel is full.
+ * @param [in]   max_frames - is maximum number of frames to check.
+ * @return       number of frames checked.
+ */
+uint32_t vt_fw_dual_fw_process(uint32_t max_frames)
+{
+	vt_ipc_frame_t frame;
+	vt_fw_ctx_t *ctx;
+	uint32_t space = vt_ipc_space(&verdict_channel);
+	uint32_t count = 0;
+
+	if(max_frames > space)
+		max_frames = space;
+	while(count < max_frames && vt_ipc_pop(&frame_channel, &frame) == VT_STATUS_SUCCESS)
+	{
+		ctx = vt_fw_ctx_of_bus(frame.instance);
+		{
+			VT_PROBE_START(probe_malicious);
+			frame.verdict = vt_fw_ctx_can_msg_is_malicious(ctx, frame.frame.msgId, frame.frame.dataLen, frame.frame.data);
+			VT_PROBE_END(VT_PROBE_FW_IS_MALICIOUS, probe_malicious);
+		}
+		{
+			VT_PROBE_START(probe_rcv_msg);
+			vt_fw_ctx_rcv_msg(ctx, frame.frame.msgId, frame.frame.dataLen, frame.frame.data);
+			VT_PROBE_END(VT_PROBE_FW_RCV_MSG, probe_rcv_msg);
+		}
+		/* Cannot fail, the space was reserved above */
+		vt_ipc_push(&verdict_channel, &frame);
+		count++;
+	}
+
+	if(count > 0)
+	{
+		VT_ATOMIC_ADD(&stats_checked, count);
+		VT_FW_DUAL_NOTIFY();
+	}
+	return count;
+}
+
+/*!
+ * @brief  This API will take the verdicts and forward the clean frames, on the CAN core at the priority of the
+ *         FlexCAN interrupts.
+ * @param [in]   none.
+ * @return       number of verdicts taken.
+ */
+uint32_t vt_fw_dual_verdict_process(void)
+{
+	vt_ipc_frame_t frame;
+	uint32_t count = 0;
+#ifdef USING_GATEWAY
+	flexcan_msgbuff_t msg;
+#endif
+	vt_status_t status;
+
+	for(;;)
+	{
+		/* The RX and TX interrupts of every instance and the notify interrupt all pop */
+		VT_FW_DUAL_LOCK();
+		status = vt_ipc_pop(&verdict_channel, &frame);
+		VT_FW_DUAL_UNLOCK();
+		if(status != VT_STATUS_SUCCESS)
+			break;
+
+		vt_probe_hist_record(&round_trip, vt_probe_now() - frame.time_stamp);
+		count++;
+		if(frame.verdict)
+		{
+			VT_ATOMIC_ADD(&stats_malicious, 1);
+			continue;
+		}
+#ifdef USING_GATEWAY
+		msg.msgId = frame.frame.msgId;
+		msg.dataLen = frame.frame.dataLen;
+		memcpy(msg.data, frame.frame.data, frame.frame.dataLen);
+		/* The time of the RX interrupt travels on, the latency of the port includes the round trip */
+		vt_fw_oem_add_message_to_forward_queue(frame.instance, &msg, frame.time_stamp);
+#endif
+	}
+
+	if(count > 0)
+		VT_ATOMIC_ADD(&stats_verdicts, count);
+	return count;
+}
+
+/*!
+ * @brief  This API will get the number of frames handed to the firewall core whose verdict the CAN core has not taken
+ *         yet, on the CAN core.
+ * @param [in]   none.
+ * @return       number of frames.
+ */
+uint32_t vt_fw_dual_pending(void)
+{
+	return stats_frames - stats_verdicts;
+}
+
+/*!
+ * @brief  This API will get counters of the channels. The round trip histogram is read on the CAN core.
+ * @param [out]  *stats - pointer to vt_fw_dual_stats_t structure.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_NULL.
+ */
+vt_status_t vt_fw_dual_get_stats(vt_fw_dual_stats_t *stats)
+{
+	if(stats == NULL)
+		return VT_STATUS_NULL;
+
+	memset(stats, 0, sizeof(vt_fw_dual_stats_t));
+	stats->frames = VT_ATOMIC_LOAD(&stats_frames);
+	stats->dropped = frame_channel.dropped;
+	stats->checked = VT_ATOMIC_LOAD(&stats_checked);
+	stats->verdicts = VT_ATOMIC_LOAD(&stats_verdicts);
+	stats->malicious = VT_ATOMIC_LOAD(&stats_malicious);
+	stats->frame_depth = vt_ipc_count(&frame_channel);
+	stats->frame_high_water = frame_channel.high_water;
+	stats->verdict_high_water = verdict_channel.high_water;
+	vt_probe_hist_get_stats(&round_trip, &stats->round_trip);
+
+	return VT_STATUS_SUCCESS;
+}
+
+#ifdef __cplusplus
+}
+#endif
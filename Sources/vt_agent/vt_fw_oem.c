@@ -11,9 +11,21 @@ extern "C" {
  *                           Includes                               *
  *------------------------------------------------------------------*/
 #include "vt_fw_oem.h"
+#include "vt_fw_ctx.h"
+#include "vt_fw_dual.h"
+#include "vt_osal.h"
+#include "vt_atomic.h"
+#include "vt_autodetect.h"
+
+#if VT_FW_DUAL_CORE && !defined(VT_FW_DUAL_WAKE)
+#error "VT_FW_DUAL_CORE needs VT_FW_DUAL_WAKE(), the software interrupt waking the firewall core (see vt_fw_dual.h)"
+#endif
 /*------------------------------------------------------------------*
  *                          Define Macro                            *
  *------------------------------------------------------------------*/
+/* Budget of the calls without one, longer than any call */
+#define VT_FW_NO_BUDGET            0xFFFFFFFFU
+#define VT_FW_PROBE_TICKS_PER_US   ((uint32_t)(VT_PROBE_TICK_HZ / 1000000UL))
 
 /*------------------------------------------------------------------*
  *                Define Enumeration and Structure                  *
@@ -27,9 +39,45 @@ extern "C" {
 /*------------------------------------------------------------------*
  *                        Private Data Types                        *
  *------------------------------------------------------------------*/
+/* Memory of every subsystem, nothing is allocated from the heap after vt_fw_oem_init */
+#ifdef VT_ARENA_HEAP
+/* Heap of the firewall core library, nothing else allocates from it */
+static uint64_t arena_core[VT_ARENA_CORE_SIZE / sizeof(uint64_t)];
+#endif
+static uint64_t arena_rules[VT_ARENA_RULES_SIZE / sizeof(uint64_t)];
+static uint64_t arena_queue[(VT_ARENA_QUEUE_SIZE + sizeof(uint64_t) - 1) / sizeof(uint64_t)];
+static uint64_t arena_state[VT_ARENA_STATE_SIZE / sizeof(uint64_t)];
+static uint64_t arena_event[VT_ARENA_EVENT_SIZE / sizeof(uint64_t)];
+
+/* Formatted report, owned by the UART while a transfer is in progress */
+static char report_buff[VT_REPORT_BUFFER_SIZE];
+static uint32_t report_dropped = 0;
+#if VT_REPORT_BINARY
+static vt_wire_encoder_t report_encoder;
+#endif
+#if VT_PROBE_ENABLE
+static uint32_t probe_report_ts = 0;
+#endif
+
+/* Wakeup of the firewall task: counters written by interrupts, copies by vt_fw_process_until_idle. The RX interrupts
+ * of the CAN core write the frames and the signal with VT_FW_DUAL_CORE, so they live in the memory of both cores */
+static VT_IPC_SHARED uint32_t idle_rx_frames VT_IPC_ALIGNED = 0;
+static uint32_t idle_timers = 0;
+static VT_IPC_SHARED uint32_t idle_signalled VT_IPC_ALIGNED = 0;
+static uint32_t idle_rx_seen = 0;
+static uint32_t idle_rx_pending = 0;
+
+/* Written by the firewall callbacks only */
+static uint32_t stats_rule_hits = 0;
+static uint32_t stats_unknown_hits = 0;
+static uint32_t stats_windows = 0;
+static uint32_t stats_window_frames = 0;
+static uint32_t stats_total_window_frames = 0;
+
 #ifdef USING_GATEWAY
 static uint8_t forward_id[VT_MAX_CAN_NUMBER] = {VT_INST_CAN1, VT_INST_CAN0};
 static volatile uint8_t tx_flags[VT_MAX_CAN_NUMBER];
+static vt_msg_queue_t tx_queue[VT_MAX_CAN_NUMBER];
 #endif
 
 static vt_can_frame_t malicious_frame = {
@@ -58,78 +106,314 @@ static vt_can_frame_t frames_pattern[2] = {
 /*------------------------------------------------------------------*
  *                        Private Functions                         *
  *------------------------------------------------------------------*/
-
-/*------------------------------------------------------------------*
- *                         Public Functions                         *
- *------------------------------------------------------------------*/
-
 /*!
- * @brief  This API will send traffic status to report to server or print out.
+ * @brief  This API will update block Led with traffic status.
  * @param [in]   car_status - is traffic status.
- * @param [in]   slot_rate - is slot rate of CAN traffic bus.
- * @param [in]   pattern_rate - is pattern rate of CAN traffic bus.
- * @param [in]   count_frames - is CAN frames of a time window.
  * @return       none.
  */
-void vt_fw_traffic_status_event(vt_car_status_t car_status, float slot_rate, float pattern_rate, uint32_t count_frames)
+static void _vt_fw_update_block_led(vt_car_status_t car_status)
 {
-	char st[256];
-	int size = 0;
-
-	memset(st,'\0', 256);
-
 	if(car_status == VT_CAR_IDLE_STAT)
 	{
-		snprintf(st, 256, "The CAN bus traffic is idle\r\n");
 		vt_led_off(leds[VT_BLOCK_LED]);
+		return;
+	}
+	if((car_status & VT_CAR_NORMAL_STAT) == VT_CAR_NORMAL_STAT)
+		vt_led_off(leds[VT_BLOCK_LED]);
+	if((car_status & VT_CAR_ABNORMAL_OVER_STAT) == VT_CAR_ABNORMAL_OVER_STAT)
+		vt_led_on(leds[VT_BLOCK_LED]);
+	if((car_status & VT_CAR_ABNORMAL_STAT) == VT_CAR_ABNORMAL_STAT)
+		vt_led_on(leds[VT_BLOCK_LED]);
+	if((car_status & VT_CAR_ABNORMAL_DS_TP_STAT) == VT_CAR_ABNORMAL_DS_TP_STAT)
+		vt_led_off(leds[VT_BLOCK_LED]);
+	if((car_status & VT_CAR_ABNORMAL_MALICIOUS) == VT_CAR_ABNORMAL_MALICIOUS)
+		vt_led_off(leds[VT_BLOCK_LED]);
+}
+
+/*!
+ * @brief  This API will fill a structured result from a detail result of the firewall core. The rule and its
+ *         bounds are found in the lookup index of the committed rules by the CAN Id of the detail.
+ * @param [in]   monitor - 0 for a blacklist detection, 1 for a monitor detection.
+ * @param [in]   *detail_result - pointer to vt_fw_detail_result_t structure.
+ * @param [in]   time_stamp - is slot tick count of the detection.
+ * @param [out]  *result - pointer to vt_fw_match_result_t structure.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_UNMATCHED.
+ */
+static vt_status_t _vt_fw_result_from_detail(uint8_t monitor, const vt_fw_detail_result_t *detail_result, uint32_t time_stamp,
+                                             vt_fw_match_result_t *result)
+{
+	vt_fw_rule_info_t info;
+
+	if(detail_result->matched_type == VT_UNMATCHED_BIT)
+		return VT_STATUS_UNMATCHED;
+
+	memset(result, 0, sizeof(vt_fw_match_result_t));
+	result->time_stamp = time_stamp;
+
+	/* Most specific match first */
+	if(detail_result->matched_type & VT_FRAME_BIT)
+		result->matched_bit = VT_FRAME_BIT;
+	else if(detail_result->matched_type & VT_PATTERN_BIT)
+		result->matched_bit = VT_PATTERN_BIT;
+	else
+		result->matched_bit = VT_RANGE_BIT;
+
+	if(monitor)
+	{
+		if(result->matched_bit == VT_FRAME_BIT)
+			result->rule_type = VT_RULE_MONITOR_FRAME;
+		else if(result->matched_bit == VT_PATTERN_BIT)
+			result->rule_type = VT_RULE_MONITOR_PATTERN;
+		else
+			result->rule_type = VT_RULE_MONITOR_RANGE;
 	}
 	else
 	{
-		if((car_status & VT_CAR_NORMAL_STAT) == VT_CAR_NORMAL_STAT)
-		{
-			snprintf(st, 256, "- Slot rate: %.3f%%\r\n- Pattern rate: %.3f%% all frame: %lu\r\nThe CAN bus traffic is normal\r\n", slot_rate * 100.0f, pattern_rate * 100.0f, count_frames);
-			vt_led_off(leds[VT_BLOCK_LED]);
-		}
+		result->rule_type = (result->matched_bit == VT_RANGE_BIT) ? VT_RULE_BLACKLIST_RANGE : VT_RULE_MALICIOUS_FRAME;
+	}
 
-		if((car_status & VT_CAR_ABNORMAL_OVER_STAT) == VT_CAR_ABNORMAL_OVER_STAT)
-		{
-			snprintf(st, 256, "- Slot rate: %.3f%%\r\n- Pattern rate: %.3f%% all frame: %lu\r\nThe CAN bus traffic is abnormal - overload frames\r\n", slot_rate * 100.0f, pattern_rate * 100.0f, count_frames);
-			vt_led_on(leds[VT_BLOCK_LED]);
-		}
+	result->can_id = vt_fw_detail_can_id(detail_result);
+	result->rule_id = VT_FW_RULE_ID_NONE;
+	if((result->can_id != VT_FW_CAN_ID_NONE) &&
+	   (vt_fw_find_rule((vt_fw_rule_type_t)result->rule_type, result->can_id, &result->rule_id, &info) == VT_STATUS_SUCCESS))
+	{
+		result->min_val = info.min_val;
+		result->max_val = info.max_val;
+		vt_fw_count_rule_hit(result->rule_id);
+		VT_ATOMIC_ADD(&stats_rule_hits, 1);
+	}
+	else
+	{
+		VT_ATOMIC_ADD(&stats_unknown_hits, 1);
+	}
 
-		if((car_status & VT_CAR_ABNORMAL_STAT) == VT_CAR_ABNORMAL_STAT)
-		{
-			snprintf(st, 256, "- Slot rate: %.3f%%\r\n- Pattern rate: %.3f%% all frame: %lu\r\nThe CAN bus traffic is abnormal\r\n", slot_rate * 100.0f, pattern_rate * 100.0f, count_frames);
-			vt_led_on(leds[VT_BLOCK_LED]);
-		}
+	return VT_STATUS_SUCCESS;
+}
 
-		if((car_status & VT_CAR_ABNORMAL_DS_TP_STAT) == VT_CAR_ABNORMAL_DS_TP_STAT)
-		{
-			size = strlen(st);
-			if(size == 0)
-				snprintf(st, 256, "- Slot rate: %.3f%%\r\n- Pattern rate: %.3f%% all frame: %lu\r\nThe CAN bus traffic is abnormal - diagnostic\r\n", slot_rate * 100.0f, pattern_rate * 100.0f, count_frames);
-			else
-				snprintf(&st[size - 2], (256 - size), " - diagnostic\r\n");
-			vt_led_off(leds[VT_BLOCK_LED]);
-		}
+/*!
+ * @brief  This API will push a matched detail of blacklist or monitor to the event ring.
+ * @param [in]   type - is VT_EVENT_BLACKLIST or VT_EVENT_MONITOR.
+ * @param [in]   *detail_result - pointer to vt_fw_detail_result_t structure.
+ * @return       none.
+ */
+static void _vt_fw_push_detail(vt_event_type_t type, vt_fw_detail_result_t *detail_result)
+{
+	vt_event_t event;
 
-		if((car_status & VT_CAR_ABNORMAL_MALICIOUS) == VT_CAR_ABNORMAL_MALICIOUS)
-		{
-			size = strlen(st);
-			if(size == 0)
-				snprintf(st, 256, "- Slot rate: %.3f%%\r\n- Pattern rate: %.3f%% all frame: %lu\r\nThe CAN bus traffic is abnormal - malicious\r\n", slot_rate * 100.0f, pattern_rate * 100.0f, count_frames);
-			else
-				snprintf(&st[size - 2], (256 - size), " - malicious\r\n");
-			vt_led_off(leds[VT_BLOCK_LED]);
-		}
+	event.type = (uint8_t)type;
+	event.time_stamp = vt_timer_get_ticks();
+	if(_vt_fw_result_from_detail((type == VT_EVENT_MONITOR), detail_result, event.time_stamp, &event.u.result) != VT_STATUS_SUCCESS)
+		return;
+
+	/* The blacklist callback runs in the RX interrupts, the hit is folded when the record is taken out */
+	vt_event_push(&event);
+}
+
+#if VT_PROBE_ENABLE
+/*!
+ * @brief  This API will push the latency of every probe hit since the previous report, once per VT_PROBE_REPORT_MS.
+ * @param [in]   now - is slot tick count.
+ * @return       none.
+ */
+static void _vt_fw_report_probes(uint32_t now)
+{
+	vt_probe_stats_t stats;
+	vt_event_t event;
+	uint8_t id;
+
+	if((now - probe_report_ts) < ((VT_PROBE_REPORT_MS * 1000U) / VT_PIT_PERIOD))
+		return;
+	probe_report_ts = now;
+
+	for(id = 0; id < VT_PROBE_MAX; id++)
+	{
+		if(vt_probe_get_stats((vt_probe_id_t)id, &stats) != VT_STATUS_SUCCESS || stats.count == 0)
+			continue;
+		memset(&event, 0, sizeof(event));
+		event.type = VT_EVENT_PROBE;
+		event.time_stamp = now;
+		event.u.probe.probe = id;
+		event.u.probe.count = stats.count;
+		event.u.probe.min_ns = stats.min_ns;
+		event.u.probe.max_ns = stats.max_ns;
+		event.u.probe.p99_ns = stats.p99_ns;
+		vt_event_push(&event);
+		/* Each report covers one interval */
+		vt_probe_reset((vt_probe_id_t)id);
+	}
+}
+#endif
+
+/*!
+ * @brief  This API will take the next record to report, blacklist and monitor hits folded by vt_aggr_hit() are
+ *         skipped. A lost-records notice goes first if the ring dropped any.
+ * @param [out]  *event - pointer to vt_event_t structure.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_EMPTY.
+ */
+static vt_status_t _vt_fw_next_report(vt_event_t *event)
+{
+	vt_event_stats_t stats;
+
+	vt_event_get_stats(&stats);
+	if(stats.dropped != report_dropped)
+	{
+		event->type = VT_EVENT_DROPPED;
+		event->time_stamp = vt_timer_get_ticks();
+		event->u.dropped = stats.dropped - report_dropped;
+		report_dropped = stats.dropped;
+		return VT_STATUS_SUCCESS;
+	}
+
+	for(;;)
+	{
+		if(vt_event_pop(event) != VT_STATUS_SUCCESS)
+			return VT_STATUS_EMPTY;
+		vt_event_mark_sent();
+		/* Repeated hits of the same rule and CAN Id are folded into one summary per interval, here in the main
+		 * loop like vt_aggr_flush() */
+		if((event->type != VT_EVENT_BLACKLIST && event->type != VT_EVENT_MONITOR) || vt_aggr_hit(event) != VT_STATUS_EXIST)
+			return VT_STATUS_SUCCESS;
+	}
+}
+
+/*!
+ * @brief  This API will tell whether records wait for the UART.
+ * @param [in]   none.
+ * @return       1 if a record waits, 0 otherwise.
+ */
+static uint8_t _vt_fw_report_pending(void)
+{
+	vt_event_stats_t stats;
+
+	vt_event_get_stats(&stats);
+	return ((stats.pushed != stats.sent) || (stats.dropped != report_dropped)) ? 1 : 0;
+}
+
+#if VT_PROBE_ENABLE
+/*!
+ * @brief  This API will get the earlier of two slot tick counts.
+ * @param [in]   a - is slot tick count.
+ * @param [in]   b - is slot tick count.
+ * @return       slot tick count.
+ */
+static uint32_t _vt_fw_earlier(uint32_t a, uint32_t b)
+{
+	return ((int32_t)(a - b) < 0) ? a : b;
+}
+#endif
+
+/*!
+ * @brief  This API will tell whether a budget is spent.
+ * @param [in]   start - is probe clock at the start of the budget.
+ * @param [in]   budget - is budget in ticks of the probe clock.
+ * @return       1 if spent, 0 otherwise.
+ */
+static uint8_t _vt_fw_over_budget(uint32_t start, uint32_t budget)
+{
+	return ((vt_probe_now() - start) >= budget) ? 1 : 0;
+}
+
+/*!
+ * @brief  This API will convert a budget to ticks of the probe clock.
+ * @param [in]   max_us - is budget in microseconds.
+ * @return       budget in ticks of the probe clock, VT_FW_NO_BUDGET if it does not fit.
+ */
+static uint32_t _vt_fw_budget_ticks(uint32_t max_us)
+{
+	if(max_us < (VT_FW_NO_BUDGET / VT_FW_PROBE_TICKS_PER_US))
+		return max_us * VT_FW_PROBE_TICKS_PER_US;
+	return VT_FW_NO_BUDGET;
+}
+
+/*!
+ * @brief  This API will format and send out pending events until the budget is spent. The UART transfer is interrupt
+ *         driven, so this function returns at once if the previous transfer is still in progress.
+ * @param [in]   start - is probe clock at the start of the budget.
+ * @param [in]   budget - is budget in ticks of the probe clock.
+ * @param [in]   flush_calls - is number of calls of vt_aggr_flush(), each checks VT_AGGR_FLUSH_SLOTS slots.
+ * @return       VT_STATUS_SUCCESS, or VT_STATUS_TIMEOUT if the budget ran out with work left.
+ */
+static vt_status_t _vt_fw_report(uint32_t start, uint32_t budget, uint32_t flush_calls)
+{
+	vt_event_t event;
+	uint32_t remaining = 0;
+	uint32_t size = 0;
+	vt_status_t status = VT_STATUS_SUCCESS;
+#if VT_REPORT_BINARY
+	uint32_t frame_size;
+#endif
+
+	while(flush_calls-- > 0)
+	{
+		vt_aggr_flush(vt_timer_get_ticks());
+		if(flush_calls > 0 && _vt_fw_over_budget(start, budget))
+			return VT_STATUS_TIMEOUT;
+	}
+	vt_missing_process(vt_timer_get_ticks());
+#if VT_PROBE_ENABLE
+	_vt_fw_report_probes(vt_timer_get_ticks());
+#endif
 
-		if((car_status & VT_CAR_IDLE_STAT) == VT_CAR_IDLE_STAT)
+	/* report_buff belongs to the UART until the previous transfer completes */
+	if(UART_GetTransmitStatus(INST_UART_PAL1, &remaining) == STATUS_BUSY)
+		return VT_STATUS_SUCCESS;
+
+#if VT_REPORT_BINARY
+	/* Pack as many frames as the buffer can hold in the worst case into one transfer */
+	while((sizeof(report_buff) - size) >= VT_WIRE_MAX_FRAME)
+	{
+		/* The frames packed so far leave, the rest goes with the next transfer */
+		if(size > 0 && _vt_fw_over_budget(start, budget))
 		{
-			size = strlen(st);
-			snprintf(&st[size -2 ], (256 - size), " - idle\r\n");
+			status = VT_STATUS_TIMEOUT;
+			break;
 		}
+		if(_vt_fw_next_report(&event) != VT_STATUS_SUCCESS)
+			break;
+		if(vt_wire_encode_event(&report_encoder, &event, (uint8_t *)&report_buff[size], sizeof(report_buff) - size, &frame_size) == VT_STATUS_SUCCESS)
+			size += frame_size;
 	}
-	UART_SendDataBlocking(INST_UART_PAL1, (const uint8_t*)st, strlen(st),30);
+#else
+	if(_vt_fw_next_report(&event) == VT_STATUS_SUCCESS)
+		size = (uint32_t)vt_event_format(&event, report_buff, sizeof(report_buff));
+#endif
+
+	if(size > 0)
+		UART_SendData(INST_UART_PAL1, (const uint8_t *)report_buff, size);
+
+	return status;
+}
+
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+
+/*!
+ * @brief  This API will send traffic status to report to server or print out.
+ * @param [in]   car_status - is traffic status.
+ * @param [in]   slot_rate - is slot rate of CAN traffic bus.
+ * @param [in]   pattern_rate - is pattern rate of CAN traffic bus.
+ * @param [in]   count_frames - is CAN frames of a time window.
+ * @return       none.
+ */
+void vt_fw_traffic_status_event(vt_car_status_t car_status, float slot_rate, float pattern_rate, uint32_t count_frames)
+{
+	vt_event_t event;
+
+	_vt_fw_update_block_led(car_status);
+
+	VT_ATOMIC_ADD(&stats_windows, 1);
+	VT_ATOMIC_STORE(&stats_window_frames, count_frames);
+	VT_ATOMIC_ADD(&stats_total_window_frames, count_frames);
+
+	event.type = VT_EVENT_TRAFFIC_STATUS;
+	event.time_stamp = vt_timer_get_ticks();
+	event.u.traffic.car_status = car_status;
+	event.u.traffic.slot_rate = vt_rate_from_float(slot_rate);
+	event.u.traffic.pattern_rate = vt_rate_from_float(pattern_rate);
+	event.u.traffic.count_frames = count_frames;
+	vt_event_push(&event);
 }
 
 /*!
@@ -139,26 +423,20 @@ void vt_fw_traffic_status_event(vt_car_status_t car_status, float slot_rate, flo
  */
 vt_status_t vt_fw_vector_report_matched(vt_vector_result_t *vector_t)
 {
-	char st[256];
+	vt_event_t event;
 
 	if(vector_t == NULL)
 		return VT_STATUS_NULL;
 
-	memset(st,'\0', 256);
-	if(vector_t->matched_flag > 0)
-	{
-		snprintf(st, 256, "- Vector rate: %lu/%lu = %.3f%% - all vectors: %lu\r\n", vector_t->count_vector_in_rl, vector_t->count_vector_in_rt, vector_t->matched_rate * 100.0f, vector_t->count_all_vector);
-	}
-	else
-	{
-		if(vector_t->matched_rate >= 0.96f)
-			snprintf(st, 256, "- Vector rate: %lu/%lu = %.3f%% - all vectors: %lu is too small\r\n", vector_t->count_vector_in_rl, vector_t->count_vector_in_rt, vector_t->matched_rate, vector_t->count_all_vector);
-		else
-			snprintf(st, 256, "- Vector rate: %lu/%lu = %.3f%% - all vectors: %lu\r\n", vector_t->count_vector_in_rl, vector_t->count_vector_in_rt, vector_t->matched_rate * 100.0f, vector_t->count_all_vector);
-	}
-	UART_SendDataBlocking(INST_UART_PAL1, (const uint8_t*)st, strlen(st),30);
+	event.type = VT_EVENT_VECTOR;
+	event.time_stamp = vt_timer_get_ticks();
+	event.u.vector.count_vector_in_rl = vector_t->count_vector_in_rl;
+	event.u.vector.count_vector_in_rt = vector_t->count_vector_in_rt;
+	event.u.vector.count_all_vector = vector_t->count_all_vector;
+	event.u.vector.matched_rate = vt_rate_from_float(vector_t->matched_rate);
+	event.u.vector.matched_flag = vector_t->matched_flag;
 
-	return VT_STATUS_SUCCESS;
+	return vt_event_push(&event);
 }
 
 /*!
@@ -172,7 +450,7 @@ vt_status_t vt_fw_blacklist_report_matched(vt_fw_detail_result_t *detail_result)
 		return VT_STATUS_NULL;
 
 	if(detail_result->matched_type > 0)
-		UART_SendDataBlocking(INST_UART_PAL1, (const uint8_t*)detail_result->detail, strlen(detail_result->detail),30);
+		_vt_fw_push_detail(VT_EVENT_BLACKLIST, detail_result);
 
 	return VT_STATUS_SUCCESS;
 }
@@ -188,48 +466,285 @@ vt_status_t vt_fw_monitor_report_matched(vt_fw_detail_result_t *detail_result)
 			return VT_STATUS_NULL;
 
 	if(detail_result->matched_type > 0)
-		UART_SendDataBlocking(INST_UART_PAL1, (const uint8_t*)detail_result->detail, strlen(detail_result->detail),30);
+		_vt_fw_push_detail(VT_EVENT_MONITOR, detail_result);
 
 	return VT_STATUS_SUCCESS;
 }
 
 /*!
- * @brief  This API will initialize firewall.
+ * @brief  This API will format and send out pending events. The UART transfer is interrupt driven, so this
+ *         function returns at once if the previous transfer is still in progress.
  * @param [in]   none.
  * @return       none.
  */
-void vt_fw_oem_init(void)
+void vt_fw_oem_report_process(void)
+{
+	_vt_fw_report(vt_probe_now(), VT_FW_NO_BUDGET, 1U);
+}
+
+/*!
+ * @brief  This API will run the firewall once and the reporting until the budget is spent.
+ * @param [in]   max_us - is budget in microseconds.
+ * @return       VT_STATUS_SUCCESS, or VT_STATUS_TIMEOUT if the budget ran out with work left.
+ */
+vt_status_t vt_fw_process_budget(uint32_t max_us)
+{
+	uint32_t start = vt_probe_now();
+	uint32_t budget = _vt_fw_budget_ticks(max_us);
+
+	{
+		VT_PROBE_START(probe_process);
+		vt_fw_process();
+		VT_PROBE_END(VT_PROBE_FW_PROCESS, probe_process);
+	}
+	/* The core runs to completion, the reporting waits for the next call if it spent the budget */
+	if(_vt_fw_over_budget(start, budget))
+		return VT_STATUS_TIMEOUT;
+	/* A whole sweep of the aggregation table fits in one call */
+	return _vt_fw_report(start, budget, VT_AGGR_TABLE_SIZE / VT_AGGR_FLUSH_SLOTS);
+}
+
+/*!
+ * @brief  This API will run the firewall until the work signalled by vt_fw_oem_signal() is done.
+ * @param [in]   none.
+ * @return       deadline in slot ticks.
+ */
+uint32_t vt_fw_process_until_idle(void)
+{
+	uint32_t start = vt_probe_now();
+	uint32_t budget = _vt_fw_budget_ticks(VT_FW_PROCESS_BUDGET_US);
+	uint32_t rx, timers, calls, now, deadline;
+	uint8_t over = 0;
+
+	do
+	{
+		/* A signal from here on wakes the next vt_osal_wait() */
+		VT_ATOMIC_STORE(&idle_signalled, 0U);
+		rx = VT_ATOMIC_LOAD(&idle_rx_frames);
+		timers = VT_ATOMIC_LOAD(&idle_timers);
+#if !VT_FW_DUAL_CORE
+		idle_rx_pending += rx - idle_rx_seen;
+#endif
+		idle_rx_seen = rx;
+		/* The core may take one frame per call, the frames left when the budget is spent wait for the next call */
+		for(calls = 0; !over; calls++)
+		{
+#if VT_FW_DUAL_CORE
+			if(idle_rx_pending == 0)
+				idle_rx_pending = vt_fw_dual_fw_process(1U);
+#endif
+			if(idle_rx_pending == 0)
+				break;
+			idle_rx_pending--;
+			{
+				VT_PROBE_START(probe_process);
+				vt_fw_process();
+				VT_PROBE_END(VT_PROBE_FW_PROCESS, probe_process);
+			}
+			over = _vt_fw_over_budget(start, budget);
+		}
+		/* A timer without frames still runs the core once */
+		if(calls == 0 && !over)
+		{
+			VT_PROBE_START(probe_process);
+			vt_fw_process();
+			VT_PROBE_END(VT_PROBE_FW_PROCESS, probe_process);
+			over = _vt_fw_over_budget(start, budget);
+		}
+		/* Reporting left over is pending, the deadline below comes at once */
+		if(!over && _vt_fw_report(start, budget, VT_AGGR_TABLE_SIZE / VT_AGGR_FLUSH_SLOTS) != VT_STATUS_SUCCESS)
+			over = 1;
+	} while(!over && (VT_ATOMIC_LOAD(&idle_rx_frames) != rx || VT_ATOMIC_LOAD(&idle_timers) != timers));
+
+	now = vt_timer_get_ticks();
+	deadline = now + ((VT_FW_IDLE_PROCESS_MS * 1000U) / VT_PIT_PERIOD);
+	if(_vt_fw_report_pending())
+		deadline = now + 1U;
+	/* The budget ran out with work left, the task goes on at once */
+	if(over)
+		deadline = now;
+#if VT_PROBE_ENABLE
+	deadline = _vt_fw_earlier(deadline, probe_report_ts + ((VT_PROBE_REPORT_MS * 1000U) / VT_PIT_PERIOD));
+#endif
+	return deadline;
+}
+
+/*!
+ * @brief  This API will wake the firewall task, from an interrupt.
+ * @param [in]   frames - is number of frames handed to the firewall, 0 for a timer.
+ * @return       none.
+ */
+void vt_fw_oem_signal(uint32_t frames)
+{
+	if(frames > 0)
+		VT_ATOMIC_ADD(&idle_rx_frames, frames);
+	else
+		VT_ATOMIC_ADD(&idle_timers, 1);
+	/* One wakeup per pass of vt_fw_process_until_idle */
+	if(VT_ATOMIC_EXCHANGE(&idle_signalled, 1U) != 0)
+		return;
+#if VT_FW_DUAL_CORE
+	/* Frames come from the CAN core, whose OSAL and interrupts never wake the firewall core */
+	if(frames > 0)
+	{
+		VT_FW_DUAL_WAKE();
+		return;
+	}
+#endif
+	vt_osal_signal_from_isr();
+}
+
+/*!
+ * @brief  This API will get counters of the agent.
+ * @param [out]  *stats - pointer to vt_fw_stats_t structure.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_NULL.
+ */
+vt_status_t vt_fw_get_stats(vt_fw_stats_t *stats)
 {
 	int i;
 
+	if(stats == NULL)
+		return VT_STATUS_NULL;
+
+	memset(stats, 0, sizeof(vt_fw_stats_t));
+	for(i = 0; i < VT_MAX_CAN_NUMBER; i++)
+	{
+		vt_can_get_stats((uint8_t)i, &stats->port[i].can);
+#ifdef USING_GATEWAY
+		stats->port[i].queue_depth = vt_queue_count(&tx_queue[i]);
+		stats->port[i].queue_high_water = tx_queue[i].high_water;
+		stats->port[i].queue_dropped = tx_queue[i].dropped;
+#endif
+	}
+	vt_event_get_stats(&stats->event);
+	vt_aggr_get_stats(&stats->aggr);
+	vt_missing_get_stats(&stats->missing);
+	vt_ratelimit_get_stats(&stats->ratelimit);
+	stats->rule_hits = VT_ATOMIC_LOAD(&stats_rule_hits);
+	stats->unknown_hits = VT_ATOMIC_LOAD(&stats_unknown_hits);
+	stats->windows = VT_ATOMIC_LOAD(&stats_windows);
+	stats->window_frames = VT_ATOMIC_LOAD(&stats_window_frames);
+	stats->total_window_frames = VT_ATOMIC_LOAD(&stats_total_window_frames);
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will initialize firewall. It stops at the first subsystem that cannot get its memory.
+ * @param [in]   none.
+ * @return       VT_STATUS_SUCCESS, or the status of the first subsystem that failed, e.g. VT_STATUS_NO_MEM.
+ */
+vt_status_t vt_fw_oem_init(void)
+{
+	vt_status_t status;
+	int i;
+
+	/* Hand the memory of each subsystem to its arena before anything allocates */
+#ifdef VT_ARENA_HEAP
+	status = vt_arena_init(VT_ARENA_CORE, arena_core, sizeof(arena_core));
+	if(status != VT_STATUS_SUCCESS)
+		return status;
+#endif
+	status = vt_arena_init(VT_ARENA_RULES, arena_rules, sizeof(arena_rules));
+	if(status != VT_STATUS_SUCCESS)
+		return status;
+	status = vt_arena_init(VT_ARENA_QUEUE, arena_queue, sizeof(arena_queue));
+	if(status != VT_STATUS_SUCCESS)
+		return status;
+	status = vt_arena_init(VT_ARENA_STATE, arena_state, sizeof(arena_state));
+	if(status != VT_STATUS_SUCCESS)
+		return status;
+	status = vt_arena_init(VT_ARENA_EVENT, arena_event, sizeof(arena_event));
+	if(status != VT_STATUS_SUCCESS)
+		return status;
+
+	/* Callbacks only push records, vt_fw_oem_report_process formats and sends them */
+	status = vt_event_init(VT_ARENA_EVENT);
+	if(status != VT_STATUS_SUCCESS)
+		return status;
+	/* Budgets run on the probe clock, with or without the probes */
+	vt_probe_clock_init();
+#if VT_PROBE_ENABLE
+	vt_probe_init();
+	probe_report_ts = 0;
+#endif
+	status = vt_aggr_init(VT_ARENA_STATE, (VT_AGGR_INTERVAL_MS * 1000U) / VT_PIT_PERIOD, 1000000U / VT_PIT_PERIOD);
+	if(status != VT_STATUS_SUCCESS)
+		return status;
+	/* A policy without timing records leaves the detection off, only a lack of memory stops the init */
+	status = vt_missing_init(VT_ARENA_STATE, car_policy, vt_timer_get_ticks());
+	if(status == VT_STATUS_NO_MEM)
+		return status;
+#if defined(USING_GATEWAY) && VT_LATENCY_ENABLE
+	status = vt_latency_init(VT_ARENA_STATE, VT_MAX_CAN_NUMBER);
+	if(status != VT_STATUS_SUCCESS)
+		return status;
+#endif
+#ifdef USING_GATEWAY
+	status = vt_ratelimit_init(VT_ARENA_STATE, car_policy, vt_timer_get_ticks());
+	if(status == VT_STATUS_NO_MEM)
+		return status;
+#endif
+	report_dropped = 0;
+	idle_rx_frames = 0;
+	idle_timers = 0;
+	idle_signalled = 0;
+	idle_rx_seen = 0;
+	idle_rx_pending = 0;
+#if VT_REPORT_BINARY
+	vt_wire_encoder_init(&report_encoder);
+#endif
+
 	/* Initialize firewall */
 	vt_fw_init(car_policy, car_vector);
 
 #ifdef USING_GATEWAY
-
-	vt_fw_create_tx_queue(VT_INST_CAN0, 256);
-	vt_fw_create_tx_queue(VT_INST_CAN1, 256);
-	/* Clear tx_flags */
+	/* Create tx queues and clear tx_flags */
 	for(i = 0; i < VT_MAX_CAN_NUMBER; i++)
 	{
+		status = vt_queue_create(&tx_queue[i], VT_ARENA_QUEUE, VT_FW_TX_QUEUE_SIZE);
+		if(status != VT_STATUS_SUCCESS)
+			return status;
 		tx_flags[i] = 0;
 	}
 #endif
+#if VT_FW_DUAL_CORE
+	/* Empty channels before the CAN core takes frames */
+	vt_fw_dual_init();
+#endif
+	/* Stage all rules, duplicates are dropped at commit */
+	status = vt_fw_begin_bulk_load();
+	if(status != VT_STATUS_SUCCESS)
+		return status;
 	/* Add a malicious CAN frame */
-	vt_fw_add_malicious_can_frame(malicious_frame.msgId, malicious_frame.dataLen, malicious_frame.data);
+	vt_fw_bulk_add_malicious_can_frame(malicious_frame.msgId, malicious_frame.dataLen, malicious_frame.data);
 	/* Add monitor a CAN frame with operator = 0 */
-	vt_fw_monitor_add_can_frame(frames_pattern[0].msgId, frames_pattern[0].dataLen, frames_pattern[0].data, 0, 1,  10);
-	vt_fw_monitor_add_can_frame(frames_pattern[1].msgId, frames_pattern[1].dataLen, frames_pattern[1].data, 1, 0,  10);
-	vt_fw_monitor_add_pattern(frames_pattern, 2, 0, 1, 10);
-	vt_fw_monitor_add_ids_to_range_list(0, 0x600, 0x6ff, 1, 0,  100);
+	vt_fw_bulk_monitor_add_can_frame(frames_pattern[0].msgId, frames_pattern[0].dataLen, frames_pattern[0].data, 0, 1,  10);
+	vt_fw_bulk_monitor_add_can_frame(frames_pattern[1].msgId, frames_pattern[1].dataLen, frames_pattern[1].data, 1, 0,  10);
+	vt_fw_bulk_monitor_add_pattern(frames_pattern, 2, 0, 1, 10);
+	vt_fw_bulk_monitor_add_ids_to_range_list(0, 0x600, 0x6ff, 1, 0,  100);
+	/* Errors of the core on a rule leave that rule out, the rule index lives in VT_ARENA_STATE */
+	status = vt_fw_commit_bulk_load();
+	if(status == VT_STATUS_NO_MEM)
+		return status;
 	/* Set slot to rule */
 	vt_fw_set_slot_time_unit(VT_PIT_PERIOD);
 
-	vt_fw_install_vector_callback(vt_fw_vector_report_matched);
-	vt_fw_install_traffic_status_callback(vt_fw_traffic_status_event);
-	vt_fw_install_blacklist_callback(vt_fw_blacklist_report_matched);
-	vt_fw_install_monitor_callback(vt_fw_monitor_report_matched);
+	/* The core reports through the contexts, the default one owns every bus */
+	vt_fw_ctx_init();
+	vt_fw_ctx_install_global_vector_callback(vt_fw_vector_report_matched);
+	vt_fw_ctx_install_global_traffic_status_callback(vt_fw_traffic_status_event);
+	vt_fw_ctx_install_blacklist_callback(vt_fw_ctx_default(), vt_fw_blacklist_report_matched);
+	vt_fw_ctx_install_monitor_callback(vt_fw_ctx_default(), vt_fw_monitor_report_matched);
 	vt_led_off(leds[VT_BLOCK_LED]);
+
+	/* No allocation is allowed after init */
+	for(i = 0; i < (int)VT_ARENA_MAX; i++)
+	{
+		vt_arena_seal((vt_arena_id_t)i);
+	}
+
+	return VT_STATUS_SUCCESS;
 }
 
 #ifdef USING_GATEWAY
@@ -237,9 +752,10 @@ void vt_fw_oem_init(void)
  * @brief  This API will add CAN message to forward queue.
  * @param [in]      instant - CAN number (e.g: 0, 1, 2).
  * @param [in]      *msg - is pointer to flexcan message.
+ * @param [in]      time_stamp - is vt_probe_now() taken in the RX interrupt.
  * @return       none.
  */
-void vt_fw_oem_add_message_to_forward_queue(uint8_t instant, flexcan_msgbuff_t *msg)
+void vt_fw_oem_add_message_to_forward_queue(uint8_t instant, flexcan_msgbuff_t *msg, uint32_t time_stamp)
 {
 	status_t result = STATUS_ERROR;
 	int mb_idx;
@@ -255,6 +771,12 @@ void vt_fw_oem_add_message_to_forward_queue(uint8_t instant, flexcan_msgbuff_t *
 
 	if(instant >= VT_MAX_CAN_NUMBER)
 		return;
+	/* A port being detected only listens, its TX complete would never come */
+	if(vt_autodetect_probing(forward_id[instant]))
+		return;
+	/* A flood is cut here, before it takes the egress bus */
+	if(vt_ratelimit_check(instant, msg->msgId, vt_timer_get_ticks()) != VT_STATUS_SUCCESS)
+		return;
 	if(tx_flags[forward_id[instant]] == 0)
 	{
 		/* Send direct */
@@ -264,15 +786,27 @@ void vt_fw_oem_add_message_to_forward_queue(uint8_t instant, flexcan_msgbuff_t *
 		result = FLEXCAN_DRV_ConfigTxMb(forward_id[instant], mb_idx, (const flexcan_data_info_t *)&dataInfo, msg->msgId);
 		if(result == STATUS_SUCCESS)
 		{
+#if VT_LATENCY_ENABLE
+			vt_latency_tx_start(forward_id[instant], msg->msgId, time_stamp);
+#endif
 			result = FLEXCAN_DRV_Send(forward_id[instant], mb_idx, (const flexcan_data_info_t *)&dataInfo, msg->msgId,(const uint8_t *) &msg->data[0]);
 			if(result == STATUS_SUCCESS)
 				tx_flags[forward_id[instant]] = 1;
 		}
+		if(result != STATUS_SUCCESS)
+			vt_can_count_tx_abort(forward_id[instant]);
 
 	}
 	else
 	{
-		vt_fw_add_msg_to_tx_queue(forward_id[instant], msg->msgId, msg->dataLen, msg->data);
+		vt_msgbuff_t qmsg;
+
+		qmsg.frame.msgId = msg->msgId;
+		qmsg.frame.dataLen = (msg->dataLen > VT_MAX_DATA_BYTE_LENGTH) ? VT_MAX_DATA_BYTE_LENGTH : msg->dataLen;
+		memcpy(qmsg.frame.data, msg->data, qmsg.frame.dataLen);
+		/* The ingress time travels with the message to the TX complete of the egress port */
+		qmsg.time_stamp = time_stamp;
+		vt_queue_push(&tx_queue[forward_id[instant]], &qmsg);
 	}
 }
 
@@ -284,7 +818,7 @@ void vt_fw_oem_add_message_to_forward_queue(uint8_t instant, flexcan_msgbuff_t *
 void vt_fw_oem_get_and_send_message(uint8_t instant)
 {
 	vt_status_t status;
-	flexcan_msgbuff_t msg;
+	vt_msgbuff_t msg;
 	status_t result = STATUS_ERROR;
 	int mb_idx;
 	static flexcan_data_info_t dataInfo =
@@ -297,19 +831,35 @@ void vt_fw_oem_get_and_send_message(uint8_t instant)
 		.fd_padding  = 0U
 	};
 
-	status = vt_fw_get_msg_from_tx_queue(instant, &msg.msgId, &msg.dataLen, msg.data);
+	if(instant >= VT_MAX_CAN_NUMBER)
+		return;
+#if VT_LATENCY_ENABLE
+	/* Called on TX complete: the frame in flight has left, unless the last send failed */
+	if(tx_flags[instant])
+		vt_latency_tx_complete(instant, vt_queue_count(&tx_queue[instant]), vt_timer_get_ticks());
+#endif
+	status = vt_queue_pop(&tx_queue[instant], &msg);
 	if(status == VT_STATUS_SUCCESS)
 	{
-		dataInfo.data_length = (uint32_t)msg.dataLen;
+		dataInfo.data_length = (uint32_t)msg.frame.dataLen;
 
 		mb_idx =  VT_START_MB_IDX;
-		result = FLEXCAN_DRV_ConfigTxMb(instant, mb_idx, (const flexcan_data_info_t *)&dataInfo, msg.msgId);
+		result = FLEXCAN_DRV_ConfigTxMb(instant, mb_idx, (const flexcan_data_info_t *)&dataInfo, msg.frame.msgId);
 		if(result == STATUS_SUCCESS)
 		{
-			result = FLEXCAN_DRV_Send(instant, mb_idx, (const flexcan_data_info_t *)&dataInfo, msg.msgId,(const uint8_t *) &msg.data[0]);
+#if VT_LATENCY_ENABLE
+			vt_latency_tx_start(instant, msg.frame.msgId, msg.time_stamp);
+#endif
+			result = FLEXCAN_DRV_Send(instant, mb_idx, (const flexcan_data_info_t *)&dataInfo, msg.frame.msgId,(const uint8_t *) &msg.frame.data[0]);
 			if(result == STATUS_SUCCESS)
 				tx_flags[instant] = 1;
 		}
+		if(result != STATUS_SUCCESS)
+		{
+			/* No TX complete will follow, let the next message be sent directly */
+			vt_can_count_tx_abort(instant);
+			tx_flags[instant] = 0;
+		}
 	}
 	else
 	{
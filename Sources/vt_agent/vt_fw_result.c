@@ -0,0 +1,98 @@
+/*
+ * vt_fw_result.c
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_fw_result.h"
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+static const char *rule_names[] = {
+		"Blacklist frame",
+		"Blacklist range",
+		"Monitor frame",
+		"Monitor pattern",
+		"Monitor range"
+};
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will get the display name of a rule type.
+ * @param [in]   rule_type - is vt_fw_rule_type_t.
+ * @return       name.
+ */
+const char *vt_fw_rule_name(uint8_t rule_type)
+{
+	if(rule_type > VT_RULE_MONITOR_RANGE)
+		return "Unknown rule";
+	return rule_names[rule_type];
+}
+
+/*!
+ * @brief  This API will get the CAN Id of a detection from the text of its detail.
+ * @param [in]   *detail_result - pointer to vt_fw_detail_result_t structure.
+ * @return       CAN Id, or VT_FW_CAN_ID_NONE.
+ */
+uint32_t vt_fw_detail_can_id(const vt_fw_detail_result_t *detail_result)
+{
+	const char *st = detail_result->detail;
+	const char *end = &detail_result->detail[sizeof(detail_result->detail) - 1U];
+	char *last;
+	unsigned long can_id;
+
+	for(; (st < end) && (st[0] != '\0') && (st[1] != '\0'); st++)
+	{
+		if((st[0] != '0') || ((st[1] != 'x') && (st[1] != 'X')))
+			continue;
+		can_id = strtoul(&st[2], &last, 16);
+		/* "0x" without digits, or past an extended CAN Id, is not a CAN Id */
+		if((last == &st[2]) || (can_id > 0x1FFFFFFFUL))
+			return VT_FW_CAN_ID_NONE;
+		return (uint32_t)can_id;
+	}
+	return VT_FW_CAN_ID_NONE;
+}
+
+/*!
+ * @brief  This API will format a structured result to a string.
+ * @param [in]   *result - pointer to vt_fw_match_result_t structure.
+ * @param [out]  *st - pointer to string buffer.
+ * @param [in]   len - size of string buffer.
+ * @return       length of string.
+ */
+int vt_fw_format_result(const vt_fw_match_result_t *result, char *st, int len)
+{
+	int size;
+
+	if(result->rule_type > VT_RULE_MONITOR_RANGE)
+	{
+		st[0] = '\0';
+		return 0;
+	}
+
+	size = snprintf(st, len, "- %s matched:", vt_fw_rule_name(result->rule_type));
+	if((size < len) && (result->can_id != VT_FW_CAN_ID_NONE))
+		size += snprintf(&st[size], len - size, " ID 0x%03lX", result->can_id);
+	if((size < len) && (result->rule_id != VT_FW_RULE_ID_NONE))
+		size += snprintf(&st[size], len - size, " rule %lu", result->rule_id);
+	if((size < len) && (result->rule_type >= VT_RULE_MONITOR_FRAME) && (result->rule_id != VT_FW_RULE_ID_NONE))
+		size += snprintf(&st[size], len - size, " limits [%u, %u]", result->min_val, result->max_val);
+	if(size < len)
+		size += snprintf(&st[size], len - size, "\r\n");
+
+	return (size < len) ? size : (len - 1);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,652 @@
+/*
+ * vt_fw_rules.c
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_fw_rules.h"
+#include "vt_arena.h"
+#include "vt_atomic.h"
+
+/*------------------------------------------------------------------*
+ *                          Define Macro                            *
+ *------------------------------------------------------------------*/
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief CAN Id interval covered by a committed rule. A pattern has one per CAN Id of its frames, a rule out of a
+ *        range of Ids has one on each side of the range.
+ */
+typedef struct _vt_fw_rule_key_t
+{
+	uint32_t from_id;
+	uint32_t to_id;
+	uint32_t max_to_id;      /*!< largest to_id of the keys of the type up to this one */
+	uint16_t rule_id;
+	uint8_t type;            /*!< vt_fw_rule_type_t */
+}vt_fw_rule_key_t;
+
+typedef struct _vt_fw_rule_t
+{
+	uint32_t key_id;         /*!< CAN Id used to order the rule (msgId, first frame Id or fromId) */
+	uint32_t to_id;          /*!< last CAN Id of a range rule */
+	uint16_t seq;            /*!< insertion order, keeps the sort deterministic */
+	uint16_t frame_idx;      /*!< first frame of the rule in the frame pool */
+	uint16_t min_val;
+	uint16_t max_val;
+	uint8_t type;            /*!< vt_fw_rule_type_t */
+	uint8_t ele_size;        /*!< number of frames in the frame pool */
+	uint8_t operator;
+	uint8_t id_operator;
+}vt_fw_rule_t;
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+/* Staging tables are carved from VT_ARENA_RULES at begin and released at commit */
+static vt_fw_rule_t *bulk_rules = NULL;
+static vt_can_frame_t *bulk_frames = NULL;
+static uint16_t bulk_rule_count = 0;
+static uint16_t bulk_frame_count = 0;
+static uint8_t bulk_active = 0;
+
+/* Committed rules in registration order, the rule Id is the position and never changes */
+static vt_fw_rule_info_t *rule_table = NULL;
+static uint16_t rule_count = 0;
+
+/* CAN Id intervals of the committed rules sorted by type and first Id, used to turn a detection back into a rule */
+static vt_fw_rule_key_t *rule_keys = NULL;
+static uint32_t rule_key_count = 0;
+
+/*------------------------------------------------------------------*
+ *                 Private Function Prototypes                      *
+ *------------------------------------------------------------------*/
+static vt_fw_rule_t *_vt_fw_bulk_new_rule(uint8_t type, uint32_t key_id, vt_can_frame_t *frames, uint8_t ele_size);
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will order two staged rules on their whole content: type and CAN Id first, so the core gets the
+ *         rules in CAN Id order, then every other field and the frames, so identical rules sort side by side.
+ * @param [in]   *ra - pointer to first rule.
+ * @param [in]   *rb - pointer to second rule.
+ * @return       -1, 0 if the rules are the same, or 1.
+ */
+static int _vt_fw_rule_content_compare(const vt_fw_rule_t *ra, const vt_fw_rule_t *rb)
+{
+	const vt_can_frame_t *fa, *fb;
+	int i, diff;
+
+	if(ra->type != rb->type)
+		return (ra->type < rb->type) ? -1 : 1;
+	if(ra->key_id != rb->key_id)
+		return (ra->key_id < rb->key_id) ? -1 : 1;
+	if(ra->to_id != rb->to_id)
+		return (ra->to_id < rb->to_id) ? -1 : 1;
+	if(ra->id_operator != rb->id_operator)
+		return (ra->id_operator < rb->id_operator) ? -1 : 1;
+	if(ra->operator != rb->operator)
+		return (ra->operator < rb->operator) ? -1 : 1;
+	if(ra->min_val != rb->min_val)
+		return (ra->min_val < rb->min_val) ? -1 : 1;
+	if(ra->max_val != rb->max_val)
+		return (ra->max_val < rb->max_val) ? -1 : 1;
+	if(ra->ele_size != rb->ele_size)
+		return (ra->ele_size < rb->ele_size) ? -1 : 1;
+	for(i = 0; i < ra->ele_size; i++)
+	{
+		fa = &bulk_frames[ra->frame_idx + i];
+		fb = &bulk_frames[rb->frame_idx + i];
+		if(fa->msgId != fb->msgId)
+			return (fa->msgId < fb->msgId) ? -1 : 1;
+		if(fa->dataLen != fb->dataLen)
+			return (fa->dataLen < fb->dataLen) ? -1 : 1;
+		diff = memcmp(fa->data, fb->data, fa->dataLen);
+		if(diff != 0)
+			return (diff < 0) ? -1 : 1;
+	}
+	return 0;
+}
+
+static int vt_fw_rule_compare(const void * a, const void * b)
+{
+	const vt_fw_rule_t *ra = (const vt_fw_rule_t *)a;
+	const vt_fw_rule_t *rb = (const vt_fw_rule_t *)b;
+	int diff = _vt_fw_rule_content_compare(ra, rb);
+
+	if(diff != 0)
+		return diff;
+	if(ra->seq != rb->seq)
+		return (ra->seq < rb->seq) ? -1 : 1;
+	return 0;
+}
+
+static int vt_fw_rule_key_compare(const void * a, const void * b)
+{
+	const vt_fw_rule_key_t *ka = (const vt_fw_rule_key_t *)a;
+	const vt_fw_rule_key_t *kb = (const vt_fw_rule_key_t *)b;
+
+	if(ka->type != kb->type)
+		return (ka->type < kb->type) ? -1 : 1;
+	if(ka->from_id != kb->from_id)
+		return (ka->from_id < kb->from_id) ? -1 : 1;
+	if(ka->to_id != kb->to_id)
+		return (ka->to_id < kb->to_id) ? -1 : 1;
+	if(ka->rule_id != kb->rule_id)
+		return (ka->rule_id < kb->rule_id) ? -1 : 1;
+	return 0;
+}
+
+/*!
+ * @brief  This API will add a CAN Id interval of a committed rule to the lookup keys.
+ * @param [in]   rule_id - is rule Id.
+ * @param [in]   type - is vt_fw_rule_type_t.
+ * @param [in]   from_id - is first CAN Id of the interval.
+ * @param [in]   to_id - is last CAN Id of the interval.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_FULL.
+ */
+static vt_status_t _vt_fw_add_rule_key(uint16_t rule_id, uint8_t type, uint32_t from_id, uint32_t to_id)
+{
+	vt_fw_rule_key_t *key;
+
+	if(rule_key_count >= VT_FW_RULE_KEY_SIZE)
+		return VT_STATUS_FULL;
+
+	key = &rule_keys[rule_key_count++];
+	key->from_id = from_id;
+	key->to_id = to_id;
+	key->max_to_id = to_id;
+	key->rule_id = rule_id;
+	key->type = type;
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will give a registered rule its Id and add the CAN Ids it covers to the lookup keys. Rules past
+ *         VT_FW_RULE_INDEX_SIZE are not indexed.
+ * @param [in]   *rule - pointer to vt_fw_rule_t structure.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_FULL, or the status of the allocation of the index.
+ */
+static vt_status_t _vt_fw_index_rule(const vt_fw_rule_t *rule)
+{
+	vt_fw_rule_info_t *info;
+	const vt_can_frame_t *frames = &bulk_frames[rule->frame_idx];
+	vt_status_t status = VT_STATUS_SUCCESS;
+	uint16_t rule_id;
+	void *ptr;
+	int i, j;
+
+	if(rule_table == NULL)
+	{
+		status = vt_arena_alloc(VT_ARENA_STATE, VT_FW_RULE_INDEX_SIZE * sizeof(vt_fw_rule_info_t), &ptr);
+		if(status != VT_STATUS_SUCCESS)
+			return status;
+		rule_table = (vt_fw_rule_info_t *)ptr;
+		status = vt_arena_alloc(VT_ARENA_STATE, VT_FW_RULE_KEY_SIZE * sizeof(vt_fw_rule_key_t), &ptr);
+		if(status != VT_STATUS_SUCCESS)
+		{
+			rule_table = NULL;
+			return status;
+		}
+		rule_keys = (vt_fw_rule_key_t *)ptr;
+	}
+	if(rule_count >= VT_FW_RULE_INDEX_SIZE)
+		return VT_STATUS_FULL;
+
+	rule_id = rule_count++;
+	info = &rule_table[rule_id];
+	info->from_id = rule->key_id;
+	info->to_id = ((rule->type == VT_RULE_BLACKLIST_RANGE) || (rule->type == VT_RULE_MONITOR_RANGE)) ? rule->to_id : rule->key_id;
+	info->min_val = rule->min_val;
+	info->max_val = rule->max_val;
+	info->hits = 0;
+	info->type = rule->type;
+	info->id_operator = rule->id_operator;
+
+	switch(rule->type)
+	{
+	case VT_RULE_MONITOR_PATTERN:
+		/* A pattern is reported by the CAN Id of any of its frames */
+		for(i = 0; (i < rule->ele_size) && (status == VT_STATUS_SUCCESS); i++)
+		{
+			for(j = 0; j < i; j++)
+			{
+				if(frames[j].msgId == frames[i].msgId)
+					break;
+			}
+			if(j == i)
+				status = _vt_fw_add_rule_key(rule_id, rule->type, frames[i].msgId, frames[i].msgId);
+		}
+		break;
+	case VT_RULE_BLACKLIST_RANGE:
+	case VT_RULE_MONITOR_RANGE:
+		if(rule->id_operator == 0)
+		{
+			status = _vt_fw_add_rule_key(rule_id, rule->type, rule->key_id, rule->to_id);
+			break;
+		}
+		/* Not in range: the Ids on both sides of the range */
+		if(rule->key_id > 0)
+			status = _vt_fw_add_rule_key(rule_id, rule->type, 0, rule->key_id - 1U);
+		if((status == VT_STATUS_SUCCESS) && (rule->to_id < 0xFFFFFFFFUL))
+			status = _vt_fw_add_rule_key(rule_id, rule->type, rule->to_id + 1U, 0xFFFFFFFFUL);
+		break;
+	default:
+		status = _vt_fw_add_rule_key(rule_id, rule->type, rule->key_id, rule->key_id);
+		break;
+	}
+
+	return status;
+}
+
+/*!
+ * @brief  This API will append a rule and its frames to the staging table.
+ * @param [in]   type - is vt_fw_rule_type_t.
+ * @param [in]   key_id - is CAN Id used to order the rule.
+ * @param [in]   *frames - pointer to CAN frame array, NULL for range rules.
+ * @param [in]   ele_size - number of frames.
+ * @return       pointer to the new rule, NULL if the staging table is full.
+ */
+static vt_fw_rule_t *_vt_fw_bulk_new_rule(uint8_t type, uint32_t key_id, vt_can_frame_t *frames, uint8_t ele_size)
+{
+	vt_fw_rule_t *rule;
+
+	if(bulk_rule_count >= VT_FW_BULK_MAX_RULES)
+		return NULL;
+	if((bulk_frame_count + ele_size) > VT_FW_BULK_MAX_FRAMES)
+		return NULL;
+
+	rule = &bulk_rules[bulk_rule_count];
+	memset(rule, 0, sizeof(vt_fw_rule_t));
+	rule->type = type;
+	rule->key_id = key_id;
+	rule->seq = bulk_rule_count;
+	rule->frame_idx = bulk_frame_count;
+	rule->ele_size = ele_size;
+	if(ele_size > 0)
+	{
+		memcpy(&bulk_frames[bulk_frame_count], frames, ele_size * sizeof(vt_can_frame_t));
+		bulk_frame_count += ele_size;
+	}
+	bulk_rule_count++;
+
+	return rule;
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will start a bulk load of firewall rules.
+ * @param [in]   none.
+ * @return       status.
+ */
+vt_status_t vt_fw_begin_bulk_load(void)
+{
+	vt_status_t status;
+	void *ptr;
+
+	if(bulk_active)
+		return VT_STATUS_BUSY;
+
+	status = vt_arena_alloc(VT_ARENA_RULES, VT_FW_BULK_MAX_RULES * sizeof(vt_fw_rule_t), &ptr);
+	if(status != VT_STATUS_SUCCESS)
+		return status;
+	bulk_rules = (vt_fw_rule_t *)ptr;
+	status = vt_arena_alloc(VT_ARENA_RULES, VT_FW_BULK_MAX_FRAMES * sizeof(vt_can_frame_t), &ptr);
+	if(status != VT_STATUS_SUCCESS)
+	{
+		vt_arena_reset(VT_ARENA_RULES);
+		return status;
+	}
+	bulk_frames = (vt_can_frame_t *)ptr;
+
+	bulk_rule_count = 0;
+	bulk_frame_count = 0;
+	bulk_active = 1;
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will stage a malicious CAN frame for the black list.
+ * @param [in]   msgId - is CAN Id.
+ * @param [in]   dataLen - length of data.
+ * @param [in]	 *databuff - is data buffer.
+ * @return       status
+ */
+vt_status_t vt_fw_bulk_add_malicious_can_frame(uint32_t msgId, uint8_t dataLen, uint8_t *databuff)
+{
+	vt_can_frame_t frame;
+
+	if(!bulk_active)
+		return VT_STATUS_UNREADY;
+	if(databuff == NULL)
+		return VT_STATUS_NULL;
+	if(dataLen > VT_MAX_DATA_BYTE_LENGTH)
+		return VT_STATUS_INVALID;
+
+	memset(&frame, 0, sizeof(frame));
+	frame.msgId = msgId;
+	frame.dataLen = dataLen;
+	memcpy(frame.data, databuff, dataLen);
+	if(_vt_fw_bulk_new_rule(VT_RULE_MALICIOUS_FRAME, msgId, &frame, 1) == NULL)
+		return VT_STATUS_FULL;
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will stage a range from CAN ID to CAN ID for the black list.
+ * @param [in]   fromId - is CAN Id.
+ * @param [in]   toId - is CAN Id.
+ * @param [in]	 operator - 0: in range ids, 1: not in range ids.
+ * @return       status
+ */
+vt_status_t vt_fw_bulk_blacklist_add_range_can_id(uint32_t fromId, uint32_t toId, uint8_t operator)
+{
+	vt_fw_rule_t *rule;
+
+	if(!bulk_active)
+		return VT_STATUS_UNREADY;
+
+	rule = _vt_fw_bulk_new_rule(VT_RULE_BLACKLIST_RANGE, fromId, NULL, 0);
+	if(rule == NULL)
+		return VT_STATUS_FULL;
+	rule->to_id = toId;
+	rule->id_operator = operator;
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will stage a CAN frame for the monitor frame list.
+ * @param [in]   msgId - is CAN Id.
+ * @param [in]   dataLen - length of data.
+ * @param [in]	 *databuff - is data buffer.
+ * @param [in]	 operator - 0: in range of minimum and maximum, 1: not in range of minimum and maximum.
+ * @param [in]   min_val - is minimum of occurrence CAN frame.
+ * @param [in]   max_val - is maximum of occurrence CAN frame.
+ * @return        status
+ */
+vt_status_t vt_fw_bulk_monitor_add_can_frame(uint32_t msgId, uint8_t dataLen, uint8_t *databuff, uint8_t operator, uint16_t min_val,  uint16_t max_val)
+{
+	vt_can_frame_t frame;
+	vt_fw_rule_t *rule;
+
+	if(!bulk_active)
+		return VT_STATUS_UNREADY;
+	if(databuff == NULL)
+		return VT_STATUS_NULL;
+	if(dataLen > VT_MAX_DATA_BYTE_LENGTH)
+		return VT_STATUS_INVALID;
+
+	memset(&frame, 0, sizeof(frame));
+	frame.msgId = msgId;
+	frame.dataLen = dataLen;
+	memcpy(frame.data, databuff, dataLen);
+	rule = _vt_fw_bulk_new_rule(VT_RULE_MONITOR_FRAME, msgId, &frame, 1);
+	if(rule == NULL)
+		return VT_STATUS_FULL;
+	rule->operator = operator;
+	rule->min_val = min_val;
+	rule->max_val = max_val;
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will stage a pattern of CAN frame for the monitor pattern list.
+ * @param [in]   *frames - pointer to CAN frame array .
+ * @param [in]	 ele_size - is size of element array in a pattern.
+ * @param [in]	 operator - 0: in range of minimum and maximum, 1: not in range of minimum and maximum.
+ * @param [in]   min_val - is minimum of occurrence pattern.
+ * @param [in]   max_val - is maximum of occurrence pattern.
+ * @return        status
+ */
+vt_status_t vt_fw_bulk_monitor_add_pattern(vt_can_frame_t *frames, uint8_t ele_size, uint8_t operator, uint16_t min_val,  uint16_t max_val)
+{
+	vt_fw_rule_t *rule;
+
+	if(!bulk_active)
+		return VT_STATUS_UNREADY;
+	if(frames == NULL)
+		return VT_STATUS_NULL;
+	if(ele_size == 0)
+		return VT_STATUS_INVALID;
+
+	rule = _vt_fw_bulk_new_rule(VT_RULE_MONITOR_PATTERN, frames[0].msgId, frames, ele_size);
+	if(rule == NULL)
+		return VT_STATUS_FULL;
+	rule->operator = operator;
+	rule->min_val = min_val;
+	rule->max_val = max_val;
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will stage a range from CAN ID to CAN ID for the monitor range list.
+ * @param [in]	 id_operator - 0: in range id, 1: not in range id.
+ * @param [in]   fromId - is CAN Id.
+ * @param [in]   toId - is CAN Id.
+ * @param [in]	 operator - 0: in range of minimum and maximum, 1: not in range of minimum and maximum.
+ * @param [in]   min_val - is minimum of occurrence range ID.
+ * @param [in]   max_val - is maximum of occurrence range ID.
+ * @return       status
+ */
+vt_status_t vt_fw_bulk_monitor_add_ids_to_range_list(uint8_t id_operator, uint32_t fromId, uint32_t toId, uint8_t operator, uint16_t min_val,  uint16_t max_val)
+{
+	vt_fw_rule_t *rule;
+
+	if(!bulk_active)
+		return VT_STATUS_UNREADY;
+
+	rule = _vt_fw_bulk_new_rule(VT_RULE_MONITOR_RANGE, fromId, NULL, 0);
+	if(rule == NULL)
+		return VT_STATUS_FULL;
+	rule->to_id = toId;
+	rule->id_operator = id_operator;
+	rule->operator = operator;
+	rule->min_val = min_val;
+	rule->max_val = max_val;
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will finish a bulk load and register the staged rules to the firewall core.
+ * @param [in]   none.
+ * @return       VT_STATUS_SUCCESS, the first error status returned by the firewall core, or the status of the index.
+ */
+vt_status_t vt_fw_commit_bulk_load(void)
+{
+	vt_status_t status = VT_STATUS_SUCCESS, result;
+	vt_fw_rule_t *rule;
+	vt_can_frame_t *frame;
+	int i;
+
+	if(!bulk_active)
+		return VT_STATUS_UNREADY;
+
+	/* The whole content is sorted on, so duplicates end up side by side, the core gets the rules in CAN Id order */
+	qsort(bulk_rules, bulk_rule_count, sizeof(vt_fw_rule_t), vt_fw_rule_compare);
+
+	for(i = 0; i < bulk_rule_count; i++)
+	{
+		rule = &bulk_rules[i];
+		if((i > 0) && (_vt_fw_rule_content_compare(&bulk_rules[i - 1], rule) == 0))
+			continue;
+
+		frame = &bulk_frames[rule->frame_idx];
+		switch(rule->type)
+		{
+		case VT_RULE_MALICIOUS_FRAME:
+			result = vt_fw_add_malicious_can_frame(frame->msgId, frame->dataLen, frame->data);
+			break;
+		case VT_RULE_BLACKLIST_RANGE:
+			result = vt_fw_blacklist_add_range_can_id(rule->key_id, rule->to_id, rule->id_operator);
+			break;
+		case VT_RULE_MONITOR_FRAME:
+			result = vt_fw_monitor_add_can_frame(frame->msgId, frame->dataLen, frame->data, rule->operator, rule->min_val, rule->max_val);
+			break;
+		case VT_RULE_MONITOR_PATTERN:
+			result = vt_fw_monitor_add_pattern(frame, rule->ele_size, rule->operator, rule->min_val, rule->max_val);
+			break;
+		case VT_RULE_MONITOR_RANGE:
+			result = vt_fw_monitor_add_ids_to_range_list(rule->id_operator, rule->key_id, rule->to_id, rule->operator, rule->min_val, rule->max_val);
+			break;
+		default:
+			result = VT_STATUS_INVALID;
+			break;
+		}
+		if((result != VT_STATUS_SUCCESS) && (result != VT_STATUS_EXIST) && (status == VT_STATUS_SUCCESS))
+			status = result;
+		/* The rule is registered either way, only the lookup of its detections is lost */
+		if(result == VT_STATUS_SUCCESS)
+			result = _vt_fw_index_rule(rule);
+		if((result != VT_STATUS_SUCCESS) && (status == VT_STATUS_SUCCESS))
+			status = result;
+	}
+	/* Keys of this commit are merged with the earlier ones, the rule Ids stay as they are */
+	if(rule_key_count > 0)
+	{
+		qsort(rule_keys, rule_key_count, sizeof(vt_fw_rule_key_t), vt_fw_rule_key_compare);
+		rule_keys[0].max_to_id = rule_keys[0].to_id;
+		for(i = 1; i < (int)rule_key_count; i++)
+		{
+			if((rule_keys[i].type == rule_keys[i - 1].type) && (rule_keys[i - 1].max_to_id > rule_keys[i].to_id))
+				rule_keys[i].max_to_id = rule_keys[i - 1].max_to_id;
+			else
+				rule_keys[i].max_to_id = rule_keys[i].to_id;
+		}
+	}
+
+	bulk_rule_count = 0;
+	bulk_frame_count = 0;
+	bulk_active = 0;
+	bulk_rules = NULL;
+	bulk_frames = NULL;
+	vt_arena_reset(VT_ARENA_RULES);
+
+	return status;
+}
+
+/*!
+ * @brief  This API will find the committed rule of a type that covers a CAN Id.
+ * @param [in]   type - is vt_fw_rule_type_t.
+ * @param [in]   can_id - is CAN Id.
+ * @param [out]  *rule_id - pointer to rule Id.
+ * @param [out]  *info - pointer to vt_fw_rule_info_t structure, may be NULL.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL or VT_STATUS_UNMATCHED.
+ */
+vt_status_t vt_fw_find_rule(vt_fw_rule_type_t type, uint32_t can_id, uint32_t *rule_id, vt_fw_rule_info_t *info)
+{
+	vt_fw_rule_key_t *key;
+	uint32_t first, low, high, mid;
+
+	if(rule_id == NULL)
+		return VT_STATUS_NULL;
+
+	/* First key of the type */
+	low = 0;
+	high = rule_key_count;
+	while(low < high)
+	{
+		mid = (low + high) / 2U;
+		if(rule_keys[mid].type < type)
+			low = mid + 1U;
+		else
+			high = mid;
+	}
+	first = low;
+
+	/* First key ordered after (type, can_id): every candidate starts at or before can_id */
+	high = rule_key_count;
+	while(low < high)
+	{
+		mid = (low + high) / 2U;
+		key = &rule_keys[mid];
+		if((key->type == type) && (key->from_id <= can_id))
+			low = mid + 1U;
+		else
+			high = mid;
+	}
+
+	/* max_to_id grows along the candidates, the first one reaching can_id covers it */
+	high = low;
+	low = first;
+	while(low < high)
+	{
+		mid = (low + high) / 2U;
+		if(rule_keys[mid].max_to_id < can_id)
+			low = mid + 1U;
+		else
+			high = mid;
+	}
+	if((low >= rule_key_count) || (rule_keys[low].type != type) || (rule_keys[low].from_id > can_id) ||
+	   (rule_keys[low].to_id < can_id))
+		return VT_STATUS_UNMATCHED;
+
+	*rule_id = rule_keys[low].rule_id;
+	if(info != NULL)
+		*info = rule_table[*rule_id];
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will count a detection of a committed rule.
+ * @param [in]   rule_id - is rule Id.
+ * @return       none.
+ */
+void vt_fw_count_rule_hit(uint32_t rule_id)
+{
+	if(rule_id < rule_count)
+		VT_ATOMIC_ADD(&rule_table[rule_id].hits, 1);
+}
+
+/*!
+ * @brief  This API will get the number of rules in the lookup index.
+ * @param [in]   none.
+ * @return       number of rules.
+ */
+uint32_t vt_fw_get_rule_count(void)
+{
+	return rule_count;
+}
+
+/*!
+ * @brief  This API will get a committed rule and its hit count.
+ * @param [in]   rule_id - is rule Id.
+ * @param [out]  *info - pointer to vt_fw_rule_info_t structure.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL or VT_STATUS_INVALID.
+ */
+vt_status_t vt_fw_get_rule_info(uint32_t rule_id, vt_fw_rule_info_t *info)
+{
+	if(info == NULL)
+		return VT_STATUS_NULL;
+	if(rule_id >= rule_count)
+		return VT_STATUS_INVALID;
+
+	*info = rule_table[rule_id];
+	info->hits = VT_ATOMIC_LOAD(&rule_table[rule_id].hits);
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*------------------------------------------------------------------*
+ *                       Test Function                              *
+ *------------------------------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif
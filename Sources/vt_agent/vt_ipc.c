@@ -0,0 +1,130 @@
+/*
+ * vt_ipc.c
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_ipc.h"
+#include "vt_atomic.h"
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will create an empty channel, before either core uses it.
+ * @param [in]   *channel - pointer to vt_ipc_channel_t structure.
+ * @param [in]   *buff - pointer to storage of size frames.
+ * @param [in]   size - is number of frames, a power of 2.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL or VT_STATUS_INVALID.
+ */
+vt_status_t vt_ipc_init(vt_ipc_channel_t *channel, vt_ipc_frame_t *buff, uint32_t size)
+{
+	if(channel == NULL || buff == NULL)
+		return VT_STATUS_NULL;
+	if(size == 0 || (size & (size - 1U)) != 0)
+		return VT_STATUS_INVALID;
+
+	memset(channel, 0, sizeof(vt_ipc_channel_t));
+	channel->buff = buff;
+	channel->mask = size - 1U;
+	VT_ATOMIC_STORE(&channel->head, 0U);
+	VT_ATOMIC_STORE(&channel->tail, 0U);
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will add a frame to the channel, on the producer core.
+ * @param [in]   *channel - pointer to vt_ipc_channel_t structure.
+ * @param [in]   *frame - pointer to vt_ipc_frame_t structure.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_FULL.
+ */
+vt_status_t vt_ipc_push(vt_ipc_channel_t *channel, const vt_ipc_frame_t *frame)
+{
+	uint32_t head = channel->head;
+	uint32_t depth = head - channel->tail_cache;
+
+	if(depth > channel->mask)
+	{
+		/* Full as far as the producer knows, read where the consumer is */
+		channel->tail_cache = VT_ATOMIC_LOAD(&channel->tail);
+		depth = head - channel->tail_cache;
+		if(depth > channel->mask)
+		{
+			channel->dropped++;
+			return VT_STATUS_FULL;
+		}
+	}
+
+	channel->buff[head & channel->mask] = *frame;
+	/* The frame is in memory before the consumer sees the new head */
+	VT_ATOMIC_STORE(&channel->head, head + 1U);
+	if(depth + 1U > channel->high_water)
+	{
+		/* The copy of tail may be old, a new maximum is checked against the consumer */
+		channel->tail_cache = VT_ATOMIC_LOAD(&channel->tail);
+		depth = head - channel->tail_cache;
+		if(depth + 1U > channel->high_water)
+			channel->high_water = depth + 1U;
+	}
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will get the oldest frame of the channel, on the consumer core.
+ * @param [in]   *channel - pointer to vt_ipc_channel_t structure.
+ * @param [out]  *frame - pointer to vt_ipc_frame_t structure.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_EMPTY.
+ */
+vt_status_t vt_ipc_pop(vt_ipc_channel_t *channel, vt_ipc_frame_t *frame)
+{
+	uint32_t tail = channel->tail;
+
+	if(channel->head_cache == tail)
+	{
+		/* Empty as far as the consumer knows, read where the producer is */
+		channel->head_cache = VT_ATOMIC_LOAD(&channel->head);
+		if(channel->head_cache == tail)
+			return VT_STATUS_EMPTY;
+	}
+
+	*frame = channel->buff[tail & channel->mask];
+	/* The frame is read before the producer may write over it */
+	VT_ATOMIC_STORE(&channel->tail, tail + 1U);
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will get the number of frames the producer can add without refusal, on the producer core.
+ * @param [in]   *channel - pointer to vt_ipc_channel_t structure.
+ * @return       number of free frames.
+ */
+uint32_t vt_ipc_space(vt_ipc_channel_t *channel)
+{
+	channel->tail_cache = VT_ATOMIC_LOAD(&channel->tail);
+	return (channel->mask + 1U) - (channel->head - channel->tail_cache);
+}
+
+/*!
+ * @brief  This API will get the number of frames in the channel, from either core.
+ * @param [in]   *channel - pointer to vt_ipc_channel_t structure.
+ * @return       number of frames.
+ */
+uint32_t vt_ipc_count(const vt_ipc_channel_t *channel)
+{
+	uint32_t tail = VT_ATOMIC_LOAD(&channel->tail);
+
+	return VT_ATOMIC_LOAD(&channel->head) - tail;
+}
+
+#ifdef __cplusplus
+}
+#endif
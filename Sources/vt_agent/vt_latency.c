@@ -0,0 +1,288 @@
+/*
+ * vt_latency.c
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_latency.h"
+
+/*------------------------------------------------------------------*
+ *                          Define Macro                            *
+ *------------------------------------------------------------------*/
+#define VT_LATENCY_STD_ID_MAX 0x7FFUL
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief State of an egress port, written by the TX complete interrupt of the port and by the sender of the
+ *        frame in flight.
+ */
+typedef struct _vt_latency_port_t
+{
+	vt_probe_hist_t all;
+	vt_probe_hist_t priority[VT_LATENCY_PRIORITY_CLASSES];
+	vt_latency_trace_t *trace;      /*!< VT_LATENCY_TRACE_SIZE frames, NULL when the trace is disabled */
+	uint32_t trace_count;
+	uint32_t trace_floor;           /*!< index of the fastest frame of a full trace */
+	uint32_t ingress;               /*!< receive time of the frame in flight */
+	uint32_t can_id;                /*!< CAN Id of the frame in flight */
+	volatile uint8_t in_flight;
+}vt_latency_port_t;
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+static vt_latency_port_t *latency_ports = NULL;
+static uint8_t latency_port_count = 0;
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will keep a frame in the trace if it is slower than the fastest frame kept.
+ * @param [in]   *port - pointer to vt_latency_port_t structure.
+ * @param [in]   *entry - pointer to vt_latency_trace_t structure.
+ * @return       none.
+ */
+static void _vt_latency_trace(vt_latency_port_t *port, const vt_latency_trace_t *entry)
+{
+	uint32_t i;
+
+	if(port->trace == NULL)
+		return;
+
+	if(port->trace_count < VT_LATENCY_TRACE_SIZE)
+	{
+		port->trace[port->trace_count++] = *entry;
+		if(port->trace_count < VT_LATENCY_TRACE_SIZE)
+			return;
+	}
+	else
+	{
+		/* Most frames are faster than every outlier kept and stop here */
+		if(entry->ticks <= port->trace[port->trace_floor].ticks)
+			return;
+		port->trace[port->trace_floor] = *entry;
+	}
+
+	port->trace_floor = 0;
+	for(i = 1; i < VT_LATENCY_TRACE_SIZE; i++)
+	{
+		if(port->trace[i].ticks < port->trace[port->trace_floor].ticks)
+			port->trace_floor = i;
+	}
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will create the histograms and traces of the egress ports with storage carved from an arena.
+ * @param [in]   arena - is arena of a subsystem.
+ * @param [in]   ports - is number of CAN ports.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_INVALID or VT_STATUS_NO_MEM.
+ */
+vt_status_t vt_latency_init(vt_arena_id_t arena, uint8_t ports)
+{
+	vt_status_t status;
+	void *ptr;
+	uint8_t i;
+
+	if(ports == 0)
+		return VT_STATUS_INVALID;
+
+	status = vt_arena_alloc(arena, ports * sizeof(vt_latency_port_t), &ptr);
+	if(status != VT_STATUS_SUCCESS)
+		return status;
+	latency_ports = (vt_latency_port_t *)ptr;
+	latency_port_count = ports;
+
+	for(i = 0; i < ports; i++)
+	{
+		latency_ports[i].trace = NULL;
+#if VT_LATENCY_TRACE_SIZE > 0
+		status = vt_arena_alloc(arena, VT_LATENCY_TRACE_SIZE * sizeof(vt_latency_trace_t), &ptr);
+		if(status != VT_STATUS_SUCCESS)
+		{
+			latency_ports = NULL;
+			latency_port_count = 0;
+			return status;
+		}
+		latency_ports[i].trace = (vt_latency_trace_t *)ptr;
+#endif
+		latency_ports[i].in_flight = 0;
+		vt_latency_reset(i);
+	}
+
+	/* Timestamps are taken with the probe clock, whether the probes are built in or not */
+	vt_probe_clock_init();
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will get the priority class of a CAN Id.
+ * @param [in]   can_id - is CAN Id.
+ * @return       priority class.
+ */
+uint8_t vt_latency_priority(uint32_t can_id)
+{
+	if(can_id > VT_LATENCY_STD_ID_MAX)
+		return (uint8_t)((can_id >> 26) & (VT_LATENCY_PRIORITY_CLASSES - 1U));
+	return (uint8_t)((can_id >> 8) & (VT_LATENCY_PRIORITY_CLASSES - 1U));
+}
+
+/*!
+ * @brief  This API will remember the frame handed to the transmit mailbox of a port.
+ * @param [in]   port - is egress CAN number.
+ * @param [in]   can_id - is CAN Id of the frame.
+ * @param [in]   ingress - is vt_probe_now() taken when the frame was received.
+ * @return       none.
+ */
+void vt_latency_tx_start(uint8_t port, uint32_t can_id, uint32_t ingress)
+{
+	if(port >= latency_port_count)
+		return;
+
+	latency_ports[port].ingress = ingress;
+	latency_ports[port].can_id = can_id;
+	latency_ports[port].in_flight = 1;
+}
+
+/*!
+ * @brief  This API will account the frame in flight on a port to the histograms and to the trace.
+ * @param [in]   port - is egress CAN number.
+ * @param [in]   queue_depth - is number of messages waiting in the tx queue of the port.
+ * @param [in]   time_stamp - is current slot tick count.
+ * @return       none.
+ */
+void vt_latency_tx_complete(uint8_t port, uint32_t queue_depth, uint32_t time_stamp)
+{
+	vt_latency_port_t *state;
+	vt_latency_trace_t entry;
+
+	if(port >= latency_port_count)
+		return;
+	state = &latency_ports[port];
+	/* A TX complete of a frame sent outside of the gateway path */
+	if(state->in_flight == 0)
+		return;
+	state->in_flight = 0;
+
+	entry.ticks = vt_probe_now() - state->ingress;
+	entry.can_id = state->can_id;
+	entry.time_stamp = time_stamp;
+	entry.queue_depth = queue_depth;
+	entry.priority = vt_latency_priority(state->can_id);
+
+	vt_probe_hist_record(&state->all, entry.ticks);
+	vt_probe_hist_record(&state->priority[entry.priority], entry.ticks);
+	_vt_latency_trace(state, &entry);
+}
+
+/*!
+ * @brief  This API will get the latency histogram of a port.
+ * @param [in]   port - is egress CAN number.
+ * @param [in]   priority - is priority class, or VT_LATENCY_ALL_PRIORITIES.
+ * @param [out]  *stats - pointer to vt_probe_stats_t structure.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL, VT_STATUS_UNREADY or VT_STATUS_INVALID.
+ */
+vt_status_t vt_latency_get_stats(uint8_t port, uint8_t priority, vt_probe_stats_t *stats)
+{
+	if(stats == NULL)
+		return VT_STATUS_NULL;
+	if(latency_ports == NULL)
+		return VT_STATUS_UNREADY;
+	if(port >= latency_port_count)
+		return VT_STATUS_INVALID;
+
+	if(priority == VT_LATENCY_ALL_PRIORITIES)
+		vt_probe_hist_get_stats(&latency_ports[port].all, stats);
+	else if(priority < VT_LATENCY_PRIORITY_CLASSES)
+		vt_probe_hist_get_stats(&latency_ports[port].priority[priority], stats);
+	else
+		return VT_STATUS_INVALID;
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will get the worst frames of a port, the slowest first.
+ * @param [in]   port - is egress CAN number.
+ * @param [out]  *trace - pointer to array of vt_latency_trace_t structure.
+ * @param [in]   max - is number of elements of the array.
+ * @param [out]  *count - number of frames copied.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL, VT_STATUS_UNREADY or VT_STATUS_INVALID.
+ */
+vt_status_t vt_latency_get_trace(uint8_t port, vt_latency_trace_t *trace, uint32_t max, uint32_t *count)
+{
+	vt_latency_trace_t sorted[VT_LATENCY_TRACE_SIZE + 1U];
+	vt_latency_trace_t entry;
+	vt_latency_port_t *state;
+	uint32_t i, j, n;
+
+	if(trace == NULL || count == NULL)
+		return VT_STATUS_NULL;
+	*count = 0;
+	if(latency_ports == NULL)
+		return VT_STATUS_UNREADY;
+	if(port >= latency_port_count)
+		return VT_STATUS_INVALID;
+	state = &latency_ports[port];
+	if(state->trace == NULL)
+		return VT_STATUS_SUCCESS;
+
+	/* Entries are copied one by one, an outlier landing meanwhile may be torn */
+	n = state->trace_count;
+	if(n > VT_LATENCY_TRACE_SIZE)
+		n = VT_LATENCY_TRACE_SIZE;
+	for(i = 0; i < n; i++)
+	{
+		entry = state->trace[i];
+		for(j = i; j > 0 && sorted[j - 1].ticks < entry.ticks; j--)
+		{
+			sorted[j] = sorted[j - 1];
+		}
+		sorted[j] = entry;
+	}
+
+	for(i = 0; i < n && i < max; i++)
+	{
+		trace[i] = sorted[i];
+	}
+	*count = i;
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will clear the histograms and the trace of a port.
+ * @param [in]   port - is egress CAN number.
+ * @return       none.
+ */
+void vt_latency_reset(uint8_t port)
+{
+	uint32_t i;
+
+	if(port >= latency_port_count)
+		return;
+
+	vt_probe_hist_reset(&latency_ports[port].all);
+	for(i = 0; i < VT_LATENCY_PRIORITY_CLASSES; i++)
+	{
+		vt_probe_hist_reset(&latency_ports[port].priority[i]);
+	}
+	latency_ports[port].trace_count = 0;
+	latency_ports[port].trace_floor = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
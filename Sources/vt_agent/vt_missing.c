@@ -0,0 +1,209 @@
+/*
+ * vt_missing.c
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_missing.h"
+#include "vt_policy.h"
+#include "vt_atomic.h"
+
+/*------------------------------------------------------------------*
+ *                          Define Macro                            *
+ *------------------------------------------------------------------*/
+#if (VT_MISSING_MAX_IDS & (VT_MISSING_MAX_IDS - 1U)) != 0
+#error "VT_MISSING_MAX_IDS must be a power of 2"
+#endif
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief State of a periodic Id, its deadline is the timer of the same index. Times are slot ticks.
+ */
+typedef struct _vt_missing_entry_t
+{
+	uint32_t can_id;
+	uint32_t timeout;
+	volatile uint32_t last_rx;      /*!< written by the RX path */
+	volatile uint32_t frames;       /*!< written by the RX path, after last_rx */
+	uint32_t frames_seen;           /*!< frames at the last expiry */
+	uint8_t missing;
+}vt_missing_entry_t;
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+static vt_missing_entry_t *missing_table = NULL;
+static vt_policy_index_t missing_index;
+static vt_wheel_t missing_wheel;
+static vt_missing_stats_t missing_stats;
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will check an Id whose deadline passed.
+ * @param [in]   *wheel - pointer to vt_wheel_t structure.
+ * @param [in]   timer - is index of the entry.
+ * @param [in]   now - is current slot tick count.
+ * @return       none.
+ */
+static void _vt_missing_expired(vt_wheel_t *wheel, uint16_t timer, uint32_t now)
+{
+	vt_missing_entry_t *entry = &missing_table[timer];
+	uint32_t frames = VT_ATOMIC_LOAD(&entry->frames);
+	vt_event_t event;
+
+	missing_stats.expired++;
+	if(frames != entry->frames_seen)
+	{
+		/* Seen since, the deadline follows the last frame */
+		entry->frames_seen = frames;
+		if(entry->missing)
+		{
+			entry->missing = 0;
+			missing_stats.resumed++;
+		}
+		vt_wheel_schedule(wheel, timer, VT_ATOMIC_LOAD(&entry->last_rx) + entry->timeout);
+		return;
+	}
+
+	/* An Id never seen may not be on this bus */
+	if(frames > 0 && !entry->missing)
+	{
+		event.type = VT_EVENT_MISSING;
+		event.time_stamp = now;
+		event.u.missing.can_id = entry->can_id;
+		event.u.missing.last_ts = entry->last_rx;
+		event.u.missing.timeout = entry->timeout;
+		/* A full ring loses the record, the next deadline reports the Id again */
+		if(vt_event_push(&event) == VT_STATUS_SUCCESS)
+		{
+			entry->missing = 1;
+			missing_stats.missing++;
+		}
+	}
+	vt_wheel_schedule(wheel, timer, now + entry->timeout);
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will create the table of the periodic Ids of a policy with storage carved from an arena.
+ * @param [in]   arena - is arena of a subsystem.
+ * @param [in]   *policy - pointer to the policy, see car_policy.
+ * @param [in]   now - is current slot tick count.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL, VT_STATUS_UNSUPPORTED, VT_STATUS_INVALID or VT_STATUS_NO_MEM.
+ */
+vt_status_t vt_missing_init(vt_arena_id_t arena, const uint8_t *policy, uint32_t now)
+{
+	const uint8_t *records, *record;
+	vt_missing_entry_t *entry;
+	vt_status_t status;
+	uint32_t count, i, can_id, interval;
+	void *ptr;
+
+	missing_table = NULL;
+	memset(&missing_stats, 0, sizeof(missing_stats));
+	status = vt_policy_get_timing(policy, &records, &count);
+	if(status != VT_STATUS_SUCCESS)
+		return status;
+
+	status = vt_arena_alloc(arena, VT_MISSING_MAX_IDS * sizeof(vt_missing_entry_t), &ptr);
+	if(status != VT_STATUS_SUCCESS)
+		return status;
+	entry = (vt_missing_entry_t *)ptr;
+	status = vt_policy_index_create(&missing_index, arena, VT_MISSING_MAX_IDS);
+	if(status != VT_STATUS_SUCCESS)
+		return status;
+	status = vt_wheel_create(&missing_wheel, arena, VT_MISSING_MAX_IDS, now);
+	if(status != VT_STATUS_SUCCESS)
+		return status;
+
+	missing_table = entry;
+	memset(missing_table, 0, VT_MISSING_MAX_IDS * sizeof(vt_missing_entry_t));
+
+	for(i = 0; i < count; i++)
+	{
+		record = &records[i * VT_POLICY_RECORD_SIZE];
+		can_id = vt_policy_get_u32(&record[VT_POLICY_RECORD_ID]);
+		interval = vt_policy_get_u32(&record[VT_POLICY_RECORD_MAX]);
+		if(vt_policy_get_u32(&record[VT_POLICY_RECORD_PERIODIC]) == 0 || interval == 0 ||
+		   vt_policy_index_find(&missing_index, can_id) != VT_POLICY_NONE)
+			continue;
+		if(missing_stats.ids >= VT_MISSING_MAX_IDS)
+		{
+			missing_stats.untracked++;
+			continue;
+		}
+
+		entry = &missing_table[missing_stats.ids];
+		entry->can_id = can_id;
+		entry->timeout = (interval < (VT_WHEEL_RANGE / VT_MISSING_INTERVALS)) ? interval * VT_MISSING_INTERVALS : VT_WHEEL_RANGE;
+		vt_policy_index_add(&missing_index, can_id, (uint16_t)missing_stats.ids);
+		vt_wheel_schedule(&missing_wheel, (uint16_t)missing_stats.ids, now + entry->timeout);
+		missing_stats.ids++;
+	}
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will stamp a received frame.
+ * @param [in]   can_id - is CAN Id.
+ * @param [in]   now - is current slot tick count.
+ * @return       none.
+ */
+void vt_missing_rcv(uint32_t can_id, uint32_t now)
+{
+	uint16_t index;
+
+	if(missing_table == NULL)
+		return;
+
+	index = vt_policy_index_find(&missing_index, can_id);
+	if(index == VT_POLICY_NONE)
+		return;
+	/* The RX interrupts of the ports may preempt each other: frames is added to after last_rx is published, and a
+	 * last_rx newer than frames says only moves the deadline later */
+	VT_ATOMIC_STORE(&missing_table[index].last_rx, now);
+	VT_ATOMIC_ADD(&missing_table[index].frames, 1U);
+}
+
+/*!
+ * @brief  This API will check the Ids whose deadline passed.
+ * @param [in]   now - is current slot tick count.
+ * @return       none.
+ */
+void vt_missing_process(uint32_t now)
+{
+	if(missing_table == NULL)
+		return;
+
+	vt_wheel_advance(&missing_wheel, now, _vt_missing_expired);
+}
+
+/*!
+ * @brief  This API will get counters of the missing-frame detection.
+ * @param [out]  *stats - pointer to vt_missing_stats_t structure.
+ * @return       none.
+ */
+void vt_missing_get_stats(vt_missing_stats_t *stats)
+{
+	if(stats == NULL)
+		return;
+
+	*stats = missing_stats;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,183 @@
+/*
+ * vt_osal.c
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_osal.h"
+#include "vt_atomic.h"
+#if VT_OSAL == VT_OSAL_BAREMETAL
+#include "vt_timer.h"
+#elif VT_OSAL == VT_OSAL_FREERTOS
+#include "FreeRTOS.h"
+#include "task.h"
+#elif VT_OSAL == VT_OSAL_PTHREAD
+#include <pthread.h>
+#include <time.h>
+#else
+#error "VT_OSAL must be VT_OSAL_BAREMETAL, VT_OSAL_FREERTOS or VT_OSAL_PTHREAD"
+#endif
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+#if VT_OSAL == VT_OSAL_BAREMETAL
+static volatile uint32_t osal_signalled = 0;
+#elif VT_OSAL == VT_OSAL_FREERTOS
+static TaskHandle_t osal_task = NULL;
+#else
+static pthread_once_t osal_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t osal_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t osal_cond;
+static uint8_t osal_signalled = 0;
+#endif
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+#if VT_OSAL == VT_OSAL_PTHREAD
+/*!
+ * @brief  This API will create the condition variable on the monotonic clock, once.
+ * @param [in]   none.
+ * @return       none.
+ */
+static void _vt_osal_once(void)
+{
+	pthread_condattr_t attr;
+
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&osal_cond, &attr);
+	pthread_condattr_destroy(&attr);
+}
+#endif
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will prepare the wakeup, in the task that waits.
+ * @param [in]   none.
+ * @return       none.
+ */
+void vt_osal_init(void)
+{
+#if VT_OSAL == VT_OSAL_BAREMETAL
+	VT_ATOMIC_STORE(&osal_signalled, 0U);
+#elif VT_OSAL == VT_OSAL_FREERTOS
+	osal_task = xTaskGetCurrentTaskHandle();
+#else
+	pthread_once(&osal_once, _vt_osal_once);
+#endif
+}
+
+/*!
+ * @brief  This API will wake the waiting task, from a task.
+ * @param [in]   none.
+ * @return       none.
+ */
+void vt_osal_signal(void)
+{
+#if VT_OSAL == VT_OSAL_BAREMETAL
+	VT_ATOMIC_STORE(&osal_signalled, 1U);
+#elif VT_OSAL == VT_OSAL_FREERTOS
+	if(osal_task != NULL)
+		xTaskNotifyGive(osal_task);
+#else
+	pthread_once(&osal_once, _vt_osal_once);
+	pthread_mutex_lock(&osal_mutex);
+	osal_signalled = 1;
+	pthread_cond_signal(&osal_cond);
+	pthread_mutex_unlock(&osal_mutex);
+#endif
+}
+
+/*!
+ * @brief  This API will wake the waiting task, from an interrupt.
+ * @param [in]   none.
+ * @return       none.
+ */
+void vt_osal_signal_from_isr(void)
+{
+#if VT_OSAL == VT_OSAL_FREERTOS
+	BaseType_t woken = pdFALSE;
+
+	if(osal_task == NULL)
+		return;
+	vTaskNotifyGiveFromISR(osal_task, &woken);
+	portYIELD_FROM_ISR(woken);
+#else
+	/* Interrupts of the host are threads */
+	vt_osal_signal();
+#endif
+}
+
+/*!
+ * @brief  This API will sleep until a signal or a timeout. A signal given since the previous wait returns at once.
+ * @param [in]   timeout_us - is timeout in microseconds, or VT_OSAL_WAIT_FOREVER.
+ * @return       VT_STATUS_SUCCESS if signalled, VT_STATUS_TIMEOUT otherwise.
+ */
+vt_status_t vt_osal_wait(uint32_t timeout_us)
+{
+#if VT_OSAL == VT_OSAL_BAREMETAL
+	uint32_t start = vt_timer_get_ticks();
+	uint32_t ticks = (timeout_us / VT_PIT_PERIOD) + (((timeout_us % VT_PIT_PERIOD) != 0) ? 1U : 0U);
+
+	while(VT_ATOMIC_EXCHANGE(&osal_signalled, 0U) == 0)
+	{
+		if(timeout_us != VT_OSAL_WAIT_FOREVER && (vt_timer_get_ticks() - start) >= ticks)
+			return VT_STATUS_TIMEOUT;
+		/* A signal racing the check is seen at the next interrupt, one slot tick later at most */
+#if defined(__PPC__) || defined(__powerpc__)
+		__asm__ volatile ("wait");
+#endif
+	}
+	return VT_STATUS_SUCCESS;
+#elif VT_OSAL == VT_OSAL_FREERTOS
+	TickType_t ticks = portMAX_DELAY;
+
+	if(timeout_us != VT_OSAL_WAIT_FOREVER)
+		ticks = (TickType_t)(((uint64_t)timeout_us * configTICK_RATE_HZ + 999999ULL) / 1000000ULL);
+	return (ulTaskNotifyTake(pdTRUE, ticks) > 0) ? VT_STATUS_SUCCESS : VT_STATUS_TIMEOUT;
+#else
+	struct timespec ts;
+	vt_status_t status = VT_STATUS_SUCCESS;
+	int result = 0;
+
+	pthread_once(&osal_once, _vt_osal_once);
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	ts.tv_sec += (time_t)(timeout_us / 1000000U);
+	ts.tv_nsec += (long)(timeout_us % 1000000U) * 1000L;
+	if(ts.tv_nsec >= 1000000000L)
+	{
+		ts.tv_sec++;
+		ts.tv_nsec -= 1000000000L;
+	}
+
+	pthread_mutex_lock(&osal_mutex);
+	while(!osal_signalled && result == 0)
+	{
+		if(timeout_us == VT_OSAL_WAIT_FOREVER)
+			result = pthread_cond_wait(&osal_cond, &osal_mutex);
+		else
+			result = pthread_cond_timedwait(&osal_cond, &osal_mutex, &ts);
+	}
+	if(osal_signalled)
+		osal_signalled = 0;
+	else
+		status = VT_STATUS_TIMEOUT;
+	pthread_mutex_unlock(&osal_mutex);
+
+	return status;
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,142 @@
+/*
+ * vt_policy.c
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_policy.h"
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will hash a CAN Id.
+ * @param [in]   *index - pointer to vt_policy_index_t structure.
+ * @param [in]   can_id - is CAN Id.
+ * @return       first slot to probe.
+ */
+static uint32_t _vt_policy_hash(const vt_policy_index_t *index, uint32_t can_id)
+{
+	return ((can_id * 0x9E3779B1U) >> 16) & index->mask;
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will read a big endian word of the policy.
+ * @param [in]   *buff - pointer to the word.
+ * @return       the word.
+ */
+uint32_t vt_policy_get_u32(const uint8_t *buff)
+{
+	return ((uint32_t)buff[0] << 24) | ((uint32_t)buff[1] << 16) | ((uint32_t)buff[2] << 8) | (uint32_t)buff[3];
+}
+
+/*!
+ * @brief  This API will check the header of a policy and find its timing records.
+ * @param [in]   *policy - pointer to the policy, see car_policy.
+ * @param [out]  **records - pointer to the first timing record.
+ * @param [out]  *count - number of timing records.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL, VT_STATUS_UNSUPPORTED or VT_STATUS_INVALID.
+ */
+vt_status_t vt_policy_get_timing(const uint8_t *policy, const uint8_t **records, uint32_t *count)
+{
+	uint32_t total;
+
+	if(policy == NULL || records == NULL || count == NULL)
+		return VT_STATUS_NULL;
+
+	/* The length first, the rest of the header may not be there */
+	total = vt_policy_get_u32(policy);
+	if(total < VT_POLICY_HEADER_SIZE)
+		return VT_STATUS_INVALID;
+	if(vt_policy_get_u32(&policy[4]) != VT_POLICY_VERSION)
+		return VT_STATUS_UNSUPPORTED;
+	*count = vt_policy_get_u32(&policy[8]);
+	if(*count > ((total - VT_POLICY_HEADER_SIZE) / VT_POLICY_RECORD_SIZE))
+		return VT_STATUS_INVALID;
+
+	*records = &policy[VT_POLICY_HEADER_SIZE];
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will create an empty index of a table with storage carved from an arena.
+ * @param [out]  *index - pointer to vt_policy_index_t structure.
+ * @param [in]   arena - is arena of a subsystem.
+ * @param [in]   max_ids - is number of entries of the table, a power of 2 below VT_POLICY_NONE / 2.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL, VT_STATUS_INVALID or VT_STATUS_NO_MEM.
+ */
+vt_status_t vt_policy_index_create(vt_policy_index_t *index, vt_arena_id_t arena, uint32_t max_ids)
+{
+	vt_status_t status;
+	uint32_t size = 2U * max_ids;
+	void *ptr;
+
+	if(index == NULL)
+		return VT_STATUS_NULL;
+	if(max_ids == 0 || (max_ids & (max_ids - 1U)) != 0 || size >= VT_POLICY_NONE)
+		return VT_STATUS_INVALID;
+
+	status = vt_arena_alloc(arena, size * sizeof(uint32_t), &ptr);
+	if(status != VT_STATUS_SUCCESS)
+		return status;
+	index->keys = (uint32_t *)ptr;
+	status = vt_arena_alloc(arena, size * sizeof(uint16_t), &ptr);
+	if(status != VT_STATUS_SUCCESS)
+		return status;
+	index->slots = (uint16_t *)ptr;
+	index->mask = size - 1U;
+	memset(index->slots, 0xFF, size * sizeof(uint16_t));
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will add the entry of a CAN Id not in the index yet, in init.
+ * @param [in]   *index - pointer to vt_policy_index_t structure.
+ * @param [in]   can_id - is CAN Id.
+ * @param [in]   entry - is index of the entry in the table, below max_ids.
+ * @return       none.
+ */
+void vt_policy_index_add(vt_policy_index_t *index, uint32_t can_id, uint16_t entry)
+{
+	uint32_t slot = _vt_policy_hash(index, can_id);
+
+	while(index->slots[slot] != VT_POLICY_NONE)
+		slot = (slot + 1U) & index->mask;
+	index->keys[slot] = can_id;
+	index->slots[slot] = entry;
+}
+
+/*!
+ * @brief  This API will find the entry of a CAN Id.
+ * @param [in]   *index - pointer to vt_policy_index_t structure.
+ * @param [in]   can_id - is CAN Id.
+ * @return       index of the entry in the table, or VT_POLICY_NONE.
+ */
+uint16_t vt_policy_index_find(const vt_policy_index_t *index, uint32_t can_id)
+{
+	uint32_t slot = _vt_policy_hash(index, can_id);
+	uint16_t entry;
+
+	/* The table is never more than half full, an empty slot ends the probe */
+	while((entry = index->slots[slot]) != VT_POLICY_NONE)
+	{
+		if(index->keys[slot] == can_id)
+			return entry;
+		slot = (slot + 1U) & index->mask;
+	}
+	return VT_POLICY_NONE;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,231 @@
+/*
+ * vt_probe.c
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_probe.h"
+#include "vt_atomic.h"
+
+/*------------------------------------------------------------------*
+ *                          Define Macro                            *
+ *------------------------------------------------------------------*/
+/*! HID0[TBEN] of the e200 core */
+#define VT_PROBE_HID0_TBEN 0x00004000UL
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+static vt_probe_hist_t probe_hist[VT_PROBE_MAX];
+
+static const char *probe_names[VT_PROBE_MAX] = {
+		"vt_rcv_callback",
+		"vt_fw_rcv_msg",
+		"vt_fw_can_msg_is_malicious",
+		"vt_fw_process",
+		"PIT_Ch0_IRQHandler"
+};
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will get the upper edge of the bucket holding a percentile.
+ * @param [in]   *stats - pointer to vt_probe_stats_t structure with buckets and count filled.
+ * @param [in]   percent - is percentile (1 to 100).
+ * @param [in]   max - is largest duration recorded, in ticks.
+ * @return       duration in ticks.
+ */
+static uint32_t _vt_probe_percentile(const vt_probe_stats_t *stats, uint32_t percent, uint32_t max)
+{
+	uint64_t target = ((uint64_t)stats->count * percent + 99U) / 100U;
+	uint64_t sum = 0;
+	uint32_t b, edge;
+
+	for(b = 0; b < VT_PROBE_BUCKETS; b++)
+	{
+		sum += stats->buckets[b];
+		if(sum >= target)
+			break;
+	}
+	if(b >= VT_PROBE_BUCKETS)
+		return max;
+
+	edge = (b == 0) ? 0 : (b >= 32U) ? 0xFFFFFFFFUL : ((1UL << b) - 1U);
+	return (edge < max) ? edge : max;
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will start the probe clock.
+ * @param [in]   none.
+ * @return       none.
+ */
+void vt_probe_clock_init(void)
+{
+#if defined(__PPC__) || defined(__powerpc__)
+	uint32_t hid0;
+
+	__asm__ volatile ("mfspr %0, 1008" : "=r" (hid0));
+	hid0 |= VT_PROBE_HID0_TBEN;
+	__asm__ volatile ("mtspr 1008, %0" : : "r" (hid0));
+#endif
+}
+
+/*!
+ * @brief  This API will clear every histogram and start the timebase on target.
+ * @param [in]   none.
+ * @return       none.
+ */
+void vt_probe_init(void)
+{
+	int i;
+
+	vt_probe_clock_init();
+	for(i = 0; i < (int)VT_PROBE_MAX; i++)
+	{
+		vt_probe_reset((vt_probe_id_t)i);
+	}
+}
+
+/*!
+ * @brief  This API will clear a histogram.
+ * @param [out]  *hist - pointer to vt_probe_hist_t structure.
+ * @return       none.
+ */
+void vt_probe_hist_reset(vt_probe_hist_t *hist)
+{
+	memset(hist, 0, sizeof(vt_probe_hist_t));
+	hist->min = 0xFFFFFFFFUL;
+}
+
+/*!
+ * @brief  This API will account a duration to a histogram.
+ * @param [in]   *hist - pointer to vt_probe_hist_t structure.
+ * @param [in]   ticks - is duration in ticks of the probe clock.
+ * @return       none.
+ */
+void vt_probe_hist_record(vt_probe_hist_t *hist, uint32_t ticks)
+{
+	uint32_t seen;
+
+	/* Several interrupts record to one probe and nest, e.g. VT_PROBE_FW_RCV_MSG from the RX of every port */
+	VT_ATOMIC_ADD(&hist->buckets[(ticks == 0) ? 0 : (32U - (uint32_t)__builtin_clz(ticks))], 1U);
+	VT_ATOMIC_ADD(&hist->count, 1U);
+	seen = VT_ATOMIC_LOAD(&hist->min);
+	while(ticks < seen && !VT_ATOMIC_CAS(&hist->min, &seen, ticks))
+		;
+	seen = VT_ATOMIC_LOAD(&hist->max);
+	while(ticks > seen && !VT_ATOMIC_CAS(&hist->max, &seen, ticks))
+		;
+}
+
+/*!
+ * @brief  This API will get a histogram with min, max, p50 and p99 in nanoseconds.
+ * @param [in]   *hist - pointer to vt_probe_hist_t structure.
+ * @param [out]  *stats - pointer to vt_probe_stats_t structure.
+ * @return       none.
+ */
+void vt_probe_hist_get_stats(const vt_probe_hist_t *hist, vt_probe_stats_t *stats)
+{
+	uint32_t max;
+
+	/* Words are copied one by one, a record landing meanwhile may be half counted */
+	memcpy(stats->buckets, (const void *)hist->buckets, sizeof(stats->buckets));
+	stats->count = VT_ATOMIC_LOAD(&hist->count);
+	max = VT_ATOMIC_LOAD(&hist->max);
+	if(stats->count == 0)
+	{
+		stats->min_ns = 0;
+		stats->max_ns = 0;
+		stats->p50_ns = 0;
+		stats->p99_ns = 0;
+		return;
+	}
+
+	stats->min_ns = vt_probe_to_ns(VT_ATOMIC_LOAD(&hist->min));
+	stats->max_ns = vt_probe_to_ns(max);
+	stats->p50_ns = vt_probe_to_ns(_vt_probe_percentile(stats, 50U, max));
+	stats->p99_ns = vt_probe_to_ns(_vt_probe_percentile(stats, 99U, max));
+}
+
+/*!
+ * @brief  This API will convert ticks of the probe clock to nanoseconds, saturated to 32 bits.
+ * @param [in]   ticks - is ticks.
+ * @return       nanoseconds.
+ */
+uint32_t vt_probe_to_ns(uint32_t ticks)
+{
+	uint64_t ns = ((uint64_t)ticks * 1000000000ULL) / VT_PROBE_TICK_HZ;
+
+	return (ns > 0xFFFFFFFFULL) ? 0xFFFFFFFFUL : (uint32_t)ns;
+}
+
+/*!
+ * @brief  This API will account a duration to the histogram of a probe.
+ * @param [in]   id - is probe.
+ * @param [in]   ticks - is duration in ticks of the probe clock.
+ * @return       none.
+ */
+void vt_probe_record(vt_probe_id_t id, uint32_t ticks)
+{
+	if((uint32_t)id >= VT_PROBE_MAX)
+		return;
+
+	vt_probe_hist_record(&probe_hist[id], ticks);
+}
+
+/*!
+ * @brief  This API will get the histogram of a probe.
+ * @param [in]   id - is probe.
+ * @param [out]  *stats - pointer to vt_probe_stats_t structure.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL or VT_STATUS_INVALID.
+ */
+vt_status_t vt_probe_get_stats(vt_probe_id_t id, vt_probe_stats_t *stats)
+{
+	if(stats == NULL)
+		return VT_STATUS_NULL;
+	if((uint32_t)id >= VT_PROBE_MAX)
+		return VT_STATUS_INVALID;
+
+	vt_probe_hist_get_stats(&probe_hist[id], stats);
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will clear the histogram of a probe.
+ * @param [in]   id - is probe.
+ * @return       none.
+ */
+void vt_probe_reset(vt_probe_id_t id)
+{
+	if((uint32_t)id >= VT_PROBE_MAX)
+		return;
+
+	vt_probe_hist_reset(&probe_hist[id]);
+}
+
+/*!
+ * @brief  This API will get the display name of a probe.
+ * @param [in]   id - is probe.
+ * @return       name.
+ */
+const char *vt_probe_name(uint8_t id)
+{
+	if(id >= VT_PROBE_MAX)
+		return "unknown";
+	return probe_names[id];
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,102 @@
+/*
+ * vt_queue.c
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_queue.h"
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will create a message queue with storage carved from an arena.
+ * @param [in]   *queue - pointer to vt_msg_queue_t structure.
+ * @param [in]   arena - is arena of a subsystem.
+ * @param [in]   size - is number of messages.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_NO_MEM.
+ */
+vt_status_t vt_queue_create(vt_msg_queue_t *queue, vt_arena_id_t arena, uint32_t size)
+{
+	vt_status_t status;
+	void *buff = NULL;
+
+	if(queue == NULL)
+		return VT_STATUS_NULL;
+	if(size == 0)
+		return VT_STATUS_INVALID;
+
+	memset(queue, 0, sizeof(vt_msg_queue_t));
+	status = vt_arena_alloc(arena, size * sizeof(vt_msgbuff_t), &buff);
+	if(status != VT_STATUS_SUCCESS)
+		return status;
+
+	queue->buff = (vt_msgbuff_t *)buff;
+	queue->size = size;
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will add a CAN message to the queue.
+ * @param [in]   *queue - pointer to vt_msg_queue_t structure.
+ * @param [in]   *msg - pointer to message.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_FULL.
+ */
+vt_status_t vt_queue_push(vt_msg_queue_t *queue, const vt_msgbuff_t *msg)
+{
+	uint32_t head = queue->head;
+	uint32_t depth = head - queue->tail;
+
+	if(depth >= queue->size)
+	{
+		queue->dropped++;
+		return VT_STATUS_FULL;
+	}
+
+	queue->buff[head % queue->size] = *msg;
+	queue->head = head + 1;
+	if(depth + 1 > queue->high_water)
+		queue->high_water = depth + 1;
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will get the oldest CAN message from the queue.
+ * @param [in]   *queue - pointer to vt_msg_queue_t structure.
+ * @param [out]  *msg - pointer to message.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_EMPTY.
+ */
+vt_status_t vt_queue_pop(vt_msg_queue_t *queue, vt_msgbuff_t *msg)
+{
+	uint32_t tail = queue->tail;
+
+	if(queue->head == tail)
+		return VT_STATUS_EMPTY;
+
+	*msg = queue->buff[tail % queue->size];
+	queue->tail = tail + 1;
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will get number of messages in the queue.
+ * @param [in]   *queue - pointer to vt_msg_queue_t structure.
+ * @return       number of messages.
+ */
+uint32_t vt_queue_count(const vt_msg_queue_t *queue)
+{
+	return queue->head - queue->tail;
+}
+
+#ifdef __cplusplus
+}
+#endif
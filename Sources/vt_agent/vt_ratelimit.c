@@ -0,0 +1,256 @@
+/*
+ * vt_ratelimit.c
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_ratelimit.h"
+#include "vt_fw_oem.h"
+#include "vt_policy.h"
+#include "vt_timer.h"
+#include "vt_atomic.h"
+
+/*------------------------------------------------------------------*
+ *                          Define Macro                            *
+ *------------------------------------------------------------------*/
+#if (VT_RATELIMIT_MAX_IDS & (VT_RATELIMIT_MAX_IDS - 1U)) != 0
+#error "VT_RATELIMIT_MAX_IDS must be a power of 2"
+#endif
+
+/* A frame costs the ticks of a window, a tick adds the frames of a window: the rate is exact without division */
+#define VT_RATELIMIT_COST           ((VT_RATELIMIT_WINDOW_MS * 1000U) / VT_PIT_PERIOD)
+#define VT_RATELIMIT_CAPACITY       (VT_RATELIMIT_BURST * VT_RATELIMIT_COST)
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief Token bucket of an Id on an ingress port. Tokens are in ticks times frames, a frame costs
+ *        VT_RATELIMIT_COST.
+ */
+typedef struct _vt_ratelimit_bucket_t
+{
+	volatile uint32_t busy;         /*!< 1 while a check updates the bucket */
+	uint32_t tokens;
+	uint32_t last;                  /*!< slot tick count of the last check */
+}vt_ratelimit_bucket_t;
+
+/*!
+ * @brief Rate of an Id, with a bucket per ingress port.
+ */
+typedef struct _vt_ratelimit_entry_t
+{
+	uint32_t can_id;
+	uint32_t max_frames;
+	uint32_t fill;                  /*!< tokens added per slot tick */
+	uint32_t full_ticks;            /*!< slot ticks filling an empty bucket */
+	vt_ratelimit_bucket_t buckets[VT_MAX_CAN_NUMBER];
+	volatile uint32_t passed;
+	volatile uint32_t dropped;
+}vt_ratelimit_entry_t;
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+static vt_ratelimit_entry_t *ratelimit_table = NULL;
+static vt_policy_index_t ratelimit_index;
+static uint32_t ratelimit_ids = 0;
+static uint32_t ratelimit_untracked = 0;
+static volatile uint32_t ratelimit_contended = 0;
+static volatile uint32_t ratelimit_mode = VT_RATELIMIT_ENFORCE;
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will create a full bucket for each Id of a policy with storage carved from an arena.
+ * @param [in]   arena - is arena of a subsystem.
+ * @param [in]   *policy - pointer to the policy, see car_policy.
+ * @param [in]   now - is current slot tick count.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL, VT_STATUS_UNSUPPORTED, VT_STATUS_INVALID or VT_STATUS_NO_MEM.
+ */
+vt_status_t vt_ratelimit_init(vt_arena_id_t arena, const uint8_t *policy, uint32_t now)
+{
+	const uint8_t *records, *record;
+	vt_ratelimit_entry_t *entry;
+	vt_status_t status;
+	uint32_t count, i, port, can_id, frames;
+	void *ptr;
+
+	ratelimit_table = NULL;
+	ratelimit_ids = 0;
+	ratelimit_untracked = 0;
+	ratelimit_contended = 0;
+	ratelimit_mode = VT_RATELIMIT_ENFORCE;
+	status = vt_policy_get_timing(policy, &records, &count);
+	if(status != VT_STATUS_SUCCESS)
+		return status;
+
+	status = vt_arena_alloc(arena, VT_RATELIMIT_MAX_IDS * sizeof(vt_ratelimit_entry_t), &ptr);
+	if(status != VT_STATUS_SUCCESS)
+		return status;
+	entry = (vt_ratelimit_entry_t *)ptr;
+	status = vt_policy_index_create(&ratelimit_index, arena, VT_RATELIMIT_MAX_IDS);
+	if(status != VT_STATUS_SUCCESS)
+		return status;
+	memset(entry, 0, VT_RATELIMIT_MAX_IDS * sizeof(vt_ratelimit_entry_t));
+	ratelimit_table = entry;
+
+	for(i = 0; i < count; i++)
+	{
+		record = &records[i * VT_POLICY_RECORD_SIZE];
+		can_id = vt_policy_get_u32(&record[VT_POLICY_RECORD_ID]);
+		frames = vt_policy_get_u32(&record[VT_POLICY_RECORD_MAX_FRAMES]);
+		if(frames == 0 || vt_policy_index_find(&ratelimit_index, can_id) != VT_POLICY_NONE)
+			continue;
+		if(ratelimit_ids >= VT_RATELIMIT_MAX_IDS)
+		{
+			ratelimit_untracked++;
+			continue;
+		}
+
+		entry = &ratelimit_table[ratelimit_ids];
+		entry->can_id = can_id;
+		entry->max_frames = frames;
+		/* An Id faster than a bucket per tick is never limited */
+		entry->fill = (frames < (VT_RATELIMIT_CAPACITY / VT_RATELIMIT_MARGIN)) ? frames * VT_RATELIMIT_MARGIN : VT_RATELIMIT_CAPACITY;
+		entry->full_ticks = (VT_RATELIMIT_CAPACITY + entry->fill - 1U) / entry->fill;
+		for(port = 0; port < VT_MAX_CAN_NUMBER; port++)
+		{
+			entry->buckets[port].tokens = VT_RATELIMIT_CAPACITY;
+			entry->buckets[port].last = now;
+		}
+		vt_policy_index_add(&ratelimit_index, can_id, (uint16_t)ratelimit_ids);
+		ratelimit_ids++;
+	}
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will choose what happens to frames over the rate.
+ * @param [in]   mode - is vt_ratelimit_mode_t.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_INVALID.
+ */
+vt_status_t vt_ratelimit_set_mode(vt_ratelimit_mode_t mode)
+{
+	if(mode != VT_RATELIMIT_ENFORCE && mode != VT_RATELIMIT_MONITOR)
+		return VT_STATUS_INVALID;
+
+	VT_ATOMIC_STORE(&ratelimit_mode, (uint32_t)mode);
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will take a token of the bucket of a frame to forward.
+ * @param [in]   port - is CAN number the frame was received on (e.g: 0, 1, 2).
+ * @param [in]   can_id - is CAN Id.
+ * @param [in]   now - is current slot tick count.
+ * @return       VT_STATUS_SUCCESS to forward the frame, VT_STATUS_FULL to drop it.
+ */
+vt_status_t vt_ratelimit_check(uint8_t port, uint32_t can_id, uint32_t now)
+{
+	vt_ratelimit_entry_t *entry;
+	vt_ratelimit_bucket_t *bucket;
+	uint32_t elapsed;
+	uint16_t index;
+	uint8_t passed;
+
+	if(ratelimit_table == NULL || port >= VT_MAX_CAN_NUMBER)
+		return VT_STATUS_SUCCESS;
+
+	index = vt_policy_index_find(&ratelimit_index, can_id);
+	if(index == VT_POLICY_NONE)
+		return VT_STATUS_SUCCESS;
+
+	entry = &ratelimit_table[index];
+	bucket = &entry->buckets[port];
+	/* The check it preempted holds the bucket and cannot go on before this one returns: the frame passes */
+	if(VT_ATOMIC_EXCHANGE(&bucket->busy, 1U) != 0)
+	{
+		VT_ATOMIC_ADD(&ratelimit_contended, 1U);
+		return VT_STATUS_SUCCESS;
+	}
+
+	elapsed = now - bucket->last;
+	bucket->last = now;
+	/* Below full_ticks the product stays below the capacity plus a fill */
+	if(elapsed >= entry->full_ticks)
+		bucket->tokens = VT_RATELIMIT_CAPACITY;
+	else if(elapsed > 0)
+	{
+		bucket->tokens += elapsed * entry->fill;
+		if(bucket->tokens > VT_RATELIMIT_CAPACITY)
+			bucket->tokens = VT_RATELIMIT_CAPACITY;
+	}
+	passed = (bucket->tokens >= VT_RATELIMIT_COST) ? 1U : 0U;
+	if(passed)
+		bucket->tokens -= VT_RATELIMIT_COST;
+	VT_ATOMIC_STORE(&bucket->busy, 0U);
+
+	if(passed)
+	{
+		VT_ATOMIC_ADD(&entry->passed, 1U);
+		return VT_STATUS_SUCCESS;
+	}
+	VT_ATOMIC_ADD(&entry->dropped, 1U);
+	return (VT_ATOMIC_LOAD(&ratelimit_mode) == VT_RATELIMIT_ENFORCE) ? VT_STATUS_FULL : VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will get the bucket of an Id.
+ * @param [in]   index - is index of the bucket.
+ * @param [out]  *info - pointer to vt_ratelimit_info_t structure.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL or VT_STATUS_INVALID.
+ */
+vt_status_t vt_ratelimit_get_info(uint32_t index, vt_ratelimit_info_t *info)
+{
+	vt_ratelimit_entry_t *entry;
+
+	if(info == NULL)
+		return VT_STATUS_NULL;
+	if(ratelimit_table == NULL || index >= ratelimit_ids)
+		return VT_STATUS_INVALID;
+
+	entry = &ratelimit_table[index];
+	info->can_id = entry->can_id;
+	info->max_frames = entry->max_frames;
+	info->passed = VT_ATOMIC_LOAD(&entry->passed);
+	info->dropped = VT_ATOMIC_LOAD(&entry->dropped);
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will get counters of the rate enforcement.
+ * @param [out]  *stats - pointer to vt_ratelimit_stats_t structure.
+ * @return       none.
+ */
+void vt_ratelimit_get_stats(vt_ratelimit_stats_t *stats)
+{
+	uint32_t i;
+
+	if(stats == NULL)
+		return;
+
+	memset(stats, 0, sizeof(vt_ratelimit_stats_t));
+	if(ratelimit_table == NULL)
+		return;
+	stats->ids = ratelimit_ids;
+	stats->untracked = ratelimit_untracked;
+	stats->contended = VT_ATOMIC_LOAD(&ratelimit_contended);
+	for(i = 0; i < ratelimit_ids; i++)
+	{
+		stats->passed += VT_ATOMIC_LOAD(&ratelimit_table[i].passed);
+		stats->dropped += VT_ATOMIC_LOAD(&ratelimit_table[i].dropped);
+	}
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -12,6 +12,7 @@ extern "C" {
  *------------------------------------------------------------------*/
 #include "vt_rtc.h"
 #include "vt_fw_if.h"
+#include "vt_fw_oem.h"
 
 /*------------------------------------------------------------------*
  *                          Define Macro                            *
@@ -116,6 +117,8 @@ void vt_rtc_timer_callback(void * callbackParam)
 {
 	/* Put your code here */
 	vt_fw_increase_system_time();
+	/* The window callbacks of the core have run, their records wait for the main loop */
+	vt_fw_oem_signal(0);
 	vt_toggle_led(leds[VT_RTC_LED]);
 }
 
@@ -13,6 +13,8 @@ extern "C" {
 #include "vt_timer.h"
 #include "vt_fw_if.h"
 #include "vt_can.h"
+#include "vt_probe.h"
+#include "vt_ipc.h"
 /*------------------------------------------------------------------*
  *                          Define Macro                            *
  *------------------------------------------------------------------*/
@@ -46,6 +48,12 @@ pit_channel_config_t vt_pit_ChnConfig0 =
     .enableInterrupt = true
 };
 
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+/* Counted on the firewall core, read by the forward path of the CAN core with VT_FW_DUAL_CORE */
+static VT_IPC_SHARED volatile uint32_t slot_ticks VT_IPC_ALIGNED = 0;
+
 /*------------------------------------------------------------------*
  *                 Private Function Prototypes                      *
  *------------------------------------------------------------------*/
@@ -59,9 +67,13 @@ pit_channel_config_t vt_pit_ChnConfig0 =
  *------------------------------------------------------------------*/
 void PIT_Ch0_IRQHandler(void)
 {
+	VT_PROBE_START(probe_pit);
+
+	slot_ticks++;
 	vt_fw_increase_slot_tick_count();
 	vt_update_can_led();
 	PIT_DRV_ClearStatusFlags(VT_INST_PIT, vt_pit_ChnConfig0.hwChannel);     
+	VT_PROBE_END(VT_PROBE_PIT_IRQ, probe_pit);
 }
 
 /*------------------------------------------------------------------*
@@ -82,6 +94,28 @@ void vt_timer_init(uint32_t instance, pit_channel_config_t *channel_config)
 	PIT_DRV_StartChannel(instance, channel_config->hwChannel);
 }
 
+/*!
+ * @brief  This API will get number of slot ticks since the timer started. A tick is VT_PIT_PERIOD microsecond.
+ * @param [in]   none.
+ * @return       tick count.
+ */
+uint32_t vt_timer_get_ticks(void)
+{
+	return slot_ticks;
+}
+
+/*!
+ * @brief  This API will get the time left until a slot tick count.
+ * @param [in]   tick - is slot tick count, e.g. a deadline of vt_fw_process_until_idle().
+ * @return       microseconds, 0 if the tick count has passed.
+ */
+uint32_t vt_timer_us_until(uint32_t tick)
+{
+	int32_t ticks = (int32_t)(tick - slot_ticks);
+
+	return (ticks > 0) ? ((uint32_t)ticks * VT_PIT_PERIOD) : 0U;
+}
+
 /*------------------------------------------------------------------*
  *                           Test Function                          *
  *------------------------------------------------------------------*/
@@ -0,0 +1,289 @@
+/*
+ * vt_wheel.c
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_wheel.h"
+
+/*------------------------------------------------------------------*
+ *                          Define Macro                            *
+ *------------------------------------------------------------------*/
+#define VT_WHEEL_SLOT_MASK      (VT_WHEEL_SLOTS - 1U)
+/*! List of the timers being expired, after the slots */
+#define VT_WHEEL_EXPIRING       (VT_WHEEL_LEVELS * VT_WHEEL_SLOTS)
+
+#if VT_WHEEL_EXPIRING > 0xFFU
+#error "VT_WHEEL_LEVELS * VT_WHEEL_SLOTS must fit the slot of a timer"
+#endif
+#if VT_WHEEL_SLOTS < 32U
+#error "VT_WHEEL_SLOTS must be 32 or more"
+#endif
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will link a timer at the head of a list.
+ * @param [in]   *wheel - pointer to vt_wheel_t structure.
+ * @param [in]   timer - is index of the timer.
+ * @param [in]   slot - is list.
+ * @return       none.
+ */
+static void _vt_wheel_link(vt_wheel_t *wheel, uint16_t timer, uint32_t slot)
+{
+	vt_wheel_timer_t *entry = &wheel->timers[timer];
+
+	entry->slot = (uint8_t)slot;
+	entry->prev = VT_WHEEL_NONE;
+	entry->next = wheel->heads[slot];
+	if(entry->next != VT_WHEEL_NONE)
+		wheel->timers[entry->next].prev = timer;
+	wheel->heads[slot] = timer;
+	if(slot < VT_WHEEL_SLOTS)
+		wheel->pending[slot >> 5] |= (1UL << (slot & 31U));
+}
+
+/*!
+ * @brief  This API will unlink a timer from its list.
+ * @param [in]   *wheel - pointer to vt_wheel_t structure.
+ * @param [in]   timer - is index of the timer.
+ * @return       none.
+ */
+static void _vt_wheel_unlink(vt_wheel_t *wheel, uint16_t timer)
+{
+	vt_wheel_timer_t *entry = &wheel->timers[timer];
+
+	if(entry->prev != VT_WHEEL_NONE)
+		wheel->timers[entry->prev].next = entry->next;
+	else
+		wheel->heads[entry->slot] = entry->next;
+	if(entry->next != VT_WHEEL_NONE)
+		wheel->timers[entry->next].prev = entry->prev;
+	if(entry->slot < VT_WHEEL_SLOTS && wheel->heads[entry->slot] == VT_WHEEL_NONE)
+		wheel->pending[entry->slot >> 5] &= ~(1UL << (entry->slot & 31U));
+}
+
+/*!
+ * @brief  This API will find the first occupied slot of the first level from a slot on, up to the end of the turn.
+ * @param [in]   *wheel - pointer to vt_wheel_t structure.
+ * @param [in]   index - is first slot to check.
+ * @return       slot, or VT_WHEEL_SLOTS if none is occupied.
+ */
+static uint32_t _vt_wheel_next_pending(const vt_wheel_t *wheel, uint32_t index)
+{
+	uint32_t word = index >> 5;
+	uint32_t bits = wheel->pending[word] & (0xFFFFFFFFUL << (index & 31U));
+
+	while(bits == 0)
+	{
+		if(++word >= (VT_WHEEL_SLOTS / 32U))
+			return VT_WHEEL_SLOTS;
+		bits = wheel->pending[word];
+	}
+	return (word << 5) + (uint32_t)__builtin_ctz(bits);
+}
+
+/*!
+ * @brief  This API will link a timer into the slot of its deadline, seen from the next tick to expire.
+ * @param [in]   *wheel - pointer to vt_wheel_t structure.
+ * @param [in]   timer - is index of the timer.
+ * @return       none.
+ */
+static void _vt_wheel_place(vt_wheel_t *wheel, uint16_t timer)
+{
+	uint32_t deadline = wheel->timers[timer].deadline;
+	int32_t delta = (int32_t)(deadline - wheel->next_tick);
+	uint32_t level;
+
+	/* Passed, expires with the next tick */
+	if(delta < 0)
+	{
+		_vt_wheel_link(wheel, timer, wheel->next_tick & VT_WHEEL_SLOT_MASK);
+		return;
+	}
+	/* Out of range, waits in the last slot of the top level */
+	if((uint32_t)delta >= VT_WHEEL_RANGE)
+	{
+		deadline = wheel->next_tick + VT_WHEEL_RANGE - 1U;
+		delta = (int32_t)(VT_WHEEL_RANGE - 1U);
+	}
+	for(level = 0; level < (VT_WHEEL_LEVELS - 1U); level++)
+	{
+		if((uint32_t)delta < (1UL << (VT_WHEEL_SLOT_BITS * (level + 1U))))
+			break;
+	}
+	_vt_wheel_link(wheel, timer, level * VT_WHEEL_SLOTS + ((deadline >> (VT_WHEEL_SLOT_BITS * level)) & VT_WHEEL_SLOT_MASK));
+}
+
+/*!
+ * @brief  This API will place the timers of a slot again, one level down or more.
+ * @param [in]   *wheel - pointer to vt_wheel_t structure.
+ * @param [in]   level - is level of the slot.
+ * @param [in]   index - is slot of the level.
+ * @return       index.
+ */
+static uint32_t _vt_wheel_cascade(vt_wheel_t *wheel, uint32_t level, uint32_t index)
+{
+	uint32_t slot = level * VT_WHEEL_SLOTS + index;
+	uint16_t timer;
+
+	while((timer = wheel->heads[slot]) != VT_WHEEL_NONE)
+	{
+		_vt_wheel_unlink(wheel, timer);
+		_vt_wheel_place(wheel, timer);
+		wheel->cascaded++;
+	}
+	return index;
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will create a timer wheel with storage of its timers carved from an arena.
+ * @param [in]   *wheel - pointer to vt_wheel_t structure.
+ * @param [in]   arena - is arena of a subsystem.
+ * @param [in]   count - is number of timers.
+ * @param [in]   now - is current slot tick count.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_INVALID or VT_STATUS_NO_MEM.
+ */
+vt_status_t vt_wheel_create(vt_wheel_t *wheel, vt_arena_id_t arena, uint16_t count, uint32_t now)
+{
+	vt_status_t status;
+	void *ptr;
+	uint32_t i;
+
+	if(wheel == NULL)
+		return VT_STATUS_NULL;
+	if(count == 0 || count == VT_WHEEL_NONE)
+		return VT_STATUS_INVALID;
+
+	status = vt_arena_alloc(arena, count * sizeof(vt_wheel_timer_t), &ptr);
+	if(status != VT_STATUS_SUCCESS)
+		return status;
+
+	wheel->timers = (vt_wheel_timer_t *)ptr;
+	memset(wheel->timers, 0, count * sizeof(vt_wheel_timer_t));
+	wheel->count = count;
+	wheel->next_tick = now + 1U;
+	wheel->armed = 0;
+	wheel->expired = 0;
+	wheel->cascaded = 0;
+	for(i = 0; i <= VT_WHEEL_EXPIRING; i++)
+		wheel->heads[i] = VT_WHEEL_NONE;
+	memset(wheel->pending, 0, sizeof(wheel->pending));
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will arm a timer, or move it if it is armed.
+ * @param [in]   *wheel - pointer to vt_wheel_t structure.
+ * @param [in]   timer - is index of the timer.
+ * @param [in]   deadline - is slot tick count.
+ * @return       none.
+ */
+void vt_wheel_schedule(vt_wheel_t *wheel, uint16_t timer, uint32_t deadline)
+{
+	vt_wheel_timer_t *entry;
+
+	if(timer >= wheel->count)
+		return;
+
+	entry = &wheel->timers[timer];
+	if(entry->armed)
+		_vt_wheel_unlink(wheel, timer);
+	else
+		wheel->armed++;
+	entry->armed = 1;
+	entry->deadline = deadline;
+	_vt_wheel_place(wheel, timer);
+}
+
+/*!
+ * @brief  This API will disarm a timer.
+ * @param [in]   *wheel - pointer to vt_wheel_t structure.
+ * @param [in]   timer - is index of the timer.
+ * @return       none.
+ */
+void vt_wheel_cancel(vt_wheel_t *wheel, uint16_t timer)
+{
+	if(timer >= wheel->count || !wheel->timers[timer].armed)
+		return;
+
+	_vt_wheel_unlink(wheel, timer);
+	wheel->timers[timer].armed = 0;
+	wheel->armed--;
+}
+
+/*!
+ * @brief  This API will expire the timers of every tick up to now.
+ * @param [in]   *wheel - pointer to vt_wheel_t structure.
+ * @param [in]   now - is current slot tick count.
+ * @param [in]   callback - is called for each expired timer.
+ * @return       number of timers expired.
+ */
+uint32_t vt_wheel_advance(vt_wheel_t *wheel, uint32_t now, vt_wheel_callback callback)
+{
+	uint32_t index, level, slot, skip;
+	uint32_t count = 0;
+	uint16_t timer;
+
+	while((int32_t)(now - wheel->next_tick) >= 0)
+	{
+		/* Nothing armed, nothing to walk */
+		if(wheel->armed == 0)
+		{
+			wheel->next_tick = now + 1U;
+			break;
+		}
+
+		/* Empty ticks up to the next occupied slot or the end of the turn of the first level cost one step */
+		index = wheel->next_tick & VT_WHEEL_SLOT_MASK;
+		if(index != 0 && wheel->heads[index] == VT_WHEEL_NONE)
+		{
+			skip = _vt_wheel_next_pending(wheel, index) - index;
+			if(skip > (now - wheel->next_tick))
+				skip = now - wheel->next_tick + 1U;
+			wheel->next_tick += skip;
+			continue;
+		}
+
+		/* A level turns: the next slot of the level above comes down */
+		for(level = 1; index == 0 && level < VT_WHEEL_LEVELS; level++)
+			index = _vt_wheel_cascade(wheel, level, (wheel->next_tick >> (VT_WHEEL_SLOT_BITS * level)) & VT_WHEEL_SLOT_MASK);
+
+		/* Move the slot aside first, the callbacks may arm timers of any slot */
+		slot = wheel->next_tick & VT_WHEEL_SLOT_MASK;
+		while((timer = wheel->heads[slot]) != VT_WHEEL_NONE)
+		{
+			_vt_wheel_unlink(wheel, timer);
+			_vt_wheel_link(wheel, timer, VT_WHEEL_EXPIRING);
+		}
+		wheel->next_tick++;
+
+		while((timer = wheel->heads[VT_WHEEL_EXPIRING]) != VT_WHEEL_NONE)
+		{
+			_vt_wheel_unlink(wheel, timer);
+			wheel->timers[timer].armed = 0;
+			wheel->armed--;
+			wheel->expired++;
+			count++;
+			if(callback != NULL)
+				callback(wheel, timer, now);
+		}
+	}
+
+	return count;
+}
+
+#ifdef __cplusplus
+}
+#endif
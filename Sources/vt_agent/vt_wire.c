@@ -0,0 +1,495 @@
+/*
+ * vt_wire.c
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_wire.h"
+
+/*------------------------------------------------------------------*
+ *                          Define Macro                            *
+ *------------------------------------------------------------------*/
+#define VT_WIRE_CRC_INIT 0xFFFFU
+#define VT_WIRE_CRC_POLY 0x1021U
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief Cursor over a decoded payload.
+ */
+typedef struct _vt_wire_reader_t
+{
+	const uint8_t *buff;
+	uint32_t len;
+	uint32_t pos;
+	uint8_t error;
+}vt_wire_reader_t;
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will calculate CRC-16/CCITT-FALSE of a buffer.
+ * @param [in]   *buff - pointer to data.
+ * @param [in]   len - length of data.
+ * @return       crc.
+ */
+static uint16_t _vt_wire_crc16(const uint8_t *buff, uint32_t len)
+{
+	uint16_t crc = VT_WIRE_CRC_INIT;
+	uint32_t i;
+	uint8_t bit;
+
+	for(i = 0; i < len; i++)
+	{
+		crc ^= (uint16_t)buff[i] << 8;
+		for(bit = 0; bit < 8; bit++)
+		{
+			if(crc & 0x8000U)
+				crc = (uint16_t)((crc << 1) ^ VT_WIRE_CRC_POLY);
+			else
+				crc = (uint16_t)(crc << 1);
+		}
+	}
+	return crc;
+}
+
+/*!
+ * @brief  This API will write a big-endian 16-bit value.
+ * @param [out]  *buff - pointer to payload buffer.
+ * @param [in]   pos - is write position.
+ * @param [in]   value - is value.
+ * @return       next write position.
+ */
+static uint32_t _vt_wire_put_u16(uint8_t *buff, uint32_t pos, uint16_t value)
+{
+	buff[pos++] = (uint8_t)(value >> 8);
+	buff[pos++] = (uint8_t)value;
+	return pos;
+}
+
+/*!
+ * @brief  This API will write an unsigned LEB128 value, 1 to 5 bytes.
+ * @param [out]  *buff - pointer to payload buffer.
+ * @param [in]   pos - is write position.
+ * @param [in]   value - is value.
+ * @return       next write position.
+ */
+static uint32_t _vt_wire_put_varint(uint8_t *buff, uint32_t pos, uint32_t value)
+{
+	while(value >= 0x80U)
+	{
+		buff[pos++] = (uint8_t)(value | 0x80U);
+		value >>= 7;
+	}
+	buff[pos++] = (uint8_t)value;
+	return pos;
+}
+
+/*!
+ * @brief  This API will read a byte, the error flag of the reader is set on overrun.
+ * @param [in]   *reader - pointer to vt_wire_reader_t structure.
+ * @return       value.
+ */
+static uint8_t _vt_wire_get_u8(vt_wire_reader_t *reader)
+{
+	if(reader->pos >= reader->len)
+	{
+		reader->error = 1;
+		return 0;
+	}
+	return reader->buff[reader->pos++];
+}
+
+/*!
+ * @brief  This API will read a big-endian 16-bit value.
+ * @param [in]   *reader - pointer to vt_wire_reader_t structure.
+ * @return       value.
+ */
+static uint16_t _vt_wire_get_u16(vt_wire_reader_t *reader)
+{
+	uint16_t value = (uint16_t)_vt_wire_get_u8(reader) << 8;
+
+	return (uint16_t)(value | _vt_wire_get_u8(reader));
+}
+
+/*!
+ * @brief  This API will read an unsigned LEB128 value.
+ * @param [in]   *reader - pointer to vt_wire_reader_t structure.
+ * @return       value.
+ */
+static uint32_t _vt_wire_get_varint(vt_wire_reader_t *reader)
+{
+	uint32_t value = 0;
+	uint8_t shift = 0;
+	uint8_t byte;
+
+	do
+	{
+		byte = _vt_wire_get_u8(reader);
+		if(shift > 28)
+		{
+			reader->error = 1;
+			return 0;
+		}
+		value |= (uint32_t)(byte & 0x7FU) << shift;
+		shift += 7;
+	} while((byte & 0x80U) && !reader->error);
+
+	return value;
+}
+
+/*!
+ * @brief  This API will encode the payload of an event without framing.
+ * @param [in]   *event - pointer to vt_event_t structure.
+ * @param [in]   tag - is tag byte.
+ * @param [in]   time_stamp - is absolute or delta timestamp.
+ * @param [out]  *buff - pointer to payload buffer of VT_WIRE_MAX_PAYLOAD bytes.
+ * @return       length of payload, 0 if the event type is unknown.
+ */
+static uint32_t _vt_wire_encode_payload(const vt_event_t *event, uint8_t tag, uint32_t time_stamp, uint8_t *buff)
+{
+	uint32_t pos = 0;
+
+	buff[pos++] = tag;
+	pos = _vt_wire_put_varint(buff, pos, time_stamp);
+
+	switch(event->type)
+	{
+	case VT_EVENT_TRAFFIC_STATUS:
+		buff[pos++] = (uint8_t)event->u.traffic.car_status;
+		pos = _vt_wire_put_u16(buff, pos, event->u.traffic.slot_rate);
+		pos = _vt_wire_put_u16(buff, pos, event->u.traffic.pattern_rate);
+		pos = _vt_wire_put_varint(buff, pos, event->u.traffic.count_frames);
+		break;
+	case VT_EVENT_VECTOR:
+		buff[pos++] = event->u.vector.matched_flag;
+		pos = _vt_wire_put_u16(buff, pos, event->u.vector.matched_rate);
+		pos = _vt_wire_put_varint(buff, pos, event->u.vector.count_vector_in_rl);
+		pos = _vt_wire_put_varint(buff, pos, event->u.vector.count_vector_in_rt);
+		pos = _vt_wire_put_varint(buff, pos, event->u.vector.count_all_vector);
+		break;
+	case VT_EVENT_BLACKLIST:
+	case VT_EVENT_MONITOR:
+		buff[pos++] = event->u.result.rule_type;
+		buff[pos++] = event->u.result.matched_bit;
+		pos = _vt_wire_put_varint(buff, pos, event->u.result.rule_id + 1U);
+		pos = _vt_wire_put_varint(buff, pos, event->u.result.can_id + 1U);
+		pos = _vt_wire_put_u16(buff, pos, event->u.result.min_val);
+		pos = _vt_wire_put_u16(buff, pos, event->u.result.max_val);
+		break;
+	case VT_EVENT_DROPPED:
+		pos = _vt_wire_put_varint(buff, pos, event->u.dropped);
+		break;
+	case VT_EVENT_SUMMARY:
+		buff[pos++] = event->u.summary.rule_type;
+		pos = _vt_wire_put_varint(buff, pos, event->u.summary.rule_id + 1U);
+		pos = _vt_wire_put_varint(buff, pos, event->u.summary.can_id + 1U);
+		pos = _vt_wire_put_varint(buff, pos, event->u.summary.count);
+		pos = _vt_wire_put_varint(buff, pos, event->time_stamp - event->u.summary.first_ts);
+		pos = _vt_wire_put_varint(buff, pos, event->u.summary.last_ts - event->u.summary.first_ts);
+		pos = _vt_wire_put_varint(buff, pos, event->u.summary.peak_rate);
+		break;
+	case VT_EVENT_PROBE:
+		buff[pos++] = event->u.probe.probe;
+		pos = _vt_wire_put_varint(buff, pos, event->u.probe.count);
+		pos = _vt_wire_put_varint(buff, pos, event->u.probe.min_ns);
+		pos = _vt_wire_put_varint(buff, pos, event->u.probe.max_ns);
+		pos = _vt_wire_put_varint(buff, pos, event->u.probe.p99_ns);
+		break;
+	case VT_EVENT_MISSING:
+		pos = _vt_wire_put_varint(buff, pos, event->u.missing.can_id);
+		pos = _vt_wire_put_varint(buff, pos, event->time_stamp - event->u.missing.last_ts);
+		pos = _vt_wire_put_varint(buff, pos, event->u.missing.timeout);
+		break;
+	default:
+		return 0;
+	}
+
+	return pos;
+}
+
+/*!
+ * @brief  This API will decode the payload of a frame to an event record.
+ * @param [in]   *dec - pointer to vt_wire_decoder_t structure.
+ * @param [in]   *buff - pointer to payload without CRC.
+ * @param [in]   len - length of payload.
+ * @param [out]  *event - pointer to vt_event_t structure.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_UNREADY if the timestamps are not known, or VT_STATUS_INVALID.
+ */
+static vt_status_t _vt_wire_decode_payload(vt_wire_decoder_t *dec, const uint8_t *buff, uint32_t len, vt_event_t *event)
+{
+	vt_wire_reader_t reader = {buff, len, 0, 0};
+	uint32_t time_stamp, first_ts = 0, last_ts = 0;
+	uint8_t tag;
+
+	memset(event, 0, sizeof(vt_event_t));
+	tag = _vt_wire_get_u8(&reader);
+	time_stamp = _vt_wire_get_varint(&reader);
+	event->type = tag & VT_WIRE_TAG_TYPE_MASK;
+
+	switch(event->type)
+	{
+	case VT_EVENT_TRAFFIC_STATUS:
+		event->u.traffic.car_status = (vt_car_status_t)_vt_wire_get_u8(&reader);
+		event->u.traffic.slot_rate = _vt_wire_get_u16(&reader);
+		event->u.traffic.pattern_rate = _vt_wire_get_u16(&reader);
+		event->u.traffic.count_frames = _vt_wire_get_varint(&reader);
+		break;
+	case VT_EVENT_VECTOR:
+		event->u.vector.matched_flag = _vt_wire_get_u8(&reader);
+		event->u.vector.matched_rate = _vt_wire_get_u16(&reader);
+		event->u.vector.count_vector_in_rl = _vt_wire_get_varint(&reader);
+		event->u.vector.count_vector_in_rt = _vt_wire_get_varint(&reader);
+		event->u.vector.count_all_vector = _vt_wire_get_varint(&reader);
+		break;
+	case VT_EVENT_BLACKLIST:
+	case VT_EVENT_MONITOR:
+		event->u.result.rule_type = _vt_wire_get_u8(&reader);
+		event->u.result.matched_bit = _vt_wire_get_u8(&reader);
+		event->u.result.rule_id = _vt_wire_get_varint(&reader) - 1U;
+		event->u.result.can_id = _vt_wire_get_varint(&reader) - 1U;
+		event->u.result.min_val = _vt_wire_get_u16(&reader);
+		event->u.result.max_val = _vt_wire_get_u16(&reader);
+		break;
+	case VT_EVENT_DROPPED:
+		event->u.dropped = _vt_wire_get_varint(&reader);
+		break;
+	case VT_EVENT_SUMMARY:
+		event->u.summary.rule_type = _vt_wire_get_u8(&reader);
+		event->u.summary.rule_id = _vt_wire_get_varint(&reader) - 1U;
+		event->u.summary.can_id = _vt_wire_get_varint(&reader) - 1U;
+		event->u.summary.count = _vt_wire_get_varint(&reader);
+		first_ts = _vt_wire_get_varint(&reader);
+		last_ts = _vt_wire_get_varint(&reader);
+		event->u.summary.peak_rate = _vt_wire_get_varint(&reader);
+		break;
+	case VT_EVENT_PROBE:
+		event->u.probe.probe = _vt_wire_get_u8(&reader);
+		event->u.probe.count = _vt_wire_get_varint(&reader);
+		event->u.probe.min_ns = _vt_wire_get_varint(&reader);
+		event->u.probe.max_ns = _vt_wire_get_varint(&reader);
+		event->u.probe.p99_ns = _vt_wire_get_varint(&reader);
+		break;
+	case VT_EVENT_MISSING:
+		event->u.missing.can_id = _vt_wire_get_varint(&reader);
+		first_ts = _vt_wire_get_varint(&reader);
+		event->u.missing.timeout = _vt_wire_get_varint(&reader);
+		break;
+	default:
+		return VT_STATUS_INVALID;
+	}
+
+	/* Trailing bytes are reserved for fields appended by later versions */
+	if(reader.error)
+		return VT_STATUS_INVALID;
+
+	if(tag & VT_WIRE_TAG_ABSOLUTE)
+	{
+		dec->time_stamp = time_stamp;
+		dec->synced = 1;
+	}
+	else
+	{
+		dec->time_stamp += time_stamp;
+	}
+	event->time_stamp = dec->time_stamp;
+	if((event->type == VT_EVENT_BLACKLIST) || (event->type == VT_EVENT_MONITOR))
+		event->u.result.time_stamp = dec->time_stamp;
+	if(event->type == VT_EVENT_SUMMARY)
+	{
+		event->u.summary.first_ts = dec->time_stamp - first_ts;
+		event->u.summary.last_ts = event->u.summary.first_ts + last_ts;
+	}
+	if(event->type == VT_EVENT_MISSING)
+		event->u.missing.last_ts = dec->time_stamp - first_ts;
+
+	/* A delta on an unknown time base, the time of a lost frame or before the first absolute one, is flagged */
+	return dec->synced ? VT_STATUS_SUCCESS : VT_STATUS_UNREADY;
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will reset an encoder. The next frame carries an absolute timestamp.
+ * @param [in]   *enc - pointer to vt_wire_encoder_t structure.
+ * @return       none.
+ */
+void vt_wire_encoder_init(vt_wire_encoder_t *enc)
+{
+	enc->time_stamp = 0;
+	enc->count = 0;
+}
+
+/*!
+ * @brief  This API will encode an event record to a frame, delimiter included.
+ * @param [in]   *enc - pointer to vt_wire_encoder_t structure.
+ * @param [in]   *event - pointer to vt_event_t structure.
+ * @param [out]  *out - pointer to output buffer.
+ * @param [in]   len - size of output buffer.
+ * @param [out]  *size - length of the frame.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_INVALID or VT_STATUS_SMALL_BUFF.
+ */
+vt_status_t vt_wire_encode_event(vt_wire_encoder_t *enc, const vt_event_t *event, uint8_t *out, uint32_t len, uint32_t *size)
+{
+	uint8_t payload[VT_WIRE_MAX_PAYLOAD];
+	uint32_t payload_len, code_pos, pos, i;
+	uint16_t crc;
+	uint8_t code, absolute;
+
+	if(enc == NULL || event == NULL || out == NULL || size == NULL)
+		return VT_STATUS_NULL;
+
+	absolute = ((enc->count % VT_WIRE_SYNC_INTERVAL) == 0);
+
+	payload_len = _vt_wire_encode_payload(event, absolute ? (event->type | VT_WIRE_TAG_ABSOLUTE) : event->type,
+	                                      absolute ? event->time_stamp : (event->time_stamp - enc->time_stamp), payload);
+	if(payload_len == 0)
+		return VT_STATUS_INVALID;
+
+	crc = _vt_wire_crc16(payload, payload_len);
+	payload_len = _vt_wire_put_u16(payload, payload_len, crc);
+
+	if(len < (payload_len + (payload_len / 254U) + 3U))
+		return VT_STATUS_SMALL_BUFF;
+
+	/* COBS: every zero is replaced by the distance to the next one, so 0x00 only appears as delimiter */
+	code_pos = 0;
+	pos = 1;
+	code = 1;
+	for(i = 0; i < payload_len; i++)
+	{
+		if(payload[i] == 0)
+		{
+			out[code_pos] = code;
+			code_pos = pos++;
+			code = 1;
+		}
+		else
+		{
+			out[pos++] = payload[i];
+			code++;
+			if(code == 0xFFU)
+			{
+				out[code_pos] = code;
+				code_pos = pos++;
+				code = 1;
+			}
+		}
+	}
+	out[code_pos] = code;
+	out[pos++] = 0x00;
+
+	enc->time_stamp = event->time_stamp;
+	enc->count++;
+	*size = pos;
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will reset a decoder.
+ * @param [in]   *dec - pointer to vt_wire_decoder_t structure.
+ * @return       none.
+ */
+void vt_wire_decoder_init(vt_wire_decoder_t *dec)
+{
+	/* If the stream is joined in the middle of a frame, that partial frame fails the CRC */
+	memset(dec, 0, sizeof(vt_wire_decoder_t));
+}
+
+/*!
+ * @brief  This API will feed one byte of the stream to a decoder.
+ * @param [in]   *dec - pointer to vt_wire_decoder_t structure.
+ * @param [in]   byte - is received byte.
+ * @param [out]  *event - pointer to vt_event_t structure.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_UNREADY, VT_STATUS_EMPTY, VT_STATUS_RCV_ERROR or VT_STATUS_INVALID.
+ */
+vt_status_t vt_wire_decode_byte(vt_wire_decoder_t *dec, uint8_t byte, vt_event_t *event)
+{
+	uint32_t len, rd, wr, i;
+	uint8_t code;
+	vt_status_t status;
+
+	if(byte != 0x00)
+	{
+		if(dec->pos < sizeof(dec->buff))
+			dec->buff[dec->pos++] = byte;
+		else
+			dec->overflow = 1;
+		return VT_STATUS_EMPTY;
+	}
+
+	len = dec->pos;
+	dec->pos = 0;
+	/* The delta of a frame lost leaves the time base unknown until the next absolute timestamp */
+	if(dec->overflow)
+	{
+		dec->overflow = 0;
+		dec->synced = 0;
+		return VT_STATUS_EMPTY;
+	}
+	if(len == 0)
+		return VT_STATUS_EMPTY;
+
+	/* COBS decode in place, the write index never passes the read index */
+	rd = 0;
+	wr = 0;
+	while(rd < len)
+	{
+		code = dec->buff[rd++];
+		for(i = 1; i < code; i++)
+		{
+			if(rd >= len)
+			{
+				dec->format_errors++;
+				dec->synced = 0;
+				return VT_STATUS_INVALID;
+			}
+			dec->buff[wr++] = dec->buff[rd++];
+		}
+		if(code != 0xFFU && rd < len)
+			dec->buff[wr++] = 0x00;
+	}
+
+	if(wr < 4U)
+	{
+		dec->format_errors++;
+		dec->synced = 0;
+		return VT_STATUS_INVALID;
+	}
+	if(_vt_wire_crc16(dec->buff, wr - 2U) != (((uint16_t)dec->buff[wr - 2U] << 8) | dec->buff[wr - 1U]))
+	{
+		dec->crc_errors++;
+		dec->synced = 0;
+		return VT_STATUS_RCV_ERROR;
+	}
+
+	status = _vt_wire_decode_payload(dec, dec->buff, wr - 2U, event);
+	if(status == VT_STATUS_UNREADY)
+	{
+		dec->unsynced++;
+		return status;
+	}
+	if(status != VT_STATUS_SUCCESS)
+	{
+		dec->format_errors++;
+		dec->synced = 0;
+		return status;
+	}
+	dec->frames++;
+
+	return VT_STATUS_SUCCESS;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,613 @@
+/*
+ * vt_bench_attack.c
+ *
+ * Host benchmark: detection latency and cost of the agent per attack class.
+ *
+ *   vt_bench_attack [-w warmup_s] [-a attack_s] [-s seed] [-r scenario=frames_per_s] [-o file] [scenario...]
+ *
+ * A baseline bus is generated from car_vector and car_policy: every Id of the vector with a timing record is sent
+ * at the period of its frames per window, with a small jitter. After the warmup an attack is laid over it for the
+ * attack time. Frames go through the mock FlexCAN to vt_rcv_callback(), vt_fw_process() and
+ * vt_fw_oem_report_process() run after every frame as in the main loop, and the events are decoded back from the
+ * UART, so the whole path of the agent is measured.
+ *
+ * A detection is a blacklist, monitor, summary or missing event, or a traffic status other than normal, idle or unknown.
+ * Detections before the attack are false positives, the baseline scenario has no attack at all.
+ *
+ * Results go to bench_output.txt (-o), one "attack.<scenario>.<key> <value>" per line, in a fixed order. Times are
+ * on the virtual clock of the mock HAL and do not depend on the host; frames_per_s and cpu_ms do.
+ */
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include <time.h>
+#include "vt_hal_mock.h"
+#include "vt_fw_if.h"
+#include "vt_fw_oem.h"
+#include "vt_can.h"
+#include "vt_rtc.h"
+#include "vt_timer.h"
+#include "vt_wire.h"
+
+/*------------------------------------------------------------------*
+ *                          Define Macro                            *
+ *------------------------------------------------------------------*/
+#define VT_BENCH_WARMUP_S        120U
+#define VT_BENCH_ATTACK_S        60U
+#define VT_BENCH_OUTPUT          "bench_output.txt"
+
+/*! Monitoring window of the core, VT_XMINUTE_TIME, the frames per window of car_policy give the periods */
+#define VT_BENCH_WINDOW_US       60000000ULL
+
+/*! Ids of the baseline bus */
+#define VT_BENCH_MAX_IDS         64U
+
+/*! Jitter of the baseline periods, in percent */
+#define VT_BENCH_JITTER_PCT      2U
+
+/*! Baseline recorded before the attack and sent again by the replay attack */
+#define VT_BENCH_REPLAY_US       1000000ULL
+#define VT_BENCH_REPLAY_FRAMES   8192U
+
+/*! Functional request Id of UDS */
+#define VT_BENCH_UDS_ID          0x7DFU
+
+#define VT_BENCH_UART_CHUNK      4096U
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef enum _vt_bench_attack_t
+{
+	VT_BENCH_NONE = 0,
+	VT_BENCH_DOS,                   /*!< flood of the highest priority Id */
+	VT_BENCH_FUZZ,                  /*!< random Ids, lengths and payloads */
+	VT_BENCH_SPOOF,                 /*!< busiest Id sent again between its frames with another payload */
+	VT_BENCH_REPLAY,                /*!< the last second of the baseline sent again in a loop */
+	VT_BENCH_SUSPEND,               /*!< busiest Id stops */
+	VT_BENCH_DIAG                   /*!< UDS session, security access and reset requests */
+}vt_bench_attack_t;
+
+typedef struct _vt_bench_scenario_t
+{
+	const char *name;
+	vt_bench_attack_t attack;
+	uint32_t rate;                  /*!< attack frames per second, 0 when the attack follows the baseline */
+	uint32_t can_id;
+}vt_bench_scenario_t;
+
+typedef struct _vt_bench_source_t
+{
+	vt_can_frame_t frame;
+	uint64_t period_us;
+	uint64_t next_us;
+	uint8_t active;
+}vt_bench_source_t;
+
+typedef struct _vt_bench_replay_t
+{
+	vt_can_frame_t frame;
+	uint64_t time_us;
+}vt_bench_replay_t;
+
+typedef struct _vt_bench_result_t
+{
+	uint64_t frames;
+	uint64_t attack_frames;
+	uint64_t frames_to_detect;
+	uint64_t detect_us;             /*!< virtual clock of the first detection after the attack started */
+	const char *detected_by;
+	uint32_t detections;            /*!< detections after the attack started */
+	uint32_t false_positives;
+	uint32_t events;
+	uint32_t events_dropped;
+	uint32_t rx_overflow;
+	double cpu_ms;
+}vt_bench_result_t;
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+static vt_bench_scenario_t bench_scenarios[] = {
+	{"baseline", VT_BENCH_NONE,    0,    0},
+	{"dos",      VT_BENCH_DOS,     2000, 0x000},
+	{"fuzz",     VT_BENCH_FUZZ,    500,  0},
+	{"spoof",    VT_BENCH_SPOOF,   0,    0},
+	{"replay",   VT_BENCH_REPLAY,  0,    0},
+	{"suspend",  VT_BENCH_SUSPEND, 0,    0},
+	{"diag",     VT_BENCH_DIAG,    20,   VT_BENCH_UDS_ID},
+};
+
+#define VT_BENCH_SCENARIOS       (sizeof(bench_scenarios) / sizeof(bench_scenarios[0]))
+
+static const uint8_t bench_uds[][VT_MAX_DATA_BYTE_LENGTH] = {
+	{0x02, 0x10, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00},       /* extended session */
+	{0x02, 0x27, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00},       /* security access, request seed */
+	{0x02, 0x11, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00},       /* hard reset */
+	{0x03, 0x28, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00},       /* communication control, disable */
+};
+
+static vt_bench_source_t bench_sources[VT_BENCH_MAX_IDS];
+static uint32_t bench_source_count;
+static vt_bench_replay_t bench_replay[VT_BENCH_REPLAY_FRAMES];
+static uint32_t bench_replay_count;
+static uint32_t bench_seed;
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+extern void PIT_Ch0_IRQHandler(void);
+
+static uint32_t _vt_bench_rand(void)
+{
+	bench_seed ^= bench_seed << 13;
+	bench_seed ^= bench_seed >> 17;
+	bench_seed ^= bench_seed << 5;
+	return bench_seed;
+}
+
+static double _vt_bench_now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1000000.0;
+}
+
+static uint32_t _vt_bench_get(const uint8_t *data, uint32_t bytes)
+{
+	uint32_t value = 0;
+
+	while(bytes-- > 0)
+		value = (value << 8) | *data++;
+	return value;
+}
+
+/*!
+ * @brief  This API will build the baseline bus: the Ids of car_vector with a timing record in car_policy, at the
+ *         period of their maximum frames per window.
+ * @param [in]   none.
+ * @return       number of Ids.
+ */
+static uint32_t _vt_bench_make_baseline(void)
+{
+	const uint8_t *record;
+	uint32_t ids = _vt_bench_get(car_vector + 4, 2);
+	uint32_t rules = _vt_bench_get(car_policy + 8, 4);
+	uint32_t i, k, id, frames, b;
+	vt_bench_source_t *source;
+
+	bench_source_count = 0;
+	for(i = 0; i < ids && bench_source_count < VT_BENCH_MAX_IDS; i++)
+	{
+		id = _vt_bench_get(car_vector + 6 + i * 4, 4);
+		for(k = 0; k < rules; k++)
+		{
+			/* Timing record: rule id, Id, 0, u16 min, u32 max, f32, u32, u8 min frames, u32 max frames */
+			record = car_policy + 12 + k * 31;
+			if(_vt_bench_get(record + 4, 4) == id)
+				break;
+		}
+		if(k >= rules)
+			continue;
+		frames = _vt_bench_get(record + 27, 4);
+		if(frames == 0)
+			continue;
+
+		source = &bench_sources[bench_source_count++];
+		memset(source, 0, sizeof(vt_bench_source_t));
+		source->frame.msgId = id;
+		source->frame.dataLen = VT_MAX_DATA_BYTE_LENGTH;
+		for(b = 0; b < VT_MAX_DATA_BYTE_LENGTH; b++)
+			source->frame.data[b] = (uint8_t)((id >> ((b & 3U) * 8U)) ^ (b * 0x11U));
+		source->period_us = VT_BENCH_WINDOW_US / frames;
+	}
+	return bench_source_count;
+}
+
+/*!
+ * @brief  This API will get the baseline Id with the shortest period, target of the spoof and suspend attacks.
+ * @param [in]   none.
+ * @return       index in bench_sources.
+ */
+static uint32_t _vt_bench_busiest(void)
+{
+	uint32_t i, best = 0;
+
+	for(i = 1; i < bench_source_count; i++)
+	{
+		if(bench_sources[i].period_us < bench_sources[best].period_us)
+			best = i;
+	}
+	return best;
+}
+
+static uint64_t _vt_bench_jitter(uint64_t period_us)
+{
+	uint64_t span = (period_us * VT_BENCH_JITTER_PCT) / 100U;
+
+	if(span == 0)
+		return period_us;
+	return period_us - span + (_vt_bench_rand() % (2U * span + 1U));
+}
+
+/*!
+ * @brief  This API will get the next frame of an attack.
+ * @param [in]   *scenario - pointer to vt_bench_scenario_t structure.
+ * @param [in]   start_us - is virtual clock of the start of the attack.
+ * @param [in]   index - is attack frames sent so far.
+ * @param [out]  *frame - pointer to vt_can_frame_t structure.
+ * @param [out]  *time_us - pointer to virtual clock of the frame.
+ * @return       VT_STATUS_SUCCESS, or VT_STATUS_EMPTY when the attack sends nothing.
+ */
+static vt_status_t _vt_bench_attack_frame(const vt_bench_scenario_t *scenario, uint64_t start_us, uint64_t index,
+                                          vt_can_frame_t *frame, uint64_t *time_us)
+{
+	const vt_bench_source_t *target;
+	uint64_t loop;
+	uint32_t b;
+
+	switch(scenario->attack)
+	{
+	case VT_BENCH_DOS:
+		frame->msgId = scenario->can_id;
+		frame->dataLen = VT_MAX_DATA_BYTE_LENGTH;
+		memset(frame->data, 0, VT_MAX_DATA_BYTE_LENGTH);
+		break;
+	case VT_BENCH_FUZZ:
+		frame->msgId = _vt_bench_rand() & 0x7FFU;
+		frame->dataLen = (uint8_t)(_vt_bench_rand() % (VT_MAX_DATA_BYTE_LENGTH + 1U));
+		for(b = 0; b < VT_MAX_DATA_BYTE_LENGTH; b++)
+			frame->data[b] = (uint8_t)_vt_bench_rand();
+		break;
+	case VT_BENCH_DIAG:
+		frame->msgId = scenario->can_id;
+		frame->dataLen = VT_MAX_DATA_BYTE_LENGTH;
+		memcpy(frame->data, bench_uds[index % (sizeof(bench_uds) / sizeof(bench_uds[0]))], VT_MAX_DATA_BYTE_LENGTH);
+		break;
+	case VT_BENCH_SPOOF:
+		/* Half a period after each legitimate frame, the Id is seen at twice its rate */
+		target = &bench_sources[_vt_bench_busiest()];
+		*frame = target->frame;
+		frame->data[0] ^= 0xFFU;
+		*time_us = start_us + target->period_us / 2U + index * target->period_us;
+		return VT_STATUS_SUCCESS;
+	case VT_BENCH_REPLAY:
+		if(bench_replay_count == 0)
+			return VT_STATUS_EMPTY;
+		loop = index / bench_replay_count;
+		*frame = bench_replay[index % bench_replay_count].frame;
+		*time_us = start_us + loop * VT_BENCH_REPLAY_US + bench_replay[index % bench_replay_count].time_us;
+		return VT_STATUS_SUCCESS;
+	default:
+		return VT_STATUS_EMPTY;
+	}
+
+	*time_us = start_us + (index * 1000000ULL) / scenario->rate;
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will get the detection an event stands for.
+ * @param [in]   *event - pointer to vt_event_t structure.
+ * @return       name of the detection, or NULL.
+ */
+static const char *_vt_bench_detection(const vt_event_t *event)
+{
+	switch(event->type)
+	{
+	case VT_EVENT_BLACKLIST:
+		return "blacklist";
+	case VT_EVENT_MONITOR:
+		return "monitor";
+	case VT_EVENT_SUMMARY:
+		return "summary";
+	case VT_EVENT_MISSING:
+		return "missing";
+	case VT_EVENT_TRAFFIC_STATUS:
+		if(event->u.traffic.car_status == VT_CAR_NORMAL_STAT || event->u.traffic.car_status == VT_CAR_IDLE_STAT ||
+		   event->u.traffic.car_status == VT_CAR_UNKOWN_STAT)
+			return NULL;
+		return "traffic_status";
+	default:
+		return NULL;
+	}
+}
+
+/*!
+ * @brief  This API will decode the events sent on the UART since the last call.
+ * @param [in]   *dec - pointer to vt_wire_decoder_t structure.
+ * @param [in]   attack_us - is virtual clock of the start of the attack, UINT64_MAX for none.
+ * @param [in]   attack_frames - is attack frames sent so far.
+ * @param [in]   end_us - is virtual clock of the end of the run, the bus stops there.
+ * @param [out]  *result - pointer to vt_bench_result_t structure.
+ * @return       none.
+ */
+static void _vt_bench_drain(vt_wire_decoder_t *dec, uint64_t attack_us, uint64_t attack_frames, uint64_t end_us,
+                            vt_bench_result_t *result)
+{
+	static uint8_t buff[VT_BENCH_UART_CHUNK];
+	vt_event_t event;
+	const char *detection;
+	uint64_t now = vt_hal_clock_us();
+	uint32_t len, i;
+
+	while((len = vt_hal_uart_read(buff, sizeof(buff))) > 0)
+	{
+		for(i = 0; i < len; i++)
+		{
+			if(vt_wire_decode_byte(dec, buff[i], &event) != VT_STATUS_SUCCESS)
+				continue;
+			result->events++;
+			detection = _vt_bench_detection(&event);
+			if(detection == NULL)
+				continue;
+			/* The whole bus stops at the end of the run, Ids due after it are not missing */
+			if(event.type == VT_EVENT_MISSING &&
+			   (now - (uint64_t)(vt_timer_get_ticks() - event.u.missing.last_ts - event.u.missing.timeout) * VT_PIT_PERIOD) >= end_us)
+				continue;
+			if(now < attack_us)
+			{
+				result->false_positives++;
+				continue;
+			}
+			if(result->detections++ == 0)
+			{
+				result->detect_us = now - attack_us;
+				result->frames_to_detect = attack_frames;
+				result->detected_by = detection;
+			}
+		}
+	}
+}
+
+/*!
+ * @brief  This API will run a scenario on a fresh agent.
+ * @param [in]   *scenario - pointer to vt_bench_scenario_t structure.
+ * @param [in]   warmup_us - is baseline before the attack.
+ * @param [in]   attack_us - is length of the attack.
+ * @param [in]   seed - is seed of the jitter and of the fuzzing.
+ * @param [out]  *result - pointer to vt_bench_result_t structure.
+ * @return       none.
+ */
+static void _vt_bench_run(const vt_bench_scenario_t *scenario, uint64_t warmup_us, uint64_t attack_us, uint32_t seed,
+                          vt_bench_result_t *result)
+{
+	vt_wire_decoder_t dec;
+	vt_fw_stats_t stats;
+	vt_can_frame_t attack_frame, frame;
+	vt_bench_source_t *source;
+	uint64_t end_us = warmup_us + attack_us;
+	uint64_t attack_at = UINT64_MAX, attack_next = UINT64_MAX, next;
+	uint32_t i, pick, busiest;
+	uint8_t attacking = 0;
+	double t0;
+
+	memset(result, 0, sizeof(vt_bench_result_t));
+	result->detected_by = "none";
+	bench_seed = seed;
+	bench_replay_count = 0;
+	busiest = _vt_bench_busiest();
+	for(i = 0; i < bench_source_count; i++)
+	{
+		bench_sources[i].active = 1;
+		bench_sources[i].next_us = _vt_bench_rand() % bench_sources[i].period_us;
+	}
+
+	vt_hal_reset();
+	vt_hal_pit_install_handler(vt_pit_ChnConfig0.hwChannel, PIT_Ch0_IRQHandler);
+	vt_rtc_init(VT_RTC_TIMER, &vt_rtcTimer_StartTime, &vt_rtcTimer_AlarmConfig);
+	vt_timer_init(VT_INST_PIT, &vt_pit_ChnConfig0);
+	vt_fw_oem_init();
+	vt_init_can(VT_INST_CAN0, VT_BITRATE_500, vt_rcv_callback, NULL);
+	vt_start_rcv(VT_INST_CAN0);
+	vt_wire_decoder_init(&dec);
+
+	t0 = _vt_bench_now_ms();
+	while(1)
+	{
+		/* Earliest of the baseline and the attack */
+		pick = bench_source_count;
+		next = UINT64_MAX;
+		for(i = 0; i < bench_source_count; i++)
+		{
+			if(bench_sources[i].active && bench_sources[i].next_us < next)
+			{
+				next = bench_sources[i].next_us;
+				pick = i;
+			}
+		}
+		if(!attacking && next >= warmup_us && scenario->attack != VT_BENCH_NONE)
+		{
+			attacking = 1;
+			attack_at = warmup_us;
+			if(scenario->attack == VT_BENCH_SUSPEND)
+				bench_sources[busiest].active = 0;
+			if(_vt_bench_attack_frame(scenario, attack_at, 0, &attack_frame, &attack_next) != VT_STATUS_SUCCESS)
+				attack_next = UINT64_MAX;
+			continue;
+		}
+		if(attack_next < next)
+		{
+			next = attack_next;
+			pick = bench_source_count;
+		}
+		if(next >= end_us)
+			break;
+
+		if(next > vt_hal_clock_us())
+			vt_hal_clock_advance((uint32_t)(next - vt_hal_clock_us()));
+		if(pick < bench_source_count)
+		{
+			source = &bench_sources[pick];
+			frame = source->frame;
+			source->next_us += _vt_bench_jitter(source->period_us);
+			if(!attacking && next + VT_BENCH_REPLAY_US >= warmup_us && bench_replay_count < VT_BENCH_REPLAY_FRAMES)
+			{
+				bench_replay[bench_replay_count].frame = frame;
+				bench_replay[bench_replay_count].time_us = next + VT_BENCH_REPLAY_US - warmup_us;
+				bench_replay_count++;
+			}
+		}
+		else
+		{
+			frame = attack_frame;
+			result->attack_frames++;
+			if(_vt_bench_attack_frame(scenario, attack_at, result->attack_frames, &attack_frame, &attack_next) != VT_STATUS_SUCCESS)
+				attack_next = UINT64_MAX;
+		}
+
+		vt_hal_can_inject(VT_INST_CAN0, frame.msgId, frame.dataLen, frame.data);
+		result->frames++;
+		vt_fw_process();
+		vt_fw_oem_report_process();
+		_vt_bench_drain(&dec, attack_at, result->attack_frames, end_us, result);
+	}
+	result->cpu_ms = _vt_bench_now_ms() - t0;
+
+	/* Windows still open at the end are reported on the next second */
+	vt_hal_clock_advance((uint32_t)(end_us - vt_hal_clock_us()) + 1000000U);
+	vt_fw_process();
+	vt_fw_oem_report_process();
+	_vt_bench_drain(&dec, attack_at, result->attack_frames, end_us, result);
+
+	vt_fw_get_stats(&stats);
+	result->events_dropped = stats.event.dropped;
+	result->rx_overflow = stats.port[VT_INST_CAN0].can.rx_fifo_overflow;
+	vt_fw_close();
+}
+
+/*!
+ * @brief  This API will write the results of a scenario.
+ * @param [in]   *out - pointer to output file.
+ * @param [in]   *scenario - pointer to vt_bench_scenario_t structure.
+ * @param [in]   *result - pointer to vt_bench_result_t structure.
+ * @return       none.
+ */
+static void _vt_bench_write(FILE *out, const vt_bench_scenario_t *scenario, const vt_bench_result_t *result)
+{
+	const char *name = scenario->name;
+
+	fprintf(out, "attack.%s.frames %llu\n", name, (unsigned long long)result->frames);
+	fprintf(out, "attack.%s.attack_frames %llu\n", name, (unsigned long long)result->attack_frames);
+	fprintf(out, "attack.%s.detected %u\n", name, (result->detections > 0) ? 1U : 0U);
+	fprintf(out, "attack.%s.detected_by %s\n", name, result->detected_by);
+	if(result->detections > 0)
+	{
+		fprintf(out, "attack.%s.time_to_detect_ms %.3f\n", name, (double)result->detect_us / 1000.0);
+		fprintf(out, "attack.%s.frames_to_detect %llu\n", name, (unsigned long long)result->frames_to_detect);
+	}
+	else
+	{
+		fprintf(out, "attack.%s.time_to_detect_ms -1\n", name);
+		fprintf(out, "attack.%s.frames_to_detect -1\n", name);
+	}
+	fprintf(out, "attack.%s.detections %u\n", name, result->detections);
+	fprintf(out, "attack.%s.false_positives %u\n", name, result->false_positives);
+	fprintf(out, "attack.%s.events %u\n", name, result->events);
+	fprintf(out, "attack.%s.events_dropped %u\n", name, result->events_dropped);
+	fprintf(out, "attack.%s.rx_overflow %u\n", name, result->rx_overflow);
+	fprintf(out, "attack.%s.cpu_ms %.3f\n", name, result->cpu_ms);
+	fprintf(out, "attack.%s.frames_per_s %.0f\n", name,
+	        (result->cpu_ms > 0.0) ? ((double)result->frames * 1000.0 / result->cpu_ms) : 0.0);
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+int main(int argc, char *argv[])
+{
+	vt_bench_result_t result;
+	uint8_t selected[VT_BENCH_SCENARIOS];
+	uint32_t warmup_s = VT_BENCH_WARMUP_S;
+	uint32_t attack_s = VT_BENCH_ATTACK_S;
+	uint32_t seed = 0x5EED1234;
+	uint32_t any = 0, i, k;
+	const char *path = VT_BENCH_OUTPUT;
+	char *rate;
+	FILE *out;
+	int bad = 0;
+
+	memset(selected, 0, sizeof(selected));
+	for(i = 1; i < (uint32_t)argc && !bad; i++)
+	{
+		if(strcmp(argv[i], "-w") == 0 && (i + 1U) < (uint32_t)argc)
+			warmup_s = (uint32_t)atoi(argv[++i]);
+		else if(strcmp(argv[i], "-a") == 0 && (i + 1U) < (uint32_t)argc)
+			attack_s = (uint32_t)atoi(argv[++i]);
+		else if(strcmp(argv[i], "-s") == 0 && (i + 1U) < (uint32_t)argc)
+			seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+		else if(strcmp(argv[i], "-o") == 0 && (i + 1U) < (uint32_t)argc)
+			path = argv[++i];
+		else if(strcmp(argv[i], "-r") == 0 && (i + 1U) < (uint32_t)argc)
+		{
+			rate = strchr(argv[++i], '=');
+			bad = 1;
+			for(k = 0; rate != NULL && k < VT_BENCH_SCENARIOS; k++)
+			{
+				if(bench_scenarios[k].rate > 0 && strncmp(argv[i], bench_scenarios[k].name, (size_t)(rate - argv[i])) == 0 &&
+				   bench_scenarios[k].name[rate - argv[i]] == '\0' && atoi(rate + 1) > 0)
+				{
+					bench_scenarios[k].rate = (uint32_t)atoi(rate + 1);
+					bad = 0;
+				}
+			}
+		}
+		else
+		{
+			bad = 1;
+			for(k = 0; k < VT_BENCH_SCENARIOS; k++)
+			{
+				if(strcmp(argv[i], bench_scenarios[k].name) == 0)
+				{
+					selected[k] = 1;
+					any = 1;
+					bad = 0;
+				}
+			}
+		}
+	}
+	if(bad || warmup_s == 0 || attack_s == 0 || seed == 0)
+	{
+		fprintf(stderr, "usage: %s [-w warmup_s] [-a attack_s] [-s seed] [-r scenario=frames_per_s] [-o file] [scenario...]\n"
+		        "scenarios:", argv[0]);
+		for(k = 0; k < VT_BENCH_SCENARIOS; k++)
+			fprintf(stderr, " %s", bench_scenarios[k].name);
+		fprintf(stderr, "\n");
+		return 1;
+	}
+
+	if(_vt_bench_make_baseline() == 0)
+	{
+		fprintf(stderr, "no Id of car_vector has a timing record in car_policy\n");
+		return 1;
+	}
+	out = fopen(path, "w");
+	if(out == NULL)
+	{
+		perror(path);
+		return 1;
+	}
+
+	fprintf(out, "attack.ids %lu\n", (unsigned long)bench_source_count);
+	fprintf(out, "attack.warmup_s %lu\n", (unsigned long)warmup_s);
+	fprintf(out, "attack.attack_s %lu\n", (unsigned long)attack_s);
+	fprintf(out, "attack.seed 0x%08lx\n", (unsigned long)seed);
+	for(k = 0; k < VT_BENCH_SCENARIOS; k++)
+	{
+		if(any && !selected[k])
+			continue;
+		_vt_bench_run(&bench_scenarios[k], (uint64_t)warmup_s * 1000000ULL, (uint64_t)attack_s * 1000000ULL, seed, &result);
+		_vt_bench_write(out, &bench_scenarios[k], &result);
+		_vt_bench_write(stdout, &bench_scenarios[k], &result);
+		fflush(stdout);
+	}
+
+	if(fclose(out) != 0)
+	{
+		perror(path);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,234 @@
+/*
+ * vt_bench_bulk_load.c
+ *
+ * Host benchmark of the agent-side rule staging: N firewall rules loaded one call at a time versus
+ * vt_fw_begin_bulk_load() / vt_fw_bulk_add_*() / vt_fw_commit_bulk_load(). The core has no bulk API, so both paths
+ * end in one core call per rule registered. What the staging changes is measured: the rules it drops as duplicates
+ * before they reach the core, and the time of the staging and of the commit on top of the core calls.
+ *
+ *   vt_bench_bulk_load [rule_count [duplicate_percent]]
+ *
+ * Build with VT_FW_BULK_MAX_RULES and VT_FW_BULK_MAX_FRAMES large enough for N.
+ */
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include <time.h>
+#include "vt_fw_if.h"
+#include "vt_fw_rules.h"
+#include "vt_arena.h"
+
+/*------------------------------------------------------------------*
+ *                          Define Macro                            *
+ *------------------------------------------------------------------*/
+#define VT_BENCH_DEFAULT_RULES   10000
+/* Rules repeated in the set, as in a policy merged from several sources */
+#define VT_BENCH_DEFAULT_DUP_PCT  25
+#define VT_BENCH_PATTERN_FRAMES  3
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef struct _vt_bench_rule_t
+{
+	uint8_t type;
+	uint8_t operator;
+	uint16_t min_val;
+	uint16_t max_val;
+	uint32_t to_id;
+	vt_can_frame_t frames[VT_BENCH_PATTERN_FRAMES];
+}vt_bench_rule_t;
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+static vt_bench_rule_t *bench_rules;
+static uint32_t bench_seed = 0x5EED1234;
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+static uint32_t _vt_bench_rand(void)
+{
+	bench_seed ^= bench_seed << 13;
+	bench_seed ^= bench_seed >> 17;
+	bench_seed ^= bench_seed << 5;
+	return bench_seed;
+}
+
+static double _vt_bench_now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1000000.0;
+}
+
+static void _vt_bench_make_rules(int count, int dup_pct)
+{
+	int i, f;
+	uint32_t pick;
+
+	for(i = 0; i < count; i++)
+	{
+		vt_bench_rule_t *rule = &bench_rules[i];
+
+		if(i > 0 && (int)(_vt_bench_rand() % 100) < dup_pct)
+		{
+			*rule = bench_rules[_vt_bench_rand() % (uint32_t)i];
+			continue;
+		}
+		memset(rule, 0, sizeof(vt_bench_rule_t));
+		pick = _vt_bench_rand() % 10;
+		rule->type = (pick < 4) ? VT_RULE_MALICIOUS_FRAME :
+		             (pick < 7) ? VT_RULE_MONITOR_FRAME :
+		             (pick < 8) ? VT_RULE_MONITOR_PATTERN :
+		             (pick < 9) ? VT_RULE_MONITOR_RANGE : VT_RULE_BLACKLIST_RANGE;
+		rule->operator = _vt_bench_rand() & 0x01;
+		rule->min_val = _vt_bench_rand() % 4;
+		rule->max_val = rule->min_val + 1 + (_vt_bench_rand() % 100);
+		for(f = 0; f < VT_BENCH_PATTERN_FRAMES; f++)
+		{
+			rule->frames[f].msgId = _vt_bench_rand() & 0x7FF;
+			rule->frames[f].dataLen = VT_MAX_DATA_BYTE_LENGTH;
+			memset(rule->frames[f].data, (int)(_vt_bench_rand() & 0xFF), VT_MAX_DATA_BYTE_LENGTH);
+		}
+		rule->to_id = rule->frames[0].msgId + (_vt_bench_rand() & 0x3F);
+	}
+}
+
+static void _vt_bench_load_per_call(int count)
+{
+	int i;
+
+	for(i = 0; i < count; i++)
+	{
+		vt_bench_rule_t *rule = &bench_rules[i];
+		vt_can_frame_t *frame = &rule->frames[0];
+
+		switch(rule->type)
+		{
+		case VT_RULE_MALICIOUS_FRAME:
+			vt_fw_add_malicious_can_frame(frame->msgId, frame->dataLen, frame->data);
+			break;
+		case VT_RULE_BLACKLIST_RANGE:
+			vt_fw_blacklist_add_range_can_id(frame->msgId, rule->to_id, rule->operator);
+			break;
+		case VT_RULE_MONITOR_FRAME:
+			vt_fw_monitor_add_can_frame(frame->msgId, frame->dataLen, frame->data, rule->operator, rule->min_val, rule->max_val);
+			break;
+		case VT_RULE_MONITOR_PATTERN:
+			vt_fw_monitor_add_pattern(rule->frames, VT_BENCH_PATTERN_FRAMES, rule->operator, rule->min_val, rule->max_val);
+			break;
+		default:
+			vt_fw_monitor_add_ids_to_range_list(0, frame->msgId, rule->to_id, rule->operator, rule->min_val, rule->max_val);
+			break;
+		}
+	}
+}
+
+static void _vt_bench_stage_bulk(int count)
+{
+	int i;
+
+	vt_fw_begin_bulk_load();
+	for(i = 0; i < count; i++)
+	{
+		vt_bench_rule_t *rule = &bench_rules[i];
+		vt_can_frame_t *frame = &rule->frames[0];
+
+		switch(rule->type)
+		{
+		case VT_RULE_MALICIOUS_FRAME:
+			vt_fw_bulk_add_malicious_can_frame(frame->msgId, frame->dataLen, frame->data);
+			break;
+		case VT_RULE_BLACKLIST_RANGE:
+			vt_fw_bulk_blacklist_add_range_can_id(frame->msgId, rule->to_id, rule->operator);
+			break;
+		case VT_RULE_MONITOR_FRAME:
+			vt_fw_bulk_monitor_add_can_frame(frame->msgId, frame->dataLen, frame->data, rule->operator, rule->min_val, rule->max_val);
+			break;
+		case VT_RULE_MONITOR_PATTERN:
+			vt_fw_bulk_monitor_add_pattern(rule->frames, VT_BENCH_PATTERN_FRAMES, rule->operator, rule->min_val, rule->max_val);
+			break;
+		default:
+			vt_fw_bulk_monitor_add_ids_to_range_list(0, frame->msgId, rule->to_id, rule->operator, rule->min_val, rule->max_val);
+			break;
+		}
+	}
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+int main(int argc, char *argv[])
+{
+	int count = VT_BENCH_DEFAULT_RULES;
+	int dup_pct = VT_BENCH_DEFAULT_DUP_PCT;
+	double t0, per_call_ms, staging_ms, commit_ms;
+	vt_status_t status;
+	vt_arena_stats_t arena_stats;
+	uint32_t arena_size, index_size;
+	void *arena_buff, *index_buff;
+
+	if(argc > 1)
+		count = atoi(argv[1]);
+	if(argc > 2)
+		dup_pct = atoi(argv[2]);
+	if((count <= 0) || (count > VT_FW_BULK_MAX_RULES) || (count * VT_BENCH_PATTERN_FRAMES > VT_FW_BULK_MAX_FRAMES) ||
+	   (dup_pct < 0) || (dup_pct > 99))
+	{
+		fprintf(stderr, "rule count must be 1..%d for this build, duplicate percent 0..99\n", VT_FW_BULK_MAX_RULES);
+		return 1;
+	}
+
+	bench_rules = (vt_bench_rule_t *)calloc((size_t)count, sizeof(vt_bench_rule_t));
+	if(bench_rules == NULL)
+		return 1;
+	_vt_bench_make_rules(count, dup_pct);
+
+	/* The staging table is carved from the rules arena, size it for the largest build */
+	arena_size = VT_FW_BULK_MAX_RULES * 32U + VT_FW_BULK_MAX_FRAMES * sizeof(vt_can_frame_t) + 64U;
+	arena_buff = malloc(arena_size);
+	/* The lookup index of the committed rules is carved from the state arena */
+	index_size = VT_FW_RULE_INDEX_SIZE * 32U + VT_FW_RULE_KEY_SIZE * 16U + 64U;
+	index_buff = malloc(index_size);
+	if(arena_buff == NULL || index_buff == NULL)
+		return 1;
+	vt_arena_init(VT_ARENA_RULES, arena_buff, arena_size);
+	vt_arena_init(VT_ARENA_STATE, index_buff, index_size);
+
+	vt_fw_init(car_policy, car_vector);
+	t0 = _vt_bench_now_ms();
+	_vt_bench_load_per_call(count);
+	per_call_ms = _vt_bench_now_ms() - t0;
+	vt_fw_close();
+
+	vt_fw_init(car_policy, car_vector);
+	t0 = _vt_bench_now_ms();
+	_vt_bench_stage_bulk(count);
+	staging_ms = _vt_bench_now_ms() - t0;
+	vt_arena_get_stats(VT_ARENA_RULES, &arena_stats);
+	t0 = _vt_bench_now_ms();
+	status = vt_fw_commit_bulk_load();
+	commit_ms = _vt_bench_now_ms() - t0;
+	vt_fw_close();
+
+	printf("bulk_load.rules %d\n", count);
+	printf("bulk_load.duplicate_percent %d\n", dup_pct);
+	/* One core call per rule on the per-call path, per rule left after the duplicates on the bulk path */
+	printf("bulk_load.per_call_core_calls %d\n", count);
+	printf("bulk_load.bulk_rules_registered %u\n", (unsigned)vt_fw_get_rule_count());
+	printf("bulk_load.per_call_ms %.3f\n", per_call_ms);
+	printf("bulk_load.staging_ms %.3f\n", staging_ms);
+	printf("bulk_load.commit_ms %.3f\n", commit_ms);
+	printf("bulk_load.bulk_ms %.3f\n", staging_ms + commit_ms);
+	printf("bulk_load.commit_status %d\n", (int)status);
+	printf("bulk_load.staging_high_water_bytes %u\n", (unsigned)arena_stats.high_water);
+
+	free(index_buff);
+	free(arena_buff);
+	free(bench_rules);
+	return 0;
+}
@@ -0,0 +1,501 @@
+/*
+ * vt_bench_dualcore.c
+ *
+ * Host benchmark: the agent with the firewall on a second core (VT_FW_DUAL_CORE, see vt_fw_dual.h), against both
+ * roles on one core.
+ *
+ *   vt_bench_dualcore [-n frames] [-b batch] [-p step_us] [-m malicious_every] [-c can_cpu] [-f fw_cpu] [-s seed]
+ *                     [-o file]
+ *
+ * The CAN core is a thread owning the mock HAL: it injects frames on CAN0 with the Ids of car_vector and random
+ * payloads, batch frames per step_us of virtual time, takes the verdicts and completes the forwarding mailboxes of
+ * CAN1 at once. Every malicious_every-th frame is the malicious frame of vt_fw_oem.c. The firewall core is a second
+ * thread running vt_fw_dual_fw_process() and vt_fw_process(), and taking the PIT and RTC interrupts on the virtual
+ * clock of the CAN core. The threads are pinned to can_cpu and fw_cpu. The CAN core holds back while batch more frames would not fit
+ * in the channel, so no frame is dropped and the run measures the sustained rate.
+ * The single core run does the same steps in one thread: inject, check, vt_fw_process(), verdicts.
+ * Events are not reported, the UART of the mock HAL belongs to the CAN core.
+ *
+ * Results go to bench_output.txt (-o), one "dualcore.<run>.<key> <value>" per line, then the speedup. Rates and
+ * latencies are wall clock.
+ */
+
+#define _GNU_SOURCE
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include "vt_hal_mock.h"
+#include "vt_fw_if.h"
+#include "vt_fw_oem.h"
+#include "vt_fw_dual.h"
+#include "vt_atomic.h"
+#include "vt_can.h"
+#include "vt_rtc.h"
+#include "vt_timer.h"
+
+/*------------------------------------------------------------------*
+ *                          Define Macro                            *
+ *------------------------------------------------------------------*/
+#define VT_BENCH_FRAMES          1000000U
+#define VT_BENCH_BATCH           8U
+#define VT_BENCH_STEP_US         1000U
+#define VT_BENCH_MALICIOUS       100U
+#define VT_BENCH_OUTPUT          "bench_output.txt"
+
+#define VT_BENCH_MALICIOUS_ID    0xCDU
+#define VT_BENCH_MAX_IDS         64U
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef struct _vt_bench_config_t
+{
+	uint32_t frames;
+	uint32_t batch;
+	uint32_t step_us;
+	uint32_t malicious_every;
+	int can_cpu;
+	int fw_cpu;
+	uint32_t seed;
+}vt_bench_config_t;
+
+typedef struct _vt_bench_result_t
+{
+	uint8_t pinned;
+	uint32_t sent;
+	uint32_t expected_malicious;
+	uint32_t forwarded;
+	vt_fw_dual_stats_t dual;
+	vt_fw_stats_t agent;
+	double wall_ms;
+}vt_bench_result_t;
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+static const uint8_t bench_malicious_data[VT_MAX_DATA_BYTE_LENGTH] = {0xCD,0xA0,0xFF,0xFA,0x04,0x26,0x19,0x79};
+
+static uint32_t bench_ids[VT_BENCH_MAX_IDS];
+static uint32_t bench_id_count;
+static uint32_t bench_seed;
+
+/* Virtual clock of the CAN core, read by the firewall core */
+static uint64_t bench_clock_us;
+/* PIT and RTC interrupts taken by the firewall core */
+static uint64_t bench_pit_us;
+static uint64_t bench_rtc_us;
+static volatile uint8_t bench_stop;
+static uint8_t bench_fw_pinned;
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+extern void PIT_Ch0_IRQHandler(void);
+
+static uint32_t _vt_bench_rand(void)
+{
+	bench_seed ^= bench_seed << 13;
+	bench_seed ^= bench_seed >> 17;
+	bench_seed ^= bench_seed << 5;
+	return bench_seed;
+}
+
+static double _vt_bench_now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1000000.0;
+}
+
+static uint32_t _vt_bench_get(const uint8_t *data, uint32_t bytes)
+{
+	uint32_t value = 0;
+
+	while(bytes-- > 0)
+		value = (value << 8) | *data++;
+	return value;
+}
+
+/*!
+ * @brief  This API will collect the standard Ids of car_vector, the Ids of the clean traffic.
+ * @param [in]   none.
+ * @return       number of Ids.
+ */
+static uint32_t _vt_bench_make_ids(void)
+{
+	uint32_t ids = _vt_bench_get(car_vector + 4, 2);
+	uint32_t i, id;
+
+	bench_id_count = 0;
+	for(i = 0; i < ids && bench_id_count < VT_BENCH_MAX_IDS; i++)
+	{
+		id = _vt_bench_get(car_vector + 6 + i * 4, 4);
+		if(id <= 0x7FFU && id != VT_BENCH_MALICIOUS_ID)
+			bench_ids[bench_id_count++] = id;
+	}
+	return bench_id_count;
+}
+
+/*!
+ * @brief  This API will pin the calling thread to a CPU.
+ * @param [in]   cpu - is CPU number, negative leaves the thread unpinned.
+ * @return       1 if pinned, 0 otherwise.
+ */
+static uint8_t _vt_bench_pin(int cpu)
+{
+	cpu_set_t set;
+
+	if(cpu < 0)
+		return 0;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0) ? 1 : 0;
+}
+
+/*!
+ * @brief  This API will start the agent on the mock HAL, without PIT and RTC: the firewall core takes them.
+ * @param [in]   none.
+ * @return       none.
+ */
+static void _vt_bench_start(void)
+{
+	vt_hal_reset();
+	vt_timer_init(VT_INST_PIT, &vt_pit_ChnConfig0);
+	vt_fw_oem_init();
+	/* Every Id runs far above its policy rate, the run measures the forwarding path */
+	vt_ratelimit_set_mode(VT_RATELIMIT_MONITOR);
+	vt_init_can(VT_INST_CAN0, VT_BITRATE_500, vt_rcv_callback, NULL);
+	vt_init_can(VT_INST_CAN1, VT_BITRATE_500, vt_rcv_callback, NULL);
+	vt_start_rcv(VT_INST_CAN0);
+	vt_start_rcv(VT_INST_CAN1);
+	VT_ATOMIC_STORE(&bench_clock_us, 0ULL);
+	bench_pit_us = 0;
+	bench_rtc_us = 0;
+	bench_stop = 0;
+	bench_fw_pinned = 0;
+}
+
+/*!
+ * @brief  This API will run one step of the CAN core: inject frames, take the verdicts, complete the forwarding and
+ *         move the virtual clock.
+ * @param [in]   *config - pointer to vt_bench_config_t structure.
+ * @param [in]   frames - is number of frames to inject.
+ * @param [in,out] *result - pointer to vt_bench_result_t structure.
+ * @return       none.
+ */
+static void _vt_bench_can_step(const vt_bench_config_t *config, uint32_t frames, vt_bench_result_t *result)
+{
+	flexcan_msgbuff_t msg;
+	uint8_t data[VT_MAX_DATA_BYTE_LENGTH];
+	uint32_t i, b;
+
+	for(i = 0; i < frames; i++)
+	{
+		result->sent++;
+		if(config->malicious_every > 0 && (result->sent % config->malicious_every) == 0)
+		{
+			result->expected_malicious++;
+			vt_hal_can_inject(VT_INST_CAN0, VT_BENCH_MALICIOUS_ID, VT_MAX_DATA_BYTE_LENGTH, bench_malicious_data);
+			continue;
+		}
+		for(b = 0; b < VT_MAX_DATA_BYTE_LENGTH; b++)
+			data[b] = (uint8_t)_vt_bench_rand();
+		vt_hal_can_inject(VT_INST_CAN0, bench_ids[_vt_bench_rand() % bench_id_count], VT_MAX_DATA_BYTE_LENGTH, data);
+	}
+
+	vt_fw_dual_verdict_process();
+	/* The egress bus takes every frame at once, a refilled mailbox completes on the next call */
+	while(vt_hal_can_complete_tx(VT_INST_CAN1) > 0)
+		;
+	while(vt_hal_can_pop_tx(VT_INST_CAN1, &msg) == STATUS_SUCCESS)
+		result->forwarded++;
+
+	if(frames > 0)
+	{
+		vt_hal_clock_advance(config->step_us);
+		VT_ATOMIC_STORE(&bench_clock_us, vt_hal_clock_us());
+	}
+}
+
+/*!
+ * @brief  This API will run the PIT and RTC interrupts due on the virtual clock of the CAN core, on the firewall core.
+ * @param [in]   none.
+ * @return       none.
+ */
+static void _vt_bench_timers(void)
+{
+	uint64_t now_us = VT_ATOMIC_LOAD(&bench_clock_us);
+
+	while((bench_pit_us + VT_PIT_PERIOD) <= now_us)
+	{
+		bench_pit_us += VT_PIT_PERIOD;
+		PIT_Ch0_IRQHandler();
+	}
+	while((bench_rtc_us + 1000000ULL) <= now_us)
+	{
+		bench_rtc_us += 1000000ULL;
+		vt_rtc_timer_callback(NULL);
+	}
+}
+
+/*!
+ * @brief  This API will run the firewall core until the CAN core is done.
+ * @param [in]   *arg - pointer to vt_bench_config_t structure.
+ * @return       NULL.
+ */
+static void *_vt_bench_fw_thread(void *arg)
+{
+	const vt_bench_config_t *config = (const vt_bench_config_t *)arg;
+
+	bench_fw_pinned = _vt_bench_pin(config->fw_cpu);
+	while(!VT_ATOMIC_LOAD(&bench_stop))
+	{
+		_vt_bench_timers();
+		if(vt_fw_dual_fw_process(VT_FW_DUAL_CHANNEL_SIZE) == 0)
+			sched_yield();
+		vt_fw_process();
+	}
+	return NULL;
+}
+
+/*!
+ * @brief  This API will collect the counters of a run and stop the agent.
+ * @param [out]  *result - pointer to vt_bench_result_t structure.
+ * @return       none.
+ */
+static void _vt_bench_finish(vt_bench_result_t *result)
+{
+	vt_fw_dual_get_stats(&result->dual);
+	vt_fw_get_stats(&result->agent);
+	vt_fw_close();
+}
+
+/*!
+ * @brief  This API will run both cores in one thread.
+ * @param [in]   *config - pointer to vt_bench_config_t structure.
+ * @param [out]  *result - pointer to vt_bench_result_t structure.
+ * @return       none.
+ */
+static void _vt_bench_run_single(const vt_bench_config_t *config, vt_bench_result_t *result)
+{
+	uint32_t frames;
+	double t0;
+
+	memset(result, 0, sizeof(vt_bench_result_t));
+	bench_seed = config->seed;
+	_vt_bench_start();
+	result->pinned = _vt_bench_pin(config->can_cpu);
+
+	t0 = _vt_bench_now_ms();
+	while(result->sent < config->frames)
+	{
+		frames = config->frames - result->sent;
+		if(frames > config->batch)
+			frames = config->batch;
+		_vt_bench_can_step(config, frames, result);
+		_vt_bench_timers();
+		vt_fw_dual_fw_process(VT_FW_DUAL_CHANNEL_SIZE);
+		vt_fw_process();
+	}
+	_vt_bench_can_step(config, 0, result);
+	result->wall_ms = _vt_bench_now_ms() - t0;
+
+	_vt_bench_finish(result);
+}
+
+/*!
+ * @brief  This API will run the CAN core in the calling thread and the firewall core in a second thread.
+ * @param [in]   *config - pointer to vt_bench_config_t structure.
+ * @param [out]  *result - pointer to vt_bench_result_t structure.
+ * @return       0, or -1 if the thread cannot start.
+ */
+static int _vt_bench_run_dual(const vt_bench_config_t *config, vt_bench_result_t *result)
+{
+	pthread_t thread;
+	uint32_t frames;
+	double t0;
+
+	memset(result, 0, sizeof(vt_bench_result_t));
+	bench_seed = config->seed;
+	_vt_bench_start();
+	result->pinned = _vt_bench_pin(config->can_cpu);
+
+	t0 = _vt_bench_now_ms();
+	if(pthread_create(&thread, NULL, _vt_bench_fw_thread, (void *)config) != 0)
+		return -1;
+	while(result->sent < config->frames)
+	{
+		/* Hold back until the batch fits in the channel */
+		if((vt_fw_dual_pending() + config->batch) > VT_FW_DUAL_CHANNEL_SIZE)
+		{
+			_vt_bench_can_step(config, 0, result);
+			sched_yield();
+			continue;
+		}
+		frames = config->frames - result->sent;
+		if(frames > config->batch)
+			frames = config->batch;
+		_vt_bench_can_step(config, frames, result);
+	}
+	while(vt_fw_dual_pending() > 0)
+	{
+		_vt_bench_can_step(config, 0, result);
+		sched_yield();
+	}
+	_vt_bench_can_step(config, 0, result);
+	result->wall_ms = _vt_bench_now_ms() - t0;
+	VT_ATOMIC_STORE(&bench_stop, 1);
+	pthread_join(thread, NULL);
+	/* Pinning fails for a CPU the host does not have */
+	result->pinned = (uint8_t)(result->pinned && bench_fw_pinned);
+
+	_vt_bench_finish(result);
+	return 0;
+}
+
+static double _vt_bench_rate(uint32_t frames, double ms)
+{
+	return (ms > 0.0) ? ((double)frames * 1000.0 / ms) : 0.0;
+}
+
+/*!
+ * @brief  This API will write the results of a run.
+ * @param [in]   *out - pointer to output file.
+ * @param [in]   *run - is name of the run.
+ * @param [in]   *result - pointer to vt_bench_result_t structure.
+ * @return       none.
+ */
+static void _vt_bench_write_run(FILE *out, const char *run, const vt_bench_result_t *result)
+{
+	const vt_fw_dual_stats_t *dual = &result->dual;
+
+	fprintf(out, "dualcore.%s.pinned %u\n", run, (unsigned)result->pinned);
+	fprintf(out, "dualcore.%s.frames %lu\n", run, (unsigned long)result->sent);
+	fprintf(out, "dualcore.%s.checked %lu\n", run, (unsigned long)dual->checked);
+	fprintf(out, "dualcore.%s.channel_dropped %lu\n", run, (unsigned long)dual->dropped);
+	fprintf(out, "dualcore.%s.malicious %lu\n", run, (unsigned long)dual->malicious);
+	fprintf(out, "dualcore.%s.expected_malicious %lu\n", run, (unsigned long)result->expected_malicious);
+	fprintf(out, "dualcore.%s.forwarded %lu\n", run, (unsigned long)result->forwarded);
+	fprintf(out, "dualcore.%s.queue_dropped %lu\n", run, (unsigned long)result->agent.port[VT_INST_CAN1].queue_dropped);
+	fprintf(out, "dualcore.%s.frame_high_water %lu\n", run, (unsigned long)dual->frame_high_water);
+	fprintf(out, "dualcore.%s.verdict_high_water %lu\n", run, (unsigned long)dual->verdict_high_water);
+	fprintf(out, "dualcore.%s.wall_ms %.3f\n", run, result->wall_ms);
+	fprintf(out, "dualcore.%s.frames_per_s %.0f\n", run, _vt_bench_rate(dual->checked, result->wall_ms));
+	fprintf(out, "dualcore.%s.round_trip_p50_ns %lu\n", run, (unsigned long)dual->round_trip.p50_ns);
+	fprintf(out, "dualcore.%s.round_trip_p99_ns %lu\n", run, (unsigned long)dual->round_trip.p99_ns);
+	fprintf(out, "dualcore.%s.round_trip_max_ns %lu\n", run, (unsigned long)dual->round_trip.max_ns);
+}
+
+/*!
+ * @brief  This API will write the results.
+ * @param [in]   *out - pointer to output file.
+ * @param [in]   *config - pointer to vt_bench_config_t structure.
+ * @param [in]   *single - pointer to vt_bench_result_t structure of the single core run.
+ * @param [in]   *dual - pointer to vt_bench_result_t structure of the dual core run.
+ * @return       none.
+ */
+static void _vt_bench_write(FILE *out, const vt_bench_config_t *config, const vt_bench_result_t *single,
+                            const vt_bench_result_t *dual)
+{
+	double single_rate = _vt_bench_rate(single->dual.checked, single->wall_ms);
+	double dual_rate = _vt_bench_rate(dual->dual.checked, dual->wall_ms);
+
+	fprintf(out, "dualcore.frames %lu\n", (unsigned long)config->frames);
+	fprintf(out, "dualcore.batch %lu\n", (unsigned long)config->batch);
+	fprintf(out, "dualcore.step_us %lu\n", (unsigned long)config->step_us);
+	fprintf(out, "dualcore.malicious_every %lu\n", (unsigned long)config->malicious_every);
+	fprintf(out, "dualcore.channel_size %lu\n", (unsigned long)VT_FW_DUAL_CHANNEL_SIZE);
+	fprintf(out, "dualcore.seed 0x%08lx\n", (unsigned long)config->seed);
+	_vt_bench_write_run(out, "single", single);
+	_vt_bench_write_run(out, "dual", dual);
+	fprintf(out, "dualcore.speedup %.2f\n", (single_rate > 0.0) ? (dual_rate / single_rate) : 0.0);
+	fprintf(out, "dualcore.added_p50_ns %ld\n", (long)dual->dual.round_trip.p50_ns - (long)single->dual.round_trip.p50_ns);
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+int main(int argc, char *argv[])
+{
+	vt_bench_config_t config;
+	vt_bench_result_t single, dual;
+	const char *path = VT_BENCH_OUTPUT;
+	FILE *out;
+	uint32_t i;
+	int bad = 0;
+
+	config.frames = VT_BENCH_FRAMES;
+	config.batch = VT_BENCH_BATCH;
+	config.step_us = VT_BENCH_STEP_US;
+	config.malicious_every = VT_BENCH_MALICIOUS;
+	config.can_cpu = 0;
+	config.fw_cpu = 1;
+	config.seed = 0x5EED1234;
+	for(i = 1; i < (uint32_t)argc && !bad; i++)
+	{
+		if((i + 1U) >= (uint32_t)argc)
+			bad = 1;
+		else if(strcmp(argv[i], "-n") == 0)
+			config.frames = (uint32_t)atoi(argv[++i]);
+		else if(strcmp(argv[i], "-b") == 0)
+			config.batch = (uint32_t)atoi(argv[++i]);
+		else if(strcmp(argv[i], "-p") == 0)
+			config.step_us = (uint32_t)atoi(argv[++i]);
+		else if(strcmp(argv[i], "-m") == 0)
+			config.malicious_every = (uint32_t)atoi(argv[++i]);
+		else if(strcmp(argv[i], "-c") == 0)
+			config.can_cpu = atoi(argv[++i]);
+		else if(strcmp(argv[i], "-f") == 0)
+			config.fw_cpu = atoi(argv[++i]);
+		else if(strcmp(argv[i], "-s") == 0)
+			config.seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+		else if(strcmp(argv[i], "-o") == 0)
+			path = argv[++i];
+		else
+			bad = 1;
+	}
+	if(bad || config.frames == 0 || config.batch == 0 || config.batch > VT_FW_DUAL_CHANNEL_SIZE || config.step_us == 0 ||
+	   config.seed == 0)
+	{
+		fprintf(stderr, "usage: %s [-n frames] [-b batch] [-p step_us] [-m malicious_every] [-c can_cpu] [-f fw_cpu]\n"
+		        "       [-s seed] [-o file]\n", argv[0]);
+		return 1;
+	}
+
+	if(_vt_bench_make_ids() == 0)
+	{
+		fprintf(stderr, "car_vector has no standard Id\n");
+		return 1;
+	}
+	out = fopen(path, "w");
+	if(out == NULL)
+	{
+		perror(path);
+		return 1;
+	}
+
+	_vt_bench_run_single(&config, &single);
+	if(_vt_bench_run_dual(&config, &dual) != 0)
+	{
+		fprintf(stderr, "cannot start the firewall core thread\n");
+		fclose(out);
+		return 1;
+	}
+	if(!dual.pinned)
+		fprintf(stderr, "threads are not pinned to CPU %d and %d, the dual core run shares CPUs\n", config.can_cpu, config.fw_cpu);
+
+	_vt_bench_write(out, &config, &single, &dual);
+	_vt_bench_write(stdout, &config, &single, &dual);
+
+	if(fclose(out) != 0)
+	{
+		perror(path);
+		return 1;
+	}
+	return 0;
+}
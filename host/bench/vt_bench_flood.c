@@ -0,0 +1,487 @@
+/*
+ * vt_bench_flood.c
+ *
+ * Host benchmark: the egress bus of the gateway under a flood of the ingress bus, with the rate enforcement of
+ * vt_ratelimit.h in monitor mode (frames over the rate forwarded, as before it) and in enforce mode.
+ *
+ *   vt_bench_flood [-d seconds] [-b kbps] [-i flood_id] [-p loop_us] [-s seed] [-o file]
+ *
+ * CAN0 and CAN1 of the agent sit on two buses of the mock HAL with bus timing (see vt_hal_mock.h). On the ingress
+ * bus a node sends the Ids of car_vector with a timing record in car_policy at the period of their maximum frames
+ * per window, with a small jitter and a sequence number in the payload. The ECU of the flood Id (by default the
+ * lowest priority of them) is compromised: it stops its periodic frames and keeps its own Id pending at all times,
+ * taking every bit the other Ids leave. The agent forwards to the egress bus, where a node acknowledges. The main
+ * loop runs vt_fw_process() and vt_fw_oem_report_process() every loop_us, and the frames on the egress bus are
+ * taken at the same pace: the latency of a legitimate frame is from its queueing on the ingress node to the end of
+ * the loop step it left the egress bus in.
+ *
+ * Results go to bench_output.txt (-o), one "flood.<mode>.<key> <value>" per line. Everything is on the virtual
+ * clock and reproducible for a seed, except cpu_ms.
+ */
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include <time.h>
+#include "vt_hal_mock.h"
+#include "vt_fw_if.h"
+#include "vt_fw_oem.h"
+#include "vt_can.h"
+#include "vt_rtc.h"
+#include "vt_timer.h"
+
+/*------------------------------------------------------------------*
+ *                          Define Macro                            *
+ *------------------------------------------------------------------*/
+#define VT_BENCH_DURATION_S      10U
+#define VT_BENCH_LOOP_US         100U
+#define VT_BENCH_OUTPUT          "bench_output.txt"
+
+#define VT_BENCH_BUS_IN          0U
+#define VT_BENCH_BUS_OUT         1U
+
+/*! Monitoring window of the core, the frames per window of car_policy give the periods */
+#define VT_BENCH_WINDOW_US       60000000ULL
+
+#define VT_BENCH_MAX_IDS         64U
+
+/*! Jitter of the periods, in percent */
+#define VT_BENCH_JITTER_PCT      2U
+
+#define VT_BENCH_UART_CHUNK      4096U
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef struct _vt_bench_config_t
+{
+	uint32_t duration_s;
+	uint32_t kbps;
+	uint32_t flood_id;
+	uint32_t loop_us;
+	uint32_t seed;
+}vt_bench_config_t;
+
+typedef struct _vt_bench_source_t
+{
+	uint32_t can_id;
+	uint64_t period_us;
+	uint64_t next_us;
+}vt_bench_source_t;
+
+typedef struct _vt_bench_result_t
+{
+	vt_hal_bus_stats_t in;
+	vt_hal_bus_stats_t out;
+	vt_hal_bus_node_stats_t flood;
+	vt_hal_can_stats_t can_in;
+	vt_fw_stats_t agent;
+	uint32_t legit_sent;
+	uint32_t legit_delivered;
+	uint32_t flood_forwarded;
+	uint32_t flood_dropped;         /*!< frames of the flood Id over the rate, forwarded anyway in monitor mode */
+	uint64_t latency_sum_us;
+	uint32_t latency_p99_us;
+	uint32_t latency_max_us;
+	double cpu_ms;
+}vt_bench_result_t;
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+static const struct
+{
+	uint32_t kbps;
+	vt_can_bitrate_type_t bitrate;
+}bench_bitrates[] = {
+	{125,  VT_BITRATE_125},
+	{250,  VT_BITRATE_250},
+	{500,  VT_BITRATE_500},
+	{800,  VT_BITRATE_800},
+	{1000, VT_BITRATE_1M},
+};
+
+#define VT_BENCH_BITRATES        (sizeof(bench_bitrates) / sizeof(bench_bitrates[0]))
+
+static vt_bench_source_t bench_sources[VT_BENCH_MAX_IDS];
+static uint32_t bench_source_count;
+static uint32_t bench_seed;
+/* Ingress time and latency of each legitimate frame, by sequence number */
+static uint64_t *bench_sent_us;
+static uint32_t *bench_latency_us;
+static uint32_t bench_capacity;
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+extern void PIT_Ch0_IRQHandler(void);
+
+static uint32_t _vt_bench_rand(void)
+{
+	bench_seed ^= bench_seed << 13;
+	bench_seed ^= bench_seed >> 17;
+	bench_seed ^= bench_seed << 5;
+	return bench_seed;
+}
+
+static double _vt_bench_now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1000000.0;
+}
+
+static uint32_t _vt_bench_get(const uint8_t *data, uint32_t bytes)
+{
+	uint32_t value = 0;
+
+	while(bytes-- > 0)
+		value = (value << 8) | *data++;
+	return value;
+}
+
+/*!
+ * @brief  This API will get the bitrate of the agent for a bitrate in kbit/s.
+ * @param [in]   kbps - is bitrate in kbit/s.
+ * @return       vt_can_bitrate_type_t, or VT_BITRATE_UNKNOWN if the agent has no such bitrate.
+ */
+static vt_can_bitrate_type_t _vt_bench_bitrate(uint32_t kbps)
+{
+	uint32_t i;
+
+	for(i = 0; i < VT_BENCH_BITRATES; i++)
+	{
+		if(bench_bitrates[i].kbps == kbps)
+			return bench_bitrates[i].bitrate;
+	}
+	return VT_BITRATE_UNKNOWN;
+}
+
+static uint64_t _vt_bench_jitter(uint64_t period_us)
+{
+	uint64_t span = (period_us * VT_BENCH_JITTER_PCT) / 100U;
+
+	if(span == 0)
+		return period_us;
+	return period_us - span + (_vt_bench_rand() % (2U * span + 1U));
+}
+
+static int _vt_bench_cmp_u32(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a;
+	uint32_t y = *(const uint32_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+/*!
+ * @brief  This API will collect the standard Ids of car_vector with a timing record in car_policy, at the period of
+ *         their maximum frames per window.
+ * @param [in]   none.
+ * @return       number of Ids.
+ */
+static uint32_t _vt_bench_make_sources(void)
+{
+	const uint8_t *record;
+	uint32_t ids = _vt_bench_get(car_vector + 4, 2);
+	uint32_t rules = _vt_bench_get(car_policy + 8, 4);
+	uint32_t i, k, id, frames;
+
+	bench_source_count = 0;
+	for(i = 0; i < ids && bench_source_count < VT_BENCH_MAX_IDS; i++)
+	{
+		id = _vt_bench_get(car_vector + 6 + i * 4, 4);
+		if(id > 0x7FFU)
+			continue;
+		for(k = 0; k < rules; k++)
+		{
+			/* Timing record: rule id, Id, 0, u16 min, u32 max, f32, u32, u8 min frames, u32 max frames */
+			record = car_policy + 12 + k * 31;
+			if(_vt_bench_get(record + 4, 4) == id)
+				break;
+		}
+		if(k >= rules)
+			continue;
+		frames = _vt_bench_get(record + 27, 4);
+		if(frames == 0)
+			continue;
+
+		bench_sources[bench_source_count].can_id = id;
+		bench_sources[bench_source_count].period_us = VT_BENCH_WINDOW_US / frames;
+		bench_source_count++;
+	}
+	return bench_source_count;
+}
+
+/*!
+ * @brief  This API will take the frames that left the egress bus.
+ * @param [in]   *config - pointer to vt_bench_config_t structure.
+ * @param [out]  *result - pointer to vt_bench_result_t structure.
+ * @return       none.
+ */
+static void _vt_bench_take_egress(const vt_bench_config_t *config, vt_bench_result_t *result)
+{
+	flexcan_msgbuff_t msg;
+	uint32_t seq;
+
+	while(vt_hal_can_pop_tx(VT_INST_CAN1, &msg) == STATUS_SUCCESS)
+	{
+		if(msg.msgId == config->flood_id)
+		{
+			result->flood_forwarded++;
+			continue;
+		}
+		seq = _vt_bench_get(msg.data, 4);
+		if(seq >= result->legit_sent || bench_latency_us[seq] != UINT32_MAX)
+			continue;
+		bench_latency_us[seq] = (uint32_t)(vt_hal_clock_us() - bench_sent_us[seq]);
+		result->latency_sum_us += bench_latency_us[seq];
+		if(bench_latency_us[seq] > result->latency_max_us)
+			result->latency_max_us = bench_latency_us[seq];
+		result->legit_delivered++;
+	}
+}
+
+/*!
+ * @brief  This API will run the agent as a gateway under the flood.
+ * @param [in]   *config - pointer to vt_bench_config_t structure.
+ * @param [in]   mode - is vt_ratelimit_mode_t.
+ * @param [out]  *result - pointer to vt_bench_result_t structure.
+ * @return       none.
+ */
+static void _vt_bench_run(const vt_bench_config_t *config, vt_ratelimit_mode_t mode, vt_bench_result_t *result)
+{
+	uint8_t uart[VT_BENCH_UART_CHUNK];
+	uint8_t data[VT_MAX_DATA_BYTE_LENGTH];
+	uint64_t end_us = (uint64_t)config->duration_s * 1000000ULL;
+	vt_ratelimit_info_t info;
+	vt_bench_source_t *source;
+	uint32_t i, b, delivered = 0;
+	int legit, flood, egress;
+	double t0;
+
+	memset(result, 0, sizeof(vt_bench_result_t));
+	bench_seed = config->seed;
+	for(i = 0; i < bench_source_count; i++)
+		bench_sources[i].next_us = _vt_bench_rand() % bench_sources[i].period_us;
+	for(i = 0; i < bench_capacity; i++)
+		bench_latency_us[i] = UINT32_MAX;
+
+	vt_hal_reset();
+	vt_hal_bus_init(VT_BENCH_BUS_IN, config->kbps * 1000U);
+	vt_hal_bus_init(VT_BENCH_BUS_OUT, config->kbps * 1000U);
+	vt_hal_bus_attach_can(VT_BENCH_BUS_IN, VT_INST_CAN0);
+	vt_hal_bus_attach_can(VT_BENCH_BUS_OUT, VT_INST_CAN1);
+	legit = vt_hal_bus_add_node(VT_BENCH_BUS_IN);
+	flood = vt_hal_bus_add_node(VT_BENCH_BUS_IN);
+	egress = vt_hal_bus_add_node(VT_BENCH_BUS_OUT);
+	(void)egress;
+
+	vt_hal_pit_install_handler(vt_pit_ChnConfig0.hwChannel, PIT_Ch0_IRQHandler);
+	vt_rtc_init(VT_RTC_TIMER, &vt_rtcTimer_StartTime, &vt_rtcTimer_AlarmConfig);
+	vt_timer_init(VT_INST_PIT, &vt_pit_ChnConfig0);
+	vt_fw_oem_init();
+	vt_ratelimit_set_mode(mode);
+	vt_init_can(VT_INST_CAN0, _vt_bench_bitrate(config->kbps), vt_rcv_callback, NULL);
+	vt_init_can(VT_INST_CAN1, _vt_bench_bitrate(config->kbps), vt_rcv_callback, NULL);
+	vt_start_rcv(VT_INST_CAN0);
+	vt_start_rcv(VT_INST_CAN1);
+
+	t0 = _vt_bench_now_ms();
+	while(vt_hal_clock_us() < end_us)
+	{
+		for(i = 0; i < bench_source_count; i++)
+		{
+			source = &bench_sources[i];
+			/* The compromised ECU sends nothing but the flood */
+			if(source->can_id == config->flood_id)
+				continue;
+			while(source->next_us <= vt_hal_clock_us() && result->legit_sent < bench_capacity)
+			{
+				memset(data, 0, sizeof(data));
+				data[0] = (uint8_t)(result->legit_sent >> 24);
+				data[1] = (uint8_t)(result->legit_sent >> 16);
+				data[2] = (uint8_t)(result->legit_sent >> 8);
+				data[3] = (uint8_t)result->legit_sent;
+				if(vt_hal_bus_node_send(VT_BENCH_BUS_IN, legit, source->can_id, VT_MAX_DATA_BYTE_LENGTH, data) == STATUS_SUCCESS)
+					bench_sent_us[result->legit_sent++] = vt_hal_clock_us();
+				source->next_us += _vt_bench_jitter(source->period_us);
+			}
+		}
+		while(vt_hal_bus_node_pending(VT_BENCH_BUS_IN, flood) < VT_HAL_BUS_NODE_QUEUE)
+		{
+			for(b = 0; b < VT_MAX_DATA_BYTE_LENGTH; b++)
+				data[b] = (uint8_t)_vt_bench_rand();
+			vt_hal_bus_node_send(VT_BENCH_BUS_IN, flood, config->flood_id, VT_MAX_DATA_BYTE_LENGTH, data);
+		}
+
+		vt_hal_clock_advance(config->loop_us);
+		vt_fw_process();
+		vt_fw_oem_report_process();
+		while(vt_hal_uart_read(uart, sizeof(uart)) == sizeof(uart))
+			;
+		_vt_bench_take_egress(config, result);
+	}
+	result->cpu_ms = _vt_bench_now_ms() - t0;
+
+	/* Frames still queued at the end are not delivered, the latency of each counts the ones that were */
+	for(i = 0; i < result->legit_sent; i++)
+	{
+		if(bench_latency_us[i] != UINT32_MAX)
+			bench_latency_us[delivered++] = bench_latency_us[i];
+	}
+	if(delivered > 0)
+	{
+		qsort(bench_latency_us, delivered, sizeof(uint32_t), _vt_bench_cmp_u32);
+		result->latency_p99_us = bench_latency_us[((uint64_t)delivered * 99U) / 100U];
+	}
+
+	vt_hal_bus_get_stats(VT_BENCH_BUS_IN, &result->in);
+	vt_hal_bus_get_stats(VT_BENCH_BUS_OUT, &result->out);
+	vt_hal_bus_node_get_stats(VT_BENCH_BUS_IN, flood, &result->flood);
+	vt_hal_can_get_stats(VT_INST_CAN0, &result->can_in);
+	vt_fw_get_stats(&result->agent);
+	for(i = 0; vt_ratelimit_get_info(i, &info) == VT_STATUS_SUCCESS; i++)
+	{
+		if(info.can_id == config->flood_id)
+			result->flood_dropped = info.dropped;
+	}
+	vt_fw_close();
+}
+
+static double _vt_bench_pct(double part, double whole)
+{
+	return (whole > 0.0) ? (part * 100.0 / whole) : 0.0;
+}
+
+/*!
+ * @brief  This API will write the results of a run.
+ * @param [in]   *out - pointer to output file.
+ * @param [in]   *config - pointer to vt_bench_config_t structure.
+ * @param [in]   *mode - is name of the mode.
+ * @param [in]   *result - pointer to vt_bench_result_t structure.
+ * @return       none.
+ */
+static void _vt_bench_write(FILE *out, const vt_bench_config_t *config, const char *mode, const vt_bench_result_t *result)
+{
+	const vt_fw_port_stats_t *port_out = &result->agent.port[VT_INST_CAN1];
+	double duration_ns = (double)config->duration_s * 1e9;
+
+	fprintf(out, "flood.%s.in.load_pct %.2f\n", mode, _vt_bench_pct((double)result->in.busy_ns, duration_ns));
+	fprintf(out, "flood.%s.in.flood_frames %lu\n", mode, (unsigned long)result->flood.tx_frames);
+	fprintf(out, "flood.%s.in.rx_overflow %lu\n", mode, (unsigned long)result->can_in.rx_overflow);
+	fprintf(out, "flood.%s.out.load_pct %.2f\n", mode, _vt_bench_pct((double)result->out.busy_ns, duration_ns));
+	fprintf(out, "flood.%s.out.frames %lu\n", mode, (unsigned long)result->out.frames);
+	fprintf(out, "flood.%s.out.flood_frames %lu\n", mode, (unsigned long)result->flood_forwarded);
+	fprintf(out, "flood.%s.flood_over_rate %lu\n", mode, (unsigned long)result->flood_dropped);
+	fprintf(out, "flood.%s.over_rate %lu\n", mode, (unsigned long)result->agent.ratelimit.dropped);
+	fprintf(out, "flood.%s.contended %lu\n", mode, (unsigned long)result->agent.ratelimit.contended);
+	fprintf(out, "flood.%s.queue_high_water %lu\n", mode, (unsigned long)port_out->queue_high_water);
+	fprintf(out, "flood.%s.queue_dropped %lu\n", mode, (unsigned long)port_out->queue_dropped);
+	fprintf(out, "flood.%s.legit.sent %lu\n", mode, (unsigned long)result->legit_sent);
+	fprintf(out, "flood.%s.legit.delivered %lu\n", mode, (unsigned long)result->legit_delivered);
+	fprintf(out, "flood.%s.legit.delivered_pct %.2f\n", mode,
+	        _vt_bench_pct((double)result->legit_delivered, (double)result->legit_sent));
+	fprintf(out, "flood.%s.legit.latency_avg_us %.1f\n", mode,
+	        (result->legit_delivered > 0) ? ((double)result->latency_sum_us / (double)result->legit_delivered) : 0.0);
+	fprintf(out, "flood.%s.legit.latency_p99_us %lu\n", mode, (unsigned long)result->latency_p99_us);
+	fprintf(out, "flood.%s.legit.latency_max_us %lu\n", mode, (unsigned long)result->latency_max_us);
+	fprintf(out, "flood.%s.cpu_ms %.3f\n", mode, result->cpu_ms);
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+int main(int argc, char *argv[])
+{
+	vt_bench_config_t config;
+	vt_bench_result_t result;
+	const char *path = VT_BENCH_OUTPUT;
+	FILE *out;
+	uint32_t i;
+	int bad = 0;
+
+	config.duration_s = VT_BENCH_DURATION_S;
+	config.kbps = 500;
+	config.flood_id = 0;
+	config.loop_us = VT_BENCH_LOOP_US;
+	config.seed = 0x5EED1234;
+	for(i = 1; i < (uint32_t)argc && !bad; i++)
+	{
+		if((i + 1U) >= (uint32_t)argc)
+			bad = 1;
+		else if(strcmp(argv[i], "-d") == 0)
+			config.duration_s = (uint32_t)atoi(argv[++i]);
+		else if(strcmp(argv[i], "-b") == 0)
+			config.kbps = (uint32_t)atoi(argv[++i]);
+		else if(strcmp(argv[i], "-i") == 0)
+			config.flood_id = (uint32_t)strtoul(argv[++i], NULL, 0);
+		else if(strcmp(argv[i], "-p") == 0)
+			config.loop_us = (uint32_t)atoi(argv[++i]);
+		else if(strcmp(argv[i], "-s") == 0)
+			config.seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+		else if(strcmp(argv[i], "-o") == 0)
+			path = argv[++i];
+		else
+			bad = 1;
+	}
+	if(bad || config.duration_s == 0 || config.loop_us == 0 || config.seed == 0 || config.flood_id > 0x7FFU ||
+	   _vt_bench_bitrate(config.kbps) == VT_BITRATE_UNKNOWN)
+	{
+		fprintf(stderr, "usage: %s [-d seconds] [-b kbps] [-i flood_id] [-p loop_us] [-s seed] [-o file]\n"
+		        "bitrates: 125 250 500 800 1000\n", argv[0]);
+		return 1;
+	}
+
+	if(_vt_bench_make_sources() == 0)
+	{
+		fprintf(stderr, "car_vector has no standard Id with a timing record\n");
+		return 1;
+	}
+	/* The lowest priority Id leaves the bus to the others, the flood takes the rest */
+	if(config.flood_id == 0)
+	{
+		for(i = 0; i < bench_source_count; i++)
+		{
+			if(bench_sources[i].can_id > config.flood_id)
+				config.flood_id = bench_sources[i].can_id;
+		}
+	}
+	bench_capacity = 0;
+	for(i = 0; i < bench_source_count; i++)
+		bench_capacity += (uint32_t)(((uint64_t)config.duration_s * 1000000ULL) / bench_sources[i].period_us) + 2U;
+	bench_sent_us = (uint64_t *)malloc(bench_capacity * sizeof(uint64_t));
+	bench_latency_us = (uint32_t *)malloc(bench_capacity * sizeof(uint32_t));
+	if(bench_sent_us == NULL || bench_latency_us == NULL)
+	{
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+	out = fopen(path, "w");
+	if(out == NULL)
+	{
+		perror(path);
+		return 1;
+	}
+
+	fprintf(out, "flood.duration_s %lu\n", (unsigned long)config.duration_s);
+	fprintf(out, "flood.kbps %lu\n", (unsigned long)config.kbps);
+	fprintf(out, "flood.flood_id 0x%03lX\n", (unsigned long)config.flood_id);
+	fprintf(out, "flood.ids %lu\n", (unsigned long)bench_source_count);
+	fprintf(out, "flood.loop_us %lu\n", (unsigned long)config.loop_us);
+	fprintf(out, "flood.seed 0x%08lx\n", (unsigned long)config.seed);
+	_vt_bench_run(&config, VT_RATELIMIT_MONITOR, &result);
+	_vt_bench_write(out, &config, "monitor", &result);
+	_vt_bench_run(&config, VT_RATELIMIT_ENFORCE, &result);
+	_vt_bench_write(out, &config, "enforce", &result);
+
+	free(bench_sent_us);
+	free(bench_latency_us);
+	if(fclose(out) != 0)
+	{
+		perror(path);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,362 @@
+/*
+ * vt_bench_gateway.c
+ *
+ * Host benchmark: forwarding throughput of the gateway at full bus load.
+ *
+ *   vt_bench_gateway [-d seconds] [-b in_kbps] [-B out_kbps] [-r rx_service_ns] [-e egress_fps] [-p loop_us]
+ *                    [-s seed] [-o file]
+ *
+ * CAN0 and CAN1 of the agent sit on two buses of the mock HAL with bus timing (see vt_hal_mock.h). An external node
+ * keeps frames pending on the ingress bus at all times, with the Ids of car_vector and random payloads, so the bus
+ * runs at 100% load with real arbitration and stuffing. The agent forwards to the egress bus, where a second node
+ * acknowledges, and optionally competes with a higher priority Id at egress_fps; the gateway forwards those frames
+ * back to the ingress bus too, where they win arbitration over the ingress node. The RX interrupt takes
+ * rx_service_ns per frame, and the main loop runs vt_fw_process() and vt_fw_oem_report_process() every loop_us.
+ *
+ * Results go to bench_output.txt (-o), one "gateway.<key> <value>" per line. Everything is on the virtual clock
+ * and reproducible for a seed, except cpu_ms and frames_per_s.
+ */
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include <time.h>
+#include "vt_hal_mock.h"
+#include "vt_fw_if.h"
+#include "vt_fw_oem.h"
+#include "vt_can.h"
+#include "vt_rtc.h"
+#include "vt_timer.h"
+
+/*------------------------------------------------------------------*
+ *                          Define Macro                            *
+ *------------------------------------------------------------------*/
+#define VT_BENCH_DURATION_S      10U
+#define VT_BENCH_LOOP_US         100U
+#define VT_BENCH_OUTPUT          "bench_output.txt"
+
+#define VT_BENCH_BUS_IN          0U
+#define VT_BENCH_BUS_OUT         1U
+
+/*! Id of the competing traffic on the egress bus, above every Id of car_vector */
+#define VT_BENCH_EGRESS_ID       0x001U
+
+#define VT_BENCH_MAX_IDS         64U
+#define VT_BENCH_UART_CHUNK      4096U
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef struct _vt_bench_config_t
+{
+	uint32_t duration_s;
+	uint32_t in_kbps;
+	uint32_t out_kbps;
+	uint32_t rx_service_ns;
+	uint32_t egress_fps;
+	uint32_t loop_us;
+	uint32_t seed;
+}vt_bench_config_t;
+
+typedef struct _vt_bench_result_t
+{
+	vt_hal_bus_stats_t in;
+	vt_hal_bus_node_stats_t ingress;
+	vt_hal_bus_stats_t out;
+	vt_hal_can_stats_t can_in;
+	vt_hal_can_stats_t can_out;
+	vt_fw_stats_t agent;
+	uint64_t egress_frames;
+	double cpu_ms;
+}vt_bench_result_t;
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+static const struct
+{
+	uint32_t kbps;
+	vt_can_bitrate_type_t bitrate;
+}bench_bitrates[] = {
+	{125,  VT_BITRATE_125},
+	{250,  VT_BITRATE_250},
+	{500,  VT_BITRATE_500},
+	{800,  VT_BITRATE_800},
+	{1000, VT_BITRATE_1M},
+};
+
+#define VT_BENCH_BITRATES        (sizeof(bench_bitrates) / sizeof(bench_bitrates[0]))
+
+static uint32_t bench_ids[VT_BENCH_MAX_IDS];
+static uint32_t bench_id_count;
+static uint32_t bench_seed;
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+extern void PIT_Ch0_IRQHandler(void);
+
+static uint32_t _vt_bench_rand(void)
+{
+	bench_seed ^= bench_seed << 13;
+	bench_seed ^= bench_seed >> 17;
+	bench_seed ^= bench_seed << 5;
+	return bench_seed;
+}
+
+static double _vt_bench_now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1000000.0;
+}
+
+static uint32_t _vt_bench_get(const uint8_t *data, uint32_t bytes)
+{
+	uint32_t value = 0;
+
+	while(bytes-- > 0)
+		value = (value << 8) | *data++;
+	return value;
+}
+
+/*!
+ * @brief  This API will get the bitrate of the agent for a bitrate in kbit/s.
+ * @param [in]   kbps - is bitrate in kbit/s.
+ * @return       vt_can_bitrate_type_t, or VT_BITRATE_UNKNOWN if the agent has no such bitrate.
+ */
+static vt_can_bitrate_type_t _vt_bench_bitrate(uint32_t kbps)
+{
+	uint32_t i;
+
+	for(i = 0; i < VT_BENCH_BITRATES; i++)
+	{
+		if(bench_bitrates[i].kbps == kbps)
+			return bench_bitrates[i].bitrate;
+	}
+	return VT_BITRATE_UNKNOWN;
+}
+
+/*!
+ * @brief  This API will collect the standard Ids of car_vector, the Ids of the ingress traffic.
+ * @param [in]   none.
+ * @return       number of Ids.
+ */
+static uint32_t _vt_bench_make_ids(void)
+{
+	uint32_t ids = _vt_bench_get(car_vector + 4, 2);
+	uint32_t i, id;
+
+	bench_id_count = 0;
+	for(i = 0; i < ids && bench_id_count < VT_BENCH_MAX_IDS; i++)
+	{
+		id = _vt_bench_get(car_vector + 6 + i * 4, 4);
+		if(id > VT_BENCH_EGRESS_ID && id <= 0x7FFU)
+			bench_ids[bench_id_count++] = id;
+	}
+	return bench_id_count;
+}
+
+/*!
+ * @brief  This API will run the agent as a gateway between two buses.
+ * @param [in]   *config - pointer to vt_bench_config_t structure.
+ * @param [out]  *result - pointer to vt_bench_result_t structure.
+ * @return       none.
+ */
+static void _vt_bench_run(const vt_bench_config_t *config, vt_bench_result_t *result)
+{
+	uint8_t uart[VT_BENCH_UART_CHUNK];
+	uint8_t data[VT_MAX_DATA_BYTE_LENGTH];
+	uint64_t end_us = (uint64_t)config->duration_s * 1000000ULL;
+	uint64_t egress_next = 0, egress_period = 0;
+	uint32_t next_id = 0, b;
+	int ingress, egress;
+	double t0;
+
+	memset(result, 0, sizeof(vt_bench_result_t));
+	bench_seed = config->seed;
+	if(config->egress_fps > 0)
+		egress_period = 1000000ULL / config->egress_fps;
+
+	vt_hal_reset();
+	vt_hal_bus_init(VT_BENCH_BUS_IN, config->in_kbps * 1000U);
+	vt_hal_bus_init(VT_BENCH_BUS_OUT, config->out_kbps * 1000U);
+	vt_hal_bus_attach_can(VT_BENCH_BUS_IN, VT_INST_CAN0);
+	vt_hal_bus_attach_can(VT_BENCH_BUS_OUT, VT_INST_CAN1);
+	ingress = vt_hal_bus_add_node(VT_BENCH_BUS_IN);
+	egress = vt_hal_bus_add_node(VT_BENCH_BUS_OUT);
+	vt_hal_can_set_rx_service_time(VT_INST_CAN0, config->rx_service_ns);
+	vt_hal_can_set_rx_service_time(VT_INST_CAN1, config->rx_service_ns);
+
+	vt_hal_pit_install_handler(vt_pit_ChnConfig0.hwChannel, PIT_Ch0_IRQHandler);
+	vt_rtc_init(VT_RTC_TIMER, &vt_rtcTimer_StartTime, &vt_rtcTimer_AlarmConfig);
+	vt_timer_init(VT_INST_PIT, &vt_pit_ChnConfig0);
+	vt_fw_oem_init();
+	/* Every Id runs far above its policy rate, the run measures the forwarding path (see vt_bench_flood.c) */
+	vt_ratelimit_set_mode(VT_RATELIMIT_MONITOR);
+	vt_init_can(VT_INST_CAN0, _vt_bench_bitrate(config->in_kbps), vt_rcv_callback, NULL);
+	vt_init_can(VT_INST_CAN1, _vt_bench_bitrate(config->out_kbps), vt_rcv_callback, NULL);
+	vt_start_rcv(VT_INST_CAN0);
+	vt_start_rcv(VT_INST_CAN1);
+
+	t0 = _vt_bench_now_ms();
+	while(vt_hal_clock_us() < end_us)
+	{
+		/* The ingress node never runs dry: the bus stays at 100% load */
+		while(vt_hal_bus_node_pending(VT_BENCH_BUS_IN, ingress) < VT_HAL_BUS_NODE_QUEUE)
+		{
+			for(b = 0; b < VT_MAX_DATA_BYTE_LENGTH; b++)
+				data[b] = (uint8_t)_vt_bench_rand();
+			vt_hal_bus_node_send(VT_BENCH_BUS_IN, ingress, bench_ids[next_id], VT_MAX_DATA_BYTE_LENGTH, data);
+			next_id = (next_id + 1U) % bench_id_count;
+		}
+		while(egress_period > 0 && egress_next <= vt_hal_clock_us())
+		{
+			memset(data, 0, sizeof(data));
+			if(vt_hal_bus_node_send(VT_BENCH_BUS_OUT, egress, VT_BENCH_EGRESS_ID, VT_MAX_DATA_BYTE_LENGTH, data) == STATUS_SUCCESS)
+				result->egress_frames++;
+			egress_next += egress_period;
+		}
+
+		vt_hal_clock_advance(config->loop_us);
+		vt_fw_process();
+		vt_fw_oem_report_process();
+		while(vt_hal_uart_read(uart, sizeof(uart)) == sizeof(uart))
+			;
+	}
+	result->cpu_ms = _vt_bench_now_ms() - t0;
+
+	vt_hal_bus_get_stats(VT_BENCH_BUS_IN, &result->in);
+	vt_hal_bus_get_stats(VT_BENCH_BUS_OUT, &result->out);
+	vt_hal_bus_node_get_stats(VT_BENCH_BUS_IN, ingress, &result->ingress);
+	vt_hal_can_get_stats(VT_INST_CAN0, &result->can_in);
+	vt_hal_can_get_stats(VT_INST_CAN1, &result->can_out);
+	vt_fw_get_stats(&result->agent);
+	vt_fw_close();
+}
+
+static double _vt_bench_pct(double part, double whole)
+{
+	return (whole > 0.0) ? (part * 100.0 / whole) : 0.0;
+}
+
+/*!
+ * @brief  This API will write the results.
+ * @param [in]   *out - pointer to output file.
+ * @param [in]   *config - pointer to vt_bench_config_t structure.
+ * @param [in]   *result - pointer to vt_bench_result_t structure.
+ * @return       none.
+ */
+static void _vt_bench_write(FILE *out, const vt_bench_config_t *config, const vt_bench_result_t *result)
+{
+	const vt_fw_port_stats_t *port_in = &result->agent.port[VT_INST_CAN0];
+	const vt_fw_port_stats_t *port_out = &result->agent.port[VT_INST_CAN1];
+	double duration_ns = (double)config->duration_s * 1e9;
+	uint32_t forwarded = result->can_out.tx_completed;
+
+	fprintf(out, "gateway.duration_s %lu\n", (unsigned long)config->duration_s);
+	fprintf(out, "gateway.in_kbps %lu\n", (unsigned long)config->in_kbps);
+	fprintf(out, "gateway.out_kbps %lu\n", (unsigned long)config->out_kbps);
+	fprintf(out, "gateway.rx_service_ns %lu\n", (unsigned long)config->rx_service_ns);
+	fprintf(out, "gateway.egress_fps %lu\n", (unsigned long)config->egress_fps);
+	fprintf(out, "gateway.loop_us %lu\n", (unsigned long)config->loop_us);
+	fprintf(out, "gateway.seed 0x%08lx\n", (unsigned long)config->seed);
+	fprintf(out, "gateway.in.frames %lu\n", (unsigned long)result->ingress.tx_frames);
+	fprintf(out, "gateway.in.frames_per_s %.1f\n", (double)result->ingress.tx_frames / (double)config->duration_s);
+	fprintf(out, "gateway.in.bus_frames %lu\n", (unsigned long)result->in.frames);
+	fprintf(out, "gateway.in.load_pct %.2f\n", _vt_bench_pct((double)result->in.busy_ns, duration_ns));
+	fprintf(out, "gateway.in.stuff_bits_per_frame %.2f\n",
+	        (result->in.frames > 0) ? ((double)result->in.stuff_bits / (double)result->in.frames) : 0.0);
+	fprintf(out, "gateway.in.rx_overflow %lu\n", (unsigned long)result->can_in.rx_overflow);
+	fprintf(out, "gateway.in.rx_frames %lu\n", (unsigned long)port_in->can.rx_frames);
+	fprintf(out, "gateway.out.frames %lu\n", (unsigned long)result->out.frames);
+	fprintf(out, "gateway.out.load_pct %.2f\n", _vt_bench_pct((double)result->out.busy_ns, duration_ns));
+	fprintf(out, "gateway.out.egress_frames %llu\n", (unsigned long long)result->egress_frames);
+	fprintf(out, "gateway.out.arbitration_lost %lu\n", (unsigned long)result->can_out.tx_arbitration_lost);
+	fprintf(out, "gateway.out.error_frames %lu\n", (unsigned long)result->out.error_frames);
+	fprintf(out, "gateway.forwarded %lu\n", (unsigned long)forwarded);
+	fprintf(out, "gateway.forwarded_per_s %.1f\n", (double)forwarded / (double)config->duration_s);
+	fprintf(out, "gateway.forwarded_pct %.2f\n", _vt_bench_pct((double)forwarded, (double)result->ingress.tx_frames));
+	fprintf(out, "gateway.queue_high_water %lu\n", (unsigned long)port_out->queue_high_water);
+	fprintf(out, "gateway.queue_dropped %lu\n", (unsigned long)port_out->queue_dropped);
+	fprintf(out, "gateway.tx_aborts %lu\n", (unsigned long)port_out->can.tx_aborts);
+	fprintf(out, "gateway.cpu_ms %.3f\n", result->cpu_ms);
+	fprintf(out, "gateway.frames_per_s %.0f\n",
+	        (result->cpu_ms > 0.0) ? ((double)result->ingress.tx_frames * 1000.0 / result->cpu_ms) : 0.0);
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+int main(int argc, char *argv[])
+{
+	vt_bench_config_t config;
+	vt_bench_result_t result;
+	const char *path = VT_BENCH_OUTPUT;
+	FILE *out;
+	uint32_t i;
+	int bad = 0;
+
+	config.duration_s = VT_BENCH_DURATION_S;
+	config.in_kbps = 500;
+	config.out_kbps = 500;
+	config.rx_service_ns = 0;
+	config.egress_fps = 0;
+	config.loop_us = VT_BENCH_LOOP_US;
+	config.seed = 0x5EED1234;
+	for(i = 1; i < (uint32_t)argc && !bad; i++)
+	{
+		if((i + 1U) >= (uint32_t)argc)
+			bad = 1;
+		else if(strcmp(argv[i], "-d") == 0)
+			config.duration_s = (uint32_t)atoi(argv[++i]);
+		else if(strcmp(argv[i], "-b") == 0)
+			config.in_kbps = (uint32_t)atoi(argv[++i]);
+		else if(strcmp(argv[i], "-B") == 0)
+			config.out_kbps = (uint32_t)atoi(argv[++i]);
+		else if(strcmp(argv[i], "-r") == 0)
+			config.rx_service_ns = (uint32_t)atoi(argv[++i]);
+		else if(strcmp(argv[i], "-e") == 0)
+			config.egress_fps = (uint32_t)atoi(argv[++i]);
+		else if(strcmp(argv[i], "-p") == 0)
+			config.loop_us = (uint32_t)atoi(argv[++i]);
+		else if(strcmp(argv[i], "-s") == 0)
+			config.seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+		else if(strcmp(argv[i], "-o") == 0)
+			path = argv[++i];
+		else
+			bad = 1;
+	}
+	if(bad || config.duration_s == 0 || config.loop_us == 0 || config.seed == 0 || config.egress_fps > 1000000U ||
+	   _vt_bench_bitrate(config.in_kbps) == VT_BITRATE_UNKNOWN || _vt_bench_bitrate(config.out_kbps) == VT_BITRATE_UNKNOWN)
+	{
+		fprintf(stderr, "usage: %s [-d seconds] [-b in_kbps] [-B out_kbps] [-r rx_service_ns] [-e egress_fps] [-p loop_us]\n"
+		        "       [-s seed] [-o file]\n"
+		        "bitrates: 125 250 500 800 1000\n", argv[0]);
+		return 1;
+	}
+
+	if(_vt_bench_make_ids() == 0)
+	{
+		fprintf(stderr, "car_vector has no standard Id\n");
+		return 1;
+	}
+	out = fopen(path, "w");
+	if(out == NULL)
+	{
+		perror(path);
+		return 1;
+	}
+
+	_vt_bench_run(&config, &result);
+	_vt_bench_write(out, &config, &result);
+	_vt_bench_write(stdout, &config, &result);
+
+	if(fclose(out) != 0)
+	{
+		perror(path);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,236 @@
+/*
+ * vt_bench_rate.c
+ *
+ * Host benchmark: rates of the core (float) to the records of the agent, in floating-point and with
+ * vt_rate_from_float().
+ *
+ *   vt_bench_rate [-n rates] [-s seed] [-o file]
+ *
+ * Rates are random floats in [0, 8) plus ties of the rounding. Each path is checked against the exact rounding,
+ * computed in double, and timed for the conversion alone and for the conversion plus the text of a traffic record.
+ * On the e200 the floating-point path also costs the save of the SPE registers in every interrupt reaching it, which
+ * a host cannot show.
+ *
+ * Results go to bench_output.txt (-o), one "rate.<key> <value>" per line. Everything but the *_ns keys is
+ * reproducible for a seed.
+ */
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "vt_rate.h"
+
+/*------------------------------------------------------------------*
+ *                          Define Macro                            *
+ *------------------------------------------------------------------*/
+#define VT_BENCH_RATES           1000000U
+#define VT_BENCH_OUTPUT          "bench_output.txt"
+#define VT_BENCH_TEXT_SIZE       96
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+static uint32_t bench_seed = 0x5EED1234;
+static float *bench_rates;
+static vt_rate_t *bench_expected;
+/* Keeps the results alive */
+static volatile uint32_t bench_sink;
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+static uint32_t _vt_bench_rand(void)
+{
+	bench_seed ^= bench_seed << 13;
+	bench_seed ^= bench_seed >> 17;
+	bench_seed ^= bench_seed << 5;
+	return bench_seed;
+}
+
+static double _vt_bench_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1000000000.0 + (double)ts.tv_nsec;
+}
+
+/*!
+ * @brief  This API will round a rate exactly: the product of a float and VT_RATE_ONE fits in a double.
+ * @param [in]   rate - is rate.
+ * @return       fixed-point rate.
+ */
+static vt_rate_t _vt_bench_exact(float rate)
+{
+	double value = floor((double)rate * VT_RATE_ONE + 0.5);
+
+	if(!(value > 0.0))
+		return 0;
+	return (value >= VT_RATE_MAX) ? VT_RATE_MAX : (vt_rate_t)value;
+}
+
+/*!
+ * @brief  This API will convert a rate in floating-point, the reference vt_rate_from_float() is compared with.
+ * @param [in]   rate - is rate.
+ * @return       fixed-point rate.
+ */
+static vt_rate_t _vt_bench_float(float rate)
+{
+	float value = rate * (float)VT_RATE_ONE + 0.5f;
+
+	if(!(value > 0.0f))
+		return 0;
+	if(value >= 65535.0f)
+		return VT_RATE_MAX;
+	return (vt_rate_t)value;
+}
+
+static void _vt_bench_make_rates(uint32_t count)
+{
+	uint32_t i;
+
+	for(i = 0; i < count; i++)
+	{
+		/* One in 16 is a tie of the rounding, k + 0.5 units */
+		if((i & 15U) == 0)
+			bench_rates[i] = ((float)(_vt_bench_rand() % (VT_RATE_ONE * 2U)) + 0.5f) / (float)VT_RATE_ONE;
+		else
+			bench_rates[i] = (float)(_vt_bench_rand() >> 8) / (float)(1U << 21);
+		bench_expected[i] = _vt_bench_exact(bench_rates[i]);
+	}
+}
+
+/*!
+ * @brief  This API will time a conversion over all rates and count results off the exact rounding.
+ * @param [in]   count - is number of rates.
+ * @param [in]   fixed - is 1 for vt_rate_from_float(), 0 for floating-point.
+ * @param [out]  *ns - is time per rate in nanoseconds.
+ * @return       number of results off the exact rounding.
+ */
+static uint32_t _vt_bench_convert(uint32_t count, uint8_t fixed, double *ns)
+{
+	uint32_t i, wrong = 0, sum = 0;
+	vt_rate_t rate;
+	double start = _vt_bench_now_ns();
+
+	for(i = 0; i < count; i++)
+	{
+		rate = fixed ? vt_rate_from_float(bench_rates[i]) : _vt_bench_float(bench_rates[i]);
+		sum += rate;
+		if(rate != bench_expected[i])
+			wrong++;
+	}
+	*ns = (_vt_bench_now_ns() - start) / (double)count;
+	bench_sink = sum;
+
+	return wrong;
+}
+
+/*!
+ * @brief  This API will time the text of a traffic record over all rates, as vt_event_format() writes it.
+ * @param [in]   count - is number of rates.
+ * @param [in]   fixed - is 1 for fixed-point, 0 for floating-point.
+ * @return       time per record in nanoseconds.
+ */
+static double _vt_bench_text(uint32_t count, uint8_t fixed)
+{
+	char text[VT_BENCH_TEXT_SIZE];
+	uint32_t i, sum = 0;
+	vt_rate_t rate;
+	double start = _vt_bench_now_ns();
+
+	for(i = 0; i < count; i++)
+	{
+		if(fixed)
+		{
+			rate = vt_rate_from_float(bench_rates[i]);
+			sum += (uint32_t)snprintf(text, sizeof(text), "- Slot rate: %lu.%02lu%%\r\n", VT_RATE_PERCENT(rate),
+			                          VT_RATE_PERCENT_FRAC(rate));
+		}
+		else
+		{
+			sum += (uint32_t)snprintf(text, sizeof(text), "- Slot rate: %.3f%%\r\n", bench_rates[i] * 100.0f);
+		}
+	}
+	bench_sink = sum;
+
+	return (_vt_bench_now_ns() - start) / (double)count;
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+int main(int argc, char *argv[])
+{
+	const char *path = VT_BENCH_OUTPUT;
+	uint32_t count = VT_BENCH_RATES;
+	uint32_t wrong_float, wrong_fixed;
+	double float_ns, fixed_ns, text_float_ns, text_fixed_ns;
+	FILE *out;
+	uint32_t i;
+	int bad = 0;
+
+	for(i = 1; i < (uint32_t)argc && !bad; i++)
+	{
+		if((i + 1U) >= (uint32_t)argc)
+			bad = 1;
+		else if(strcmp(argv[i], "-n") == 0)
+			count = (uint32_t)atoi(argv[++i]);
+		else if(strcmp(argv[i], "-s") == 0)
+			bench_seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+		else if(strcmp(argv[i], "-o") == 0)
+			path = argv[++i];
+		else
+			bad = 1;
+	}
+	if(bad || count == 0 || bench_seed == 0)
+	{
+		fprintf(stderr, "usage: %s [-n rates] [-s seed] [-o file]\n", argv[0]);
+		return 1;
+	}
+
+	bench_rates = (float *)malloc(count * sizeof(float));
+	bench_expected = (vt_rate_t *)malloc(count * sizeof(vt_rate_t));
+	if(bench_rates == NULL || bench_expected == NULL)
+	{
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+	out = fopen(path, "w");
+	if(out == NULL)
+	{
+		perror(path);
+		return 1;
+	}
+
+	fprintf(out, "rate.count %lu\n", (unsigned long)count);
+	fprintf(out, "rate.seed 0x%08lx\n", (unsigned long)bench_seed);
+	_vt_bench_make_rates(count);
+	/* Warm up the caches with the first pass */
+	_vt_bench_convert(count, 0, &float_ns);
+	wrong_float = _vt_bench_convert(count, 0, &float_ns);
+	wrong_fixed = _vt_bench_convert(count, 1, &fixed_ns);
+	text_float_ns = _vt_bench_text(count, 0);
+	text_fixed_ns = _vt_bench_text(count, 1);
+
+	fprintf(out, "rate.float.off_exact %lu\n", (unsigned long)wrong_float);
+	fprintf(out, "rate.fixed.off_exact %lu\n", (unsigned long)wrong_fixed);
+	fprintf(out, "rate.float.convert_ns %.2f\n", float_ns);
+	fprintf(out, "rate.fixed.convert_ns %.2f\n", fixed_ns);
+	fprintf(out, "rate.float.text_ns %.2f\n", text_float_ns);
+	fprintf(out, "rate.fixed.text_ns %.2f\n", text_fixed_ns);
+
+	free(bench_rates);
+	free(bench_expected);
+	if(fclose(out) != 0)
+	{
+		perror(path);
+		return 1;
+	}
+	return (wrong_fixed == 0) ? 0 : 1;
+}
@@ -0,0 +1,421 @@
+/*
+ * vt_bench_socketcan.c
+ *
+ * Host benchmark: sustained frame rate of the SocketCAN driver (see vt_socketcan.h) over several interfaces.
+ *
+ *   vt_bench_socketcan [-d seconds] [-r fps] [-f] [-o file] if0 [if1 [if2]]
+ *
+ * Every interface gets a generator thread writing 8 byte frames with a sequence number through its own raw socket,
+ * -r frames per second (as fast as the interface takes them with 0), in batches with sendmmsg(). The driver receives
+ * them with FLEXCAN_DRV_RxFifo and a double buffer, as vt_can.c does, and a counting callback checks the sequence
+ * and records the latency from the kernel RX timestamp to the callback. With -f the callback also forwards every
+ * frame to the next interface, which exercises the transmit batching.
+ * On a Linux host without CAN hardware:
+ *   modprobe vcan && ip link add dev vcan0 type vcan && ip link set up vcan0
+ *
+ * Results go to bench_output.txt (-o), one "socketcan.<if>.<key> <value>" per line, then the totals.
+ */
+
+#define _GNU_SOURCE
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include "vt_atomic.h"
+#include "vt_probe.h"
+#include "vt_socketcan.h"
+
+/*------------------------------------------------------------------*
+ *                          Define Macro                            *
+ *------------------------------------------------------------------*/
+#define VT_BENCH_DURATION_S      10U
+#define VT_BENCH_OUTPUT          "bench_output.txt"
+
+/*! Id of the generator of an interface is VT_BENCH_BASE_ID + index */
+#define VT_BENCH_BASE_ID         0x100U
+/*! Pacing period of a generator */
+#define VT_BENCH_TICK_NS         1000000ULL
+/*! Time left for the last frames to arrive */
+#define VT_BENCH_DRAIN_NS        200000000L
+/*! Mailboxes the forwarding cycles through */
+#define VT_BENCH_TX_MB           32U
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef struct _vt_bench_if_t
+{
+	const char *ifname;
+	pthread_t thread;
+	int fd;
+	uint32_t fps;
+	/* Generator */
+	uint64_t sent;
+	uint64_t send_retries;
+	/* Callback, under the interrupt lock of the driver */
+	flexcan_msgbuff_t buff[2];
+	uint8_t active;
+	uint32_t expected;
+	uint64_t received;
+	uint64_t gaps;                  /*!< frames skipped in the sequence */
+	uint64_t overflow;
+	uint64_t forwarded;
+	uint64_t forward_busy;
+	uint8_t mb_idx;
+	vt_probe_hist_t latency;
+}vt_bench_if_t;
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+static vt_bench_if_t bench_if[VT_SOCKETCAN_INSTANCES];
+static uint32_t bench_if_count;
+static uint8_t bench_forward;
+static uint8_t bench_stop;
+static flexcan_state_t bench_state;
+
+static const flexcan_user_config_t bench_config = {
+	.max_num_mb = VT_BENCH_TX_MB,
+	.num_id_filters = FLEXCAN_RX_FIFO_ID_FILTERS_8,
+	.is_rx_fifo_needed = true,
+	.flexcanMode = FLEXCAN_NORMAL_MODE,
+	.payload = FLEXCAN_PAYLOAD_SIZE_8,
+	.fd_enable = false,
+	.pe_clock = FLEXCAN_CLK_SOURCE_FXOSC,
+	.transfer_type = FLEXCAN_RXFIFO_USING_INTERRUPTS,
+};
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+static uint64_t _vt_bench_now_ns(clockid_t clock)
+{
+	struct timespec ts;
+
+	clock_gettime(clock, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void _vt_bench_sleep_until(uint64_t at_ns)
+{
+	struct timespec ts;
+
+	ts.tv_sec = (time_t)(at_ns / 1000000000ULL);
+	ts.tv_nsec = (long)(at_ns % 1000000000ULL);
+	while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+		;
+}
+
+/*!
+ * @brief  This API will count a received frame and forward it, the interrupt lock of the driver is held.
+ * @param [in]   instance - is FlexCAN instance.
+ * @param [in]   eventType - is FlexCAN event.
+ * @param [in]   *flexcanState - pointer to flexcan_state_t structure.
+ * @return       none.
+ */
+static void _vt_bench_callback(uint8_t instance, flexcan_event_type_t eventType, flexcan_state_t *flexcanState)
+{
+	vt_bench_if_t *port = &bench_if[instance];
+	flexcan_msgbuff_t *msg;
+	flexcan_data_info_t info;
+	uint64_t ts_ns, now_ns;
+	uint32_t seq;
+	uint8_t next;
+
+	(void)flexcanState;
+	if(eventType == FLEXCAN_EVENT_RXFIFO_OVERFLOW)
+	{
+		port->overflow++;
+		return;
+	}
+	if(eventType != FLEXCAN_EVENT_RXFIFO_COMPLETE)
+		return;
+
+	now_ns = _vt_bench_now_ns(CLOCK_REALTIME);
+	msg = &port->buff[port->active];
+	port->active = !port->active;
+	FLEXCAN_DRV_RxFifo(instance, &port->buff[port->active]);
+
+	if(msg->msgId != VT_BENCH_BASE_ID + instance || msg->dataLen < 4U)
+		return;
+	port->received++;
+	seq = (uint32_t)msg->data[0] | ((uint32_t)msg->data[1] << 8) | ((uint32_t)msg->data[2] << 16) |
+	      ((uint32_t)msg->data[3] << 24);
+	if(seq > port->expected)
+		port->gaps += seq - port->expected;
+	port->expected = seq + 1U;
+	ts_ns = vt_socketcan_rx_timestamp_ns(instance);
+	if(ts_ns != 0 && now_ns >= ts_ns)
+		vt_probe_hist_record(&port->latency, (uint32_t)(now_ns - ts_ns));
+
+	if(bench_forward && bench_if_count > 1)
+	{
+		next = (uint8_t)((instance + 1U) % bench_if_count);
+		memset(&info, 0, sizeof(info));
+		info.msg_id_type = FLEXCAN_MSG_ID_STD;
+		info.data_length = msg->dataLen;
+		/* Another Id, the generator of the next interface does not see its own sequence */
+		if(FLEXCAN_DRV_Send(next, port->mb_idx, &info, msg->msgId | 0x400U, msg->data) == STATUS_SUCCESS)
+			port->forwarded++;
+		else
+			port->forward_busy++;
+		port->mb_idx = (uint8_t)((port->mb_idx + 1U) % VT_BENCH_TX_MB);
+	}
+}
+
+/*!
+ * @brief  This API will open the raw socket of a generator, it reads nothing.
+ * @param [in]   *ifname - pointer to interface name.
+ * @return       socket, or -1 on error.
+ */
+static int _vt_bench_open(const char *ifname)
+{
+	struct sockaddr_can addr;
+	int fd;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.can_family = AF_CAN;
+	addr.can_ifindex = (int)if_nametoindex(ifname);
+	if(addr.can_ifindex == 0)
+		return -1;
+	fd = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+	if(fd < 0)
+		return -1;
+	if(bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+	{
+		close(fd);
+		return -1;
+	}
+	(void)setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FILTER, NULL, 0);
+	return fd;
+}
+
+/*!
+ * @brief  This API will write frames of one interface until the benchmark stops.
+ * @param [in]   *arg - pointer to vt_bench_if_t structure.
+ * @return       NULL.
+ */
+static void *_vt_bench_generator(void *arg)
+{
+	vt_bench_if_t *port = (vt_bench_if_t *)arg;
+	uint32_t index = (uint32_t)(port - bench_if);
+	struct can_frame frames[VT_SOCKETCAN_BATCH];
+	struct iovec iov[VT_SOCKETCAN_BATCH];
+	struct mmsghdr msgs[VT_SOCKETCAN_BATCH];
+	struct timespec pause = {0, 100000L};
+	uint64_t start_ns = _vt_bench_now_ns(CLOCK_MONOTONIC);
+	uint64_t tick = 0, due;
+	uint32_t i, count;
+	int n;
+
+	memset(msgs, 0, sizeof(msgs));
+	memset(frames, 0, sizeof(frames));
+	for(i = 0; i < VT_SOCKETCAN_BATCH; i++)
+	{
+		frames[i].can_id = VT_BENCH_BASE_ID + index;
+		frames[i].can_dlc = CAN_MAX_DLEN;
+		frames[i].data[4] = (uint8_t)index;
+		iov[i].iov_base = &frames[i];
+		iov[i].iov_len = sizeof(struct can_frame);
+		msgs[i].msg_hdr.msg_iov = &iov[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	while(!VT_ATOMIC_LOAD(&bench_stop))
+	{
+		/* Frames due by the end of this tick, a full batch when unpaced */
+		count = VT_SOCKETCAN_BATCH;
+		if(port->fps > 0)
+		{
+			tick++;
+			due = (uint64_t)port->fps * tick * VT_BENCH_TICK_NS / 1000000000ULL;
+			count = (due - port->sent < VT_SOCKETCAN_BATCH) ? (uint32_t)(due - port->sent) : VT_SOCKETCAN_BATCH;
+		}
+		for(i = 0; i < count; i++)
+		{
+			frames[i].data[0] = (uint8_t)(port->sent + i);
+			frames[i].data[1] = (uint8_t)((port->sent + i) >> 8);
+			frames[i].data[2] = (uint8_t)((port->sent + i) >> 16);
+			frames[i].data[3] = (uint8_t)((port->sent + i) >> 24);
+		}
+		i = 0;
+		while(i < count && !VT_ATOMIC_LOAD(&bench_stop))
+		{
+			n = sendmmsg(port->fd, &msgs[i], count - i, 0);
+			if(n > 0)
+			{
+				i += (uint32_t)n;
+				port->sent += (uint64_t)n;
+			}
+			else
+			{
+				port->send_retries++;
+				nanosleep(&pause, NULL);
+			}
+		}
+		if(port->fps > 0)
+			_vt_bench_sleep_until(start_ns + tick * VT_BENCH_TICK_NS);
+	}
+	return NULL;
+}
+
+static double _vt_bench_ratio(uint64_t part, uint64_t whole)
+{
+	return (whole > 0) ? ((double)part / (double)whole) : 0.0;
+}
+
+/*!
+ * @brief  This API will write the results.
+ * @param [in]   *out - pointer to output file.
+ * @param [in]   duration_s - is duration in seconds.
+ * @return       none.
+ */
+static void _vt_bench_write(FILE *out, uint32_t duration_s)
+{
+	vt_socketcan_stats_t sc;
+	vt_probe_stats_t lat;
+	uint64_t sent = 0, received = 0, forwarded = 0;
+	uint32_t i;
+
+	for(i = 0; i < bench_if_count; i++)
+	{
+		vt_bench_if_t *port = &bench_if[i];
+		const char *name = port->ifname;
+
+		vt_socketcan_get_stats((uint8_t)i, &sc);
+		vt_probe_hist_get_stats(&port->latency, &lat);
+		fprintf(out, "socketcan.%s.sent %llu\n", name, (unsigned long long)port->sent);
+		fprintf(out, "socketcan.%s.send_retries %llu\n", name, (unsigned long long)port->send_retries);
+		fprintf(out, "socketcan.%s.received %llu\n", name, (unsigned long long)port->received);
+		fprintf(out, "socketcan.%s.received_per_s %.1f\n", name, (double)port->received / (double)duration_s);
+		fprintf(out, "socketcan.%s.lost %llu\n", name,
+		        (unsigned long long)((port->sent > port->received) ? (port->sent - port->received) : 0));
+		fprintf(out, "socketcan.%s.sequence_gaps %llu\n", name, (unsigned long long)port->gaps);
+		fprintf(out, "socketcan.%s.overflow %llu\n", name, (unsigned long long)port->overflow);
+		fprintf(out, "socketcan.%s.socket_dropped %llu\n", name, (unsigned long long)sc.rx_dropped);
+		fprintf(out, "socketcan.%s.rx_frames_per_batch %.2f\n", name, _vt_bench_ratio(sc.rx_frames, sc.rx_batches));
+		fprintf(out, "socketcan.%s.latency_p50_us %.1f\n", name, (double)lat.p50_ns / 1000.0);
+		fprintf(out, "socketcan.%s.latency_p99_us %.1f\n", name, (double)lat.p99_ns / 1000.0);
+		fprintf(out, "socketcan.%s.latency_max_us %.1f\n", name, (double)lat.max_ns / 1000.0);
+		fprintf(out, "socketcan.%s.forwarded %llu\n", name, (unsigned long long)port->forwarded);
+		fprintf(out, "socketcan.%s.forward_busy %llu\n", name, (unsigned long long)port->forward_busy);
+		fprintf(out, "socketcan.%s.tx_frames %llu\n", name, (unsigned long long)sc.tx_frames);
+		fprintf(out, "socketcan.%s.tx_frames_per_batch %.2f\n", name, _vt_bench_ratio(sc.tx_frames, sc.tx_batches));
+		fprintf(out, "socketcan.%s.tx_retries %llu\n", name, (unsigned long long)sc.tx_retries);
+		fprintf(out, "socketcan.%s.tx_errors %llu\n", name, (unsigned long long)sc.tx_errors);
+		sent += port->sent;
+		received += port->received;
+		forwarded += port->forwarded;
+	}
+	fprintf(out, "socketcan.interfaces %lu\n", (unsigned long)bench_if_count);
+	fprintf(out, "socketcan.duration_s %lu\n", (unsigned long)duration_s);
+	fprintf(out, "socketcan.sent %llu\n", (unsigned long long)sent);
+	fprintf(out, "socketcan.received %llu\n", (unsigned long long)received);
+	fprintf(out, "socketcan.received_per_s %.1f\n", (double)received / (double)duration_s);
+	fprintf(out, "socketcan.forwarded_per_s %.1f\n", (double)forwarded / (double)duration_s);
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+int main(int argc, char *argv[])
+{
+	const char *path = VT_BENCH_OUTPUT;
+	uint32_t duration_s = VT_BENCH_DURATION_S;
+	uint32_t fps = 0;
+	struct timespec drain = {0, VT_BENCH_DRAIN_NS};
+	FILE *out;
+	uint32_t i;
+	int bad = 0;
+
+	for(i = 1; i < (uint32_t)argc && !bad; i++)
+	{
+		if(strcmp(argv[i], "-f") == 0)
+			bench_forward = 1;
+		else if(argv[i][0] != '-')
+		{
+			if(bench_if_count < VT_SOCKETCAN_INSTANCES)
+				bench_if[bench_if_count++].ifname = argv[i];
+			else
+				bad = 1;
+		}
+		else if((i + 1U) >= (uint32_t)argc)
+			bad = 1;
+		else if(strcmp(argv[i], "-d") == 0)
+			duration_s = (uint32_t)atoi(argv[++i]);
+		else if(strcmp(argv[i], "-r") == 0)
+			fps = (uint32_t)atoi(argv[++i]);
+		else if(strcmp(argv[i], "-o") == 0)
+			path = argv[++i];
+		else
+			bad = 1;
+	}
+	if(bad || bench_if_count == 0 || duration_s == 0)
+	{
+		fprintf(stderr, "usage: %s [-d seconds] [-r fps] [-f] [-o file] if0 [if1 [if2]]\n", argv[0]);
+		return 1;
+	}
+
+	bench_state.callback = _vt_bench_callback;
+	for(i = 0; i < bench_if_count; i++)
+	{
+		vt_bench_if_t *port = &bench_if[i];
+
+		port->fps = fps;
+		vt_probe_hist_reset(&port->latency);
+		port->fd = _vt_bench_open(port->ifname);
+		if(port->fd < 0 || vt_socketcan_set_interface((uint8_t)i, port->ifname) != VT_STATUS_SUCCESS ||
+		   FLEXCAN_DRV_Init((uint8_t)i, &bench_state, &bench_config) != STATUS_SUCCESS)
+		{
+			fprintf(stderr, "%s: cannot open SocketCAN interface\n", port->ifname);
+			return 1;
+		}
+		FLEXCAN_DRV_RxFifo((uint8_t)i, &port->buff[0]);
+	}
+	out = fopen(path, "w");
+	if(out == NULL)
+	{
+		perror(path);
+		return 1;
+	}
+
+	for(i = 0; i < bench_if_count; i++)
+	{
+		if(pthread_create(&bench_if[i].thread, NULL, _vt_bench_generator, &bench_if[i]) != 0)
+		{
+			fprintf(stderr, "cannot start generator\n");
+			return 1;
+		}
+	}
+	sleep(duration_s);
+	VT_ATOMIC_STORE(&bench_stop, 1);
+	for(i = 0; i < bench_if_count; i++)
+		pthread_join(bench_if[i].thread, NULL);
+	nanosleep(&drain, NULL);
+	for(i = 0; i < bench_if_count; i++)
+	{
+		vt_socketcan_close((uint8_t)i);
+		close(bench_if[i].fd);
+	}
+
+	_vt_bench_write(out, duration_s);
+	_vt_bench_write(stdout, duration_s);
+	if(fclose(out) != 0)
+	{
+		perror(path);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,490 @@
+/*
+ * vt_bench_wcet.c
+ *
+ * Host benchmark: worst-case time per call of vt_fw_can_msg_is_malicious(), vt_fw_rcv_msg() and vt_fw_process()
+ * under adversarial rule sets and traffic, and how it grows with the rule count.
+ *
+ *   vt_bench_wcet [-n calls] [-r repeats] [-b frames_per_process] [-s ruleset] [rule_count...]
+ *
+ * Rule sets, loaded with vt_fw_begin_bulk_load() / vt_fw_commit_bulk_load():
+ *   blacklist - malicious frames, half on one Id with payloads that differ in the last bytes only, half on Ids
+ *               that share their low 11 bits, so any hash or mask of the Id collides
+ *   ranges    - blacklist ranges and monitor range lists nested around one Id, every one overlaps every other
+ *   patterns  - monitor patterns of VT_BENCH_PATTERN_LEN frames sharing all but their last frame
+ *   mixed     - a third of each
+ * The traffic of each set is the worst case for it: near misses on the colliding Ids, Ids inside every range, and
+ * the shared prefix of the patterns over and over, with a few hits.
+ *
+ * Durations are in ticks of the probe clock (vt_probe.h): core cycles on target, nanoseconds on host. Each point is
+ * run -r times and max_ticks is the lowest of the maxima, which drops preemption of the host; max_ticks_any is the
+ * highest. On target, run it with interrupts masked and read max_ticks_any. ticks_per_rule is the least squares
+ * slope of max_ticks over the rules staged. Build with VT_FW_BULK_MAX_RULES and VT_FW_BULK_MAX_FRAMES large enough.
+ */
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_fw_if.h"
+#include "vt_fw_rules.h"
+#include "vt_arena.h"
+#include "vt_probe.h"
+
+/*------------------------------------------------------------------*
+ *                          Define Macro                            *
+ *------------------------------------------------------------------*/
+#define VT_BENCH_DEFAULT_CALLS   1000000U
+#define VT_BENCH_DEFAULT_REPEATS 3U
+#define VT_BENCH_DEFAULT_BATCH   8U
+
+/*! Frames of a pattern rule */
+#define VT_BENCH_PATTERN_LEN     16U
+
+/*! Frames of worst-case traffic, replayed in a loop, a power of 2 */
+#define VT_BENCH_TRAFFIC         4096U
+
+/*! Id every blacklist rule collides on, and centre of the nested ranges */
+#define VT_BENCH_COLLIDE_ID      0x123U
+#define VT_BENCH_RANGE_ID        0x400U
+#define VT_BENCH_PATTERN_ID      0x200U
+
+/*! Slot ticks per second of the core, one tick per frame */
+#define VT_BENCH_TICKS_PER_S     5000U
+
+#define VT_BENCH_MAX_POINTS      16U
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef enum _vt_bench_set_t
+{
+	VT_BENCH_BLACKLIST = 0,
+	VT_BENCH_RANGES,
+	VT_BENCH_PATTERNS,
+	VT_BENCH_MIXED,
+	VT_BENCH_SETS
+}vt_bench_set_t;
+
+typedef enum _vt_bench_fn_t
+{
+	VT_BENCH_IS_MALICIOUS = 0,
+	VT_BENCH_RCV_MSG,
+	VT_BENCH_PROCESS,
+	VT_BENCH_FNS
+}vt_bench_fn_t;
+
+typedef struct _vt_bench_point_t
+{
+	uint32_t rules;                 /*!< rules staged, x of the slope */
+	uint32_t max_ticks;             /*!< lowest maximum of the repeats */
+	uint32_t max_ticks_any;         /*!< highest maximum of the repeats */
+	vt_probe_stats_t stats;         /*!< every call of every repeat */
+}vt_bench_point_t;
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+static const char *set_names[VT_BENCH_SETS] = {"blacklist", "ranges", "patterns", "mixed"};
+static const char *fn_names[VT_BENCH_FNS] = {"is_malicious", "rcv_msg", "process"};
+static const uint32_t default_counts[] = {16, 64, 256, 1024, 4096, 10000};
+
+static vt_can_frame_t bench_traffic[VT_BENCH_TRAFFIC];
+static vt_can_frame_t bench_pattern[VT_BENCH_PATTERN_LEN];
+static uint32_t bench_seed = 0x5EED1234;
+static volatile uint32_t bench_sink;
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+static uint32_t _vt_bench_rand(void)
+{
+	bench_seed ^= bench_seed << 13;
+	bench_seed ^= bench_seed >> 17;
+	bench_seed ^= bench_seed << 5;
+	return bench_seed;
+}
+
+static vt_status_t _vt_bench_vector(vt_vector_result_t *vector_t)
+{
+	(void)vector_t;
+	return VT_STATUS_SUCCESS;
+}
+
+static void _vt_bench_traffic_status(vt_car_status_t car_status, float slot_rate, float pattern_rate, uint32_t count_id)
+{
+	(void)car_status;
+	(void)slot_rate;
+	(void)pattern_rate;
+	(void)count_id;
+}
+
+static vt_status_t _vt_bench_detail(vt_fw_detail_result_t *detail_result)
+{
+	bench_sink += detail_result->matched_type;
+	return VT_STATUS_SUCCESS;
+}
+
+static void _vt_bench_frame(vt_can_frame_t *frame, uint32_t msgId, uint8_t fill, uint32_t tag)
+{
+	frame->msgId = msgId;
+	frame->dataLen = VT_MAX_DATA_BYTE_LENGTH;
+	memset(frame->data, fill, VT_MAX_DATA_BYTE_LENGTH);
+	frame->data[VT_MAX_DATA_BYTE_LENGTH - 2] = (uint8_t)(tag >> 8);
+	frame->data[VT_MAX_DATA_BYTE_LENGTH - 1] = (uint8_t)tag;
+}
+
+/*!
+ * @brief  This API will stage the colliding malicious frames.
+ * @param [in]   count - is rules.
+ * @return       rules staged.
+ */
+static uint32_t _vt_bench_add_blacklist(uint32_t count)
+{
+	vt_can_frame_t frame;
+	uint32_t i, staged = 0;
+
+	for(i = 0; i < count; i++)
+	{
+		if((i & 1U) == 0)
+			_vt_bench_frame(&frame, VT_BENCH_COLLIDE_ID, 0xA5, i);
+		else
+			_vt_bench_frame(&frame, ((i + 1U) << 11) | VT_BENCH_COLLIDE_ID, 0xA5, i);
+		staged += (vt_fw_bulk_add_malicious_can_frame(frame.msgId, frame.dataLen, frame.data) == VT_STATUS_SUCCESS);
+	}
+	return staged;
+}
+
+/*!
+ * @brief  This API will stage the nested ranges, they grow into extended Ids when standard Ids run out.
+ * @param [in]   count - is rules.
+ * @return       rules staged.
+ */
+static uint32_t _vt_bench_add_ranges(uint32_t count)
+{
+	uint32_t i, half, from, staged = 0;
+	vt_status_t status;
+
+	for(i = 0; i < count; i++)
+	{
+		half = (i >> 1) + 1U;
+		from = (half < VT_BENCH_RANGE_ID) ? (VT_BENCH_RANGE_ID - half) : 0U;
+		if((i & 1U) == 0)
+			status = vt_fw_bulk_blacklist_add_range_can_id(from, VT_BENCH_RANGE_ID + half, 0);
+		else
+			status = vt_fw_bulk_monitor_add_ids_to_range_list(0, from, VT_BENCH_RANGE_ID + half, 1, 0, 100);
+		staged += (status == VT_STATUS_SUCCESS);
+	}
+	return staged;
+}
+
+/*!
+ * @brief  This API will stage the patterns sharing their first VT_BENCH_PATTERN_LEN - 1 frames, as many as the
+ *         frames of the staging table hold.
+ * @param [in]   count - is rules.
+ * @return       rules staged.
+ */
+static uint32_t _vt_bench_add_patterns(uint32_t count)
+{
+	uint32_t i, f, staged = 0;
+
+	for(f = 0; f < VT_BENCH_PATTERN_LEN - 1U; f++)
+		_vt_bench_frame(&bench_pattern[f], VT_BENCH_PATTERN_ID + f, 0x5A, f);
+	for(i = 0; i < count; i++)
+	{
+		_vt_bench_frame(&bench_pattern[VT_BENCH_PATTERN_LEN - 1U], VT_BENCH_PATTERN_ID + VT_BENCH_PATTERN_LEN, 0x5A, i);
+		staged += (vt_fw_bulk_monitor_add_pattern(bench_pattern, VT_BENCH_PATTERN_LEN, 0, 1, 10) == VT_STATUS_SUCCESS);
+	}
+	return staged;
+}
+
+/*!
+ * @brief  This API will load a rule set on a fresh core.
+ * @param [in]   set - is vt_bench_set_t.
+ * @param [in]   count - is rules.
+ * @param [out]  *staged - pointer to rules staged.
+ * @return       status of the commit.
+ */
+static vt_status_t _vt_bench_load(vt_bench_set_t set, uint32_t count, uint32_t *staged)
+{
+	vt_fw_init(car_policy, car_vector);
+	vt_fw_set_slot_time_unit(1000000U / VT_BENCH_TICKS_PER_S);
+	vt_fw_install_vector_callback(_vt_bench_vector);
+	vt_fw_install_traffic_status_callback(_vt_bench_traffic_status);
+	vt_fw_install_blacklist_callback(_vt_bench_detail);
+	vt_fw_install_monitor_callback(_vt_bench_detail);
+
+	vt_fw_begin_bulk_load();
+	switch(set)
+	{
+	case VT_BENCH_BLACKLIST:
+		*staged = _vt_bench_add_blacklist(count);
+		break;
+	case VT_BENCH_RANGES:
+		*staged = _vt_bench_add_ranges(count);
+		break;
+	case VT_BENCH_PATTERNS:
+		*staged = _vt_bench_add_patterns(count);
+		break;
+	default:
+		*staged = _vt_bench_add_blacklist(count / 3U);
+		*staged += _vt_bench_add_ranges(count / 3U);
+		*staged += _vt_bench_add_patterns(count - 2U * (count / 3U));
+		break;
+	}
+	return vt_fw_commit_bulk_load();
+}
+
+/*!
+ * @brief  This API will build the worst-case traffic of a rule set, one frame in 64 is a hit.
+ * @param [in]   set - is vt_bench_set_t.
+ * @param [in]   count - is rules.
+ * @return       none.
+ */
+static void _vt_bench_make_traffic(vt_bench_set_t set, uint32_t count)
+{
+	vt_can_frame_t *frame;
+	uint32_t i, kind, pos;
+
+	for(i = 0; i < VT_BENCH_TRAFFIC; i++)
+	{
+		frame = &bench_traffic[i];
+		kind = (set == VT_BENCH_MIXED) ? (i % 3U) : (uint32_t)set;
+		switch(kind)
+		{
+		case VT_BENCH_BLACKLIST:
+			/* Same Id and payload as every rule but for the tag */
+			if((i & 63U) == 0)
+				_vt_bench_frame(frame, VT_BENCH_COLLIDE_ID, 0xA5, (_vt_bench_rand() % count) & ~1U);
+			else if((i & 1U) == 0)
+				_vt_bench_frame(frame, VT_BENCH_COLLIDE_ID, 0xA5, 0xFFFF);
+			else
+				_vt_bench_frame(frame, ((_vt_bench_rand() % (count + 1U) + 1U) << 11) | VT_BENCH_COLLIDE_ID, 0xA5, 0xFFFE);
+			break;
+		case VT_BENCH_RANGES:
+			_vt_bench_frame(frame, VT_BENCH_RANGE_ID + (_vt_bench_rand() % 3U) - 1U, 0x00, i);
+			break;
+		default:
+			/* The shared prefix again and again, every fourth time completed by the last frame of a pattern */
+			pos = i % VT_BENCH_PATTERN_LEN;
+			if(pos < VT_BENCH_PATTERN_LEN - 1U)
+				_vt_bench_frame(frame, VT_BENCH_PATTERN_ID + pos, 0x5A, pos);
+			else if(((i / VT_BENCH_PATTERN_LEN) & 3U) == 0)
+				_vt_bench_frame(frame, VT_BENCH_PATTERN_ID + VT_BENCH_PATTERN_LEN, 0x5A, _vt_bench_rand() % count);
+			else
+				_vt_bench_frame(frame, VT_BENCH_PATTERN_ID + VT_BENCH_PATTERN_LEN, 0x5A, 0xFFFF);
+			break;
+		}
+	}
+}
+
+/*!
+ * @brief  This API will time every call of the three entry points over the traffic of a rule set.
+ * @param [in]   calls - is frames, each one is checked and received.
+ * @param [in]   batch - is frames received between two vt_fw_process().
+ * @param [out]  *hist - pointer to VT_BENCH_FNS vt_probe_hist_t structures, accumulated.
+ * @param [out]  *max - pointer to VT_BENCH_FNS maxima of this run.
+ * @return       none.
+ */
+static void _vt_bench_measure(uint32_t calls, uint32_t batch, vt_probe_hist_t *hist, uint32_t *max)
+{
+	vt_can_frame_t *frame;
+	uint32_t i, t0, ticks, fn;
+	uint32_t d[VT_BENCH_FNS];
+
+	memset(max, 0, VT_BENCH_FNS * sizeof(uint32_t));
+	for(i = 0; i < calls; i++)
+	{
+		frame = &bench_traffic[i & (VT_BENCH_TRAFFIC - 1U)];
+
+		t0 = vt_probe_now();
+		bench_sink += vt_fw_can_msg_is_malicious(frame->msgId, frame->dataLen, frame->data);
+		d[VT_BENCH_IS_MALICIOUS] = vt_probe_now() - t0;
+
+		t0 = vt_probe_now();
+		vt_fw_rcv_msg(frame->msgId, frame->dataLen, frame->data);
+		d[VT_BENCH_RCV_MSG] = vt_probe_now() - t0;
+
+		/* One slot tick per frame, the core closes its windows on the second */
+		vt_fw_increase_slot_tick_count();
+		if(((i + 1U) % VT_BENCH_TICKS_PER_S) == 0)
+			vt_fw_increase_system_time();
+
+		for(fn = VT_BENCH_IS_MALICIOUS; fn <= VT_BENCH_RCV_MSG; fn++)
+		{
+			vt_probe_hist_record(&hist[fn], d[fn]);
+			if(d[fn] > max[fn])
+				max[fn] = d[fn];
+		}
+
+		if(((i + 1U) % batch) == 0)
+		{
+			t0 = vt_probe_now();
+			vt_fw_process();
+			ticks = vt_probe_now() - t0;
+			vt_probe_hist_record(&hist[VT_BENCH_PROCESS], ticks);
+			if(ticks > max[VT_BENCH_PROCESS])
+				max[VT_BENCH_PROCESS] = ticks;
+		}
+	}
+}
+
+/*!
+ * @brief  This API will get the lowest duration of two back to back reads of the probe clock.
+ * @param [in]   none.
+ * @return       ticks.
+ */
+static uint32_t _vt_bench_clock_overhead(void)
+{
+	uint32_t i, t0, ticks, best = 0xFFFFFFFFUL;
+
+	for(i = 0; i < 10000U; i++)
+	{
+		t0 = vt_probe_now();
+		ticks = vt_probe_now() - t0;
+		if(ticks < best)
+			best = ticks;
+	}
+	return best;
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+int main(int argc, char *argv[])
+{
+	vt_bench_point_t points[VT_BENCH_FNS][VT_BENCH_MAX_POINTS];
+	vt_probe_hist_t hist[VT_BENCH_FNS];
+	uint32_t counts[VT_BENCH_MAX_POINTS];
+	uint32_t max[VT_BENCH_FNS];
+	uint32_t calls = VT_BENCH_DEFAULT_CALLS;
+	uint32_t repeats = VT_BENCH_DEFAULT_REPEATS;
+	uint32_t batch = VT_BENCH_DEFAULT_BATCH;
+	uint32_t npoints = 0, p, r, fn, set, first_set = 0, last_set = VT_BENCH_SETS - 1U;
+	uint32_t arena_size;
+	void *arena_buff;
+	vt_status_t status, result;
+	uint32_t staged = 0;
+	double sx, sy, sxx, sxy, slope;
+	int i, bad = 0;
+
+	for(i = 1; i < argc && !bad; i++)
+	{
+		if(strcmp(argv[i], "-n") == 0 && (i + 1) < argc)
+			calls = (uint32_t)atoi(argv[++i]);
+		else if(strcmp(argv[i], "-r") == 0 && (i + 1) < argc)
+			repeats = (uint32_t)atoi(argv[++i]);
+		else if(strcmp(argv[i], "-b") == 0 && (i + 1) < argc)
+			batch = (uint32_t)atoi(argv[++i]);
+		else if(strcmp(argv[i], "-s") == 0 && (i + 1) < argc)
+		{
+			i++;
+			for(set = 0; set < VT_BENCH_SETS && strcmp(argv[i], set_names[set]) != 0; set++)
+				;
+			bad = (set >= VT_BENCH_SETS);
+			first_set = last_set = set;
+		}
+		else if(argv[i][0] != '-' && npoints < VT_BENCH_MAX_POINTS)
+			counts[npoints++] = (uint32_t)atoi(argv[i]);
+		else
+			bad = 1;
+	}
+	if(npoints == 0)
+	{
+		for(p = 0; p < sizeof(default_counts) / sizeof(default_counts[0]); p++)
+		{
+			if(default_counts[p] <= VT_FW_BULK_MAX_RULES)
+				counts[npoints++] = default_counts[p];
+		}
+	}
+	for(p = 0; p < npoints; p++)
+	{
+		if(counts[p] == 0 || counts[p] > VT_FW_BULK_MAX_RULES)
+			bad = 1;
+	}
+	if(bad || calls == 0 || repeats == 0 || batch == 0)
+	{
+		fprintf(stderr, "usage: %s [-n calls] [-r repeats] [-b frames_per_process] [-s blacklist|ranges|patterns|mixed] "
+		        "[rule_count...]\nrule counts must be 1..%d for this build\n", argv[0], VT_FW_BULK_MAX_RULES);
+		return 1;
+	}
+
+	/* The staging table is carved from the rules arena, size it for the largest build */
+	arena_size = VT_FW_BULK_MAX_RULES * 32U + VT_FW_BULK_MAX_FRAMES * sizeof(vt_can_frame_t) + 64U;
+	arena_buff = malloc(arena_size);
+	if(arena_buff == NULL)
+		return 1;
+	vt_arena_init(VT_ARENA_RULES, arena_buff, arena_size);
+	vt_probe_clock_init();
+
+	printf("wcet.tick_hz %lu\n", (unsigned long)VT_PROBE_TICK_HZ);
+	printf("wcet.clock_overhead_ticks %u\n", (unsigned)_vt_bench_clock_overhead());
+	printf("wcet.calls %u\n", (unsigned)calls);
+	printf("wcet.repeats %u\n", (unsigned)repeats);
+	printf("wcet.frames_per_process %u\n", (unsigned)batch);
+
+	for(set = first_set; set <= last_set; set++)
+	{
+		for(p = 0; p < npoints; p++)
+		{
+			for(fn = 0; fn < VT_BENCH_FNS; fn++)
+			{
+				vt_probe_hist_reset(&hist[fn]);
+				points[fn][p].max_ticks = 0xFFFFFFFFUL;
+				points[fn][p].max_ticks_any = 0;
+			}
+			bench_seed = 0x5EED1234;
+			_vt_bench_make_traffic((vt_bench_set_t)set, counts[p]);
+
+			status = VT_STATUS_SUCCESS;
+			for(r = 0; r < repeats; r++)
+			{
+				result = _vt_bench_load((vt_bench_set_t)set, counts[p], &staged);
+				if(result != VT_STATUS_SUCCESS)
+					status = result;
+				_vt_bench_measure(calls, batch, hist, max);
+				vt_fw_close();
+				for(fn = 0; fn < VT_BENCH_FNS; fn++)
+				{
+					if(max[fn] < points[fn][p].max_ticks)
+						points[fn][p].max_ticks = max[fn];
+					if(max[fn] > points[fn][p].max_ticks_any)
+						points[fn][p].max_ticks_any = max[fn];
+				}
+			}
+
+			for(fn = 0; fn < VT_BENCH_FNS; fn++)
+				points[fn][p].rules = staged;
+			printf("wcet.%s.rules_staged.%u %u\n", set_names[set], (unsigned)counts[p], (unsigned)staged);
+			printf("wcet.%s.commit_status.%u %d\n", set_names[set], (unsigned)counts[p], (int)status);
+			for(fn = 0; fn < VT_BENCH_FNS; fn++)
+			{
+				vt_probe_hist_get_stats(&hist[fn], &points[fn][p].stats);
+				printf("wcet.%s.%s.max_ticks.%u %u\n", set_names[set], fn_names[fn], (unsigned)counts[p],
+				       (unsigned)points[fn][p].max_ticks);
+				printf("wcet.%s.%s.max_ticks_any.%u %u\n", set_names[set], fn_names[fn], (unsigned)counts[p],
+				       (unsigned)points[fn][p].max_ticks_any);
+				printf("wcet.%s.%s.p99_ns.%u %u\n", set_names[set], fn_names[fn], (unsigned)counts[p],
+				       (unsigned)points[fn][p].stats.p99_ns);
+			}
+			fflush(stdout);
+		}
+
+		/* Growth of the worst case with the rule count */
+		for(fn = 0; fn < VT_BENCH_FNS; fn++)
+		{
+			sx = sy = sxx = sxy = 0.0;
+			for(p = 0; p < npoints; p++)
+			{
+				sx += (double)points[fn][p].rules;
+				sy += (double)points[fn][p].max_ticks;
+				sxx += (double)points[fn][p].rules * (double)points[fn][p].rules;
+				sxy += (double)points[fn][p].rules * (double)points[fn][p].max_ticks;
+			}
+			slope = ((double)npoints * sxx - sx * sx);
+			slope = (slope != 0.0) ? (((double)npoints * sxy - sx * sy) / slope) : 0.0;
+			printf("wcet.%s.%s.ticks_per_rule %.4f\n", set_names[set], fn_names[fn], slope);
+		}
+	}
+
+	free(arena_buff);
+	return 0;
+}
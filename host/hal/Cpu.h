@@ -0,0 +1,57 @@
+/*
+ * Cpu.h
+ *
+ * Host stand-in for the header generated by the S32 Design Studio: the status codes and the SIUL2 registers
+ * used by the agent. See vt_hal_mock.h.
+ */
+
+#ifndef CPU_H_
+#define CPU_H_
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef enum
+{
+	STATUS_SUCCESS                          = 0x000U,
+	STATUS_ERROR                            = 0x001U,
+	STATUS_BUSY                             = 0x002U,
+	STATUS_TIMEOUT                          = 0x003U,
+	STATUS_UNSUPPORTED                      = 0x004U,
+	STATUS_FLEXCAN_MB_OUT_OF_RANGE          = 0x300U,
+	STATUS_FLEXCAN_NO_TRANSFER_IN_PROGRESS  = 0x301U
+}status_t;
+
+typedef struct
+{
+	volatile uint32_t MSCR[512];
+	volatile uint32_t GPDO[128];
+}SIUL2_Type;
+
+/*------------------------------------------------------------------*
+ *                          Define macro                            *
+ *------------------------------------------------------------------*/
+#define SIUL2_MSCR_OBE(x)           ((uint32_t)(x) << 25)
+#define SIUL2_GPDO_PDO_4n_SHIFT     24U
+#define SIUL2_GPDO_PDO_4n_WIDTH     1U
+
+/*! Pin registers live in memory on host */
+extern SIUL2_Type vt_hal_siul2;
+#define SIUL2 (&vt_hal_siul2)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CPU_H_ */
@@ -0,0 +1,12 @@
+/*
+ * clockMan1.h
+ *
+ * Host stand-in for the clock manager configuration, clocks are not modelled.
+ */
+
+#ifndef clockMan1_H
+#define clockMan1_H
+
+#include "Cpu.h"
+
+#endif /* clockMan1_H */
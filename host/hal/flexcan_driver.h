@@ -0,0 +1,169 @@
+/*
+ * flexcan_driver.h
+ *
+ * Host stand-in for the FlexCAN driver of the S32 SDK, implemented by vt_hal_mock.c. Only the calls and types
+ * used by the agent are provided, with the SDK signatures.
+ */
+
+#ifndef FLEXCAN_DRIVER_H
+#define FLEXCAN_DRIVER_H
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "Cpu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef enum
+{
+	FLEXCAN_MSG_ID_STD,
+	FLEXCAN_MSG_ID_EXT
+}flexcan_msgbuff_id_type_t;
+
+typedef enum
+{
+	FLEXCAN_EVENT_RX_COMPLETE,
+	FLEXCAN_EVENT_RXFIFO_COMPLETE,
+	FLEXCAN_EVENT_RXFIFO_WARNING,
+	FLEXCAN_EVENT_RXFIFO_OVERFLOW,
+	FLEXCAN_EVENT_TX_COMPLETE,
+	FLEXCAN_EVENT_ERROR
+}flexcan_event_type_t;
+
+typedef enum
+{
+	FLEXCAN_CLK_SOURCE_FXOSC,
+	FLEXCAN_CLK_SOURCE_PERIPH
+}flexcan_clk_source_t;
+
+typedef enum
+{
+	FLEXCAN_RX_FIFO_ID_FILTERS_8,
+	FLEXCAN_RX_FIFO_ID_FILTERS_16,
+	FLEXCAN_RX_FIFO_ID_FILTERS_24,
+	FLEXCAN_RX_FIFO_ID_FILTERS_32,
+	FLEXCAN_RX_FIFO_ID_FILTERS_40,
+	FLEXCAN_RX_FIFO_ID_FILTERS_48
+}flexcan_rx_fifo_id_filter_num_t;
+
+typedef enum
+{
+	FLEXCAN_NORMAL_MODE,
+	FLEXCAN_LISTEN_ONLY_MODE,
+	FLEXCAN_LOOPBACK_MODE,
+	FLEXCAN_FREEZE_MODE,
+	FLEXCAN_DISABLE_MODE
+}flexcan_operation_modes_t;
+
+typedef enum
+{
+	FLEXCAN_PAYLOAD_SIZE_8,
+	FLEXCAN_PAYLOAD_SIZE_16,
+	FLEXCAN_PAYLOAD_SIZE_32,
+	FLEXCAN_PAYLOAD_SIZE_64
+}flexcan_fd_payload_size_t;
+
+typedef enum
+{
+	FLEXCAN_RXFIFO_USING_INTERRUPTS,
+	FLEXCAN_RXFIFO_USING_DMA
+}flexcan_rxfifo_transfer_type_t;
+
+typedef enum
+{
+	FLEXCAN_RX_FIFO_ID_FORMAT_A,
+	FLEXCAN_RX_FIFO_ID_FORMAT_B,
+	FLEXCAN_RX_FIFO_ID_FORMAT_C,
+	FLEXCAN_RX_FIFO_ID_FORMAT_D
+}flexcan_rx_fifo_id_element_format_t;
+
+typedef struct
+{
+	uint32_t cs;
+	uint32_t msgId;
+	uint8_t data[64];
+	uint8_t dataLen;
+}flexcan_msgbuff_t;
+
+struct FlexCANState;
+
+typedef void (*flexcan_callback_t)(uint8_t instance, flexcan_event_type_t eventType, struct FlexCANState *flexcanState);
+
+typedef void (*flexcan_error_callback_t)(uint8_t instance, flexcan_event_type_t eventType, struct FlexCANState *flexcanState);
+
+typedef struct FlexCANState
+{
+	flexcan_callback_t callback;
+	void *callbackParam;
+	flexcan_error_callback_t error_callback;
+	void *errorCallbackParam;
+}flexcan_state_t;
+
+typedef struct
+{
+	flexcan_msgbuff_id_type_t msg_id_type;
+	uint32_t data_length;
+	bool fd_enable;
+	uint8_t fd_padding;
+	bool enable_brs;
+	bool is_remote;
+}flexcan_data_info_t;
+
+typedef struct
+{
+	uint32_t propSeg;
+	uint32_t phaseSeg1;
+	uint32_t phaseSeg2;
+	uint32_t preDivider;
+	uint32_t rJumpwidth;
+}flexcan_time_segment_t;
+
+typedef struct
+{
+	uint32_t max_num_mb;
+	flexcan_rx_fifo_id_filter_num_t num_id_filters;
+	bool is_rx_fifo_needed;
+	flexcan_operation_modes_t flexcanMode;
+	flexcan_fd_payload_size_t payload;
+	bool fd_enable;
+	flexcan_clk_source_t pe_clock;
+	flexcan_time_segment_t bitrate;
+	flexcan_time_segment_t bitrate_cbt;
+	flexcan_rxfifo_transfer_type_t transfer_type;
+	uint8_t rxFifoDMAChannel;
+}flexcan_user_config_t;
+
+typedef struct
+{
+	bool isRemoteFrame;
+	bool isExtendedFrame;
+	uint32_t *idFilter;
+}flexcan_id_table_t;
+
+/*------------------------------------------------------------------*
+ *                       Function Prototypes                        *
+ *------------------------------------------------------------------*/
+status_t FLEXCAN_DRV_Init(uint8_t instance, flexcan_state_t *state, const flexcan_user_config_t *data);
+void FLEXCAN_DRV_SetBitrate(uint8_t instance, const flexcan_time_segment_t *bitrate);
+status_t FLEXCAN_DRV_ConfigTxMb(uint8_t instance, uint8_t mb_idx, const flexcan_data_info_t *tx_info, uint32_t msg_id);
+status_t FLEXCAN_DRV_Send(uint8_t instance, uint8_t mb_idx, const flexcan_data_info_t *tx_info, uint32_t msg_id, const uint8_t *mb_data);
+status_t FLEXCAN_DRV_GetTransferStatus(uint8_t instance, uint8_t mb_idx);
+status_t FLEXCAN_DRV_AbortTransfer(uint8_t instance, uint8_t mb_idx);
+status_t FLEXCAN_DRV_RxFifo(uint8_t instance, flexcan_msgbuff_t *data);
+status_t FLEXCAN_DRV_RxFifoBlocking(uint8_t instance, flexcan_msgbuff_t *data, uint32_t timeout_ms);
+void FLEXCAN_DRV_SetRxFifoGlobalMask(uint8_t instance, flexcan_msgbuff_id_type_t id_type, uint32_t mask);
+void FLEXCAN_DRV_SetRxMbGlobalMask(uint8_t instance, flexcan_msgbuff_id_type_t id_type, uint32_t mask);
+void FLEXCAN_DRV_ConfigRxFifo(uint8_t instance, flexcan_rx_fifo_id_element_format_t id_format, const flexcan_id_table_t *id_filter_table);
+void FLEXCAN_DRV_InstallErrorCallback(uint8_t instance, flexcan_error_callback_t callback, void *callbackParam);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLEXCAN_DRIVER_H */
@@ -0,0 +1,57 @@
+/*
+ * pit_driver.h
+ *
+ * Host stand-in for the PIT driver of the S32 SDK, implemented by vt_hal_mock.c on the virtual clock.
+ */
+
+#ifndef PIT_DRIVER_H
+#define PIT_DRIVER_H
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "Cpu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef enum
+{
+	PIT_PERIOD_UNITS_COUNTS,
+	PIT_PERIOD_UNITS_MICROSECONDS
+}pit_period_units_t;
+
+typedef struct
+{
+	bool enableStandardTimers;
+	bool enableRTITimer;
+	bool stopRunInDebug;
+}pit_config_t;
+
+typedef struct
+{
+	uint32_t hwChannel;
+	pit_period_units_t periodUnit;
+	uint32_t period;
+	bool enableChain;
+	bool enableInterrupt;
+}pit_channel_config_t;
+
+/*------------------------------------------------------------------*
+ *                       Function Prototypes                        *
+ *------------------------------------------------------------------*/
+void PIT_DRV_Init(uint32_t instance, const pit_config_t *config);
+status_t PIT_DRV_InitChannel(uint32_t instance, const pit_channel_config_t *chnlConfig);
+void PIT_DRV_StartChannel(uint32_t instance, uint32_t channel);
+void PIT_DRV_StopChannel(uint32_t instance, uint32_t channel);
+void PIT_DRV_ClearStatusFlags(uint32_t instance, uint32_t channel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIT_DRIVER_H */
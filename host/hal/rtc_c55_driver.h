@@ -0,0 +1,78 @@
+/*
+ * rtc_c55_driver.h
+ *
+ * Host stand-in for the RTC driver of the S32 SDK, implemented by vt_hal_mock.c on the virtual clock.
+ */
+
+#ifndef RTC_C55_DRIVER_H
+#define RTC_C55_DRIVER_H
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "Cpu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef enum
+{
+	RTC_CLOCK_SOURCE_SXOSC,
+	RTC_CLOCK_SOURCE_SIRC,
+	RTC_CLOCK_SOURCE_FIRC,
+	RTC_CLOCK_SOURCE_XOSC
+}rtc_clk_select_t;
+
+typedef struct
+{
+	rtc_clk_select_t clockSelect;
+	bool divideBy32;
+	bool divideBy512;
+	bool freezeEnable;
+	bool nonSupervisorAccessEnable;
+}rtc_init_config_t;
+
+typedef struct
+{
+	uint16_t year;
+	uint16_t month;
+	uint16_t day;
+	uint16_t hour;
+	uint16_t minutes;
+	uint8_t seconds;
+}rtc_timedate_t;
+
+typedef struct
+{
+	uint32_t startTime;             /*!< seconds of the time set when the counter started */
+}rtc_state_t;
+
+typedef struct
+{
+	rtc_timedate_t alarmTime;
+	uint32_t repetitionInterval;
+	uint32_t numberOfRepeats;
+	bool repeatForever;
+	bool alarmIntEnable;
+	void (*alarmCallback)(void *callbackParam);
+	void *callbackParams;
+}rtc_alarm_config_t;
+
+/*------------------------------------------------------------------*
+ *                       Function Prototypes                        *
+ *------------------------------------------------------------------*/
+status_t RTC_DRV_Init(uint32_t instance, rtc_state_t *state, const rtc_init_config_t *config);
+status_t RTC_DRV_SetTimeDate(uint32_t instance, const rtc_timedate_t *time);
+status_t RTC_DRV_GetTimeDate(uint32_t instance, rtc_timedate_t *time);
+status_t RTC_DRV_StartCounter(uint32_t instance);
+status_t RTC_DRV_ConfigureAlarm(uint32_t instance, rtc_alarm_config_t *alarmConfig);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RTC_C55_DRIVER_H */
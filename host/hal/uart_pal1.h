@@ -0,0 +1,36 @@
+/*
+ * uart_pal1.h
+ *
+ * Host stand-in for the UART peripheral abstraction of the S32 SDK, implemented by vt_hal_mock.c. Bytes sent
+ * are captured and read back with vt_hal_uart_read().
+ */
+
+#ifndef UART_PAL1_H
+#define UART_PAL1_H
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "Cpu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                          Define macro                            *
+ *------------------------------------------------------------------*/
+#define INST_UART_PAL1 (0U)
+
+/*------------------------------------------------------------------*
+ *                       Function Prototypes                        *
+ *------------------------------------------------------------------*/
+status_t UART_SendData(uint32_t instance, const uint8_t *txBuff, uint32_t txSize);
+status_t UART_SendDataBlocking(uint32_t instance, const uint8_t *txBuff, uint32_t txSize, uint32_t timeout);
+status_t UART_GetTransmitStatus(uint32_t instance, uint32_t *bytesRemaining);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UART_PAL1_H */
@@ -0,0 +1,1757 @@
+/*
+ * vt_hal_mock.c
+ *
+ * Mock FlexCAN, PIT, RTC, UART and SIUL2 drivers for the host build, see vt_hal_mock.h.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include <string.h>
+#include "vt_hal_mock.h"
+
+/*------------------------------------------------------------------*
+ *                          Define Macro                            *
+ *------------------------------------------------------------------*/
+#define VT_HAL_CAN_TX_MASK          (VT_HAL_CAN_TX_CAPTURE - 1U)
+#define VT_HAL_UART_MASK            (VT_HAL_UART_CAPTURE - 1U)
+#define VT_HAL_BUS_NODE_MASK        (VT_HAL_BUS_NODE_QUEUE - 1U)
+
+#if (VT_HAL_CAN_TX_CAPTURE & VT_HAL_CAN_TX_MASK) != 0
+#error "VT_HAL_CAN_TX_CAPTURE must be a power of 2"
+#endif
+#if (VT_HAL_UART_CAPTURE & VT_HAL_UART_MASK) != 0
+#error "VT_HAL_UART_CAPTURE must be a power of 2"
+#endif
+#if (VT_HAL_BUS_NODE_QUEUE & VT_HAL_BUS_NODE_MASK) != 0
+#error "VT_HAL_BUS_NODE_QUEUE must be a power of 2"
+#endif
+
+/*! PIT clock used to convert periods given in counts */
+#define VT_HAL_PIT_CLOCK_MHZ        40U
+
+#define VT_HAL_US_PER_SECOND        1000000ULL
+#define VT_HAL_NS_PER_US            1000ULL
+
+/*! Senders of a bus: the FlexCAN instances, then the external nodes */
+#define VT_HAL_BUS_SENDERS          (VT_HAL_CAN_INSTANCES + VT_HAL_BUS_MAX_NODES)
+#define VT_HAL_BUS_NO_SENDER        0xFFU
+
+/*! Bits after the CRC of a frame: CRC delimiter, ACK slot, ACK delimiter and EOF */
+#define VT_HAL_BUS_TAIL_BITS        10U
+#define VT_HAL_BUS_IFS_BITS         3U
+/*! Error flag and error delimiter */
+#define VT_HAL_BUS_ERROR_BITS       14U
+/*! Bits a node at another bitrate lets through before it flags a stuff or form error */
+#define VT_HAL_BUS_MISMATCH_BITS    16U
+/*! Longest frame before stuffing: extended Id, 8 bytes and the CRC */
+#define VT_HAL_BUS_MAX_BITS         128U
+
+#define VT_HAL_CAN_ERROR_PASSIVE    128U
+#define VT_HAL_CAN_BUS_OFF          256U
+#define VT_HAL_CAN_BUS_OFF_BITS     (128U * 11U)
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef enum _vt_hal_fire_t
+{
+	VT_HAL_FIRE_NONE = 0,
+	VT_HAL_FIRE_BUS,
+	VT_HAL_FIRE_RX,
+	VT_HAL_FIRE_PIT,
+	VT_HAL_FIRE_RTC
+}vt_hal_fire_t;
+
+typedef enum _vt_hal_bus_outcome_t
+{
+	VT_HAL_BUS_OK = 0,
+	VT_HAL_BUS_ERR_CRC,             /*!< injected error, flagged after the ACK delimiter */
+	VT_HAL_BUS_ERR_ACK,             /*!< nobody acknowledged */
+	VT_HAL_BUS_ERR_BIT,             /*!< two senders with the same arbitration field and another payload */
+	VT_HAL_BUS_ERR_FORM             /*!< a node at another bitrate took part */
+}vt_hal_bus_outcome_t;
+
+typedef struct _vt_hal_frame_t
+{
+	uint32_t msgId;
+	uint8_t dataLen;
+	uint8_t extended;
+	uint8_t data[8];
+}vt_hal_frame_t;
+
+typedef struct _vt_hal_errc_t
+{
+	uint32_t tec;
+	uint32_t rec;
+	uint64_t recover_ns;            /*!< end of the bus-off state */
+	uint8_t bus_off;
+}vt_hal_errc_t;
+
+typedef struct _vt_hal_can_t
+{
+	flexcan_state_t *state;
+	uint32_t max_num_mb;
+	uint8_t initialized;
+	uint8_t manual_complete;        /*!< 0: mailboxes complete on the next clock step */
+	uint8_t delivering;             /*!< a callback is running, frames are delivered by the outer loop */
+	uint8_t error_enabled;          /*!< error interrupts enabled by FLEXCAN_DRV_InstallErrorCallback */
+	flexcan_msgbuff_t *rx_buff;     /*!< buffer armed by FLEXCAN_DRV_RxFifo */
+	flexcan_msgbuff_t rx_fifo[VT_HAL_CAN_RX_FIFO_DEPTH];
+	uint32_t rx_head;
+	uint32_t rx_count;
+	uint8_t mb_busy[VT_HAL_CAN_MAX_MB];
+	flexcan_msgbuff_t tx_capture[VT_HAL_CAN_TX_CAPTURE];
+	uint32_t tx_head;
+	uint32_t tx_tail;
+	vt_hal_can_stats_t stats;
+	uint8_t bus;                    /*!< bus number + 1, 0 when frames are delivered at once */
+	uint8_t listen_only;
+	uint32_t bitrate;               /*!< from the time segments, bit/s */
+	vt_hal_frame_t mb_frame[VT_HAL_CAN_MAX_MB];
+	uint64_t mb_ready_ns[VT_HAL_CAN_MAX_MB];
+	uint32_t rx_service_ns;
+	uint64_t rx_ready_ns;           /*!< the RX interrupt can take the next frame of the FIFO */
+	vt_hal_errc_t errc;
+}vt_hal_can_t;
+
+typedef struct _vt_hal_node_t
+{
+	vt_hal_frame_t queue[VT_HAL_BUS_NODE_QUEUE];
+	uint64_t ready_ns[VT_HAL_BUS_NODE_QUEUE];
+	uint32_t head;
+	uint32_t count;
+	vt_hal_errc_t errc;
+	vt_hal_bus_node_stats_t stats;
+}vt_hal_node_t;
+
+/*! Frame a sender puts up for arbitration */
+typedef struct _vt_hal_tx_t
+{
+	const vt_hal_frame_t *frame;
+	uint32_t key;                   /*!< arbitration field, lower wins */
+	uint8_t mb_idx;
+}vt_hal_tx_t;
+
+typedef struct _vt_hal_bus_t
+{
+	uint32_t bitrate;               /*!< 0 when the bus is not initialized */
+	uint32_t node_count;
+	vt_hal_node_t nodes[VT_HAL_BUS_MAX_NODES];
+	uint64_t free_ns;               /*!< end of the intermission of the last frame */
+	uint32_t inject_errors;
+	/* Frame on the bus */
+	uint8_t busy;
+	uint8_t sender;
+	uint8_t rival;                  /*!< second sender of the same frame, or VT_HAL_BUS_NO_SENDER */
+	uint8_t mb_idx;
+	uint8_t rival_mb_idx;
+	uint8_t aborted;                /*!< mailbox aborted or instance re-initialized while on the bus */
+	vt_hal_bus_outcome_t outcome;
+	vt_hal_frame_t frame;
+	uint64_t start_ns;
+	uint64_t end_ns;
+	vt_hal_bus_stats_t stats;
+}vt_hal_bus_t;
+
+typedef struct _vt_hal_pit_t
+{
+	void (*handler)(void);
+	uint64_t period_us;
+	uint64_t next_us;
+	uint8_t running;
+}vt_hal_pit_t;
+
+typedef struct _vt_hal_rtc_t
+{
+	rtc_timedate_t base;            /*!< time set, year and month are kept as they are */
+	uint64_t base_us;               /*!< virtual clock when the time was set */
+	uint8_t running;
+	rtc_alarm_config_t alarm;
+	uint64_t alarm_us;              /*!< virtual clock of the next alarm */
+	uint32_t alarm_left;            /*!< repeats left when the alarm does not repeat forever */
+	uint8_t alarm_armed;
+}vt_hal_rtc_t;
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+static uint64_t hal_clock_us = 0;
+static uint32_t hal_clock_frac_ns = 0;  /* time of a bus event within the microsecond */
+static uint32_t hal_cpu_ns = 0;         /* time taken by polls, not yet on the clock */
+static uint8_t hal_advancing = 0;
+static vt_hal_bus_t hal_bus[VT_HAL_BUS_COUNT];
+static vt_hal_can_t hal_can[VT_HAL_CAN_INSTANCES];
+static vt_hal_pit_t hal_pit[VT_HAL_PIT_CHANNELS];
+static vt_hal_rtc_t hal_rtc;
+static uint8_t hal_uart[VT_HAL_UART_CAPTURE];
+static uint32_t hal_uart_head = 0;
+static uint32_t hal_uart_tail = 0;
+
+/*------------------------------------------------------------------*
+ *                        Global Data Types                         *
+ *------------------------------------------------------------------*/
+SIUL2_Type vt_hal_siul2;
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+static uint64_t _vt_hal_now_ns(void)
+{
+	return hal_clock_us * VT_HAL_NS_PER_US + hal_clock_frac_ns;
+}
+
+/*!
+ * @brief  This API will move the virtual clock to an event, never backwards.
+ * @param [in]   ns - is time in ns.
+ * @return       none.
+ */
+static void _vt_hal_clock_set(uint64_t ns)
+{
+	if(ns <= _vt_hal_now_ns())
+		return;
+	hal_clock_us = ns / VT_HAL_NS_PER_US;
+	hal_clock_frac_ns = (uint32_t)(ns % VT_HAL_NS_PER_US);
+}
+
+/*!
+ * @brief  This API will get a FlexCAN instance.
+ * @param [in]   instance - is FlexCAN instance.
+ * @return       pointer to vt_hal_can_t structure, or NULL if the instance is not modelled.
+ */
+static vt_hal_can_t *_vt_hal_can(uint8_t instance)
+{
+	return (instance < VT_HAL_CAN_INSTANCES) ? &hal_can[instance] : NULL;
+}
+
+/*!
+ * @brief  This API will raise a FlexCAN event.
+ * @param [in]   instance - is FlexCAN instance.
+ * @param [in]   event - is event.
+ * @return       none.
+ */
+static void _vt_hal_can_event(uint8_t instance, flexcan_event_type_t event)
+{
+	vt_hal_can_t *can = &hal_can[instance];
+
+	if(can->state != NULL && can->state->callback != NULL)
+		can->state->callback(instance, event, can->state);
+}
+
+/*!
+ * @brief  This API will raise a FlexCAN error, only to the error callback as the SDK does.
+ * @param [in]   instance - is FlexCAN instance.
+ * @return       none.
+ */
+static void _vt_hal_can_error(uint8_t instance)
+{
+	vt_hal_can_t *can = &hal_can[instance];
+
+	if(can->error_enabled && can->state != NULL && can->state->error_callback != NULL)
+		can->state->error_callback(instance, FLEXCAN_EVENT_ERROR, can->state);
+}
+
+/*!
+ * @brief  This API will copy the frames waiting in the RX FIFO to armed buffers, one callback per frame, as fast
+ *         as the RX service time allows.
+ * @param [in]   instance - is FlexCAN instance.
+ * @return       none.
+ */
+static void _vt_hal_can_deliver(uint8_t instance)
+{
+	vt_hal_can_t *can = &hal_can[instance];
+	flexcan_msgbuff_t *msg;
+
+	/* The callback re-arms a buffer, the loop below picks the next frame up */
+	if(can->delivering)
+		return;
+	can->delivering = 1;
+	while(can->rx_count > 0 && can->rx_buff != NULL && _vt_hal_now_ns() >= can->rx_ready_ns)
+	{
+		if(can->rx_service_ns > 0)
+			can->rx_ready_ns = _vt_hal_now_ns() + can->rx_service_ns;
+		msg = can->rx_buff;
+		can->rx_buff = NULL;
+		*msg = can->rx_fifo[can->rx_head];
+		can->rx_head = (can->rx_head + 1U) % VT_HAL_CAN_RX_FIFO_DEPTH;
+		can->rx_count--;
+		can->stats.rx_delivered++;
+		_vt_hal_can_event(instance, FLEXCAN_EVENT_RXFIFO_COMPLETE);
+	}
+	can->delivering = 0;
+}
+
+/*!
+ * @brief  This API will complete the transfer of a mailbox.
+ * @param [in]   instance - is FlexCAN instance.
+ * @param [in]   mb_idx - is mailbox.
+ * @return       none.
+ */
+static void _vt_hal_can_complete_mb(uint8_t instance, uint32_t mb_idx)
+{
+	hal_can[instance].mb_busy[mb_idx] = 0;
+	hal_can[instance].stats.tx_completed++;
+	_vt_hal_can_event(instance, FLEXCAN_EVENT_TX_COMPLETE);
+}
+
+#if VT_HAL_MOCK_FLEXCAN
+/*!
+ * @brief  This API will check a mailbox can take a transfer.
+ * @param [in]   *can - pointer to vt_hal_can_t structure.
+ * @param [in]   mb_idx - is mailbox.
+ * @return       STATUS_SUCCESS, STATUS_ERROR, STATUS_FLEXCAN_MB_OUT_OF_RANGE or STATUS_BUSY.
+ */
+static status_t _vt_hal_can_check_mb(const vt_hal_can_t *can, uint8_t mb_idx)
+{
+	if(can == NULL || can->initialized == 0)
+		return STATUS_ERROR;
+	if(mb_idx >= can->max_num_mb)
+		return STATUS_FLEXCAN_MB_OUT_OF_RANGE;
+	if(can->mb_busy[mb_idx])
+		return STATUS_BUSY;
+	return STATUS_SUCCESS;
+}
+#endif
+
+/*!
+ * @brief  This API will put a received frame in the RX FIFO.
+ * @param [in]   instance - is FlexCAN instance.
+ * @param [in]   msgId - is CAN Id.
+ * @param [in]   dataLen - is payload length.
+ * @param [in]   *data - pointer to payload.
+ * @return       STATUS_SUCCESS, or STATUS_BUSY if the FIFO is full and the frame is lost.
+ */
+static status_t _vt_hal_can_receive(uint8_t instance, uint32_t msgId, uint8_t dataLen, const uint8_t *data)
+{
+	vt_hal_can_t *can = &hal_can[instance];
+	flexcan_msgbuff_t *slot;
+
+	if(can->rx_count >= VT_HAL_CAN_RX_FIFO_DEPTH)
+	{
+		can->stats.rx_overflow++;
+		_vt_hal_can_event(instance, FLEXCAN_EVENT_RXFIFO_OVERFLOW);
+		return STATUS_BUSY;
+	}
+
+	slot = &can->rx_fifo[(can->rx_head + can->rx_count) % VT_HAL_CAN_RX_FIFO_DEPTH];
+	memset(slot, 0, sizeof(flexcan_msgbuff_t));
+	slot->msgId = msgId;
+	slot->dataLen = (dataLen > sizeof(slot->data)) ? (uint8_t)sizeof(slot->data) : dataLen;
+	if(slot->dataLen > 0)
+		memcpy(slot->data, data, slot->dataLen);
+	can->rx_count++;
+
+	_vt_hal_can_deliver(instance);
+	return STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will capture a transmitted frame.
+ * @param [in]   *can - pointer to vt_hal_can_t structure.
+ * @param [in]   msgId - is CAN Id.
+ * @param [in]   dataLen - is payload length.
+ * @param [in]   *data - pointer to payload, or NULL.
+ * @return       none.
+ */
+static void _vt_hal_can_capture(vt_hal_can_t *can, uint32_t msgId, uint32_t dataLen, const uint8_t *data)
+{
+	flexcan_msgbuff_t *msg;
+
+	if((can->tx_head - can->tx_tail) >= VT_HAL_CAN_TX_CAPTURE)
+	{
+		can->stats.tx_capture_lost++;
+		return;
+	}
+	msg = &can->tx_capture[can->tx_head & VT_HAL_CAN_TX_MASK];
+	memset(msg, 0, sizeof(flexcan_msgbuff_t));
+	msg->msgId = msgId;
+	msg->dataLen = (dataLen > sizeof(msg->data)) ? (uint8_t)sizeof(msg->data) : (uint8_t)dataLen;
+	if(data != NULL)
+		memcpy(msg->data, data, msg->dataLen);
+	can->tx_head++;
+}
+
+/*!
+ * @brief  This API will get the time of the next frame the RX interrupt can take.
+ * @param [in]   instance - is FlexCAN instance.
+ * @param [out]  *at - pointer to time in ns.
+ * @return       1 if a frame waits for an armed buffer, 0 otherwise.
+ */
+static uint8_t _vt_hal_can_rx_next(uint8_t instance, uint64_t *at)
+{
+	vt_hal_can_t *can = &hal_can[instance];
+
+	if(can->rx_count == 0 || can->rx_buff == NULL || can->delivering)
+		return 0;
+	*at = (can->rx_ready_ns > _vt_hal_now_ns()) ? can->rx_ready_ns : _vt_hal_now_ns();
+	return 1;
+}
+
+#if VT_HAL_MOCK_FLEXCAN
+/*!
+ * @brief  This API will convert time segments to a bitrate.
+ * @param [in]   *seg - pointer to flexcan_time_segment_t structure.
+ * @return       bitrate in bit/s.
+ */
+static uint32_t _vt_hal_can_bitrate(const flexcan_time_segment_t *seg)
+{
+	uint32_t quanta = 1U + (seg->propSeg + 1U) + (seg->phaseSeg1 + 1U) + (seg->phaseSeg2 + 1U);
+
+	return VT_HAL_CAN_PE_CLOCK_HZ / ((seg->preDivider + 1U) * quanta);
+}
+#endif
+
+/*!
+ * @brief  This API will convert bits to time on a bus.
+ * @param [in]   *bus - pointer to vt_hal_bus_t structure.
+ * @param [in]   bits - is number of bits.
+ * @return       time in ns.
+ */
+static uint64_t _vt_hal_bus_ns(const vt_hal_bus_t *bus, uint32_t bits)
+{
+	return ((uint64_t)bits * 1000000000ULL + bus->bitrate / 2U) / bus->bitrate;
+}
+
+static void _vt_hal_bus_put(uint8_t *bits, uint32_t *count, uint32_t value, uint32_t width)
+{
+	while(width-- > 0)
+		bits[(*count)++] = (uint8_t)((value >> width) & 1U);
+}
+
+/*!
+ * @brief  This API will encode a data frame up to its CRC, and count the stuff bits.
+ * @param [in]   *frame - pointer to vt_hal_frame_t structure.
+ * @param [out]  *stuff - pointer to number of stuff bits.
+ * @return       bits from the start of frame to the end of the CRC, stuff bits included.
+ */
+static uint32_t _vt_hal_bus_encode(const vt_hal_frame_t *frame, uint32_t *stuff)
+{
+	uint8_t bits[VT_HAL_BUS_MAX_BITS];
+	uint32_t count = 0, i, run = 1;
+	uint16_t crc = 0;
+	uint8_t last, next;
+
+	_vt_hal_bus_put(bits, &count, 0, 1);                                    /* SOF */
+	if(frame->extended)
+	{
+		_vt_hal_bus_put(bits, &count, frame->msgId >> 18, 11);
+		_vt_hal_bus_put(bits, &count, 3, 2);                                /* SRR, IDE */
+		_vt_hal_bus_put(bits, &count, frame->msgId & 0x3FFFFU, 18);
+		_vt_hal_bus_put(bits, &count, 0, 3);                                /* RTR, r1, r0 */
+	}
+	else
+	{
+		_vt_hal_bus_put(bits, &count, frame->msgId & 0x7FFU, 11);
+		_vt_hal_bus_put(bits, &count, 0, 3);                                /* RTR, IDE, r0 */
+	}
+	_vt_hal_bus_put(bits, &count, frame->dataLen, 4);
+	for(i = 0; i < frame->dataLen; i++)
+		_vt_hal_bus_put(bits, &count, frame->data[i], 8);
+
+	/* CRC-15, x^15 + x^14 + x^10 + x^8 + x^7 + x^4 + x^3 + 1 */
+	for(i = 0; i < count; i++)
+	{
+		next = (uint8_t)(bits[i] ^ ((crc >> 14) & 1U));
+		crc = (uint16_t)((crc << 1) & 0x7FFFU);
+		if(next)
+			crc ^= 0x4599U;
+	}
+	_vt_hal_bus_put(bits, &count, crc, 15);
+
+	/* A complement bit follows 5 equal bits and starts the next run */
+	*stuff = 0;
+	last = bits[0];
+	for(i = 1; i < count; i++)
+	{
+		if(bits[i] == last)
+			run++;
+		else
+		{
+			last = bits[i];
+			run = 1;
+		}
+		if(run == 5U)
+		{
+			(*stuff)++;
+			last ^= 1U;
+			run = 1;
+		}
+	}
+	return count + *stuff;
+}
+
+/*!
+ * @brief  This API will get the arbitration field of a frame: base Id, SRR, IDE, extended Id and RTR.
+ * @param [in]   *frame - pointer to vt_hal_frame_t structure.
+ * @return       arbitration field, the lowest wins.
+ */
+static uint32_t _vt_hal_bus_key(const vt_hal_frame_t *frame)
+{
+	if(frame->extended)
+		return ((frame->msgId >> 18) << 21) | (3U << 19) | ((frame->msgId & 0x3FFFFU) << 1);
+	return (frame->msgId & 0x7FFU) << 21;
+}
+
+static uint8_t _vt_hal_bus_same(const vt_hal_frame_t *a, const vt_hal_frame_t *b)
+{
+	return (a->msgId == b->msgId && a->extended == b->extended && a->dataLen == b->dataLen &&
+	        memcmp(a->data, b->data, a->dataLen) == 0) ? 1U : 0U;
+}
+
+/*!
+ * @brief  This API will get the FlexCAN instance of a sender.
+ * @param [in]   b - is bus number.
+ * @param [in]   sender - is sender.
+ * @return       pointer to vt_hal_can_t structure, or NULL if the sender is not an instance on the bus.
+ */
+static vt_hal_can_t *_vt_hal_bus_can(uint8_t b, uint32_t sender)
+{
+	if(sender >= VT_HAL_CAN_INSTANCES || hal_can[sender].bus != (uint8_t)(b + 1U) || hal_can[sender].initialized == 0)
+		return NULL;
+	return &hal_can[sender];
+}
+
+/*!
+ * @brief  This API will get an external node.
+ * @param [in]   bus - is bus number.
+ * @param [in]   node - is node number.
+ * @return       pointer to vt_hal_node_t structure, or NULL.
+ */
+static vt_hal_node_t *_vt_hal_bus_node(uint8_t bus, int node)
+{
+	if(bus >= VT_HAL_BUS_COUNT || node < 0 || (uint32_t)node >= hal_bus[bus].node_count)
+		return NULL;
+	return &hal_bus[bus].nodes[node];
+}
+
+/*!
+ * @brief  This API will get the error counters of a sender.
+ * @param [in]   b - is bus number.
+ * @param [in]   sender - is sender.
+ * @return       pointer to vt_hal_errc_t structure, or NULL if the sender is not on the bus.
+ */
+static vt_hal_errc_t *_vt_hal_bus_errc(uint8_t b, uint32_t sender)
+{
+	vt_hal_can_t *can = _vt_hal_bus_can(b, sender);
+
+	if(can != NULL)
+		return &can->errc;
+	if(sender >= VT_HAL_CAN_INSTANCES && (sender - VT_HAL_CAN_INSTANCES) < hal_bus[b].node_count)
+		return &hal_bus[b].nodes[sender - VT_HAL_CAN_INSTANCES].errc;
+	return NULL;
+}
+
+/*!
+ * @brief  This API will end the bus-off state of a node once the recovery time has passed.
+ * @param [in]   *errc - pointer to vt_hal_errc_t structure.
+ * @param [in]   at - is time in ns.
+ * @return       1 if the node is bus-off at that time, 0 otherwise.
+ */
+static uint8_t _vt_hal_bus_off(vt_hal_errc_t *errc, uint64_t at)
+{
+	if(errc->bus_off && at >= errc->recover_ns)
+	{
+		errc->bus_off = 0;
+		errc->tec = 0;
+		errc->rec = 0;
+	}
+	return errc->bus_off;
+}
+
+/*!
+ * @brief  This API will check a FlexCAN instance samples the bus at the bitrate of the bus, within 1%.
+ * @param [in]   *bus - pointer to vt_hal_bus_t structure.
+ * @param [in]   *can - pointer to vt_hal_can_t structure.
+ * @return       1 if it does, 0 otherwise.
+ */
+static uint8_t _vt_hal_bus_in_sync(const vt_hal_bus_t *bus, const vt_hal_can_t *can)
+{
+	uint32_t diff = (can->bitrate > bus->bitrate) ? (can->bitrate - bus->bitrate) : (bus->bitrate - can->bitrate);
+
+	return ((uint64_t)diff * 100U <= bus->bitrate) ? 1U : 0U;
+}
+
+/*!
+ * @brief  This API will get the frame a sender puts up for arbitration.
+ * @param [in]   b - is bus number.
+ * @param [in]   sender - is sender.
+ * @param [in]   at - is arbitration time in ns.
+ * @param [out]  *tx - pointer to vt_hal_tx_t structure, the lowest arbitration field ready at that time.
+ * @param [out]  *ready - pointer to earliest time a frame of the sender is ready, bus-off included.
+ * @return       1 if the sender has a frame ready at that time, 0 otherwise.
+ */
+static uint8_t _vt_hal_bus_pending(uint8_t b, uint32_t sender, uint64_t at, vt_hal_tx_t *tx, uint64_t *ready)
+{
+	vt_hal_bus_t *bus = &hal_bus[b];
+	vt_hal_can_t *can = _vt_hal_bus_can(b, sender);
+	vt_hal_errc_t *errc = _vt_hal_bus_errc(b, sender);
+	vt_hal_node_t *node;
+	uint64_t earliest = UINT64_MAX;
+	uint32_t mb_idx, key;
+	uint8_t found = 0;
+
+	if(errc == NULL || (can != NULL && can->listen_only))
+		return 0;
+	_vt_hal_bus_off(errc, at);
+
+	if(can != NULL)
+	{
+		/* Lowest Id first, then the lowest mailbox */
+		for(mb_idx = 0; mb_idx < can->max_num_mb; mb_idx++)
+		{
+			if(can->mb_busy[mb_idx] == 0)
+				continue;
+			if(can->mb_ready_ns[mb_idx] < earliest)
+				earliest = can->mb_ready_ns[mb_idx];
+			if(can->mb_ready_ns[mb_idx] > at)
+				continue;
+			key = _vt_hal_bus_key(&can->mb_frame[mb_idx]);
+			if(!found || key < tx->key)
+			{
+				tx->frame = &can->mb_frame[mb_idx];
+				tx->key = key;
+				tx->mb_idx = (uint8_t)mb_idx;
+				found = 1;
+			}
+		}
+	}
+	else
+	{
+		node = &bus->nodes[sender - VT_HAL_CAN_INSTANCES];
+		if(node->count > 0)
+		{
+			earliest = node->ready_ns[node->head];
+			if(earliest <= at)
+			{
+				tx->frame = &node->queue[node->head];
+				tx->key = _vt_hal_bus_key(tx->frame);
+				tx->mb_idx = 0;
+				found = 1;
+			}
+		}
+	}
+
+	if(errc->bus_off)
+	{
+		if(earliest < errc->recover_ns)
+			earliest = errc->recover_ns;
+		found = 0;
+	}
+	*ready = earliest;
+	return found;
+}
+
+/*!
+ * @brief  This API will get the time of the next event of a bus: the end of the frame on it, or the next arbitration.
+ * @param [in]   b - is bus number.
+ * @param [out]  *at - pointer to time in ns.
+ * @return       1 if an event is due, 0 if the bus stays idle.
+ */
+static uint8_t _vt_hal_bus_next(uint8_t b, uint64_t *at)
+{
+	vt_hal_bus_t *bus = &hal_bus[b];
+	vt_hal_tx_t tx;
+	uint64_t ready, earliest = UINT64_MAX;
+	uint32_t sender;
+
+	if(bus->bitrate == 0)
+		return 0;
+	if(bus->busy)
+	{
+		*at = bus->end_ns;
+		return 1;
+	}
+	for(sender = 0; sender < VT_HAL_BUS_SENDERS; sender++)
+	{
+		ready = UINT64_MAX;
+		(void)_vt_hal_bus_pending(b, sender, 0, &tx, &ready);
+		if(ready < earliest)
+			earliest = ready;
+	}
+	if(earliest == UINT64_MAX)
+		return 0;
+	*at = (earliest > bus->free_ns) ? earliest : bus->free_ns;
+	return 1;
+}
+
+/*!
+ * @brief  This API will arbitrate a bus and put the winning frame on it.
+ * @param [in]   b - is bus number.
+ * @param [in]   at - is arbitration time in ns.
+ * @return       none.
+ */
+static void _vt_hal_bus_start(uint8_t b, uint64_t at)
+{
+	vt_hal_bus_t *bus = &hal_bus[b];
+	vt_hal_tx_t tx, best = {NULL, 0, 0};
+	vt_hal_can_t *can;
+	uint64_t ready;
+	uint32_t sender, contenders = 0, count = 0, bits, stuff, crc_bits;
+	uint8_t ack = 0, destroyed = 0;
+
+	bus->sender = VT_HAL_BUS_NO_SENDER;
+	bus->rival = VT_HAL_BUS_NO_SENDER;
+	for(sender = 0; sender < VT_HAL_BUS_SENDERS; sender++)
+	{
+		if(!_vt_hal_bus_pending(b, sender, at, &tx, &ready))
+			continue;
+		contenders |= 1UL << sender;
+		count++;
+		if(bus->sender == VT_HAL_BUS_NO_SENDER || tx.key < best.key)
+		{
+			best = tx;
+			bus->sender = (uint8_t)sender;
+			bus->rival = VT_HAL_BUS_NO_SENDER;
+		}
+		else if(tx.key == best.key && bus->rival == VT_HAL_BUS_NO_SENDER)
+		{
+			bus->rival = (uint8_t)sender;
+			bus->rival_mb_idx = tx.mb_idx;
+			if(!_vt_hal_bus_same(tx.frame, best.frame))
+				destroyed = 1;
+		}
+	}
+	if(bus->sender == VT_HAL_BUS_NO_SENDER)
+		return;
+
+	/* Losers try again at the next arbitration */
+	if(count > 1U)
+		bus->stats.arbitrations++;
+	for(sender = 0; sender < VT_HAL_BUS_SENDERS; sender++)
+	{
+		if((contenders & (1UL << sender)) == 0 || sender == bus->sender || sender == bus->rival)
+			continue;
+		can = _vt_hal_bus_can(b, sender);
+		if(can != NULL)
+			can->stats.tx_arbitration_lost++;
+		else
+			bus->nodes[sender - VT_HAL_CAN_INSTANCES].stats.tx_arbitration_lost++;
+	}
+
+	bus->busy = 1;
+	bus->aborted = 0;
+	bus->frame = *best.frame;
+	bus->mb_idx = best.mb_idx;
+	bus->start_ns = at;
+	bus->outcome = VT_HAL_BUS_OK;
+	crc_bits = _vt_hal_bus_encode(&bus->frame, &stuff);
+	bits = crc_bits + VT_HAL_BUS_TAIL_BITS;
+
+	/* Nodes in sync and out of bus-off acknowledge, error active nodes at another bitrate destroy the frame */
+	for(sender = 0; sender < VT_HAL_BUS_SENDERS; sender++)
+	{
+		vt_hal_errc_t *errc = _vt_hal_bus_errc(b, sender);
+
+		if(errc == NULL || _vt_hal_bus_off(errc, at))
+			continue;
+		can = _vt_hal_bus_can(b, sender);
+		if(can != NULL && !_vt_hal_bus_in_sync(bus, can))
+		{
+			if(sender == bus->sender || (!can->listen_only && errc->tec < VT_HAL_CAN_ERROR_PASSIVE &&
+			                             errc->rec < VT_HAL_CAN_ERROR_PASSIVE))
+				bus->outcome = VT_HAL_BUS_ERR_FORM;
+			continue;
+		}
+		if(sender != bus->sender && sender != bus->rival && (can == NULL || !can->listen_only))
+			ack = 1;
+	}
+
+	if(destroyed)
+	{
+		bus->outcome = VT_HAL_BUS_ERR_BIT;
+		bits = crc_bits / 2U + VT_HAL_BUS_ERROR_BITS;
+	}
+	else if(bus->outcome == VT_HAL_BUS_ERR_FORM)
+	{
+		bits = VT_HAL_BUS_MISMATCH_BITS + VT_HAL_BUS_ERROR_BITS;
+	}
+	else if(bus->inject_errors > 0)
+	{
+		bus->inject_errors--;
+		bus->outcome = VT_HAL_BUS_ERR_CRC;
+		bits = crc_bits + 3U + VT_HAL_BUS_ERROR_BITS;
+	}
+	else if(!ack)
+	{
+		bus->outcome = VT_HAL_BUS_ERR_ACK;
+		bits = crc_bits + 2U + VT_HAL_BUS_ERROR_BITS;
+	}
+	else
+	{
+		bus->stats.stuff_bits += stuff;
+	}
+	bus->end_ns = at + _vt_hal_bus_ns(bus, bits);
+	bus->free_ns = bus->end_ns + _vt_hal_bus_ns(bus, VT_HAL_BUS_IFS_BITS);
+	bus->stats.busy_ns += bus->free_ns - at;
+}
+
+/*!
+ * @brief  This API will count an error frame against a transmitter, which goes bus-off past 255.
+ * @param [in]   b - is bus number.
+ * @param [in]   sender - is sender.
+ * @return       none.
+ */
+static void _vt_hal_bus_tx_error(uint8_t b, uint32_t sender)
+{
+	vt_hal_bus_t *bus = &hal_bus[b];
+	vt_hal_errc_t *errc = _vt_hal_bus_errc(b, sender);
+	vt_hal_can_t *can = _vt_hal_bus_can(b, sender);
+
+	if(errc == NULL)
+		return;
+	if(can != NULL)
+		can->stats.tx_errors++;
+	else
+		bus->nodes[sender - VT_HAL_CAN_INSTANCES].stats.tx_errors++;
+
+	/* An error passive transmitter missing its ACK keeps its count */
+	if(bus->outcome == VT_HAL_BUS_ERR_ACK && errc->tec >= VT_HAL_CAN_ERROR_PASSIVE)
+		return;
+	errc->tec += 8U;
+	if(errc->tec >= VT_HAL_CAN_BUS_OFF)
+	{
+		errc->bus_off = 1;
+		errc->recover_ns = bus->free_ns + _vt_hal_bus_ns(bus, VT_HAL_CAN_BUS_OFF_BITS);
+		if(can != NULL)
+			can->stats.bus_off++;
+		else
+			bus->nodes[sender - VT_HAL_CAN_INSTANCES].stats.bus_off++;
+	}
+}
+
+/*!
+ * @brief  This API will end the frame on a bus: receivers take it and the sender completes, or every node counts
+ *         the error frame and the sender tries again.
+ * @param [in]   b - is bus number.
+ * @return       none.
+ */
+static void _vt_hal_bus_end(uint8_t b)
+{
+	vt_hal_bus_t *bus = &hal_bus[b];
+	vt_hal_frame_t frame = bus->frame;
+	vt_hal_errc_t *errc;
+	vt_hal_can_t *can;
+	vt_hal_node_t *node;
+	uint32_t sender, raised = 0, received = 0;
+	uint8_t ok = (bus->outcome == VT_HAL_BUS_OK) ? 1U : 0U;
+
+	bus->busy = 0;
+	if(ok)
+		bus->stats.frames++;
+	else
+		bus->stats.error_frames++;
+
+	/* Counters first, the callbacks below may send again */
+	for(sender = 0; sender < VT_HAL_BUS_SENDERS; sender++)
+	{
+		errc = _vt_hal_bus_errc(b, sender);
+		if(errc == NULL || _vt_hal_bus_off(errc, bus->start_ns))
+			continue;
+		can = _vt_hal_bus_can(b, sender);
+		node = (can == NULL) ? &bus->nodes[sender - VT_HAL_CAN_INSTANCES] : NULL;
+		if(sender == bus->sender || sender == bus->rival)
+		{
+			if(ok)
+			{
+				if(errc->tec > 0)
+					errc->tec--;
+				if(node != NULL)
+				{
+					node->head = (node->head + 1U) & VT_HAL_BUS_NODE_MASK;
+					node->count--;
+					node->stats.tx_frames++;
+				}
+			}
+			else
+			{
+				_vt_hal_bus_tx_error(b, sender);
+			}
+		}
+		else if(ok && (can == NULL || _vt_hal_bus_in_sync(bus, can)))
+		{
+			if(errc->rec > 127U)
+				errc->rec = 127U;
+			else if(errc->rec > 0)
+				errc->rec--;
+			if(node != NULL)
+				node->stats.rx_frames++;
+			else
+				received |= 1UL << sender;
+		}
+		else
+		{
+			if(errc->rec < 255U)
+				errc->rec++;
+			if(can != NULL)
+				can->stats.rx_errors++;
+		}
+		if(can != NULL && (!ok || !_vt_hal_bus_in_sync(bus, can)))
+			raised |= 1UL << sender;
+	}
+
+	for(sender = 0; sender < VT_HAL_CAN_INSTANCES; sender++)
+	{
+		if(raised & (1UL << sender))
+			_vt_hal_can_error((uint8_t)sender);
+	}
+	if(!ok)
+		return;
+
+	can = _vt_hal_bus_can(b, bus->sender);
+	if(can != NULL && !bus->aborted)
+	{
+		can->mb_busy[bus->mb_idx] = 0;
+		_vt_hal_can_capture(can, frame.msgId, frame.dataLen, frame.data);
+		can->stats.tx_completed++;
+		_vt_hal_can_event(bus->sender, FLEXCAN_EVENT_TX_COMPLETE);
+	}
+	can = _vt_hal_bus_can(b, bus->rival);
+	if(can != NULL && can->mb_busy[bus->rival_mb_idx])
+	{
+		can->mb_busy[bus->rival_mb_idx] = 0;
+		_vt_hal_can_capture(can, frame.msgId, frame.dataLen, frame.data);
+		can->stats.tx_completed++;
+		_vt_hal_can_event(bus->rival, FLEXCAN_EVENT_TX_COMPLETE);
+	}
+	for(sender = 0; sender < VT_HAL_CAN_INSTANCES; sender++)
+	{
+		if(received & (1UL << sender))
+		{
+			hal_can[sender].stats.rx_bus++;
+			(void)_vt_hal_can_receive((uint8_t)sender, frame.msgId, frame.dataLen, frame.data);
+		}
+	}
+}
+
+#if VT_HAL_MOCK_FLEXCAN
+/*!
+ * @brief  This API will take the CPU time of a poll, interrupts due meanwhile run before it returns.
+ * @param [in]   ns - is time in ns.
+ * @return       none.
+ */
+static void _vt_hal_cpu_consume(uint32_t ns)
+{
+	uint32_t us;
+
+	/* Time does not move inside an interrupt */
+	if(hal_advancing)
+		return;
+	hal_cpu_ns += ns;
+	if(hal_cpu_ns >= VT_HAL_NS_PER_US)
+	{
+		us = hal_cpu_ns / (uint32_t)VT_HAL_NS_PER_US;
+		hal_cpu_ns %= (uint32_t)VT_HAL_NS_PER_US;
+		vt_hal_clock_advance(us);
+	}
+}
+#endif
+
+/*!
+ * @brief  This API will convert a time and date to seconds, days of a month only.
+ * @param [in]   *time - pointer to rtc_timedate_t structure.
+ * @return       seconds.
+ */
+static uint64_t _vt_hal_rtc_seconds(const rtc_timedate_t *time)
+{
+	return (((uint64_t)time->day * 24U + time->hour) * 60U + time->minutes) * 60U + time->seconds;
+}
+
+/*!
+ * @brief  This API will get the time of the RTC in seconds.
+ * @param [in]   none.
+ * @return       seconds.
+ */
+static uint64_t _vt_hal_rtc_now(void)
+{
+	uint64_t seconds = _vt_hal_rtc_seconds(&hal_rtc.base);
+
+	if(hal_rtc.running)
+		seconds += (hal_clock_us - hal_rtc.base_us) / VT_HAL_US_PER_SECOND;
+	return seconds;
+}
+
+/*!
+ * @brief  This API will raise the RTC alarm and schedule the next one.
+ * @param [in]   none.
+ * @return       none.
+ */
+static void _vt_hal_rtc_fire(void)
+{
+	uint32_t interval = (hal_rtc.alarm.repetitionInterval > 0) ? hal_rtc.alarm.repetitionInterval : 1U;
+
+	if(hal_rtc.alarm.repeatForever || hal_rtc.alarm_left > 0)
+	{
+		if(!hal_rtc.alarm.repeatForever)
+			hal_rtc.alarm_left--;
+		hal_rtc.alarm_us += (uint64_t)interval * VT_HAL_US_PER_SECOND;
+	}
+	else
+	{
+		hal_rtc.alarm_armed = 0;
+	}
+
+	if(hal_rtc.alarm.alarmIntEnable && hal_rtc.alarm.alarmCallback != NULL)
+		hal_rtc.alarm.alarmCallback(hal_rtc.alarm.callbackParams);
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will reset every mock peripheral and the virtual clock to 0.
+ * @param [in]   none.
+ * @return       none.
+ */
+void vt_hal_reset(void)
+{
+	hal_clock_us = 0;
+	hal_clock_frac_ns = 0;
+	hal_cpu_ns = 0;
+	hal_advancing = 0;
+	memset(hal_can, 0, sizeof(hal_can));
+	memset(hal_bus, 0, sizeof(hal_bus));
+	memset(hal_pit, 0, sizeof(hal_pit));
+	memset(&hal_rtc, 0, sizeof(hal_rtc));
+	hal_uart_head = 0;
+	hal_uart_tail = 0;
+	memset(&vt_hal_siul2, 0, sizeof(vt_hal_siul2));
+}
+
+/*!
+ * @brief  This API will get the virtual clock.
+ * @param [in]   none.
+ * @return       microseconds since vt_hal_reset().
+ */
+uint64_t vt_hal_clock_us(void)
+{
+	return hal_clock_us;
+}
+
+/*!
+ * @brief  This API will move the virtual clock forward.
+ * @param [in]   us - is microseconds.
+ * @return       none.
+ */
+void vt_hal_clock_advance(uint32_t us)
+{
+	uint64_t target = (hal_clock_us + us) * VT_HAL_NS_PER_US;
+	uint64_t next, at;
+	vt_hal_pit_t *pit;
+	vt_hal_fire_t fire;
+	uint8_t i, index = 0;
+
+	hal_advancing++;
+	for(i = 0; i < VT_HAL_CAN_INSTANCES; i++)
+	{
+		if(hal_can[i].manual_complete == 0 && hal_can[i].bus == 0)
+			vt_hal_can_complete_tx(i);
+		_vt_hal_can_deliver(i);
+	}
+
+	for(;;)
+	{
+		/* Earliest event due before the target, the buses first on a tie */
+		fire = VT_HAL_FIRE_NONE;
+		next = target;
+		for(i = 0; i < VT_HAL_BUS_COUNT; i++)
+		{
+			if(_vt_hal_bus_next(i, &at) && at <= target && (fire == VT_HAL_FIRE_NONE || at < next))
+			{
+				next = at;
+				fire = VT_HAL_FIRE_BUS;
+				index = i;
+			}
+		}
+		for(i = 0; i < VT_HAL_CAN_INSTANCES; i++)
+		{
+			if(_vt_hal_can_rx_next(i, &at) && at <= target && (fire == VT_HAL_FIRE_NONE || at < next))
+			{
+				next = at;
+				fire = VT_HAL_FIRE_RX;
+				index = i;
+			}
+		}
+		for(i = 0; i < VT_HAL_PIT_CHANNELS; i++)
+		{
+			pit = &hal_pit[i];
+			at = pit->next_us * VT_HAL_NS_PER_US;
+			if(pit->running && pit->handler != NULL && pit->period_us > 0 && at <= target &&
+			   (fire == VT_HAL_FIRE_NONE || at < next))
+			{
+				next = at;
+				fire = VT_HAL_FIRE_PIT;
+				index = i;
+			}
+		}
+		at = hal_rtc.alarm_us * VT_HAL_NS_PER_US;
+		if(hal_rtc.running && hal_rtc.alarm_armed && at <= target && (fire == VT_HAL_FIRE_NONE || at < next))
+		{
+			next = at;
+			fire = VT_HAL_FIRE_RTC;
+		}
+		if(fire == VT_HAL_FIRE_NONE)
+			break;
+
+		_vt_hal_clock_set(next);
+		switch(fire)
+		{
+		case VT_HAL_FIRE_BUS:
+			if(hal_bus[index].busy)
+				_vt_hal_bus_end(index);
+			else
+				_vt_hal_bus_start(index, next);
+			break;
+		case VT_HAL_FIRE_RX:
+			_vt_hal_can_deliver(index);
+			break;
+		case VT_HAL_FIRE_PIT:
+			hal_pit[index].next_us += hal_pit[index].period_us;
+			hal_pit[index].handler();
+			break;
+		default:
+			_vt_hal_rtc_fire();
+			break;
+		}
+	}
+	_vt_hal_clock_set(target);
+	hal_advancing--;
+}
+
+/*!
+ * @brief  This API will install the interrupt handler of a PIT channel.
+ * @param [in]   channel - is PIT channel.
+ * @param [in]   handler - is handler.
+ * @return       none.
+ */
+void vt_hal_pit_install_handler(uint32_t channel, void (*handler)(void))
+{
+	if(channel < VT_HAL_PIT_CHANNELS)
+		hal_pit[channel].handler = handler;
+}
+
+/*!
+ * @brief  This API will inject a received frame.
+ * @param [in]   instance - is FlexCAN instance.
+ * @param [in]   msgId - is CAN Id.
+ * @param [in]   dataLen - is payload length.
+ * @param [in]   *data - pointer to payload.
+ * @return       STATUS_SUCCESS, STATUS_BUSY if the frame is lost, or STATUS_ERROR.
+ */
+status_t vt_hal_can_inject(uint8_t instance, uint32_t msgId, uint8_t dataLen, const uint8_t *data)
+{
+	vt_hal_can_t *can = _vt_hal_can(instance);
+
+	if(can == NULL || can->initialized == 0 || (dataLen > 0 && data == NULL))
+		return STATUS_ERROR;
+
+	can->stats.rx_injected++;
+	return _vt_hal_can_receive(instance, msgId, dataLen, data);
+}
+
+/*!
+ * @brief  This API will choose how mailboxes complete.
+ * @param [in]   instance - is FlexCAN instance.
+ * @param [in]   enable - is auto-complete.
+ * @return       none.
+ */
+void vt_hal_can_set_auto_complete(uint8_t instance, bool enable)
+{
+	vt_hal_can_t *can = _vt_hal_can(instance);
+
+	if(can != NULL)
+		can->manual_complete = enable ? 0 : 1;
+}
+
+/*!
+ * @brief  This API will complete every pending mailbox of an instance, the lowest mailbox first.
+ * @param [in]   instance - is FlexCAN instance.
+ * @return       number of mailboxes completed.
+ */
+uint32_t vt_hal_can_complete_tx(uint8_t instance)
+{
+	vt_hal_can_t *can = _vt_hal_can(instance);
+	uint32_t mb_idx, count = 0;
+
+	if(can == NULL)
+		return 0;
+	/* A mailbox refilled by the callback completes on the next call */
+	for(mb_idx = 0; mb_idx < can->max_num_mb; mb_idx++)
+	{
+		if(can->mb_busy[mb_idx])
+		{
+			_vt_hal_can_complete_mb(instance, mb_idx);
+			count++;
+		}
+	}
+	return count;
+}
+
+/*!
+ * @brief  This API will get the oldest captured transmitted frame.
+ * @param [in]   instance - is FlexCAN instance.
+ * @param [out]  *msg - pointer to flexcan_msgbuff_t structure.
+ * @return       STATUS_SUCCESS, or STATUS_ERROR if nothing was transmitted.
+ */
+status_t vt_hal_can_pop_tx(uint8_t instance, flexcan_msgbuff_t *msg)
+{
+	vt_hal_can_t *can = _vt_hal_can(instance);
+
+	if(can == NULL || msg == NULL || can->tx_head == can->tx_tail)
+		return STATUS_ERROR;
+
+	*msg = can->tx_capture[can->tx_tail & VT_HAL_CAN_TX_MASK];
+	can->tx_tail++;
+	return STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will get counters of a FlexCAN instance.
+ * @param [in]   instance - is FlexCAN instance.
+ * @param [out]  *stats - pointer to vt_hal_can_stats_t structure.
+ * @return       STATUS_SUCCESS or STATUS_ERROR.
+ */
+status_t vt_hal_can_get_stats(uint8_t instance, vt_hal_can_stats_t *stats)
+{
+	vt_hal_can_t *can = _vt_hal_can(instance);
+
+	if(can == NULL || stats == NULL)
+		return STATUS_ERROR;
+	(void)_vt_hal_bus_off(&can->errc, _vt_hal_now_ns());
+	*stats = can->stats;
+	stats->tec = can->errc.tec;
+	stats->rec = can->errc.rec;
+	return STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will set the time the RX interrupt takes per frame.
+ * @param [in]   instance - is FlexCAN instance.
+ * @param [in]   ns - is service time in ns.
+ * @return       none.
+ */
+void vt_hal_can_set_rx_service_time(uint8_t instance, uint32_t ns)
+{
+	vt_hal_can_t *can = _vt_hal_can(instance);
+
+	if(can != NULL)
+		can->rx_service_ns = ns;
+}
+
+/*!
+ * @brief  This API will create an empty bus.
+ * @param [in]   bus - is bus number.
+ * @param [in]   bitrate - is bitrate in bit/s.
+ * @return       STATUS_SUCCESS or STATUS_ERROR.
+ */
+status_t vt_hal_bus_init(uint8_t bus, uint32_t bitrate)
+{
+	uint8_t i;
+
+	if(bus >= VT_HAL_BUS_COUNT || bitrate == 0)
+		return STATUS_ERROR;
+
+	for(i = 0; i < VT_HAL_CAN_INSTANCES; i++)
+	{
+		if(hal_can[i].bus == (uint8_t)(bus + 1U))
+			hal_can[i].bus = 0;
+	}
+	memset(&hal_bus[bus], 0, sizeof(vt_hal_bus_t));
+	hal_bus[bus].bitrate = bitrate;
+	hal_bus[bus].free_ns = _vt_hal_now_ns();
+	return STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will attach a FlexCAN instance to a bus.
+ * @param [in]   bus - is bus number.
+ * @param [in]   instance - is FlexCAN instance.
+ * @return       STATUS_SUCCESS or STATUS_ERROR.
+ */
+status_t vt_hal_bus_attach_can(uint8_t bus, uint8_t instance)
+{
+	vt_hal_can_t *can = _vt_hal_can(instance);
+	uint32_t mb_idx;
+
+	if(can == NULL || bus >= VT_HAL_BUS_COUNT || hal_bus[bus].bitrate == 0 || can->bus != 0)
+		return STATUS_ERROR;
+
+	/* Mailboxes already pending go on the bus from now */
+	for(mb_idx = 0; mb_idx < VT_HAL_CAN_MAX_MB; mb_idx++)
+		can->mb_ready_ns[mb_idx] = _vt_hal_now_ns();
+	memset(&can->errc, 0, sizeof(vt_hal_errc_t));
+	can->bus = (uint8_t)(bus + 1U);
+	return STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will add an external node to a bus.
+ * @param [in]   bus - is bus number.
+ * @return       node number, or -1.
+ */
+int vt_hal_bus_add_node(uint8_t bus)
+{
+	vt_hal_bus_t *b;
+
+	if(bus >= VT_HAL_BUS_COUNT || hal_bus[bus].bitrate == 0 || hal_bus[bus].node_count >= VT_HAL_BUS_MAX_NODES)
+		return -1;
+	b = &hal_bus[bus];
+	memset(&b->nodes[b->node_count], 0, sizeof(vt_hal_node_t));
+	return (int)b->node_count++;
+}
+
+/*!
+ * @brief  This API will queue a frame on an external node.
+ * @param [in]   bus - is bus number.
+ * @param [in]   node - is node number.
+ * @param [in]   msgId - is CAN Id.
+ * @param [in]   dataLen - is payload length.
+ * @param [in]   *data - pointer to payload.
+ * @return       STATUS_SUCCESS, STATUS_BUSY or STATUS_ERROR.
+ */
+status_t vt_hal_bus_node_send(uint8_t bus, int node, uint32_t msgId, uint8_t dataLen, const uint8_t *data)
+{
+	vt_hal_node_t *n = _vt_hal_bus_node(bus, node);
+	vt_hal_frame_t *frame;
+	uint32_t slot;
+
+	if(n == NULL || dataLen > sizeof(frame->data) || msgId > 0x1FFFFFFFU || (dataLen > 0 && data == NULL))
+		return STATUS_ERROR;
+	if(n->count >= VT_HAL_BUS_NODE_QUEUE)
+		return STATUS_BUSY;
+
+	slot = (n->head + n->count) & VT_HAL_BUS_NODE_MASK;
+	frame = &n->queue[slot];
+	memset(frame, 0, sizeof(vt_hal_frame_t));
+	frame->msgId = msgId;
+	frame->extended = (msgId > 0x7FFU) ? 1U : 0U;
+	frame->dataLen = dataLen;
+	if(dataLen > 0)
+		memcpy(frame->data, data, dataLen);
+	n->ready_ns[slot] = _vt_hal_now_ns();
+	n->count++;
+	return STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will get the frames an external node has still to send.
+ * @param [in]   bus - is bus number.
+ * @param [in]   node - is node number.
+ * @return       number of frames.
+ */
+uint32_t vt_hal_bus_node_pending(uint8_t bus, int node)
+{
+	vt_hal_node_t *n = _vt_hal_bus_node(bus, node);
+
+	return (n != NULL) ? n->count : 0U;
+}
+
+/*!
+ * @brief  This API will get counters of an external node.
+ * @param [in]   bus - is bus number.
+ * @param [in]   node - is node number.
+ * @param [out]  *stats - pointer to vt_hal_bus_node_stats_t structure.
+ * @return       STATUS_SUCCESS or STATUS_ERROR.
+ */
+status_t vt_hal_bus_node_get_stats(uint8_t bus, int node, vt_hal_bus_node_stats_t *stats)
+{
+	vt_hal_node_t *n = _vt_hal_bus_node(bus, node);
+
+	if(n == NULL || stats == NULL)
+		return STATUS_ERROR;
+	(void)_vt_hal_bus_off(&n->errc, _vt_hal_now_ns());
+	*stats = n->stats;
+	stats->tec = n->errc.tec;
+	stats->rec = n->errc.rec;
+	return STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will destroy the next frames of a bus with a CRC error.
+ * @param [in]   bus - is bus number.
+ * @param [in]   count - is number of frames.
+ * @return       none.
+ */
+void vt_hal_bus_inject_errors(uint8_t bus, uint32_t count)
+{
+	if(bus < VT_HAL_BUS_COUNT)
+		hal_bus[bus].inject_errors += count;
+}
+
+/*!
+ * @brief  This API will get counters of a bus.
+ * @param [in]   bus - is bus number.
+ * @param [out]  *stats - pointer to vt_hal_bus_stats_t structure.
+ * @return       STATUS_SUCCESS or STATUS_ERROR.
+ */
+status_t vt_hal_bus_get_stats(uint8_t bus, vt_hal_bus_stats_t *stats)
+{
+	if(bus >= VT_HAL_BUS_COUNT || stats == NULL)
+		return STATUS_ERROR;
+	*stats = hal_bus[bus].stats;
+	return STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will read captured UART bytes.
+ * @param [out]  *buff - pointer to buffer.
+ * @param [in]   len - size of buffer.
+ * @return       number of bytes copied.
+ */
+uint32_t vt_hal_uart_read(uint8_t *buff, uint32_t len)
+{
+	uint32_t count = 0;
+
+	while(count < len && hal_uart_tail != hal_uart_head)
+	{
+		buff[count++] = hal_uart[hal_uart_tail & VT_HAL_UART_MASK];
+		hal_uart_tail++;
+	}
+	return count;
+}
+
+/*------------------------------------------------------------------*
+ *                          FlexCAN driver                          *
+ *------------------------------------------------------------------*/
+#if VT_HAL_MOCK_FLEXCAN
+status_t FLEXCAN_DRV_Init(uint8_t instance, flexcan_state_t *state, const flexcan_user_config_t *data)
+{
+	vt_hal_can_t *can = _vt_hal_can(instance);
+
+	if(can == NULL || state == NULL || data == NULL)
+		return STATUS_ERROR;
+
+	/* Re-initialization drops the frames in flight, as a module reset does, and the error callback */
+	can->state = state;
+	state->error_callback = NULL;
+	state->errorCallbackParam = NULL;
+	can->error_enabled = 0;
+	can->max_num_mb = (data->max_num_mb < VT_HAL_CAN_MAX_MB) ? data->max_num_mb : VT_HAL_CAN_MAX_MB;
+	can->rx_buff = NULL;
+	can->rx_head = 0;
+	can->rx_count = 0;
+	memset(can->mb_busy, 0, sizeof(can->mb_busy));
+	can->listen_only = (data->flexcanMode == FLEXCAN_LISTEN_ONLY_MODE) ? 1U : 0U;
+	can->bitrate = _vt_hal_can_bitrate(&data->bitrate);
+	memset(&can->errc, 0, sizeof(vt_hal_errc_t));
+	if(can->bus != 0 && hal_bus[can->bus - 1U].busy && hal_bus[can->bus - 1U].sender == instance)
+		hal_bus[can->bus - 1U].aborted = 1;
+	can->initialized = 1;
+	return STATUS_SUCCESS;
+}
+
+void FLEXCAN_DRV_SetBitrate(uint8_t instance, const flexcan_time_segment_t *bitrate)
+{
+	vt_hal_can_t *can = _vt_hal_can(instance);
+
+	if(can != NULL && bitrate != NULL)
+		can->bitrate = _vt_hal_can_bitrate(bitrate);
+}
+
+status_t FLEXCAN_DRV_ConfigTxMb(uint8_t instance, uint8_t mb_idx, const flexcan_data_info_t *tx_info, uint32_t msg_id)
+{
+	(void)tx_info;
+	(void)msg_id;
+	return _vt_hal_can_check_mb(_vt_hal_can(instance), mb_idx);
+}
+
+status_t FLEXCAN_DRV_Send(uint8_t instance, uint8_t mb_idx, const flexcan_data_info_t *tx_info, uint32_t msg_id, const uint8_t *mb_data)
+{
+	vt_hal_can_t *can = _vt_hal_can(instance);
+	vt_hal_frame_t *frame;
+	status_t result;
+
+	result = _vt_hal_can_check_mb(can, mb_idx);
+	if(result != STATUS_SUCCESS)
+		return result;
+	if(tx_info == NULL)
+		return STATUS_ERROR;
+
+	can->mb_busy[mb_idx] = 1;
+	can->stats.tx_sent++;
+	if(can->bus == 0)
+	{
+		_vt_hal_can_capture(can, msg_id, tx_info->data_length, mb_data);
+		return STATUS_SUCCESS;
+	}
+
+	/* Captured when the frame leaves the bus */
+	frame = &can->mb_frame[mb_idx];
+	memset(frame, 0, sizeof(vt_hal_frame_t));
+	frame->extended = (tx_info->msg_id_type == FLEXCAN_MSG_ID_EXT) ? 1U : 0U;
+	frame->msgId = msg_id & (frame->extended ? 0x1FFFFFFFU : 0x7FFU);
+	frame->dataLen = (tx_info->data_length > sizeof(frame->data)) ? (uint8_t)sizeof(frame->data) : (uint8_t)tx_info->data_length;
+	if(mb_data != NULL)
+		memcpy(frame->data, mb_data, frame->dataLen);
+	can->mb_ready_ns[mb_idx] = _vt_hal_now_ns();
+	return STATUS_SUCCESS;
+}
+
+status_t FLEXCAN_DRV_GetTransferStatus(uint8_t instance, uint8_t mb_idx)
+{
+	vt_hal_can_t *can = _vt_hal_can(instance);
+
+	if(can == NULL || mb_idx >= can->max_num_mb)
+		return STATUS_ERROR;
+	if(can->mb_busy[mb_idx] == 0)
+		return STATUS_SUCCESS;
+	if(can->bus != 0)
+	{
+		/* The frame leaves when the bus lets it, the poll itself takes time */
+		_vt_hal_cpu_consume(VT_HAL_CAN_POLL_NS);
+		return (can->mb_busy[mb_idx] == 0) ? STATUS_SUCCESS : STATUS_BUSY;
+	}
+	if(can->manual_complete)
+		return STATUS_BUSY;
+
+	/* Polling stands for the time the frame takes on the bus */
+	_vt_hal_can_complete_mb(instance, mb_idx);
+	return STATUS_SUCCESS;
+}
+
+status_t FLEXCAN_DRV_AbortTransfer(uint8_t instance, uint8_t mb_idx)
+{
+	vt_hal_can_t *can = _vt_hal_can(instance);
+
+	if(can == NULL || mb_idx >= can->max_num_mb)
+		return STATUS_ERROR;
+	if(can->mb_busy[mb_idx] == 0)
+		return STATUS_FLEXCAN_NO_TRANSFER_IN_PROGRESS;
+
+	/* A frame already on the bus goes on without its TX complete */
+	can->mb_busy[mb_idx] = 0;
+	can->stats.tx_aborted++;
+	if(can->bus != 0 && hal_bus[can->bus - 1U].busy && hal_bus[can->bus - 1U].sender == instance &&
+	   hal_bus[can->bus - 1U].mb_idx == mb_idx)
+		hal_bus[can->bus - 1U].aborted = 1;
+	return STATUS_SUCCESS;
+}
+
+status_t FLEXCAN_DRV_RxFifo(uint8_t instance, flexcan_msgbuff_t *data)
+{
+	vt_hal_can_t *can = _vt_hal_can(instance);
+
+	if(can == NULL || can->initialized == 0)
+		return STATUS_ERROR;
+	if(can->rx_buff != NULL)
+		return STATUS_BUSY;
+
+	/* Frames already in the FIFO are delivered on the next injection or clock step */
+	can->rx_buff = data;
+	return STATUS_SUCCESS;
+}
+
+status_t FLEXCAN_DRV_RxFifoBlocking(uint8_t instance, flexcan_msgbuff_t *data, uint32_t timeout_ms)
+{
+	vt_hal_can_t *can = _vt_hal_can(instance);
+
+	if(can == NULL || can->initialized == 0 || data == NULL)
+		return STATUS_ERROR;
+
+	if(can->rx_count == 0)
+	{
+		/* Nothing can arrive while the caller blocks, the timeout only costs virtual time */
+		vt_hal_clock_advance(timeout_ms * 1000U);
+		if(can->rx_count == 0)
+			return STATUS_TIMEOUT;
+	}
+
+	*data = can->rx_fifo[can->rx_head];
+	can->rx_head = (can->rx_head + 1U) % VT_HAL_CAN_RX_FIFO_DEPTH;
+	can->rx_count--;
+	can->stats.rx_delivered++;
+	return STATUS_SUCCESS;
+}
+
+void FLEXCAN_DRV_SetRxFifoGlobalMask(uint8_t instance, flexcan_msgbuff_id_type_t id_type, uint32_t mask)
+{
+	(void)instance;
+	(void)id_type;
+	(void)mask;
+}
+
+void FLEXCAN_DRV_SetRxMbGlobalMask(uint8_t instance, flexcan_msgbuff_id_type_t id_type, uint32_t mask)
+{
+	(void)instance;
+	(void)id_type;
+	(void)mask;
+}
+
+void FLEXCAN_DRV_ConfigRxFifo(uint8_t instance, flexcan_rx_fifo_id_element_format_t id_format, const flexcan_id_table_t *id_filter_table)
+{
+	(void)instance;
+	(void)id_format;
+	(void)id_filter_table;
+}
+
+void FLEXCAN_DRV_InstallErrorCallback(uint8_t instance, flexcan_error_callback_t callback, void *callbackParam)
+{
+	vt_hal_can_t *can = _vt_hal_can(instance);
+
+	if(can == NULL || can->state == NULL)
+		return;
+	can->state->error_callback = callback;
+	can->state->errorCallbackParam = callbackParam;
+	can->error_enabled = (callback != NULL) ? 1U : 0U;
+}
+#endif
+
+/*------------------------------------------------------------------*
+ *                            PIT driver                            *
+ *------------------------------------------------------------------*/
+void PIT_DRV_Init(uint32_t instance, const pit_config_t *config)
+{
+	(void)instance;
+	(void)config;
+}
+
+status_t PIT_DRV_InitChannel(uint32_t instance, const pit_channel_config_t *chnlConfig)
+{
+	vt_hal_pit_t *pit;
+
+	(void)instance;
+	if(chnlConfig == NULL || chnlConfig->hwChannel >= VT_HAL_PIT_CHANNELS)
+		return STATUS_ERROR;
+
+	pit = &hal_pit[chnlConfig->hwChannel];
+	if(chnlConfig->periodUnit == PIT_PERIOD_UNITS_MICROSECONDS)
+		pit->period_us = chnlConfig->period;
+	else
+		pit->period_us = chnlConfig->period / VT_HAL_PIT_CLOCK_MHZ;
+	pit->running = 0;
+	return STATUS_SUCCESS;
+}
+
+void PIT_DRV_StartChannel(uint32_t instance, uint32_t channel)
+{
+	(void)instance;
+	if(channel >= VT_HAL_PIT_CHANNELS)
+		return;
+	hal_pit[channel].running = 1;
+	hal_pit[channel].next_us = hal_clock_us + hal_pit[channel].period_us;
+}
+
+void PIT_DRV_StopChannel(uint32_t instance, uint32_t channel)
+{
+	(void)instance;
+	if(channel < VT_HAL_PIT_CHANNELS)
+		hal_pit[channel].running = 0;
+}
+
+void PIT_DRV_ClearStatusFlags(uint32_t instance, uint32_t channel)
+{
+	(void)instance;
+	(void)channel;
+}
+
+/*------------------------------------------------------------------*
+ *                            RTC driver                            *
+ *------------------------------------------------------------------*/
+status_t RTC_DRV_Init(uint32_t instance, rtc_state_t *state, const rtc_init_config_t *config)
+{
+	(void)instance;
+	(void)config;
+	memset(&hal_rtc, 0, sizeof(hal_rtc));
+	if(state != NULL)
+		state->startTime = 0;
+	return STATUS_SUCCESS;
+}
+
+status_t RTC_DRV_SetTimeDate(uint32_t instance, const rtc_timedate_t *time)
+{
+	(void)instance;
+	if(time == NULL)
+		return STATUS_ERROR;
+	hal_rtc.base = *time;
+	hal_rtc.base_us = hal_clock_us;
+	return STATUS_SUCCESS;
+}
+
+status_t RTC_DRV_GetTimeDate(uint32_t instance, rtc_timedate_t *time)
+{
+	uint64_t seconds;
+
+	(void)instance;
+	if(time == NULL)
+		return STATUS_ERROR;
+
+	/* Days run on without a calendar, year and month stay as set */
+	seconds = _vt_hal_rtc_now();
+	*time = hal_rtc.base;
+	time->seconds = (uint8_t)(seconds % 60U);
+	time->minutes = (uint16_t)((seconds / 60U) % 60U);
+	time->hour = (uint16_t)((seconds / 3600U) % 24U);
+	time->day = (uint16_t)(seconds / 86400U);
+	return STATUS_SUCCESS;
+}
+
+status_t RTC_DRV_StartCounter(uint32_t instance)
+{
+	(void)instance;
+	if(!hal_rtc.running)
+	{
+		hal_rtc.base_us = hal_clock_us;
+		hal_rtc.running = 1;
+	}
+	return STATUS_SUCCESS;
+}
+
+status_t RTC_DRV_ConfigureAlarm(uint32_t instance, rtc_alarm_config_t *alarmConfig)
+{
+	uint64_t now, at;
+
+	(void)instance;
+	if(alarmConfig == NULL)
+		return STATUS_ERROR;
+
+	hal_rtc.alarm = *alarmConfig;
+	now = _vt_hal_rtc_now();
+	at = _vt_hal_rtc_seconds(&alarmConfig->alarmTime);
+	hal_rtc.alarm_us = hal_clock_us + ((at > now) ? (at - now) : 1U) * VT_HAL_US_PER_SECOND;
+	hal_rtc.alarm_left = alarmConfig->numberOfRepeats;
+	hal_rtc.alarm_armed = 1;
+	return STATUS_SUCCESS;
+}
+
+/*------------------------------------------------------------------*
+ *                            UART driver                           *
+ *------------------------------------------------------------------*/
+status_t UART_SendData(uint32_t instance, const uint8_t *txBuff, uint32_t txSize)
+{
+	uint32_t i;
+
+	(void)instance;
+	if(txBuff == NULL)
+		return STATUS_ERROR;
+
+	/* The transfer completes at once, the oldest bytes are overwritten when nobody reads them */
+	for(i = 0; i < txSize; i++)
+	{
+		hal_uart[hal_uart_head & VT_HAL_UART_MASK] = txBuff[i];
+		hal_uart_head++;
+		if((hal_uart_head - hal_uart_tail) > VT_HAL_UART_CAPTURE)
+			hal_uart_tail++;
+	}
+	return STATUS_SUCCESS;
+}
+
+status_t UART_SendDataBlocking(uint32_t instance, const uint8_t *txBuff, uint32_t txSize, uint32_t timeout)
+{
+	(void)timeout;
+	return UART_SendData(instance, txBuff, txSize);
+}
+
+status_t UART_GetTransmitStatus(uint32_t instance, uint32_t *bytesRemaining)
+{
+	(void)instance;
+	if(bytesRemaining != NULL)
+		*bytesRemaining = 0;
+	return STATUS_SUCCESS;
+}
+
+#ifdef __cplusplus
+}
+#endif
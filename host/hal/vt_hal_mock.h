@@ -0,0 +1,301 @@
+/*
+ * vt_hal_mock.h
+ *
+ * Host build of the agent: the S32 SDK drivers used by Sources/vt_agent are replaced by a mock HAL on a virtual
+ * clock. Received frames are injected, transmitted frames and UART bytes are captured, and interrupts (PIT,
+ * RTC alarm, FlexCAN callbacks) are raised synchronously from the calls below.
+ *
+ * By default frames are delivered at once and mailboxes complete on the next clock step, no bus timing is
+ * modelled. An instance attached to a virtual bus with vt_hal_bus_attach_can() instead shares the bus with the other
+ * instances and the external nodes of vt_hal_bus_add_node(), at the bitrate of the bus:
+ *   - a frame lasts its bits with stuffing, CRC, ACK, EOF and the 3 bit intermission;
+ *   - the lowest arbitration field of the frames pending on every node wins, mailboxes of an instance included;
+ *   - received frames enter the 6 deep RX FIFO at the end of the frame, and the FIFO drains at the RX service time
+ *     of vt_hal_can_set_rx_service_time(), so a slow vt_rcv_callback() overflows it;
+ *   - error frames (injected, missing ACK, colliding senders, a node at another bitrate) move the transmit and
+ *     receive error counters, failed frames are sent again and a node past 255 goes bus-off, then recovers after
+ *     128 x 11 bit times, each raises FLEXCAN_EVENT_ERROR to the callback of FLEXCAN_DRV_InstallErrorCallback, not
+ *     to the one of FLEXCAN_DRV_Init, and only once it is installed after the last init as on target;
+ *   - a busy FLEXCAN_DRV_GetTransferStatus poll costs VT_HAL_CAN_POLL_NS of virtual time, so vt_send_can_msg() waits
+ *     for the bus as on target.
+ * Remote frames, CAN FD, the error passive suspend time and hard synchronization are not modelled.
+ */
+
+#ifndef VT_HAL_MOCK_H_
+#define VT_HAL_MOCK_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "Cpu.h"
+#include "flexcan_driver.h"
+#include "pit_driver.h"
+#include "rtc_c55_driver.h"
+#include "uart_pal1.h"
+
+/*------------------------------------------------------------------*
+ *                          Define macro                            *
+ *------------------------------------------------------------------*/
+/*! 0 leaves the FLEXCAN_DRV_* calls to another driver, e.g. host/socketcan, the PIT, RTC and UART stay mocked */
+#ifndef VT_HAL_MOCK_FLEXCAN
+#define VT_HAL_MOCK_FLEXCAN         1
+#endif
+
+/*! Number of FlexCAN instances modelled */
+#define VT_HAL_CAN_INSTANCES        3U
+
+/*! Number of message buffers of an instance */
+#define VT_HAL_CAN_MAX_MB           64U
+
+/*! Frames held by the RX FIFO while no buffer is armed with FLEXCAN_DRV_RxFifo */
+#define VT_HAL_CAN_RX_FIFO_DEPTH    6U
+
+/*! Transmitted frames kept per instance until read with vt_hal_can_pop_tx(), must be a power of 2 */
+#ifndef VT_HAL_CAN_TX_CAPTURE
+#define VT_HAL_CAN_TX_CAPTURE       1024U
+#endif
+
+/*! UART bytes kept until read with vt_hal_uart_read(), must be a power of 2 */
+#ifndef VT_HAL_UART_CAPTURE
+#define VT_HAL_UART_CAPTURE         65536U
+#endif
+
+/*! Number of PIT channels modelled */
+#define VT_HAL_PIT_CHANNELS         4U
+
+/*! PE clock of FlexCAN, converts the time segments of FLEXCAN_DRV_Init and FLEXCAN_DRV_SetBitrate to a bitrate */
+#define VT_HAL_CAN_PE_CLOCK_HZ      40000000U
+
+/*! Virtual time taken by a FLEXCAN_DRV_GetTransferStatus poll of a busy mailbox on a bus, in ns */
+#ifndef VT_HAL_CAN_POLL_NS
+#define VT_HAL_CAN_POLL_NS          250U
+#endif
+
+/*! Number of virtual buses */
+#define VT_HAL_BUS_COUNT            3U
+
+/*! External nodes per bus */
+#define VT_HAL_BUS_MAX_NODES        8U
+
+/*! Frames queued per external node, must be a power of 2 */
+#ifndef VT_HAL_BUS_NODE_QUEUE
+#define VT_HAL_BUS_NODE_QUEUE       64U
+#endif
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef struct _vt_hal_can_stats_t
+{
+	uint32_t rx_injected;           /*!< frames handed to vt_hal_can_inject() */
+	uint32_t rx_delivered;          /*!< frames copied to an armed buffer */
+	uint32_t rx_overflow;           /*!< frames lost because the RX FIFO was full */
+	uint32_t tx_sent;               /*!< frames accepted by FLEXCAN_DRV_Send */
+	uint32_t tx_completed;          /*!< TX complete events raised */
+	uint32_t tx_aborted;            /*!< transfers aborted with FLEXCAN_DRV_AbortTransfer */
+	uint32_t tx_capture_lost;       /*!< transmitted frames not captured because the capture was full */
+	uint32_t rx_bus;                /*!< frames received from a bus */
+	uint32_t tx_arbitration_lost;   /*!< arbitrations lost by a pending mailbox on a bus */
+	uint32_t tx_errors;             /*!< frames of the instance destroyed by an error frame */
+	uint32_t rx_errors;             /*!< error frames seen while receiving */
+	uint32_t bus_off;               /*!< times the instance went bus-off */
+	uint32_t tec;                   /*!< transmit error counter */
+	uint32_t rec;                   /*!< receive error counter */
+}vt_hal_can_stats_t;
+
+typedef struct _vt_hal_bus_stats_t
+{
+	uint64_t busy_ns;               /*!< time taken by frames and error frames with their intermission */
+	uint32_t frames;                /*!< frames transmitted without error */
+	uint32_t error_frames;
+	uint32_t stuff_bits;            /*!< stuff bits of the frames transmitted without error */
+	uint32_t arbitrations;          /*!< arbitrations with more than one node pending */
+}vt_hal_bus_stats_t;
+
+typedef struct _vt_hal_bus_node_stats_t
+{
+	uint32_t tx_frames;
+	uint32_t rx_frames;
+	uint32_t tx_arbitration_lost;
+	uint32_t tx_errors;
+	uint32_t bus_off;
+	uint32_t tec;
+	uint32_t rec;
+}vt_hal_bus_node_stats_t;
+
+/*------------------------------------------------------------------*
+ *                       Function Prototypes                        *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will reset every mock peripheral and the virtual clock to 0.
+ * @param [in]   none.
+ * @return       none.
+ */
+void vt_hal_reset(void);
+
+/*!
+ * @brief  This API will get the virtual clock.
+ * @param [in]   none.
+ * @return       microseconds since vt_hal_reset().
+ */
+uint64_t vt_hal_clock_us(void);
+
+/*!
+ * @brief  This API will move the virtual clock forward. Pending TX mailboxes of instances on no bus complete first,
+ *         then every PIT period, RTC second, frame on a bus and RX FIFO delivery crossed raises its interrupt, in
+ *         time order.
+ * @param [in]   us - is microseconds.
+ * @return       none.
+ */
+void vt_hal_clock_advance(uint32_t us);
+
+/*!
+ * @brief  This API will install the interrupt handler of a PIT channel, as the vector table does on target.
+ * @param [in]   channel - is PIT channel.
+ * @param [in]   handler - is handler, e.g. PIT_Ch0_IRQHandler.
+ * @return       none.
+ */
+void vt_hal_pit_install_handler(uint32_t channel, void (*handler)(void));
+
+/*!
+ * @brief  This API will inject a received frame. It is copied to the buffer armed by FLEXCAN_DRV_RxFifo and the
+ *         FLEXCAN_EVENT_RXFIFO_COMPLETE callback runs before the call returns. Without an armed buffer the frame
+ *         waits in the RX FIFO, or raises FLEXCAN_EVENT_RXFIFO_OVERFLOW when the FIFO is full.
+ * @param [in]   instance - is FlexCAN instance.
+ * @param [in]   msgId - is CAN Id.
+ * @param [in]   dataLen - is payload length.
+ * @param [in]   *data - pointer to payload.
+ * @return       STATUS_SUCCESS, STATUS_BUSY if the frame is lost, or STATUS_ERROR.
+ */
+status_t vt_hal_can_inject(uint8_t instance, uint32_t msgId, uint8_t dataLen, const uint8_t *data);
+
+/*!
+ * @brief  This API will choose how mailboxes complete. With auto-complete (the default) a mailbox completes on the
+ *         next vt_hal_clock_advance() or FLEXCAN_DRV_GetTransferStatus; without it only vt_hal_can_complete_tx()
+ *         completes it, which holds the bus to test queueing. Instances on a bus complete when the frame has left.
+ * @param [in]   instance - is FlexCAN instance.
+ * @param [in]   enable - is auto-complete.
+ * @return       none.
+ */
+void vt_hal_can_set_auto_complete(uint8_t instance, bool enable);
+
+/*!
+ * @brief  This API will complete every pending mailbox of an instance, raising FLEXCAN_EVENT_TX_COMPLETE for each.
+ * @param [in]   instance - is FlexCAN instance.
+ * @return       number of mailboxes completed.
+ */
+uint32_t vt_hal_can_complete_tx(uint8_t instance);
+
+/*!
+ * @brief  This API will get the oldest captured transmitted frame. On a bus frames are captured when they leave
+ *         without error, in bus order.
+ * @param [in]   instance - is FlexCAN instance.
+ * @param [out]  *msg - pointer to flexcan_msgbuff_t structure.
+ * @return       STATUS_SUCCESS, or STATUS_ERROR if nothing was transmitted.
+ */
+status_t vt_hal_can_pop_tx(uint8_t instance, flexcan_msgbuff_t *msg);
+
+/*!
+ * @brief  This API will get counters of a FlexCAN instance.
+ * @param [in]   instance - is FlexCAN instance.
+ * @param [out]  *stats - pointer to vt_hal_can_stats_t structure.
+ * @return       STATUS_SUCCESS or STATUS_ERROR.
+ */
+status_t vt_hal_can_get_stats(uint8_t instance, vt_hal_can_stats_t *stats);
+
+/*!
+ * @brief  This API will set the time the RX interrupt takes per frame. A frame of the RX FIFO is delivered that long
+ *         after the previous one at the earliest, the others wait in the FIFO or overflow it.
+ * @param [in]   instance - is FlexCAN instance.
+ * @param [in]   ns - is service time in ns, 0 (the default) delivers at once.
+ * @return       none.
+ */
+void vt_hal_can_set_rx_service_time(uint8_t instance, uint32_t ns);
+
+/*!
+ * @brief  This API will create an empty bus, without instance or node.
+ * @param [in]   bus - is bus number, below VT_HAL_BUS_COUNT.
+ * @param [in]   bitrate - is bitrate in bit/s.
+ * @return       STATUS_SUCCESS or STATUS_ERROR.
+ */
+status_t vt_hal_bus_init(uint8_t bus, uint32_t bitrate);
+
+/*!
+ * @brief  This API will attach a FlexCAN instance to a bus, before or after FLEXCAN_DRV_Init. The instance runs at
+ *         the bitrate of its own time segments and takes part in arbitration, ACK and error signalling.
+ * @param [in]   bus - is bus number.
+ * @param [in]   instance - is FlexCAN instance.
+ * @return       STATUS_SUCCESS or STATUS_ERROR.
+ */
+status_t vt_hal_bus_attach_can(uint8_t bus, uint8_t instance);
+
+/*!
+ * @brief  This API will add an external node to a bus. It acknowledges every frame and sends the frames queued with
+ *         vt_hal_bus_node_send() in order.
+ * @param [in]   bus - is bus number.
+ * @return       node number, or -1 if the bus is full or not initialized.
+ */
+int vt_hal_bus_add_node(uint8_t bus);
+
+/*!
+ * @brief  This API will queue a frame on an external node, ready from the current virtual time. Ids above 0x7FF
+ *         are sent as extended Ids.
+ * @param [in]   bus - is bus number.
+ * @param [in]   node - is node number.
+ * @param [in]   msgId - is CAN Id.
+ * @param [in]   dataLen - is payload length, up to 8.
+ * @param [in]   *data - pointer to payload.
+ * @return       STATUS_SUCCESS, STATUS_BUSY if the queue is full, or STATUS_ERROR.
+ */
+status_t vt_hal_bus_node_send(uint8_t bus, int node, uint32_t msgId, uint8_t dataLen, const uint8_t *data);
+
+/*!
+ * @brief  This API will get the frames an external node has still to send.
+ * @param [in]   bus - is bus number.
+ * @param [in]   node - is node number.
+ * @return       number of frames, the one on the bus included.
+ */
+uint32_t vt_hal_bus_node_pending(uint8_t bus, int node);
+
+/*!
+ * @brief  This API will get counters of an external node.
+ * @param [in]   bus - is bus number.
+ * @param [in]   node - is node number.
+ * @param [out]  *stats - pointer to vt_hal_bus_node_stats_t structure.
+ * @return       STATUS_SUCCESS or STATUS_ERROR.
+ */
+status_t vt_hal_bus_node_get_stats(uint8_t bus, int node, vt_hal_bus_node_stats_t *stats);
+
+/*!
+ * @brief  This API will destroy the next frames of a bus with a CRC error, as noise on the wires does.
+ * @param [in]   bus - is bus number.
+ * @param [in]   count - is number of frames.
+ * @return       none.
+ */
+void vt_hal_bus_inject_errors(uint8_t bus, uint32_t count);
+
+/*!
+ * @brief  This API will get counters of a bus.
+ * @param [in]   bus - is bus number.
+ * @param [out]  *stats - pointer to vt_hal_bus_stats_t structure.
+ * @return       STATUS_SUCCESS or STATUS_ERROR.
+ */
+status_t vt_hal_bus_get_stats(uint8_t bus, vt_hal_bus_stats_t *stats);
+
+/*!
+ * @brief  This API will read captured UART bytes.
+ * @param [out]  *buff - pointer to buffer.
+ * @param [in]   len - size of buffer.
+ * @return       number of bytes copied.
+ */
+uint32_t vt_hal_uart_read(uint8_t *buff, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VT_HAL_MOCK_H_ */
@@ -0,0 +1,907 @@
+/*
+ * vt_socketcan.c
+ *
+ * FlexCAN driver on Linux SocketCAN raw sockets, see vt_socketcan.h.
+ */
+
+#define _GNU_SOURCE
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <linux/net_tstamp.h>
+#include "vt_atomic.h"
+#include "vt_socketcan.h"
+
+/*------------------------------------------------------------------*
+ *                          Define Macro                            *
+ *------------------------------------------------------------------*/
+#define VT_SOCKETCAN_TX_MASK        (VT_SOCKETCAN_TX_QUEUE - 1U)
+
+#if (VT_SOCKETCAN_TX_QUEUE & VT_SOCKETCAN_TX_MASK) != 0
+#error "VT_SOCKETCAN_TX_QUEUE must be a power of 2"
+#endif
+
+/*! The receive thread wakes up at least this often to see a stop request */
+#define VT_SOCKETCAN_RX_TIMEOUT_US  100000L
+/*! Back-off of the transmit thread while the interface queue is full */
+#define VT_SOCKETCAN_TX_RETRY_NS    100000L
+
+/*! Entries of the RX FIFO filter table, FLEXCAN_RX_FIFO_ID_FILTERS_48 */
+#define VT_SOCKETCAN_MAX_FILTERS    48U
+
+/*! Bits of the control and status word of a FlexCAN message buffer */
+#define VT_SOCKETCAN_CS_SRR         (1UL << 22)
+#define VT_SOCKETCAN_CS_IDE         (1UL << 21)
+#define VT_SOCKETCAN_CS_RTR         (1UL << 20)
+#define VT_SOCKETCAN_CS_DLC_SHIFT   16U
+
+#define VT_SOCKETCAN_NS_PER_S       1000000000ULL
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+/*! Payload of SCM_TIMESTAMPING: software, deprecated, hardware */
+typedef struct _vt_socketcan_scm_ts_t
+{
+	struct timespec ts[3];
+}vt_socketcan_scm_ts_t;
+
+/*! Control messages of a received frame: SCM_TIMESTAMPING or SCM_TIMESTAMPNS, and SO_RXQ_OVFL */
+typedef union _vt_socketcan_cmsg_t
+{
+	struct cmsghdr align;
+	uint8_t buff[CMSG_SPACE(sizeof(vt_socketcan_scm_ts_t)) + CMSG_SPACE(sizeof(uint32_t))];
+}vt_socketcan_cmsg_t;
+
+typedef struct _vt_socketcan_port_t
+{
+	char ifname[IFNAMSIZ];
+	int fd;
+	uint8_t open;
+	uint8_t stop;
+	flexcan_state_t *state;
+	uint32_t max_num_mb;
+	pthread_t rx_thread;
+	pthread_t tx_thread;
+	/* Receive, rx_lock */
+	pthread_mutex_t rx_lock;
+	pthread_cond_t rx_cond;
+	flexcan_msgbuff_t *rx_buff;     /*!< armed by FLEXCAN_DRV_RxFifo */
+	flexcan_msgbuff_t *rx_wait;     /*!< waited for by FLEXCAN_DRV_RxFifoBlocking */
+	uint32_t rx_overflow;           /*!< last SO_RXQ_OVFL count */
+	uint64_t rx_timestamp_ns;
+	uint32_t global_mask;
+	uint32_t filter[VT_SOCKETCAN_MAX_FILTERS];
+	uint32_t filter_count;
+	uint32_t filter_num;            /*!< entries of the table given to FLEXCAN_DRV_ConfigRxFifo */
+	uint8_t filter_extended;
+	/* Transmit, tx_lock */
+	pthread_mutex_t tx_lock;
+	pthread_cond_t tx_cond;
+	struct can_frame tx_queue[VT_SOCKETCAN_TX_QUEUE];
+	uint32_t tx_head;
+	uint32_t tx_tail;
+	struct can_frame mb_frame[VT_SOCKETCAN_MAX_MB];
+	uint8_t mb_busy[VT_SOCKETCAN_MAX_MB];   /*!< the frame waits for room in tx_queue */
+	uint32_t mb_pending;
+	vt_socketcan_stats_t stats;
+}vt_socketcan_port_t;
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+static vt_socketcan_port_t sc_port[VT_SOCKETCAN_INSTANCES];
+static pthread_once_t sc_once = PTHREAD_ONCE_INIT;
+/*! Interrupt lock: callbacks of every instance run one at a time, as the FlexCAN interrupts of a core */
+static pthread_mutex_t sc_irq_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will set up the ports once.
+ * @param [in]   none.
+ * @return       none.
+ */
+static void _vt_socketcan_setup(void)
+{
+	uint32_t i;
+
+	for(i = 0; i < VT_SOCKETCAN_INSTANCES; i++)
+	{
+		memset(&sc_port[i], 0, sizeof(vt_socketcan_port_t));
+		snprintf(sc_port[i].ifname, sizeof(sc_port[i].ifname), "can%u", (unsigned)i);
+		sc_port[i].fd = -1;
+		pthread_mutex_init(&sc_port[i].rx_lock, NULL);
+		pthread_cond_init(&sc_port[i].rx_cond, NULL);
+		pthread_mutex_init(&sc_port[i].tx_lock, NULL);
+		pthread_cond_init(&sc_port[i].tx_cond, NULL);
+	}
+}
+
+/*!
+ * @brief  This API will get the port of an instance.
+ * @param [in]   instance - is FlexCAN instance.
+ * @return       pointer to vt_socketcan_port_t structure, NULL if out of range.
+ */
+static vt_socketcan_port_t *_vt_socketcan_port(uint8_t instance)
+{
+	pthread_once(&sc_once, _vt_socketcan_setup);
+	if(instance >= VT_SOCKETCAN_INSTANCES)
+		return NULL;
+	return &sc_port[instance];
+}
+
+/*!
+ * @brief  This API will check a mailbox of an open port.
+ * @param [in]   *port - pointer to vt_socketcan_port_t structure.
+ * @param [in]   mb_idx - is mailbox.
+ * @return       STATUS_SUCCESS, STATUS_ERROR or STATUS_FLEXCAN_MB_OUT_OF_RANGE.
+ */
+static status_t _vt_socketcan_check_mb(const vt_socketcan_port_t *port, uint8_t mb_idx)
+{
+	if(port == NULL || port->open == 0)
+		return STATUS_ERROR;
+	if(mb_idx >= port->max_num_mb)
+		return STATUS_FLEXCAN_MB_OUT_OF_RANGE;
+	return STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will raise an event to the callback of FLEXCAN_DRV_Init, the interrupt lock is held.
+ * @param [in]   instance - is FlexCAN instance.
+ * @param [in]   event - is event.
+ * @return       none.
+ */
+static void _vt_socketcan_event(uint8_t instance, flexcan_event_type_t event)
+{
+	flexcan_state_t *state = sc_port[instance].state;
+
+	if(state != NULL && state->callback != NULL)
+		state->callback(instance, event, state);
+}
+
+/*!
+ * @brief  This API will apply the RX FIFO filter table and global mask to the socket, rx_lock is held.
+ * @param [in]   *port - pointer to vt_socketcan_port_t structure.
+ * @return       none.
+ */
+static void _vt_socketcan_apply_filter(vt_socketcan_port_t *port)
+{
+	struct can_filter filter[VT_SOCKETCAN_MAX_FILTERS];
+	uint32_t i, count = 0;
+	uint8_t extended;
+
+	if(port->fd < 0)
+		return;
+
+	if(port->global_mask == 0 || port->filter_count == 0)
+	{
+		/* Nothing masked, every frame passes */
+		filter[0].can_id = 0;
+		filter[0].can_mask = 0;
+		count = 1;
+	}
+	else
+	{
+		for(i = 0; i < port->filter_count; i++)
+		{
+			extended = (port->filter_extended || port->filter[i] > CAN_SFF_MASK) ? 1U : 0U;
+			if(extended)
+			{
+				filter[count].can_id = (port->filter[i] & CAN_EFF_MASK) | CAN_EFF_FLAG;
+				filter[count].can_mask = (port->global_mask & CAN_EFF_MASK) | CAN_EFF_FLAG;
+			}
+			else
+			{
+				filter[count].can_id = port->filter[i] & CAN_SFF_MASK;
+				filter[count].can_mask = (port->global_mask & CAN_SFF_MASK) | CAN_EFF_FLAG;
+			}
+			count++;
+		}
+	}
+	(void)setsockopt(port->fd, SOL_CAN_RAW, CAN_RAW_FILTER, filter, count * sizeof(struct can_filter));
+}
+
+/*!
+ * @brief  This API will copy a SocketCAN frame to a FlexCAN message buffer.
+ * @param [out]  *msg - pointer to flexcan_msgbuff_t structure.
+ * @param [in]   *frame - pointer to can_frame structure.
+ * @return       none.
+ */
+static void _vt_socketcan_to_msg(flexcan_msgbuff_t *msg, const struct can_frame *frame)
+{
+	uint8_t len = (frame->can_dlc > CAN_MAX_DLEN) ? CAN_MAX_DLEN : frame->can_dlc;
+
+	memset(msg, 0, sizeof(flexcan_msgbuff_t));
+	msg->cs = (uint32_t)len << VT_SOCKETCAN_CS_DLC_SHIFT;
+	if(frame->can_id & CAN_EFF_FLAG)
+	{
+		msg->msgId = frame->can_id & CAN_EFF_MASK;
+		msg->cs |= VT_SOCKETCAN_CS_IDE | VT_SOCKETCAN_CS_SRR;
+	}
+	else
+	{
+		msg->msgId = frame->can_id & CAN_SFF_MASK;
+	}
+	if(frame->can_id & CAN_RTR_FLAG)
+		msg->cs |= VT_SOCKETCAN_CS_RTR;
+	else
+		memcpy(msg->data, frame->data, len);
+	msg->dataLen = len;
+}
+
+/*!
+ * @brief  This API will read the RX timestamp and the drop count of a received frame.
+ * @param [in]   *hdr - pointer to msghdr structure of the frame.
+ * @param [out]  *ts_ns - pointer to timestamp in ns, 0 if none.
+ * @param [out]  *overflow - pointer to SO_RXQ_OVFL count, unchanged if none.
+ * @return       none.
+ */
+static void _vt_socketcan_parse_cmsg(struct msghdr *hdr, uint64_t *ts_ns, uint32_t *overflow)
+{
+	struct cmsghdr *cmsg;
+	vt_socketcan_scm_ts_t scm;
+	struct timespec ts;
+
+	*ts_ns = 0;
+	for(cmsg = CMSG_FIRSTHDR(hdr); cmsg != NULL; cmsg = CMSG_NXTHDR(hdr, cmsg))
+	{
+		if(cmsg->cmsg_level != SOL_SOCKET)
+			continue;
+		if(cmsg->cmsg_type == SO_TIMESTAMPING && cmsg->cmsg_len >= CMSG_LEN(sizeof(scm)))
+		{
+			/* Hardware time when the interface stamps, software time otherwise */
+			memcpy(&scm, CMSG_DATA(cmsg), sizeof(scm));
+			ts = (scm.ts[2].tv_sec != 0 || scm.ts[2].tv_nsec != 0) ? scm.ts[2] : scm.ts[0];
+			*ts_ns = (uint64_t)ts.tv_sec * VT_SOCKETCAN_NS_PER_S + (uint64_t)ts.tv_nsec;
+		}
+		else if(cmsg->cmsg_type == SO_TIMESTAMPNS && cmsg->cmsg_len >= CMSG_LEN(sizeof(ts)))
+		{
+			memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+			*ts_ns = (uint64_t)ts.tv_sec * VT_SOCKETCAN_NS_PER_S + (uint64_t)ts.tv_nsec;
+		}
+		else if(cmsg->cmsg_type == SO_RXQ_OVFL && cmsg->cmsg_len >= CMSG_LEN(sizeof(uint32_t)))
+		{
+			memcpy(overflow, CMSG_DATA(cmsg), sizeof(uint32_t));
+		}
+	}
+}
+
+/*!
+ * @brief  This API will hand a received frame to the driver, the interrupt lock is held.
+ * @param [in]   instance - is FlexCAN instance.
+ * @param [in]   *frame - pointer to can_frame structure.
+ * @param [in]   *hdr - pointer to msghdr structure of the frame.
+ * @return       none.
+ */
+static void _vt_socketcan_deliver(uint8_t instance, const struct can_frame *frame, struct msghdr *hdr)
+{
+	vt_socketcan_port_t *port = &sc_port[instance];
+	flexcan_msgbuff_t *buff;
+	uint64_t ts_ns;
+	uint32_t overflow = port->rx_overflow;
+
+	_vt_socketcan_parse_cmsg(hdr, &ts_ns, &overflow);
+	if(overflow != port->rx_overflow)
+	{
+		/* The socket dropped frames since the last one, the FIFO overflowed */
+		VT_ATOMIC_ADD(&port->stats.rx_dropped, (uint64_t)(overflow - port->rx_overflow));
+		port->rx_overflow = overflow;
+		_vt_socketcan_event(instance, FLEXCAN_EVENT_RXFIFO_OVERFLOW);
+	}
+	if(frame->can_id & CAN_ERR_FLAG)
+		return;
+
+	pthread_mutex_lock(&port->rx_lock);
+	if(port->rx_wait != NULL)
+	{
+		_vt_socketcan_to_msg(port->rx_wait, frame);
+		port->rx_wait = NULL;
+		pthread_cond_signal(&port->rx_cond);
+		pthread_mutex_unlock(&port->rx_lock);
+		VT_ATOMIC_ADD(&port->stats.rx_delivered, 1);
+		return;
+	}
+	buff = port->rx_buff;
+	port->rx_buff = NULL;
+	pthread_mutex_unlock(&port->rx_lock);
+
+	if(buff == NULL)
+	{
+		VT_ATOMIC_ADD(&port->stats.rx_lost, 1);
+		_vt_socketcan_event(instance, FLEXCAN_EVENT_RXFIFO_OVERFLOW);
+		return;
+	}
+	_vt_socketcan_to_msg(buff, frame);
+	port->rx_timestamp_ns = ts_ns;
+	VT_ATOMIC_ADD(&port->stats.rx_delivered, 1);
+	_vt_socketcan_event(instance, FLEXCAN_EVENT_RXFIFO_COMPLETE);
+}
+
+/*!
+ * @brief  This API will read frames in batches until the port stops.
+ * @param [in]   *arg - pointer to vt_socketcan_port_t structure.
+ * @return       NULL.
+ */
+static void *_vt_socketcan_rx_thread(void *arg)
+{
+	vt_socketcan_port_t *port = (vt_socketcan_port_t *)arg;
+	uint8_t instance = (uint8_t)(port - sc_port);
+	struct can_frame frames[VT_SOCKETCAN_BATCH];
+	struct iovec iov[VT_SOCKETCAN_BATCH];
+	struct mmsghdr msgs[VT_SOCKETCAN_BATCH];
+	vt_socketcan_cmsg_t cmsg[VT_SOCKETCAN_BATCH];
+	struct timespec pause = {0, VT_SOCKETCAN_TX_RETRY_NS};
+	uint32_t i;
+	int n;
+
+	while(!VT_ATOMIC_LOAD(&port->stop))
+	{
+		memset(msgs, 0, sizeof(msgs));
+		for(i = 0; i < VT_SOCKETCAN_BATCH; i++)
+		{
+			iov[i].iov_base = &frames[i];
+			iov[i].iov_len = sizeof(struct can_frame);
+			msgs[i].msg_hdr.msg_iov = &iov[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+			msgs[i].msg_hdr.msg_control = cmsg[i].buff;
+			msgs[i].msg_hdr.msg_controllen = sizeof(cmsg[i].buff);
+		}
+
+		/* Blocks for the first frame only, then takes what is queued */
+		n = recvmmsg(port->fd, msgs, VT_SOCKETCAN_BATCH, MSG_WAITFORONE, NULL);
+		if(n <= 0)
+		{
+			/* Timeouts let the stop flag be seen, other errors (interface down) are retried */
+			if(n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+				nanosleep(&pause, NULL);
+			continue;
+		}
+		VT_ATOMIC_ADD(&port->stats.rx_batches, 1);
+		VT_ATOMIC_ADD(&port->stats.rx_frames, (uint64_t)n);
+
+		pthread_mutex_lock(&sc_irq_lock);
+		for(i = 0; i < (uint32_t)n; i++)
+		{
+			if(msgs[i].msg_len == sizeof(struct can_frame))
+				_vt_socketcan_deliver(instance, &frames[i], &msgs[i].msg_hdr);
+		}
+		pthread_mutex_unlock(&sc_irq_lock);
+	}
+	return NULL;
+}
+
+/*!
+ * @brief  This API will move mailboxes waiting for room to the transmit queue, lowest first, tx_lock is held.
+ * @param [in]   *port - pointer to vt_socketcan_port_t structure.
+ * @return       none.
+ */
+static void _vt_socketcan_tx_refill(vt_socketcan_port_t *port)
+{
+	uint32_t mb_idx;
+
+	for(mb_idx = 0; mb_idx < VT_SOCKETCAN_MAX_MB && port->mb_pending > 0; mb_idx++)
+	{
+		if((port->tx_head - port->tx_tail) >= VT_SOCKETCAN_TX_QUEUE)
+			return;
+		if(port->mb_busy[mb_idx])
+		{
+			port->tx_queue[port->tx_head & VT_SOCKETCAN_TX_MASK] = port->mb_frame[mb_idx];
+			port->tx_head++;
+			port->mb_busy[mb_idx] = 0;
+			port->mb_pending--;
+		}
+	}
+}
+
+/*!
+ * @brief  This API will take frames of the transmit queue.
+ * @param [in]   *port - pointer to vt_socketcan_port_t structure.
+ * @param [out]  *frames - pointer to frames.
+ * @param [in]   max - is number of frames that fit.
+ * @return       number of frames taken.
+ */
+static uint32_t _vt_socketcan_tx_take(vt_socketcan_port_t *port, struct can_frame *frames, uint32_t max)
+{
+	uint32_t count = 0;
+
+	pthread_mutex_lock(&port->tx_lock);
+	while(count < max && port->tx_head != port->tx_tail)
+	{
+		frames[count++] = port->tx_queue[port->tx_tail & VT_SOCKETCAN_TX_MASK];
+		port->tx_tail++;
+	}
+	_vt_socketcan_tx_refill(port);
+	pthread_mutex_unlock(&port->tx_lock);
+	return count;
+}
+
+/*!
+ * @brief  This API will write the queued frames in batches until the port stops.
+ * @param [in]   *arg - pointer to vt_socketcan_port_t structure.
+ * @return       NULL.
+ */
+static void *_vt_socketcan_tx_thread(void *arg)
+{
+	vt_socketcan_port_t *port = (vt_socketcan_port_t *)arg;
+	uint8_t instance = (uint8_t)(port - sc_port);
+	struct can_frame frames[VT_SOCKETCAN_BATCH];
+	struct iovec iov[VT_SOCKETCAN_BATCH];
+	struct mmsghdr msgs[VT_SOCKETCAN_BATCH];
+	struct timespec pause = {0, VT_SOCKETCAN_TX_RETRY_NS};
+	uint32_t i, count, taken, sent;
+	int n;
+
+	memset(msgs, 0, sizeof(msgs));
+	for(i = 0; i < VT_SOCKETCAN_BATCH; i++)
+	{
+		iov[i].iov_base = &frames[i];
+		iov[i].iov_len = sizeof(struct can_frame);
+		msgs[i].msg_hdr.msg_iov = &iov[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	while(1)
+	{
+		pthread_mutex_lock(&port->tx_lock);
+		while(port->tx_head == port->tx_tail && !VT_ATOMIC_LOAD(&port->stop))
+			pthread_cond_wait(&port->tx_cond, &port->tx_lock);
+		pthread_mutex_unlock(&port->tx_lock);
+		if(VT_ATOMIC_LOAD(&port->stop))
+			break;
+
+		/*
+		 * A frame is complete once taken for the batch. Its TX complete runs the callback, which may queue the next
+		 * frame of the agent, so a gateway forwarding one frame at a time still fills the batch.
+		 */
+		count = _vt_socketcan_tx_take(port, frames, VT_SOCKETCAN_BATCH);
+		taken = count;
+		while(taken > 0)
+		{
+			pthread_mutex_lock(&sc_irq_lock);
+			for(i = 0; i < taken; i++)
+				_vt_socketcan_event(instance, FLEXCAN_EVENT_TX_COMPLETE);
+			pthread_mutex_unlock(&sc_irq_lock);
+			taken = _vt_socketcan_tx_take(port, &frames[count], VT_SOCKETCAN_BATCH - count);
+			count += taken;
+		}
+
+		sent = 0;
+		while(sent < count)
+		{
+			n = sendmmsg(port->fd, &msgs[sent], count - sent, 0);
+			if(n > 0)
+			{
+				sent += (uint32_t)n;
+				VT_ATOMIC_ADD(&port->stats.tx_batches, 1);
+				VT_ATOMIC_ADD(&port->stats.tx_frames, (uint64_t)n);
+			}
+			else if((errno == ENOBUFS || errno == EAGAIN || errno == EINTR) && !VT_ATOMIC_LOAD(&port->stop))
+			{
+				/* The interface queue is full, wait for the bus */
+				VT_ATOMIC_ADD(&port->stats.tx_retries, 1);
+				nanosleep(&pause, NULL);
+			}
+			else
+			{
+				/* The first frame cannot be written, e.g. the interface is down */
+				VT_ATOMIC_ADD(&port->stats.tx_errors, 1);
+				sent++;
+			}
+		}
+	}
+	return NULL;
+}
+
+/*!
+ * @brief  This API will open the raw socket of a port and start its threads.
+ * @param [in]   *port - pointer to vt_socketcan_port_t structure.
+ * @return       STATUS_SUCCESS or STATUS_ERROR.
+ */
+static status_t _vt_socketcan_open(vt_socketcan_port_t *port)
+{
+	struct sockaddr_can addr;
+	struct timeval timeout = {0, VT_SOCKETCAN_RX_TIMEOUT_US};
+	int rcvbuf = (int)VT_SOCKETCAN_RCVBUF;
+	int flags = SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE |
+	            SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+	int on = 1;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.can_family = AF_CAN;
+	addr.can_ifindex = (int)if_nametoindex(port->ifname);
+	if(addr.can_ifindex == 0)
+		return STATUS_ERROR;
+
+	port->fd = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+	if(port->fd < 0)
+		return STATUS_ERROR;
+	if(bind(port->fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+	{
+		close(port->fd);
+		port->fd = -1;
+		return STATUS_ERROR;
+	}
+
+	/* Options past the binding are best effort, a missing one only costs its information */
+	(void)setsockopt(port->fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+	(void)setsockopt(port->fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	(void)setsockopt(port->fd, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on));
+	if(setsockopt(port->fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) < 0)
+		(void)setsockopt(port->fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on));
+	_vt_socketcan_apply_filter(port);
+
+	VT_ATOMIC_STORE(&port->stop, 0);
+	if(pthread_create(&port->rx_thread, NULL, _vt_socketcan_rx_thread, port) != 0)
+	{
+		close(port->fd);
+		port->fd = -1;
+		return STATUS_ERROR;
+	}
+	if(pthread_create(&port->tx_thread, NULL, _vt_socketcan_tx_thread, port) != 0)
+	{
+		VT_ATOMIC_STORE(&port->stop, 1);
+		pthread_join(port->rx_thread, NULL);
+		close(port->fd);
+		port->fd = -1;
+		return STATUS_ERROR;
+	}
+	port->open = 1;
+	return STATUS_SUCCESS;
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will bind an instance to a network interface, before FLEXCAN_DRV_Init.
+ * @param [in]   instance - is FlexCAN instance.
+ * @param [in]   *ifname - pointer to interface name, e.g. "can0" or "vcan0".
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL or VT_STATUS_INVALID.
+ */
+vt_status_t vt_socketcan_set_interface(uint8_t instance, const char *ifname)
+{
+	vt_socketcan_port_t *port = _vt_socketcan_port(instance);
+
+	if(ifname == NULL)
+		return VT_STATUS_NULL;
+	if(port == NULL || port->open || strlen(ifname) == 0 || strlen(ifname) >= sizeof(port->ifname))
+		return VT_STATUS_INVALID;
+
+	strcpy(port->ifname, ifname);
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will stop the threads of an instance and close its socket.
+ * @param [in]   instance - is FlexCAN instance.
+ * @return       none.
+ */
+void vt_socketcan_close(uint8_t instance)
+{
+	vt_socketcan_port_t *port = _vt_socketcan_port(instance);
+
+	if(port == NULL || port->open == 0)
+		return;
+
+	pthread_mutex_lock(&port->tx_lock);
+	VT_ATOMIC_STORE(&port->stop, 1);
+	pthread_cond_signal(&port->tx_cond);
+	pthread_mutex_unlock(&port->tx_lock);
+	pthread_join(port->rx_thread, NULL);
+	pthread_join(port->tx_thread, NULL);
+	close(port->fd);
+	port->fd = -1;
+	port->open = 0;
+}
+
+/*!
+ * @brief  This API will take the lock the callbacks run under.
+ * @param [in]   none.
+ * @return       none.
+ */
+void vt_socketcan_lock(void)
+{
+	pthread_mutex_lock(&sc_irq_lock);
+}
+
+/*!
+ * @brief  This API will release the lock the callbacks run under.
+ * @param [in]   none.
+ * @return       none.
+ */
+void vt_socketcan_unlock(void)
+{
+	pthread_mutex_unlock(&sc_irq_lock);
+}
+
+/*!
+ * @brief  This API will get the kernel RX timestamp of the frame being delivered.
+ * @param [in]   instance - is FlexCAN instance.
+ * @return       CLOCK_REALTIME in ns, 0 if unknown.
+ */
+uint64_t vt_socketcan_rx_timestamp_ns(uint8_t instance)
+{
+	vt_socketcan_port_t *port = _vt_socketcan_port(instance);
+
+	return (port != NULL) ? port->rx_timestamp_ns : 0;
+}
+
+/*!
+ * @brief  This API will get counters of an instance.
+ * @param [in]   instance - is FlexCAN instance.
+ * @param [out]  *stats - pointer to vt_socketcan_stats_t structure.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL or VT_STATUS_INVALID.
+ */
+vt_status_t vt_socketcan_get_stats(uint8_t instance, vt_socketcan_stats_t *stats)
+{
+	vt_socketcan_port_t *port = _vt_socketcan_port(instance);
+
+	if(stats == NULL)
+		return VT_STATUS_NULL;
+	if(port == NULL)
+		return VT_STATUS_INVALID;
+
+	stats->rx_frames = VT_ATOMIC_LOAD(&port->stats.rx_frames);
+	stats->rx_batches = VT_ATOMIC_LOAD(&port->stats.rx_batches);
+	stats->rx_delivered = VT_ATOMIC_LOAD(&port->stats.rx_delivered);
+	stats->rx_lost = VT_ATOMIC_LOAD(&port->stats.rx_lost);
+	stats->rx_dropped = VT_ATOMIC_LOAD(&port->stats.rx_dropped);
+	stats->tx_frames = VT_ATOMIC_LOAD(&port->stats.tx_frames);
+	stats->tx_batches = VT_ATOMIC_LOAD(&port->stats.tx_batches);
+	stats->tx_retries = VT_ATOMIC_LOAD(&port->stats.tx_retries);
+	stats->tx_errors = VT_ATOMIC_LOAD(&port->stats.tx_errors);
+	return VT_STATUS_SUCCESS;
+}
+
+/*------------------------------------------------------------------*
+ *                          FlexCAN driver                          *
+ *------------------------------------------------------------------*/
+status_t FLEXCAN_DRV_Init(uint8_t instance, flexcan_state_t *state, const flexcan_user_config_t *data)
+{
+	vt_socketcan_port_t *port = _vt_socketcan_port(instance);
+
+	if(port == NULL || state == NULL || data == NULL)
+		return STATUS_ERROR;
+
+	/* Bitrate and mode belong to the interface, "ip link" sets them */
+	port->state = state;
+	port->max_num_mb = (data->max_num_mb < VT_SOCKETCAN_MAX_MB) ? data->max_num_mb : VT_SOCKETCAN_MAX_MB;
+	port->filter_num = 8U * ((uint32_t)data->num_id_filters + 1U);
+	if(port->filter_num > VT_SOCKETCAN_MAX_FILTERS)
+		port->filter_num = VT_SOCKETCAN_MAX_FILTERS;
+
+	/* Re-initialization drops the frames not taken yet, as a module reset does */
+	pthread_mutex_lock(&port->rx_lock);
+	port->rx_buff = NULL;
+	pthread_mutex_unlock(&port->rx_lock);
+	pthread_mutex_lock(&port->tx_lock);
+	port->tx_tail = port->tx_head;
+	memset(port->mb_busy, 0, sizeof(port->mb_busy));
+	port->mb_pending = 0;
+	pthread_mutex_unlock(&port->tx_lock);
+
+	if(port->open)
+		return STATUS_SUCCESS;
+	return _vt_socketcan_open(port);
+}
+
+void FLEXCAN_DRV_SetBitrate(uint8_t instance, const flexcan_time_segment_t *bitrate)
+{
+	/* The bitrate of a SocketCAN interface is set with "ip link" */
+	(void)instance;
+	(void)bitrate;
+}
+
+status_t FLEXCAN_DRV_ConfigTxMb(uint8_t instance, uint8_t mb_idx, const flexcan_data_info_t *tx_info, uint32_t msg_id)
+{
+	(void)tx_info;
+	(void)msg_id;
+	return _vt_socketcan_check_mb(_vt_socketcan_port(instance), mb_idx);
+}
+
+status_t FLEXCAN_DRV_Send(uint8_t instance, uint8_t mb_idx, const flexcan_data_info_t *tx_info, uint32_t msg_id, const uint8_t *mb_data)
+{
+	vt_socketcan_port_t *port = _vt_socketcan_port(instance);
+	struct can_frame frame;
+	status_t result;
+
+	result = _vt_socketcan_check_mb(port, mb_idx);
+	if(result != STATUS_SUCCESS)
+		return result;
+	if(tx_info == NULL)
+		return STATUS_ERROR;
+
+	memset(&frame, 0, sizeof(frame));
+	if(tx_info->msg_id_type == FLEXCAN_MSG_ID_EXT)
+		frame.can_id = (msg_id & CAN_EFF_MASK) | CAN_EFF_FLAG;
+	else
+		frame.can_id = msg_id & CAN_SFF_MASK;
+	frame.can_dlc = (tx_info->data_length > CAN_MAX_DLEN) ? CAN_MAX_DLEN : (uint8_t)tx_info->data_length;
+	if(tx_info->is_remote)
+		frame.can_id |= CAN_RTR_FLAG;
+	else if(mb_data != NULL)
+		memcpy(frame.data, mb_data, frame.can_dlc);
+
+	pthread_mutex_lock(&port->tx_lock);
+	if(port->mb_busy[mb_idx])
+	{
+		pthread_mutex_unlock(&port->tx_lock);
+		return STATUS_BUSY;
+	}
+	if(port->mb_pending == 0 && (port->tx_head - port->tx_tail) < VT_SOCKETCAN_TX_QUEUE)
+	{
+		/* The mailbox is free again at once */
+		port->tx_queue[port->tx_head & VT_SOCKETCAN_TX_MASK] = frame;
+		port->tx_head++;
+	}
+	else
+	{
+		/* Held by the mailbox until the transmit thread makes room */
+		port->mb_frame[mb_idx] = frame;
+		port->mb_busy[mb_idx] = 1;
+		port->mb_pending++;
+	}
+	pthread_cond_signal(&port->tx_cond);
+	pthread_mutex_unlock(&port->tx_lock);
+	return STATUS_SUCCESS;
+}
+
+status_t FLEXCAN_DRV_GetTransferStatus(uint8_t instance, uint8_t mb_idx)
+{
+	vt_socketcan_port_t *port = _vt_socketcan_port(instance);
+	uint8_t busy;
+
+	if(port == NULL || mb_idx >= port->max_num_mb)
+		return STATUS_ERROR;
+
+	pthread_mutex_lock(&port->tx_lock);
+	busy = port->mb_busy[mb_idx];
+	pthread_mutex_unlock(&port->tx_lock);
+	if(busy == 0)
+		return STATUS_SUCCESS;
+
+	/* Let the transmit thread run while the caller polls */
+	sched_yield();
+	return STATUS_BUSY;
+}
+
+status_t FLEXCAN_DRV_AbortTransfer(uint8_t instance, uint8_t mb_idx)
+{
+	vt_socketcan_port_t *port = _vt_socketcan_port(instance);
+	status_t result = STATUS_FLEXCAN_NO_TRANSFER_IN_PROGRESS;
+
+	if(port == NULL || mb_idx >= port->max_num_mb)
+		return STATUS_ERROR;
+
+	/* A frame already in the transmit queue goes on */
+	pthread_mutex_lock(&port->tx_lock);
+	if(port->mb_busy[mb_idx])
+	{
+		port->mb_busy[mb_idx] = 0;
+		port->mb_pending--;
+		result = STATUS_SUCCESS;
+	}
+	pthread_mutex_unlock(&port->tx_lock);
+	return result;
+}
+
+status_t FLEXCAN_DRV_RxFifo(uint8_t instance, flexcan_msgbuff_t *data)
+{
+	vt_socketcan_port_t *port = _vt_socketcan_port(instance);
+	status_t result = STATUS_SUCCESS;
+
+	if(port == NULL || port->open == 0)
+		return STATUS_ERROR;
+
+	pthread_mutex_lock(&port->rx_lock);
+	if(port->rx_buff != NULL)
+		result = STATUS_BUSY;
+	else
+		port->rx_buff = data;
+	pthread_mutex_unlock(&port->rx_lock);
+	return result;
+}
+
+status_t FLEXCAN_DRV_RxFifoBlocking(uint8_t instance, flexcan_msgbuff_t *data, uint32_t timeout_ms)
+{
+	vt_socketcan_port_t *port = _vt_socketcan_port(instance);
+	struct timespec deadline;
+	status_t result = STATUS_SUCCESS;
+
+	if(port == NULL || port->open == 0 || data == NULL)
+		return STATUS_ERROR;
+
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += timeout_ms / 1000U;
+	deadline.tv_nsec += (long)(timeout_ms % 1000U) * 1000000L;
+	if(deadline.tv_nsec >= (long)VT_SOCKETCAN_NS_PER_S)
+	{
+		deadline.tv_sec++;
+		deadline.tv_nsec -= (long)VT_SOCKETCAN_NS_PER_S;
+	}
+
+	/* The next frame goes to the caller instead of the armed buffer */
+	pthread_mutex_lock(&port->rx_lock);
+	port->rx_wait = data;
+	while(port->rx_wait != NULL)
+	{
+		if(pthread_cond_timedwait(&port->rx_cond, &port->rx_lock, &deadline) == ETIMEDOUT)
+		{
+			if(port->rx_wait != NULL)
+				result = STATUS_TIMEOUT;
+			port->rx_wait = NULL;
+		}
+	}
+	pthread_mutex_unlock(&port->rx_lock);
+	return result;
+}
+
+void FLEXCAN_DRV_SetRxFifoGlobalMask(uint8_t instance, flexcan_msgbuff_id_type_t id_type, uint32_t mask)
+{
+	vt_socketcan_port_t *port = _vt_socketcan_port(instance);
+
+	(void)id_type;
+	if(port == NULL)
+		return;
+	pthread_mutex_lock(&port->rx_lock);
+	port->global_mask = mask;
+	_vt_socketcan_apply_filter(port);
+	pthread_mutex_unlock(&port->rx_lock);
+}
+
+void FLEXCAN_DRV_InstallErrorCallback(uint8_t instance, flexcan_error_callback_t callback, void *callbackParam)
+{
+	vt_socketcan_port_t *port = _vt_socketcan_port(instance);
+
+	/* Error frames are not received from the socket, the callback is kept but never raised */
+	if(port == NULL || port->state == NULL)
+		return;
+	port->state->error_callback = callback;
+	port->state->errorCallbackParam = callbackParam;
+}
+
+void FLEXCAN_DRV_SetRxMbGlobalMask(uint8_t instance, flexcan_msgbuff_id_type_t id_type, uint32_t mask)
+{
+	/* No receive mailboxes, frames only come through the RX FIFO */
+	(void)instance;
+	(void)id_type;
+	(void)mask;
+}
+
+void FLEXCAN_DRV_ConfigRxFifo(uint8_t instance, flexcan_rx_fifo_id_element_format_t id_format, const flexcan_id_table_t *id_filter_table)
+{
+	vt_socketcan_port_t *port = _vt_socketcan_port(instance);
+
+	(void)id_format;
+	if(port == NULL || id_filter_table == NULL || id_filter_table->idFilter == NULL)
+		return;
+	pthread_mutex_lock(&port->rx_lock);
+	port->filter_count = (port->filter_num > 0) ? port->filter_num : VT_SOCKETCAN_MAX_FILTERS;
+	memcpy(port->filter, id_filter_table->idFilter, port->filter_count * sizeof(uint32_t));
+	port->filter_extended = id_filter_table->isExtendedFrame ? 1U : 0U;
+	_vt_socketcan_apply_filter(port);
+	pthread_mutex_unlock(&port->rx_lock);
+}
+
+#ifdef __cplusplus
+}
+#endif
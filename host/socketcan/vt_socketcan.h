@@ -0,0 +1,134 @@
+/*
+ * vt_socketcan.h
+ *
+ * FlexCAN driver of the agent on Linux SocketCAN raw sockets. It implements the FLEXCAN_DRV_* calls made by
+ * Sources/vt_agent/vt_can.c, so vt_init_can(), vt_get_msg(), vt_send_can_msg() and vt_start_rcv() run unmodified on
+ * a Linux gateway, as they do on the mock HAL of the host build. The PIT, RTC and UART come from the mock HAL built
+ * with VT_HAL_MOCK_FLEXCAN=0, its clock driven from the real time by the caller (see host/tools/vt_agent_linux.c).
+ *
+ * Each instance is bound to a network interface, canN by default, or vcanN for tests:
+ *   ip link add dev vcan0 type vcan && ip link set up vcan0
+ * The bitrate of a real interface is set with "ip link set canN type can bitrate ..." before the agent starts, the
+ * bitrate given to FLEXCAN_DRV_Init is not applied.
+ *
+ * Every instance runs a receive thread, reading up to VT_SOCKETCAN_BATCH frames per recvmmsg() with their kernel
+ * RX timestamp (SO_TIMESTAMPING, hardware when the interface has it) and the count of frames the socket dropped
+ * (SO_RXQ_OVFL), and a transmit thread, writing the queued frames with sendmmsg(). The callback of
+ * FLEXCAN_DRV_Init runs in those threads under one lock, vt_socketcan_lock(), so it is never re-entered, as the
+ * FlexCAN interrupts of one core are not:
+ *   - FLEXCAN_EVENT_RXFIFO_COMPLETE for every frame copied to the buffer armed with FLEXCAN_DRV_RxFifo, a frame
+ *     arriving without an armed buffer is lost and raises FLEXCAN_EVENT_RXFIFO_OVERFLOW;
+ *   - FLEXCAN_EVENT_RXFIFO_OVERFLOW when the socket reports dropped frames;
+ *   - FLEXCAN_EVENT_TX_COMPLETE for every frame the transmit thread takes for its next sendmmsg().
+ * A mailbox given to FLEXCAN_DRV_Send is free again as soon as its frame is in the transmit queue, it holds the
+ * frame only while the queue is full. As the TX complete of a frame can queue the next one into the same batch, the
+ * gateway forwarding one frame at a time still writes in batches.
+ */
+
+#ifndef VT_SOCKETCAN_H_
+#define VT_SOCKETCAN_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "Cpu.h"
+#include "flexcan_driver.h"
+#include "vt_fw_if.h"
+
+/*------------------------------------------------------------------*
+ *                          Define macro                            *
+ *------------------------------------------------------------------*/
+/*! Number of instances, VT_INST_CAN0 to VT_INST_CAN2 */
+#define VT_SOCKETCAN_INSTANCES      3U
+
+/*! Frames read per recvmmsg() and written per sendmmsg() */
+#ifndef VT_SOCKETCAN_BATCH
+#define VT_SOCKETCAN_BATCH          32U
+#endif
+
+/*! Frames queued for the transmit thread per instance, must be a power of 2 */
+#ifndef VT_SOCKETCAN_TX_QUEUE
+#define VT_SOCKETCAN_TX_QUEUE       256U
+#endif
+
+/*! Message buffers of an instance */
+#define VT_SOCKETCAN_MAX_MB         64U
+
+/*! Receive buffer of a socket, in bytes, to ride out scheduling delays at full bus load */
+#ifndef VT_SOCKETCAN_RCVBUF
+#define VT_SOCKETCAN_RCVBUF         (1024U * 1024U)
+#endif
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef struct _vt_socketcan_stats_t
+{
+	uint64_t rx_frames;             /*!< frames read from the socket */
+	uint64_t rx_batches;            /*!< recvmmsg() calls returning frames */
+	uint64_t rx_delivered;          /*!< frames copied to an armed buffer */
+	uint64_t rx_lost;               /*!< frames read while no buffer was armed */
+	uint64_t rx_dropped;            /*!< frames dropped by the socket, SO_RXQ_OVFL */
+	uint64_t tx_frames;             /*!< frames written to the socket */
+	uint64_t tx_batches;            /*!< sendmmsg() calls writing frames */
+	uint64_t tx_retries;            /*!< sendmmsg() calls refused because the interface queue was full */
+	uint64_t tx_errors;             /*!< frames dropped on a write error */
+}vt_socketcan_stats_t;
+
+/*------------------------------------------------------------------*
+ *                       Function Prototypes                        *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will bind an instance to a network interface, before FLEXCAN_DRV_Init.
+ * @param [in]   instance - is FlexCAN instance.
+ * @param [in]   *ifname - pointer to interface name, e.g. "can0" or "vcan0".
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL or VT_STATUS_INVALID.
+ */
+vt_status_t vt_socketcan_set_interface(uint8_t instance, const char *ifname);
+
+/*!
+ * @brief  This API will stop the threads of an instance and close its socket.
+ * @param [in]   instance - is FlexCAN instance.
+ * @return       none.
+ */
+void vt_socketcan_close(uint8_t instance);
+
+/*!
+ * @brief  This API will take the lock the callbacks run under. Code of the caller sharing state with the callbacks,
+ *         e.g. the PIT handler of the mock HAL, runs under it as an interrupt would.
+ * @param [in]   none.
+ * @return       none.
+ */
+void vt_socketcan_lock(void);
+
+/*!
+ * @brief  This API will release the lock the callbacks run under.
+ * @param [in]   none.
+ * @return       none.
+ */
+void vt_socketcan_unlock(void);
+
+/*!
+ * @brief  This API will get the kernel RX timestamp of the frame being delivered, from FLEXCAN_EVENT_RXFIFO_COMPLETE.
+ * @param [in]   instance - is FlexCAN instance.
+ * @return       CLOCK_REALTIME in ns, hardware time when the interface stamps frames, 0 if unknown.
+ */
+uint64_t vt_socketcan_rx_timestamp_ns(uint8_t instance);
+
+/*!
+ * @brief  This API will get counters of an instance.
+ * @param [in]   instance - is FlexCAN instance.
+ * @param [out]  *stats - pointer to vt_socketcan_stats_t structure.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL or VT_STATUS_INVALID.
+ */
+vt_status_t vt_socketcan_get_stats(uint8_t instance, vt_socketcan_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VT_SOCKETCAN_H_ */
@@ -0,0 +1,174 @@
+/*
+ * vt_test_rules.c
+ *
+ * Host test of the bulk loading of firewall rules: rules of the same type and CAN Id that differ in their payload
+ * or limits are staged interleaved with repeats of each other, only one of each distinct rule must reach the
+ * firewall core and be indexed. The core is replaced by stubs counting the rules it is given. Exits 0 when every
+ * check passes.
+ */
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "vt_fw_rules.h"
+#include "vt_arena.h"
+
+/*------------------------------------------------------------------*
+ *                          Define Macro                            *
+ *------------------------------------------------------------------*/
+#define VT_TEST_ARENA_SIZE       (64U * 1024U)
+
+#define VT_TEST_CHECK(cond)      _vt_test_check((cond), #cond, __LINE__)
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+static uint64_t test_arena_rules[VT_TEST_ARENA_SIZE / sizeof(uint64_t)];
+static uint64_t test_arena_state[VT_TEST_ARENA_SIZE / sizeof(uint64_t)];
+static uint32_t test_core_rules = 0;
+static uint32_t test_failures = 0;
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+static void _vt_test_check(int cond, const char *text, int line)
+{
+	if(cond)
+		return;
+	fprintf(stderr, "vt_test_rules.c:%d: check failed: %s\n", line, text);
+	test_failures++;
+}
+
+/*!
+ * @brief  This API will start a bulk load on empty arenas.
+ * @param [in]   none.
+ * @return       none.
+ */
+static void _vt_test_begin(void)
+{
+	VT_TEST_CHECK(vt_fw_begin_bulk_load() == VT_STATUS_SUCCESS);
+	test_core_rules = 0;
+}
+
+/*!
+ * @brief  This API will check malicious frames of one CAN Id with different payloads, staged A, B, A.
+ * @param [in]   none.
+ * @return       none.
+ */
+static void _vt_test_malicious(void)
+{
+	uint8_t data_a[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+	uint8_t data_b[8] = {1, 2, 3, 4, 5, 6, 7, 9};
+	uint32_t rules = vt_fw_get_rule_count();
+
+	_vt_test_begin();
+	VT_TEST_CHECK(vt_fw_bulk_add_malicious_can_frame(0x100, 8, data_a) == VT_STATUS_SUCCESS);
+	VT_TEST_CHECK(vt_fw_bulk_add_malicious_can_frame(0x100, 8, data_b) == VT_STATUS_SUCCESS);
+	VT_TEST_CHECK(vt_fw_bulk_add_malicious_can_frame(0x100, 8, data_a) == VT_STATUS_SUCCESS);
+	VT_TEST_CHECK(vt_fw_commit_bulk_load() == VT_STATUS_SUCCESS);
+	VT_TEST_CHECK(test_core_rules == 2U);
+	VT_TEST_CHECK(vt_fw_get_rule_count() == rules + 2U);
+}
+
+/*!
+ * @brief  This API will check monitor frames of one CAN Id with different limits, staged A, B, A, B.
+ * @param [in]   none.
+ * @return       none.
+ */
+static void _vt_test_monitor(void)
+{
+	uint8_t data[2] = {0x10, 0x20};
+	uint32_t rules = vt_fw_get_rule_count();
+	uint32_t rule_id;
+	vt_fw_rule_info_t info;
+
+	_vt_test_begin();
+	VT_TEST_CHECK(vt_fw_bulk_monitor_add_can_frame(0x200, 2, data, 0, 1, 10) == VT_STATUS_SUCCESS);
+	VT_TEST_CHECK(vt_fw_bulk_monitor_add_can_frame(0x200, 2, data, 0, 1, 20) == VT_STATUS_SUCCESS);
+	VT_TEST_CHECK(vt_fw_bulk_monitor_add_can_frame(0x200, 2, data, 0, 1, 10) == VT_STATUS_SUCCESS);
+	VT_TEST_CHECK(vt_fw_bulk_monitor_add_can_frame(0x200, 2, data, 0, 1, 20) == VT_STATUS_SUCCESS);
+	VT_TEST_CHECK(vt_fw_commit_bulk_load() == VT_STATUS_SUCCESS);
+	VT_TEST_CHECK(test_core_rules == 2U);
+	VT_TEST_CHECK(vt_fw_get_rule_count() == rules + 2U);
+	VT_TEST_CHECK(vt_fw_find_rule(VT_RULE_MONITOR_FRAME, 0x200, &rule_id, &info) == VT_STATUS_SUCCESS);
+	VT_TEST_CHECK(info.from_id == 0x200);
+}
+
+/*!
+ * @brief  This API will check ranges of one first CAN Id with different ends, staged A, B, A.
+ * @param [in]   none.
+ * @return       none.
+ */
+static void _vt_test_range(void)
+{
+	uint32_t rules = vt_fw_get_rule_count();
+
+	_vt_test_begin();
+	VT_TEST_CHECK(vt_fw_bulk_blacklist_add_range_can_id(0x300, 0x30F, 0) == VT_STATUS_SUCCESS);
+	VT_TEST_CHECK(vt_fw_bulk_blacklist_add_range_can_id(0x300, 0x31F, 0) == VT_STATUS_SUCCESS);
+	VT_TEST_CHECK(vt_fw_bulk_blacklist_add_range_can_id(0x300, 0x30F, 0) == VT_STATUS_SUCCESS);
+	VT_TEST_CHECK(vt_fw_commit_bulk_load() == VT_STATUS_SUCCESS);
+	VT_TEST_CHECK(test_core_rules == 2U);
+	VT_TEST_CHECK(vt_fw_get_rule_count() == rules + 2U);
+}
+
+/*------------------------------------------------------------------*
+ *                  Firewall core stubs                             *
+ *------------------------------------------------------------------*/
+vt_status_t vt_fw_add_malicious_can_frame(uint32_t msgId, uint8_t dataLen, uint8_t *databuff)
+{
+	(void)msgId; (void)dataLen; (void)databuff;
+	test_core_rules++;
+	return VT_STATUS_SUCCESS;
+}
+
+vt_status_t vt_fw_blacklist_add_range_can_id(uint32_t fromId, uint32_t toId, uint8_t operator)
+{
+	(void)fromId; (void)toId; (void)operator;
+	test_core_rules++;
+	return VT_STATUS_SUCCESS;
+}
+
+vt_status_t vt_fw_monitor_add_can_frame(uint32_t msgId, uint8_t dataLen, uint8_t *databuff, uint8_t operator, uint16_t min_val,  uint16_t max_val)
+{
+	(void)msgId; (void)dataLen; (void)databuff; (void)operator; (void)min_val; (void)max_val;
+	test_core_rules++;
+	return VT_STATUS_SUCCESS;
+}
+
+vt_status_t vt_fw_monitor_add_pattern(vt_can_frame_t *frames, uint8_t ele_size, uint8_t operator, uint16_t min_val,  uint16_t max_val)
+{
+	(void)frames; (void)ele_size; (void)operator; (void)min_val; (void)max_val;
+	test_core_rules++;
+	return VT_STATUS_SUCCESS;
+}
+
+vt_status_t vt_fw_monitor_add_ids_to_range_list(uint8_t id_operator, uint32_t fromId, uint32_t toId, uint8_t operator, uint16_t min_val,  uint16_t max_val)
+{
+	(void)id_operator; (void)fromId; (void)toId; (void)operator; (void)min_val; (void)max_val;
+	test_core_rules++;
+	return VT_STATUS_SUCCESS;
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+int main(void)
+{
+	VT_TEST_CHECK(vt_arena_init(VT_ARENA_RULES, test_arena_rules, sizeof(test_arena_rules)) == VT_STATUS_SUCCESS);
+	VT_TEST_CHECK(vt_arena_init(VT_ARENA_STATE, test_arena_state, sizeof(test_arena_state)) == VT_STATUS_SUCCESS);
+
+	_vt_test_malicious();
+	_vt_test_monitor();
+	_vt_test_range();
+
+	if(test_failures > 0)
+	{
+		fprintf(stderr, "vt_test_rules: %lu checks failed\n", (unsigned long)test_failures);
+		return 1;
+	}
+	printf("vt_test_rules: passed\n");
+	return 0;
+}
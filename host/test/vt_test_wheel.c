@@ -0,0 +1,242 @@
+/*
+ * vt_test_wheel.c
+ *
+ * Host test of the timer wheel: timers armed at deadlines on every level, across the wrap of a level and beyond
+ * VT_WHEEL_RANGE must expire at the tick of their deadline, neither before nor after, when the wheel is advanced one
+ * tick at a time or in one jump. A callback arming its timer again must see it expire at the new deadline. Exits 0
+ * when every check passes.
+ */
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "vt_wheel.h"
+
+/*------------------------------------------------------------------*
+ *                          Define Macro                            *
+ *------------------------------------------------------------------*/
+#define VT_TEST_ARENA_SIZE       (16U * 1024U)
+#define VT_TEST_TIMERS           16U
+/*! Tick of no expiry */
+#define VT_TEST_NEVER            0xFFFFFFFFUL
+
+#define VT_TEST_CHECK(cond)      _vt_test_check((cond), #cond, __LINE__)
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+static uint64_t test_arena[VT_TEST_ARENA_SIZE / sizeof(uint64_t)];
+static uint32_t test_expired_at[VT_TEST_TIMERS];
+static uint32_t test_expiries[VT_TEST_TIMERS];
+static uint32_t test_rearm[VT_TEST_TIMERS];         /*!< times the callback arms the timer again */
+static uint32_t test_rearm_after = 0;               /*!< ticks from the expiry to the new deadline */
+static uint32_t test_order[VT_TEST_TIMERS];
+static uint32_t test_order_count = 0;
+static uint32_t test_failures = 0;
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+static void _vt_test_check(int cond, const char *text, int line)
+{
+	if(cond)
+		return;
+	fprintf(stderr, "vt_test_wheel.c:%d: check failed: %s\n", line, text);
+	test_failures++;
+}
+
+/*!
+ * @brief  This API will record the expiry of a timer and arm it again while it has re-arms left.
+ * @param [in]   *wheel - pointer to vt_wheel_t structure.
+ * @param [in]   timer - is index of the timer.
+ * @param [in]   now - is current slot tick count.
+ * @return       none.
+ */
+static void _vt_test_expired(vt_wheel_t *wheel, uint16_t timer, uint32_t now)
+{
+	test_expired_at[timer] = now;
+	test_expiries[timer]++;
+	if(test_order_count < VT_TEST_TIMERS)
+		test_order[test_order_count++] = timer;
+	if(test_rearm[timer] > 0)
+	{
+		test_rearm[timer]--;
+		vt_wheel_schedule(wheel, timer, now + test_rearm_after);
+	}
+}
+
+/*!
+ * @brief  This API will create a wheel on an empty arena and forget the expiries of the previous check.
+ * @param [out]  *wheel - pointer to vt_wheel_t structure.
+ * @param [in]   now - is current slot tick count.
+ * @return       none.
+ */
+static void _vt_test_begin(vt_wheel_t *wheel, uint32_t now)
+{
+	uint32_t i;
+
+	VT_TEST_CHECK(vt_arena_init(VT_ARENA_STATE, test_arena, sizeof(test_arena)) == VT_STATUS_SUCCESS);
+	VT_TEST_CHECK(vt_wheel_create(wheel, VT_ARENA_STATE, VT_TEST_TIMERS, now) == VT_STATUS_SUCCESS);
+	for(i = 0; i < VT_TEST_TIMERS; i++)
+	{
+		test_expired_at[i] = VT_TEST_NEVER;
+		test_expiries[i] = 0;
+		test_rearm[i] = 0;
+	}
+	test_rearm_after = 0;
+	test_order_count = 0;
+}
+
+/*!
+ * @brief  This API will advance a wheel one tick at a time.
+ * @param [in]   *wheel - pointer to vt_wheel_t structure.
+ * @param [in]   from - is first tick.
+ * @param [in]   to - is last tick.
+ * @return       none.
+ */
+static void _vt_test_step(vt_wheel_t *wheel, uint32_t from, uint32_t to)
+{
+	uint32_t now;
+
+	for(now = from; (int32_t)(to - now) >= 0; now++)
+		vt_wheel_advance(wheel, now, _vt_test_expired);
+}
+
+/*!
+ * @brief  This API will check timers placed on every level expire at their deadline. Starts below the wrap of a
+ *         level or of the tick count cross the cascades of the levels above.
+ * @param [in]   start - is slot tick count at create.
+ * @return       none.
+ */
+static void _vt_test_levels(uint32_t start)
+{
+	static const uint32_t after[] = {
+		1U, 2U, 63U, 64U, 65U, 127U, 4095U, 4096U, 4097U, 70000U, VT_WHEEL_RANGE - 1U
+	};
+	uint32_t count = sizeof(after) / sizeof(after[0]);
+	vt_wheel_t wheel;
+	uint32_t i;
+
+	_vt_test_begin(&wheel, start);
+	for(i = 0; i < count; i++)
+		vt_wheel_schedule(&wheel, (uint16_t)i, start + after[i]);
+	VT_TEST_CHECK(wheel.armed == count);
+
+	_vt_test_step(&wheel, start + 1U, start + VT_WHEEL_RANGE + 10U);
+	for(i = 0; i < count; i++)
+		VT_TEST_CHECK(test_expired_at[i] == start + after[i] && test_expiries[i] == 1U);
+	VT_TEST_CHECK(wheel.armed == 0 && wheel.expired == count);
+	/* Every timer armed beyond the first level came down a level or more */
+	VT_TEST_CHECK(wheel.cascaded >= count - 3U);
+}
+
+/*!
+ * @brief  This API will check timers expire in the order of their deadlines when the wheel is advanced in one jump,
+ *         and no timer expires before its tick.
+ * @param [in]   none.
+ * @return       none.
+ */
+static void _vt_test_jump(void)
+{
+	vt_wheel_t wheel;
+	uint32_t start = 0xFFFFFF00UL;
+
+	_vt_test_begin(&wheel, start);
+	vt_wheel_schedule(&wheel, 0, start + 5000U);
+	vt_wheel_schedule(&wheel, 1, start + 10U);
+	vt_wheel_schedule(&wheel, 2, start + 300U);
+	vt_wheel_schedule(&wheel, 3, start + 5001U);
+
+	VT_TEST_CHECK(vt_wheel_advance(&wheel, start + 4999U, _vt_test_expired) == 2U);
+	VT_TEST_CHECK(test_expired_at[0] == VT_TEST_NEVER && test_expired_at[3] == VT_TEST_NEVER);
+	VT_TEST_CHECK(vt_wheel_advance(&wheel, start + 6000U, _vt_test_expired) == 2U);
+	VT_TEST_CHECK(test_order_count == 4U);
+	VT_TEST_CHECK(test_order[0] == 1U && test_order[1] == 2U && test_order[2] == 0U && test_order[3] == 3U);
+}
+
+/*!
+ * @brief  This API will check deadlines beyond VT_WHEEL_RANGE wait and expire at their tick, not at the range.
+ * @param [in]   none.
+ * @return       none.
+ */
+static void _vt_test_beyond_range(void)
+{
+	vt_wheel_t wheel;
+	uint32_t start = 1000U;
+
+	_vt_test_begin(&wheel, start);
+	vt_wheel_schedule(&wheel, 0, start + VT_WHEEL_RANGE);
+	vt_wheel_schedule(&wheel, 1, start + VT_WHEEL_RANGE + 1000U);
+	vt_wheel_schedule(&wheel, 2, start + 3U * VT_WHEEL_RANGE + 7U);
+
+	_vt_test_step(&wheel, start + 1U, start + 3U * VT_WHEEL_RANGE + 100U);
+	VT_TEST_CHECK(test_expired_at[0] == start + VT_WHEEL_RANGE);
+	VT_TEST_CHECK(test_expired_at[1] == start + VT_WHEEL_RANGE + 1000U);
+	VT_TEST_CHECK(test_expired_at[2] == start + 3U * VT_WHEEL_RANGE + 7U);
+	VT_TEST_CHECK(test_expiries[0] == 1U && test_expiries[1] == 1U && test_expiries[2] == 1U);
+	VT_TEST_CHECK(wheel.armed == 0);
+}
+
+/*!
+ * @brief  This API will check a timer armed again from the callback, ahead and at a deadline already passed, and a
+ *         timer cancelled before its deadline.
+ * @param [in]   none.
+ * @return       none.
+ */
+static void _vt_test_rearm(void)
+{
+	vt_wheel_t wheel;
+	uint32_t start = 4000U;
+
+	_vt_test_begin(&wheel, start);
+	test_rearm[0] = 3U;
+	test_rearm_after = 100U;
+	vt_wheel_schedule(&wheel, 0, start + 90U);
+	vt_wheel_schedule(&wheel, 1, start + 200U);
+	vt_wheel_cancel(&wheel, 1);
+
+	/* Expires at 90, then 190, 290 and 390 across the wrap of the first level at 4096 */
+	_vt_test_step(&wheel, start + 1U, start + 389U);
+	VT_TEST_CHECK(test_expired_at[0] == start + 290U);
+	VT_TEST_CHECK(wheel.armed == 1U);
+	_vt_test_step(&wheel, start + 390U, start + 1000U);
+	VT_TEST_CHECK(test_expired_at[0] == start + 390U);
+	VT_TEST_CHECK(test_expired_at[1] == VT_TEST_NEVER);
+	VT_TEST_CHECK(test_expiries[0] == 4U);
+	VT_TEST_CHECK(wheel.armed == 0 && wheel.expired == 4U);
+
+	/* A deadline already passed expires with the next tick */
+	test_rearm[0] = 1U;
+	test_rearm_after = 0;
+	vt_wheel_schedule(&wheel, 0, start + 900U);
+	_vt_test_step(&wheel, start + 1001U, start + 1001U);
+	VT_TEST_CHECK(test_expired_at[0] == start + 1001U);
+	_vt_test_step(&wheel, start + 1002U, start + 1002U);
+	VT_TEST_CHECK(test_expired_at[0] == start + 1002U);
+	VT_TEST_CHECK(test_expiries[0] == 6U);
+	VT_TEST_CHECK(wheel.armed == 0);
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+int main(void)
+{
+	_vt_test_levels(0);
+	_vt_test_levels(VT_WHEEL_SLOTS - 3U);
+	_vt_test_levels(VT_WHEEL_RANGE - 5U);
+	_vt_test_levels(0xFFFFFFFFUL - 100U);
+	_vt_test_jump();
+	_vt_test_beyond_range();
+	_vt_test_rearm();
+
+	if(test_failures > 0)
+	{
+		fprintf(stderr, "vt_test_wheel: %lu checks failed\n", (unsigned long)test_failures);
+		return 1;
+	}
+	printf("vt_test_wheel: passed\n");
+	return 0;
+}
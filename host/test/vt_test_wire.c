@@ -0,0 +1,295 @@
+/*
+ * vt_test_wire.c
+ *
+ * Host test of the event wire format: a record of every event type is encoded to one stream and decoded back byte
+ * by byte, the decoded records must equal the encoded ones. A frame with a corrupted byte must fail the CRC, the
+ * next frames must decode again but be flagged until an absolute timestamp restores their time. Exits 0 when every
+ * check passes.
+ */
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "vt_wire.h"
+
+/*------------------------------------------------------------------*
+ *                          Define Macro                            *
+ *------------------------------------------------------------------*/
+#define VT_TEST_EVENTS           8U
+#define VT_TEST_STREAM_SIZE      (VT_TEST_EVENTS * VT_WIRE_MAX_FRAME)
+
+#define VT_TEST_CHECK(cond)      _vt_test_check((cond), #cond, __LINE__)
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+static vt_event_t test_events[VT_TEST_EVENTS];
+static uint8_t test_stream[VT_TEST_STREAM_SIZE];
+static uint32_t test_failures = 0;
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+static void _vt_test_check(int cond, const char *text, int line)
+{
+	if(cond)
+		return;
+	fprintf(stderr, "vt_test_wire.c:%d: check failed: %s\n", line, text);
+	test_failures++;
+}
+
+/*!
+ * @brief  This API will fill one record of every event type, as the agent pushes them.
+ * @param [in]   none.
+ * @return       none.
+ */
+static void _vt_test_make_events(void)
+{
+	vt_event_t *event;
+	uint32_t time_stamp = 1000U;
+
+	memset(test_events, 0, sizeof(test_events));
+
+	event = &test_events[0];
+	event->type = VT_EVENT_TRAFFIC_STATUS;
+	event->u.traffic.car_status = VT_CAR_ABNORMAL_STAT;
+	event->u.traffic.slot_rate = VT_RATE_ONE / 4U;
+	event->u.traffic.pattern_rate = VT_RATE_ONE;
+	event->u.traffic.count_frames = 123456U;
+
+	event = &test_events[1];
+	event->type = VT_EVENT_VECTOR;
+	event->u.vector.count_vector_in_rl = 7U;
+	event->u.vector.count_vector_in_rt = 9U;
+	event->u.vector.count_all_vector = 300U;
+	event->u.vector.matched_rate = VT_RATE(7U, 9U);
+	event->u.vector.matched_flag = 1U;
+
+	event = &test_events[2];
+	event->type = VT_EVENT_BLACKLIST;
+	event->u.result.rule_id = 3U;
+	event->u.result.can_id = 0x1FFFFFFFUL;
+	event->u.result.rule_type = VT_RULE_BLACKLIST_RANGE;
+	event->u.result.matched_bit = VT_RANGE_BIT;
+
+	/* Unknown rule and CAN Id travel as 0 */
+	event = &test_events[3];
+	event->type = VT_EVENT_MONITOR;
+	event->u.result.rule_id = VT_FW_RULE_ID_NONE;
+	event->u.result.can_id = VT_FW_CAN_ID_NONE;
+	event->u.result.min_val = 2U;
+	event->u.result.max_val = 0xFFFFU;
+	event->u.result.rule_type = VT_RULE_MONITOR_PATTERN;
+	event->u.result.matched_bit = VT_PATTERN_BIT;
+
+	event = &test_events[4];
+	event->type = VT_EVENT_DROPPED;
+	event->u.dropped = 42U;
+
+	event = &test_events[5];
+	event->type = VT_EVENT_SUMMARY;
+	event->u.summary.rule_id = 0U;
+	event->u.summary.can_id = 0x123U;
+	event->u.summary.count = 5000U;
+	event->u.summary.peak_rate = 800U;
+	event->u.summary.rule_type = VT_RULE_MALICIOUS_FRAME;
+
+	event = &test_events[6];
+	event->type = VT_EVENT_PROBE;
+	event->u.probe.count = 100000U;
+	event->u.probe.min_ns = 250U;
+	event->u.probe.max_ns = 90000U;
+	event->u.probe.p99_ns = 4000U;
+	event->u.probe.probe = 2U;
+
+	event = &test_events[7];
+	event->type = VT_EVENT_MISSING;
+	event->u.missing.can_id = 0x7DFU;
+	event->u.missing.timeout = 500U;
+
+	/* Timestamps go forward and wrap, derived timestamps follow the ones the decoder rebuilds */
+	for(event = test_events; event < &test_events[VT_TEST_EVENTS]; event++)
+	{
+		event->time_stamp = time_stamp;
+		time_stamp += 0x7FFFFFF0UL;
+	}
+	test_events[2].u.result.time_stamp = test_events[2].time_stamp;
+	test_events[3].u.result.time_stamp = test_events[3].time_stamp;
+	test_events[5].u.summary.first_ts = test_events[5].time_stamp - 300U;
+	test_events[5].u.summary.last_ts = test_events[5].time_stamp - 10U;
+	test_events[7].u.missing.last_ts = test_events[7].time_stamp - 600U;
+}
+
+/*!
+ * @brief  This API will encode every test record to the stream.
+ * @param [out]  *ends - pointer to array of the stream length after each frame.
+ * @return       length of the stream.
+ */
+static uint32_t _vt_test_encode(uint32_t *ends)
+{
+	vt_wire_encoder_t enc;
+	uint32_t pos = 0, size = 0, i;
+
+	vt_wire_encoder_init(&enc);
+	for(i = 0; i < VT_TEST_EVENTS; i++)
+	{
+		VT_TEST_CHECK(vt_wire_encode_event(&enc, &test_events[i], &test_stream[pos], VT_TEST_STREAM_SIZE - pos, &size) == VT_STATUS_SUCCESS);
+		VT_TEST_CHECK(size <= VT_WIRE_MAX_FRAME);
+		VT_TEST_CHECK(memchr(&test_stream[pos], 0x00, size - 1U) == NULL);
+		VT_TEST_CHECK(test_stream[pos + size - 1U] == 0x00);
+		pos += size;
+		ends[i] = pos;
+	}
+	return pos;
+}
+
+/*!
+ * @brief  This API will check every record comes back from the stream as it was encoded.
+ * @param [in]   len - is length of the stream.
+ * @return       none.
+ */
+static void _vt_test_round_trip(uint32_t len)
+{
+	vt_wire_decoder_t dec;
+	vt_event_t event;
+	vt_status_t status;
+	uint32_t pos, decoded = 0;
+
+	vt_wire_decoder_init(&dec);
+	for(pos = 0; pos < len; pos++)
+	{
+		status = vt_wire_decode_byte(&dec, test_stream[pos], &event);
+		if(status == VT_STATUS_EMPTY)
+			continue;
+		VT_TEST_CHECK(status == VT_STATUS_SUCCESS);
+		if(status != VT_STATUS_SUCCESS || decoded >= VT_TEST_EVENTS)
+			continue;
+		VT_TEST_CHECK(memcmp(&event, &test_events[decoded], sizeof(vt_event_t)) == 0);
+		decoded++;
+	}
+	VT_TEST_CHECK(decoded == VT_TEST_EVENTS);
+	VT_TEST_CHECK(dec.frames == VT_TEST_EVENTS);
+	VT_TEST_CHECK(dec.crc_errors == 0 && dec.format_errors == 0);
+}
+
+/*!
+ * @brief  This API will check a decoder joining the stream after its absolute timestamp flags the records.
+ * @param [in]   *ends - pointer to array of the stream length after each frame.
+ * @return       none.
+ */
+static void _vt_test_join(const uint32_t *ends)
+{
+	vt_wire_decoder_t dec;
+	vt_event_t event;
+	vt_status_t status = VT_STATUS_EMPTY;
+	uint32_t pos;
+
+	vt_wire_decoder_init(&dec);
+	for(pos = ends[0]; pos < ends[1]; pos++)
+		status = vt_wire_decode_byte(&dec, test_stream[pos], &event);
+	VT_TEST_CHECK(status == VT_STATUS_UNREADY);
+	VT_TEST_CHECK(event.type == VT_EVENT_VECTOR);
+	VT_TEST_CHECK(dec.frames == 0 && dec.unsynced == 1U);
+}
+
+/*!
+ * @brief  This API will check a corrupted frame is dropped, the decoder picks up at the next one but flags the
+ *         records until an absolute timestamp gives their time back.
+ * @param [in]   *ends - pointer to array of the stream length after each frame.
+ * @param [in]   len - is length of the stream.
+ * @return       none.
+ */
+static void _vt_test_corrupted(const uint32_t *ends, uint32_t len)
+{
+	vt_wire_decoder_t dec;
+	vt_event_t event;
+	vt_status_t status = VT_STATUS_EMPTY;
+	uint32_t pos, flagged = 0;
+
+	/* A byte in the middle of the blacklist frame, never the delimiter */
+	test_stream[(ends[1] + ends[2]) / 2U] ^= 0x01U;
+
+	vt_wire_decoder_init(&dec);
+	for(pos = 0; pos < ends[3]; pos++)
+	{
+		status = vt_wire_decode_byte(&dec, test_stream[pos], &event);
+		if(pos == ends[2] - 1U)
+			VT_TEST_CHECK(status == VT_STATUS_RCV_ERROR || status == VT_STATUS_INVALID);
+	}
+	/* The delta of the frame lost is missing from the timestamp, the record is flagged */
+	VT_TEST_CHECK(status == VT_STATUS_UNREADY);
+	VT_TEST_CHECK(event.type == VT_EVENT_MONITOR);
+	VT_TEST_CHECK(event.u.result.rule_id == test_events[3].u.result.rule_id);
+	VT_TEST_CHECK(event.u.result.can_id == test_events[3].u.result.can_id);
+	VT_TEST_CHECK(event.u.result.max_val == test_events[3].u.result.max_val);
+	VT_TEST_CHECK(event.time_stamp != test_events[3].time_stamp);
+	VT_TEST_CHECK(dec.frames == 2U && dec.unsynced == 1U);
+
+	/* Only the first frame of the stream is absolute, every record after the one lost stays flagged */
+	for(; pos < len; pos++)
+	{
+		status = vt_wire_decode_byte(&dec, test_stream[pos], &event);
+		if(status == VT_STATUS_EMPTY)
+			continue;
+		VT_TEST_CHECK(status == VT_STATUS_UNREADY);
+		flagged++;
+	}
+	VT_TEST_CHECK(flagged == VT_TEST_EVENTS - 4U);
+
+	/* The absolute timestamp of the first frame, then its delta, give the time back */
+	for(pos = 0; pos < ends[1]; pos++)
+	{
+		status = vt_wire_decode_byte(&dec, test_stream[pos], &event);
+		if(pos == ends[0] - 1U)
+		{
+			VT_TEST_CHECK(status == VT_STATUS_SUCCESS);
+			VT_TEST_CHECK(event.time_stamp == test_events[0].time_stamp);
+		}
+	}
+	VT_TEST_CHECK(status == VT_STATUS_SUCCESS);
+	VT_TEST_CHECK(memcmp(&event, &test_events[1], sizeof(vt_event_t)) == 0);
+	VT_TEST_CHECK(dec.frames == 4U);
+}
+
+/*!
+ * @brief  This API will check a frame that does not fit leaves the encoder unchanged.
+ * @param [in]   none.
+ * @return       none.
+ */
+static void _vt_test_small_buffer(void)
+{
+	vt_wire_encoder_t enc;
+	uint8_t out[VT_WIRE_MAX_FRAME];
+	uint32_t size = 0;
+
+	vt_wire_encoder_init(&enc);
+	VT_TEST_CHECK(vt_wire_encode_event(&enc, &test_events[5], out, 4U, &size) == VT_STATUS_SMALL_BUFF);
+	VT_TEST_CHECK(enc.count == 0);
+	VT_TEST_CHECK(vt_wire_encode_event(&enc, &test_events[5], out, sizeof(out), &size) == VT_STATUS_SUCCESS);
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+int main(void)
+{
+	uint32_t ends[VT_TEST_EVENTS];
+	uint32_t len;
+
+	_vt_test_make_events();
+	len = _vt_test_encode(ends);
+	_vt_test_round_trip(len);
+	_vt_test_join(ends);
+	_vt_test_corrupted(ends, len);
+	_vt_test_small_buffer();
+
+	if(test_failures > 0)
+	{
+		fprintf(stderr, "vt_test_wire: %lu checks failed\n", (unsigned long)test_failures);
+		return 1;
+	}
+	printf("vt_test_wire: passed\n");
+	return 0;
+}
@@ -0,0 +1,206 @@
+/*
+ * vt_agent_linux.c
+ *
+ * Host tool: the agent on a Linux gateway, CAN0 and CAN1 on SocketCAN interfaces (see vt_socketcan.h).
+ *
+ *   vt_agent_linux [-i if0] [-I if1] [-p loop_us] [-o file]
+ *
+ * The interfaces (can0 and can1 by default) must be up at their bitrate. Frames go through vt_rcv_callback() in the
+ * receive threads of the driver, and are forwarded between the two interfaces as on target. The PIT, RTC and UART
+ * are the mock HAL, its clock follows CLOCK_MONOTONIC: the main loop sleeps in vt_osal_wait() until a frame, the
+ * deadline of vt_fw_process_until_idle() or loop_us at most, advances the clock under the interrupt lock, so the PIT
+ * handler and the FlexCAN callbacks never run at once, then runs vt_fw_process_until_idle() outside of it, as the
+ * main loop of the target does. The mock timers only move in the main loop, loop_us bounds their lateness.
+ * The event stream of the UART goes to the file (-o), stdout by default, for vt_decode. Counters are printed to
+ * stderr on SIGINT or SIGTERM.
+ */
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include <signal.h>
+#include <time.h>
+#include "vt_hal_mock.h"
+#include "vt_socketcan.h"
+#include "vt_fw_if.h"
+#include "vt_fw_oem.h"
+#include "vt_can.h"
+#include "vt_rtc.h"
+#include "vt_timer.h"
+#include "vt_osal.h"
+
+/*------------------------------------------------------------------*
+ *                          Define Macro                            *
+ *------------------------------------------------------------------*/
+#define VT_LINUX_LOOP_US        1000U
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+static volatile sig_atomic_t linux_stop;
+
+extern void PIT_Ch0_IRQHandler(void);
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+static void _vt_linux_signal(int sig)
+{
+	(void)sig;
+	linux_stop = 1;
+}
+
+static uint64_t _vt_linux_now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000U;
+}
+
+/*!
+ * @brief  This API will write the bytes of the UART.
+ * @param [in]   *out - pointer to output file.
+ * @return       none.
+ */
+static void _vt_linux_drain(FILE *out)
+{
+	uint8_t buff[4096];
+	uint32_t len;
+
+	while((len = vt_hal_uart_read(buff, sizeof(buff))) > 0)
+		fwrite(buff, 1, len, out);
+	fflush(out);
+}
+
+/*!
+ * @brief  This API will print the counters of a port.
+ * @param [in]   instance - is FlexCAN instance.
+ * @param [in]   *ifname - pointer to interface name.
+ * @param [in]   *port - pointer to vt_fw_port_stats_t structure.
+ * @return       none.
+ */
+static void _vt_linux_print(uint8_t instance, const char *ifname, const vt_fw_port_stats_t *port)
+{
+	vt_socketcan_stats_t sc;
+
+	vt_socketcan_get_stats(instance, &sc);
+	fprintf(stderr, "%s: rx %llu in %llu batches, lost %llu, dropped %llu; tx %llu in %llu batches, retries %llu, errors %llu\n",
+	        ifname, (unsigned long long)sc.rx_frames, (unsigned long long)sc.rx_batches, (unsigned long long)sc.rx_lost,
+	        (unsigned long long)sc.rx_dropped, (unsigned long long)sc.tx_frames, (unsigned long long)sc.tx_batches,
+	        (unsigned long long)sc.tx_retries, (unsigned long long)sc.tx_errors);
+	fprintf(stderr, "%s: agent rx %lu tx %lu overflow %lu aborts %lu, queue high water %lu dropped %lu\n",
+	        ifname, (unsigned long)port->can.rx_frames, (unsigned long)port->can.tx_frames,
+	        (unsigned long)port->can.rx_fifo_overflow, (unsigned long)port->can.tx_aborts,
+	        (unsigned long)port->queue_high_water, (unsigned long)port->queue_dropped);
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+int main(int argc, char *argv[])
+{
+	const char *ifname[VT_MAX_CAN_NUMBER] = {"can0", "can1"};
+	const char *path = NULL;
+	uint32_t loop_us = VT_LINUX_LOOP_US;
+	uint32_t deadline, wait_us;
+	vt_fw_stats_t stats;
+	uint64_t start_us, now_us;
+	FILE *out = stdout;
+	uint32_t i;
+	int bad = 0;
+
+	for(i = 1; i < (uint32_t)argc && !bad; i++)
+	{
+		if((i + 1U) >= (uint32_t)argc)
+			bad = 1;
+		else if(strcmp(argv[i], "-i") == 0)
+			ifname[VT_INST_CAN0] = argv[++i];
+		else if(strcmp(argv[i], "-I") == 0)
+			ifname[VT_INST_CAN1] = argv[++i];
+		else if(strcmp(argv[i], "-p") == 0)
+			loop_us = (uint32_t)atoi(argv[++i]);
+		else if(strcmp(argv[i], "-o") == 0)
+			path = argv[++i];
+		else
+			bad = 1;
+	}
+	if(bad || loop_us == 0 || loop_us >= 1000000U)
+	{
+		fprintf(stderr, "usage: %s [-i if0] [-I if1] [-p loop_us] [-o file]\n", argv[0]);
+		return 1;
+	}
+	for(i = 0; i < VT_MAX_CAN_NUMBER; i++)
+	{
+		if(vt_socketcan_set_interface((uint8_t)i, ifname[i]) != VT_STATUS_SUCCESS)
+		{
+			fprintf(stderr, "%s: invalid interface name\n", ifname[i]);
+			return 1;
+		}
+	}
+	if(path != NULL)
+	{
+		out = fopen(path, "wb");
+		if(out == NULL)
+		{
+			perror(path);
+			return 1;
+		}
+	}
+
+	vt_hal_reset();
+	vt_hal_pit_install_handler(vt_pit_ChnConfig0.hwChannel, PIT_Ch0_IRQHandler);
+	vt_rtc_init(VT_RTC_TIMER, &vt_rtcTimer_StartTime, &vt_rtcTimer_AlarmConfig);
+	vt_timer_init(VT_INST_PIT, &vt_pit_ChnConfig0);
+	if(vt_fw_oem_init() != VT_STATUS_SUCCESS)
+	{
+		fprintf(stderr, "vt_agent: init of the firewall failed, see the arena sizes in vt_fw_oem.h\n");
+		return 1;
+	}
+	for(i = 0; i < VT_MAX_CAN_NUMBER; i++)
+	{
+		/* The bitrate is the one of the interface */
+		if(vt_init_can((uint8_t)i, VT_BITRATE_500, vt_rcv_callback, NULL) != STATUS_SUCCESS)
+		{
+			fprintf(stderr, "%s: cannot open SocketCAN interface\n", ifname[i]);
+			return 1;
+		}
+		vt_start_rcv((uint8_t)i);
+	}
+
+	signal(SIGINT, _vt_linux_signal);
+	signal(SIGTERM, _vt_linux_signal);
+	vt_osal_init();
+	deadline = vt_timer_get_ticks();
+	start_us = _vt_linux_now_us();
+	while(!linux_stop)
+	{
+		wait_us = vt_timer_us_until(deadline);
+		vt_osal_wait((wait_us < loop_us) ? wait_us : loop_us);
+		now_us = _vt_linux_now_us() - start_us;
+		if(now_us > vt_hal_clock_us())
+		{
+			vt_socketcan_lock();
+			vt_hal_clock_advance((uint32_t)(now_us - vt_hal_clock_us()));
+			vt_socketcan_unlock();
+		}
+		deadline = vt_fw_process_until_idle();
+		_vt_linux_drain(out);
+	}
+
+	for(i = 0; i < VT_MAX_CAN_NUMBER; i++)
+		vt_socketcan_close((uint8_t)i);
+	vt_fw_process_until_idle();
+	_vt_linux_drain(out);
+	vt_fw_get_stats(&stats);
+	for(i = 0; i < VT_MAX_CAN_NUMBER; i++)
+		_vt_linux_print((uint8_t)i, ifname[i], &stats.port[i]);
+	vt_fw_close();
+
+	if(out != stdout && fclose(out) != 0)
+	{
+		perror(path);
+		return 1;
+	}
+	return 0;
+}
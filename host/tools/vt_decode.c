@@ -0,0 +1,183 @@
+/*
+ * vt_decode.c
+ *
+ * Host tool: decode the binary event stream of the agent (see vt_wire.h) captured from the UART.
+ *
+ *   vt_decode [-j] [-t us_per_tick] [file]
+ *
+ * Reads the file, or stdin when no file is given, and prints one event per line as text,
+ * or as JSON objects with -j. Counters of the decoder are printed to stderr at the end.
+ */
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_wire.h"
+
+/*------------------------------------------------------------------*
+ *                          Define Macro                            *
+ *------------------------------------------------------------------*/
+/*! Slot tick of the agent, VT_PIT_PERIOD */
+#define VT_DECODE_DEFAULT_TICK_US 200.0
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+static const char *event_names[] = {"none", "traffic_status", "vector", "blacklist", "monitor", "dropped", "summary", "probe", "missing"};
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will print an event as one JSON object.
+ * @param [in]   *event - pointer to vt_event_t structure.
+ * @param [in]   seconds - is timestamp in seconds.
+ * @param [in]   synced - is 0 if the time base is unknown, the time is null then.
+ * @return       none.
+ */
+static void _vt_decode_print_json(const vt_event_t *event, double seconds, int synced)
+{
+	printf("{\"type\":\"%s\",\"ticks\":%lu", event_names[event->type], (unsigned long)event->time_stamp);
+	if(synced)
+		printf(",\"time\":%.4f", seconds);
+	else
+		printf(",\"time\":null");
+	switch(event->type)
+	{
+	case VT_EVENT_TRAFFIC_STATUS:
+		printf(",\"car_status\":%d,\"slot_rate\":%lu.%04lu,\"pattern_rate\":%lu.%04lu,\"count_frames\":%lu",
+		       (int)event->u.traffic.car_status, VT_RATE_WHOLE(event->u.traffic.slot_rate),
+		       VT_RATE_FRAC(event->u.traffic.slot_rate), VT_RATE_WHOLE(event->u.traffic.pattern_rate),
+		       VT_RATE_FRAC(event->u.traffic.pattern_rate), (unsigned long)event->u.traffic.count_frames);
+		break;
+	case VT_EVENT_VECTOR:
+		printf(",\"matched_flag\":%u,\"matched_rate\":%lu.%04lu,\"in_rl\":%lu,\"in_rt\":%lu,\"all\":%lu",
+		       event->u.vector.matched_flag, VT_RATE_WHOLE(event->u.vector.matched_rate),
+		       VT_RATE_FRAC(event->u.vector.matched_rate),
+		       (unsigned long)event->u.vector.count_vector_in_rl, (unsigned long)event->u.vector.count_vector_in_rt,
+		       (unsigned long)event->u.vector.count_all_vector);
+		break;
+	case VT_EVENT_BLACKLIST:
+	case VT_EVENT_MONITOR:
+		printf(",\"rule_type\":%u,\"matched_bit\":%u", event->u.result.rule_type, event->u.result.matched_bit);
+		if(event->u.result.rule_id != VT_FW_RULE_ID_NONE)
+			printf(",\"rule_id\":%lu", (unsigned long)event->u.result.rule_id);
+		if(event->u.result.can_id != VT_FW_CAN_ID_NONE)
+			printf(",\"can_id\":%lu", (unsigned long)event->u.result.can_id);
+		printf(",\"min\":%u,\"max\":%u", event->u.result.min_val, event->u.result.max_val);
+		break;
+	case VT_EVENT_DROPPED:
+		printf(",\"dropped\":%lu", (unsigned long)event->u.dropped);
+		break;
+	case VT_EVENT_SUMMARY:
+		printf(",\"rule_type\":%u", event->u.summary.rule_type);
+		if(event->u.summary.rule_id != VT_FW_RULE_ID_NONE)
+			printf(",\"rule_id\":%lu", (unsigned long)event->u.summary.rule_id);
+		if(event->u.summary.can_id != VT_FW_CAN_ID_NONE)
+			printf(",\"can_id\":%lu", (unsigned long)event->u.summary.can_id);
+		printf(",\"count\":%lu,\"first_ticks\":%lu,\"last_ticks\":%lu,\"peak_rate\":%lu",
+		       (unsigned long)event->u.summary.count, (unsigned long)event->u.summary.first_ts,
+		       (unsigned long)event->u.summary.last_ts, (unsigned long)event->u.summary.peak_rate);
+		break;
+	case VT_EVENT_PROBE:
+		printf(",\"probe\":\"%s\",\"count\":%lu,\"min_ns\":%lu,\"max_ns\":%lu,\"p99_ns\":%lu",
+		       vt_probe_name(event->u.probe.probe), (unsigned long)event->u.probe.count,
+		       (unsigned long)event->u.probe.min_ns, (unsigned long)event->u.probe.max_ns, (unsigned long)event->u.probe.p99_ns);
+		break;
+	case VT_EVENT_MISSING:
+		printf(",\"can_id\":%lu,\"last_ticks\":%lu,\"timeout_ticks\":%lu", (unsigned long)event->u.missing.can_id,
+		       (unsigned long)event->u.missing.last_ts, (unsigned long)event->u.missing.timeout);
+		break;
+	default:
+		break;
+	}
+	printf("}\n");
+}
+
+/*!
+ * @brief  This API will print an event as text, the same text the agent sends with VT_REPORT_BINARY = 0.
+ * @param [in]   *event - pointer to vt_event_t structure.
+ * @param [in]   seconds - is timestamp in seconds.
+ * @param [in]   synced - is 0 if the time base is unknown, the time is printed as ? then.
+ * @return       none.
+ */
+static void _vt_decode_print_text(const vt_event_t *event, double seconds, int synced)
+{
+	char st[256];
+	char *line, *next;
+
+	vt_event_format(event, st, sizeof(st));
+	for(line = st; *line != '\0'; line = next)
+	{
+		next = strchr(line, '\n');
+		if(next == NULL)
+			next = line + strlen(line);
+		else
+			*next++ = '\0';
+		if(line[0] != '\0' && line[strlen(line) - 1] == '\r')
+			line[strlen(line) - 1] = '\0';
+		if(synced)
+			printf("[%12.4f] %s\n", seconds, line);
+		else
+			printf("[%12s] %s\n", "?", line);
+	}
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+int main(int argc, char *argv[])
+{
+	vt_wire_decoder_t dec;
+	vt_event_t event;
+	double tick_us = VT_DECODE_DEFAULT_TICK_US;
+	double seconds;
+	vt_status_t status;
+	int json = 0;
+	FILE *in = stdin;
+	int c, i;
+
+	for(i = 1; i < argc; i++)
+	{
+		if(strcmp(argv[i], "-j") == 0)
+			json = 1;
+		else if(strcmp(argv[i], "-t") == 0 && (i + 1) < argc)
+			tick_us = atof(argv[++i]);
+		else if(argv[i][0] == '-')
+		{
+			fprintf(stderr, "usage: %s [-j] [-t us_per_tick] [file]\n", argv[0]);
+			return 1;
+		}
+		else
+		{
+			in = fopen(argv[i], "rb");
+			if(in == NULL)
+			{
+				perror(argv[i]);
+				return 1;
+			}
+		}
+	}
+
+	vt_wire_decoder_init(&dec);
+	while((c = fgetc(in)) != EOF)
+	{
+		status = vt_wire_decode_byte(&dec, (uint8_t)c, &event);
+		if(status != VT_STATUS_SUCCESS && status != VT_STATUS_UNREADY)
+			continue;
+
+		/* Before the first absolute timestamp, and after a frame lost until the next one, the time is not known */
+		seconds = (double)event.time_stamp * tick_us / 1000000.0;
+		if(json)
+			_vt_decode_print_json(&event, seconds, (status == VT_STATUS_SUCCESS));
+		else
+			_vt_decode_print_text(&event, seconds, (status == VT_STATUS_SUCCESS));
+	}
+
+	if(in != stdin)
+		fclose(in);
+	fprintf(stderr, "frames: %lu unsynced: %lu crc errors: %lu format errors: %lu\n", (unsigned long)dec.frames,
+	        (unsigned long)dec.unsynced, (unsigned long)dec.crc_errors, (unsigned long)dec.format_errors);
+
+	return 0;
+}
@@ -0,0 +1,670 @@
+/*
+ * vt_eval.c
+ *
+ * Host tool: evaluate a policy against many recorded traces in parallel and merge the detections.
+ *
+ *   vt_eval [-j workers] [-t us_per_tick] [-b frames_per_process] [-c channel] [-p policy.bin -v vector.bin]
+ *           [-l list] trace...
+ *
+ * The firewall core keeps its state in globals, so each worker is a process with its own core. Workers take the
+ * next trace from a counter in shared memory, the largest traces first, until the list is done. A worker that
+ * crashes on a trace marks only that trace as failed, the others are taken by the remaining workers.
+ *
+ * One line per trace is printed as it completes, then the summary: events per hour of trace time for every rule
+ * that fired, and the distribution of the vector matched_rate.
+ */
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "vt_fw_if.h"
+#include "vt_fw_result.h"
+#include "vt_atomic.h"
+#include "vt_trace_replay.h"
+
+/*------------------------------------------------------------------*
+ *                          Define Macro                            *
+ *------------------------------------------------------------------*/
+/*! Distinct rules recorded per trace, further rules are counted as lost */
+#define VT_EVAL_MAX_RULES       256U
+
+/*! Bins of the matched_rate histogram over [0, 1] */
+#define VT_EVAL_RATE_BINS       100U
+
+/*! Interval at which completed traces are printed */
+#define VT_EVAL_POLL_US         20000U
+
+/*! Longest path in a list file */
+#define VT_EVAL_PATH_LEN        4096U
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef enum _vt_eval_state_t
+{
+	VT_EVAL_PENDING = 0,
+	VT_EVAL_RUNNING,
+	VT_EVAL_DONE,
+	VT_EVAL_FAILED
+}vt_eval_state_t;
+
+/*!
+ * @brief Rule of the firewall core, identified by the kind of detection and the CAN Id in its detail.
+ */
+typedef struct _vt_eval_rule_t
+{
+	uint32_t can_id;                            /*!< VT_FW_CAN_ID_NONE if the detail has no CAN Id */
+	uint32_t count;
+	uint32_t traces;                            /*!< traces the rule fired in */
+	uint8_t monitor;                            /*!< 0: blacklist, 1: monitor */
+	uint8_t matched_bit;                        /*!< VT_FRAME_BIT, VT_RANGE_BIT or VT_PATTERN_BIT */
+}vt_eval_rule_t;
+
+/*!
+ * @brief Result of a trace, written by the worker in shared memory.
+ */
+typedef struct _vt_eval_trace_t
+{
+	volatile uint32_t state;                    /*!< vt_eval_state_t */
+	pid_t worker;                               /*!< process evaluating the trace */
+	uint64_t frames;
+	uint64_t duration_us;                       /*!< trace time */
+	double elapsed_s;                           /*!< host time */
+	uint32_t errors;                            /*!< lines of the trace that do not parse */
+	uint32_t traffic_events;
+	uint32_t detections;                        /*!< blacklist and monitor events */
+	uint32_t vector_count;
+	double rate_sum;
+	float rate_min;
+	float rate_max;
+	uint32_t rate_hist[VT_EVAL_RATE_BINS];
+	uint32_t rule_count;
+	uint32_t rules_lost;                        /*!< detections of rules beyond VT_EVAL_MAX_RULES */
+	vt_eval_rule_t rules[VT_EVAL_MAX_RULES];
+}vt_eval_trace_t;
+
+typedef struct _vt_eval_shared_t
+{
+	uint32_t next;                              /*!< next entry of the work order */
+	vt_eval_trace_t traces[];
+}vt_eval_shared_t;
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+static const char *bit_names[] = {"none", "frame", "range", "none", "pattern"};
+
+/* Trace evaluated by this worker, written by the core callbacks */
+static vt_eval_trace_t *eval_current;
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+static double _vt_eval_now_s(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000.0;
+}
+
+/*!
+ * @brief  This API will count a detection to its rule in a rule table.
+ * @param [in]   *rules - pointer to rule table.
+ * @param [in]   *count - pointer to number of rules in the table.
+ * @param [in]   max - is size of the table.
+ * @param [in]   *rule - pointer to vt_eval_rule_t structure, count is added.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_FULL.
+ */
+static vt_status_t _vt_eval_count_rule(vt_eval_rule_t *rules, uint32_t *count, uint32_t max, const vt_eval_rule_t *rule)
+{
+	uint32_t i;
+
+	for(i = 0; i < *count; i++)
+	{
+		if(rules[i].can_id == rule->can_id && rules[i].monitor == rule->monitor && rules[i].matched_bit == rule->matched_bit)
+		{
+			rules[i].count += rule->count;
+			rules[i].traces += rule->traces;
+			return VT_STATUS_SUCCESS;
+		}
+	}
+	if(*count >= max)
+		return VT_STATUS_FULL;
+
+	rules[(*count)++] = *rule;
+	return VT_STATUS_SUCCESS;
+}
+
+static void _vt_eval_traffic_status(vt_car_status_t car_status, float slot_rate, float pattern_rate, uint32_t count_id)
+{
+	(void)car_status;
+	(void)slot_rate;
+	(void)pattern_rate;
+	(void)count_id;
+	eval_current->traffic_events++;
+}
+
+static vt_status_t _vt_eval_vector(vt_vector_result_t *vector_t)
+{
+	vt_eval_trace_t *trace = eval_current;
+	float rate;
+	uint32_t bin;
+
+	if(vector_t == NULL)
+		return VT_STATUS_NULL;
+
+	rate = vector_t->matched_rate;
+	if(!(rate >= 0.0f))
+		rate = 0.0f;
+	if(rate > 1.0f)
+		rate = 1.0f;
+	bin = (uint32_t)(rate * VT_EVAL_RATE_BINS);
+	if(bin >= VT_EVAL_RATE_BINS)
+		bin = VT_EVAL_RATE_BINS - 1U;
+
+	if(trace->vector_count == 0 || rate < trace->rate_min)
+		trace->rate_min = rate;
+	if(trace->vector_count == 0 || rate > trace->rate_max)
+		trace->rate_max = rate;
+	trace->rate_sum += rate;
+	trace->rate_hist[bin]++;
+	trace->vector_count++;
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will count a blacklist or monitor detection to its rule.
+ * @param [in]   monitor - 0 for a blacklist detection, 1 for a monitor detection.
+ * @param [in]   *detail_result - pointer to vt_fw_detail_result_t structure.
+ * @return       status.
+ */
+static vt_status_t _vt_eval_detail(uint8_t monitor, vt_fw_detail_result_t *detail_result)
+{
+	vt_eval_trace_t *trace = eval_current;
+	vt_eval_rule_t rule;
+
+	if(detail_result == NULL)
+		return VT_STATUS_NULL;
+	if(detail_result->matched_type == VT_UNMATCHED_BIT)
+		return VT_STATUS_SUCCESS;
+
+	/* Most specific match first, as the agent does */
+	if(detail_result->matched_type & VT_FRAME_BIT)
+		rule.matched_bit = VT_FRAME_BIT;
+	else if(detail_result->matched_type & VT_PATTERN_BIT)
+		rule.matched_bit = VT_PATTERN_BIT;
+	else
+		rule.matched_bit = VT_RANGE_BIT;
+	rule.monitor = monitor;
+	rule.can_id = vt_fw_detail_can_id(detail_result);
+	rule.count = 1;
+	rule.traces = 1;
+
+	trace->detections++;
+	if(_vt_eval_count_rule(trace->rules, &trace->rule_count, VT_EVAL_MAX_RULES, &rule) != VT_STATUS_SUCCESS)
+		trace->rules_lost++;
+	return VT_STATUS_SUCCESS;
+}
+
+static vt_status_t _vt_eval_blacklist(vt_fw_detail_result_t *detail_result)
+{
+	return _vt_eval_detail(0, detail_result);
+}
+
+static vt_status_t _vt_eval_monitor(vt_fw_detail_result_t *detail_result)
+{
+	return _vt_eval_detail(1, detail_result);
+}
+
+/*!
+ * @brief  This API will replay a trace on a fresh firewall core.
+ * @param [out]  *result - pointer to vt_eval_trace_t structure.
+ * @param [in]   *path - pointer to file name of the trace.
+ * @param [in]   *replay - pointer to vt_trace_replay_t structure with the replay options.
+ * @param [in]   *policy - pointer to policy data.
+ * @param [in]   *vector - pointer to vector data.
+ * @return       none.
+ */
+static void _vt_eval_run(vt_eval_trace_t *result, const char *path, const vt_trace_replay_t *options,
+                         const uint8_t *policy, const uint8_t *vector)
+{
+	vt_trace_replay_t replay;
+	vt_trace_t trace;
+	vt_status_t status;
+	uint32_t i;
+	double t0;
+
+	if(vt_trace_open(&trace, path) != VT_STATUS_SUCCESS)
+	{
+		VT_ATOMIC_STORE(&result->state, (uint32_t)VT_EVAL_FAILED);
+		return;
+	}
+
+	eval_current = result;
+	vt_trace_replay_init(&replay, options->tick_us, options->batch, options->channel);
+	vt_fw_init(policy, vector);
+	vt_fw_set_slot_time_unit((uint16_t)options->tick_us);
+	vt_fw_install_vector_callback(_vt_eval_vector);
+	vt_fw_install_traffic_status_callback(_vt_eval_traffic_status);
+	vt_fw_install_blacklist_callback(_vt_eval_blacklist);
+	vt_fw_install_monitor_callback(_vt_eval_monitor);
+
+	t0 = _vt_eval_now_s();
+	status = vt_trace_replay_run(&replay, &trace);
+	result->elapsed_s = _vt_eval_now_s() - t0;
+	result->frames = replay.frames;
+	result->duration_us = vt_trace_replay_time_us(&replay);
+	result->errors = trace.errors;
+	for(i = 0; i < result->rule_count; i++)
+	{
+		result->rules[i].traces = 1;
+	}
+
+	vt_fw_close();
+	vt_trace_close(&trace);
+	VT_ATOMIC_STORE(&result->state, (uint32_t)((status == VT_STATUS_SUCCESS) ? VT_EVAL_DONE : VT_EVAL_FAILED));
+}
+
+/*!
+ * @brief  This API will add a trace to the path array.
+ * @param [in, out] ***paths - pointer to path array.
+ * @param [in, out] *count - pointer to number of paths.
+ * @param [in]   *path - pointer to file name of the trace.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_NO_MEM.
+ */
+static vt_status_t _vt_eval_add_path(char ***paths, uint32_t *count, const char *path)
+{
+	char **grown;
+
+	grown = (char **)realloc(*paths, (*count + 1U) * sizeof(char *));
+	if(grown == NULL)
+		return VT_STATUS_NO_MEM;
+	*paths = grown;
+	grown[*count] = strdup(path);
+	if(grown[*count] == NULL)
+		return VT_STATUS_NO_MEM;
+	(*count)++;
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will add the traces of a list file, one path per line.
+ * @param [in]   *list - pointer to file name of the list.
+ * @param [in, out] ***paths - pointer to path array.
+ * @param [in, out] *count - pointer to number of paths.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_IO or VT_STATUS_NO_MEM.
+ */
+static vt_status_t _vt_eval_read_list(const char *list, char ***paths, uint32_t *count)
+{
+	char line[VT_EVAL_PATH_LEN];
+	FILE *in;
+	size_t len;
+
+	in = fopen(list, "r");
+	if(in == NULL)
+	{
+		perror(list);
+		return VT_STATUS_IO;
+	}
+	while(fgets(line, sizeof(line), in) != NULL)
+	{
+		len = strlen(line);
+		while(len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+			line[--len] = '\0';
+		if(len == 0 || line[0] == '#')
+			continue;
+
+		if(_vt_eval_add_path(paths, count, line) != VT_STATUS_SUCCESS)
+		{
+			fclose(in);
+			return VT_STATUS_NO_MEM;
+		}
+	}
+	fclose(in);
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will print the result of a trace.
+ * @param [in]   *path - pointer to file name of the trace.
+ * @param [in]   *result - pointer to vt_eval_trace_t structure.
+ * @return       none.
+ */
+static void _vt_eval_print_trace(const char *path, const vt_eval_trace_t *result)
+{
+	double hours = (double)result->duration_us / 3600000000.0;
+
+	if(result->state != VT_EVAL_DONE)
+	{
+		printf("trace %s failed\n", path);
+		return;
+	}
+	printf("trace %s frames %llu hours %.3f detections %lu (%.2f/h) rules %lu vector %lu mean_rate %.4f elapsed %.3f s\n",
+	       path, (unsigned long long)result->frames, hours, (unsigned long)result->detections,
+	       (hours > 0.0) ? ((double)result->detections / hours) : 0.0, (unsigned long)result->rule_count,
+	       (unsigned long)result->vector_count, result->vector_count ? (result->rate_sum / result->vector_count) : 0.0,
+	       result->elapsed_s);
+}
+
+static int _vt_eval_compare_rules(const void *a, const void *b)
+{
+	const vt_eval_rule_t *ra = (const vt_eval_rule_t *)a;
+	const vt_eval_rule_t *rb = (const vt_eval_rule_t *)b;
+
+	if(ra->count != rb->count)
+		return (ra->count < rb->count) ? 1 : -1;
+	return (ra->can_id < rb->can_id) ? -1 : (ra->can_id > rb->can_id);
+}
+
+/*!
+ * @brief  This API will get a percentile of the matched_rate histogram, as the upper bound of its bin.
+ * @param [in]   *hist - pointer to histogram.
+ * @param [in]   total - is number of samples.
+ * @param [in]   percent - is percentile.
+ * @return       matched_rate.
+ */
+static double _vt_eval_percentile(const uint64_t *hist, uint64_t total, uint32_t percent)
+{
+	uint64_t rank = (total * percent + 99U) / 100U;
+	uint64_t seen = 0;
+	uint32_t i;
+
+	for(i = 0; i < VT_EVAL_RATE_BINS; i++)
+	{
+		seen += hist[i];
+		if(seen >= rank && seen > 0)
+			break;
+	}
+	return (double)(i + 1U) / VT_EVAL_RATE_BINS;
+}
+
+/*!
+ * @brief  This API will merge the results of every trace and print the summary.
+ * @param [in]   *shared - pointer to vt_eval_shared_t structure.
+ * @param [in]   count - is number of traces.
+ * @param [in]   elapsed - is host time of the evaluation.
+ * @return       number of failed traces.
+ */
+static uint32_t _vt_eval_summary(const vt_eval_shared_t *shared, uint32_t count, double elapsed)
+{
+	vt_eval_rule_t *rules;
+	uint32_t rule_count = 0;
+	uint64_t hist[VT_EVAL_RATE_BINS];
+	uint64_t frames = 0, duration_us = 0, vector_count = 0, detections = 0, lost = 0;
+	double rate_sum = 0.0, hours;
+	float rate_min = 1.0f, rate_max = 0.0f;
+	uint32_t failed = 0;
+	uint32_t i, j;
+	const vt_eval_trace_t *result;
+
+	memset(hist, 0, sizeof(hist));
+	rules = (vt_eval_rule_t *)malloc(((size_t)count * VT_EVAL_MAX_RULES + 1U) * sizeof(vt_eval_rule_t));
+	if(rules == NULL)
+		return count;
+
+	for(i = 0; i < count; i++)
+	{
+		result = &shared->traces[i];
+		if(result->state != VT_EVAL_DONE)
+		{
+			failed++;
+			continue;
+		}
+
+		frames += result->frames;
+		duration_us += result->duration_us;
+		detections += result->detections;
+		lost += result->rules_lost;
+		for(j = 0; j < result->rule_count; j++)
+		{
+			_vt_eval_count_rule(rules, &rule_count, count * VT_EVAL_MAX_RULES, &result->rules[j]);
+		}
+
+		if(result->vector_count > 0)
+		{
+			if(result->rate_min < rate_min)
+				rate_min = result->rate_min;
+			if(result->rate_max > rate_max)
+				rate_max = result->rate_max;
+		}
+		vector_count += result->vector_count;
+		rate_sum += result->rate_sum;
+		for(j = 0; j < VT_EVAL_RATE_BINS; j++)
+		{
+			hist[j] += result->rate_hist[j];
+		}
+	}
+	hours = (double)duration_us / 3600000000.0;
+
+	printf("summary: traces %lu failed %lu, frames %llu, trace hours %.3f, elapsed %.3f s, %.0f frames/s\n",
+	       (unsigned long)count, (unsigned long)failed, (unsigned long long)frames, hours, elapsed,
+	       (elapsed > 0.0) ? ((double)frames / elapsed) : 0.0);
+	printf("summary: detections %llu (%.2f/h), rules %lu, detections of rules not recorded %llu\n",
+	       (unsigned long long)detections, (hours > 0.0) ? ((double)detections / hours) : 0.0,
+	       (unsigned long)rule_count, (unsigned long long)lost);
+
+	qsort(rules, rule_count, sizeof(vt_eval_rule_t), _vt_eval_compare_rules);
+	for(i = 0; i < rule_count; i++)
+	{
+		if(rules[i].can_id == VT_FW_CAN_ID_NONE)
+			printf("rule %s/%s -", rules[i].monitor ? "monitor" : "blacklist", bit_names[rules[i].matched_bit]);
+		else
+			printf("rule %s/%s 0x%lX", rules[i].monitor ? "monitor" : "blacklist", bit_names[rules[i].matched_bit],
+			       (unsigned long)rules[i].can_id);
+		printf(": %lu events, %.3f/h, in %lu of %lu traces\n", (unsigned long)rules[i].count,
+		       (hours > 0.0) ? ((double)rules[i].count / hours) : 0.0, (unsigned long)rules[i].traces,
+		       (unsigned long)(count - failed));
+	}
+
+	if(vector_count > 0)
+	{
+		printf("vector matched_rate: n %llu min %.4f mean %.4f max %.4f p1 %.2f p10 %.2f p50 %.2f p90 %.2f\n",
+		       (unsigned long long)vector_count, rate_min, rate_sum / (double)vector_count, rate_max,
+		       _vt_eval_percentile(hist, vector_count, 1), _vt_eval_percentile(hist, vector_count, 10),
+		       _vt_eval_percentile(hist, vector_count, 50), _vt_eval_percentile(hist, vector_count, 90));
+		for(i = 0; i < VT_EVAL_RATE_BINS; i++)
+		{
+			if(hist[i] > 0)
+				printf("vector matched_rate [%.2f, %.2f%c %llu\n", (double)i / VT_EVAL_RATE_BINS,
+				       (double)(i + 1U) / VT_EVAL_RATE_BINS, (i + 1U == VT_EVAL_RATE_BINS) ? ']' : ')',
+				       (unsigned long long)hist[i]);
+		}
+	}
+	else
+	{
+		printf("vector matched_rate: n 0\n");
+	}
+
+	free(rules);
+	return failed;
+}
+
+/*!
+ * @brief  This API will start a worker process taking traces until the work order is done.
+ * @param [in]   *shared - pointer to vt_eval_shared_t structure.
+ * @param [in]   *order - pointer to work order, indexes of the traces.
+ * @param [in]   count - is number of traces.
+ * @param [in]   **paths - pointer to path array.
+ * @param [in]   *options - pointer to vt_trace_replay_t structure with the replay options.
+ * @param [in]   *policy - pointer to policy data.
+ * @param [in]   *vector - pointer to vector data.
+ * @return       process id of the worker, or -1.
+ */
+static pid_t _vt_eval_spawn(vt_eval_shared_t *shared, const uint32_t *order, uint32_t count, char **paths,
+                            const vt_trace_replay_t *options, const uint8_t *policy, const uint8_t *vector)
+{
+	vt_eval_trace_t *result;
+	uint32_t index;
+	pid_t pid;
+
+	fflush(stdout);
+	pid = fork();
+	if(pid != 0)
+		return pid;
+
+	while((index = VT_ATOMIC_ADD(&shared->next, 1U)) < count)
+	{
+		result = &shared->traces[order[index]];
+		result->worker = getpid();
+		VT_ATOMIC_STORE(&result->state, (uint32_t)VT_EVAL_RUNNING);
+		_vt_eval_run(result, paths[order[index]], options, policy, vector);
+	}
+	fflush(stdout);
+	_exit(0);
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+int main(int argc, char *argv[])
+{
+	vt_trace_replay_t options;
+	vt_eval_shared_t *shared;
+	const uint8_t *policy = car_policy;
+	const uint8_t *vector = car_vector;
+	uint8_t *policy_file = NULL;
+	uint8_t *vector_file = NULL;
+	const char *channel = NULL;
+	char **paths = NULL;
+	uint32_t *order;
+	uint64_t *sizes;
+	uint32_t count = 0;
+	uint32_t tick_us = VT_TRACE_REPLAY_TICK_US;
+	uint32_t batch = 1;
+	uint32_t workers = 0;
+	uint32_t printed, failed, running, i, j;
+	size_t shared_size;
+	struct stat st;
+	pid_t pid;
+	int wstatus;
+	double t0;
+
+	for(i = 1; i < (uint32_t)argc; i++)
+	{
+		if(strcmp(argv[i], "-j") == 0 && (i + 1) < (uint32_t)argc)
+			workers = (uint32_t)atoi(argv[++i]);
+		else if(strcmp(argv[i], "-t") == 0 && (i + 1) < (uint32_t)argc)
+			tick_us = (uint32_t)atoi(argv[++i]);
+		else if(strcmp(argv[i], "-b") == 0 && (i + 1) < (uint32_t)argc)
+			batch = (uint32_t)atoi(argv[++i]);
+		else if(strcmp(argv[i], "-c") == 0 && (i + 1) < (uint32_t)argc)
+			channel = argv[++i];
+		else if(strcmp(argv[i], "-p") == 0 && (i + 1) < (uint32_t)argc)
+			policy = policy_file = vt_trace_replay_load(argv[++i]);
+		else if(strcmp(argv[i], "-v") == 0 && (i + 1) < (uint32_t)argc)
+			vector = vector_file = vt_trace_replay_load(argv[++i]);
+		else if(strcmp(argv[i], "-l") == 0 && (i + 1) < (uint32_t)argc)
+		{
+			if(_vt_eval_read_list(argv[++i], &paths, &count) != VT_STATUS_SUCCESS)
+				return 1;
+		}
+		else if(argv[i][0] == '-')
+			break;
+		else if(_vt_eval_add_path(&paths, &count, argv[i]) != VT_STATUS_SUCCESS)
+			return 1;
+	}
+	if(i < (uint32_t)argc || count == 0 || vt_trace_replay_init(&options, tick_us, batch, channel) != VT_STATUS_SUCCESS)
+	{
+		fprintf(stderr, "usage: %s [-j workers] [-t us_per_tick] [-b frames_per_process] [-c channel] "
+		        "[-p policy.bin -v vector.bin] [-l list] trace...\n", argv[0]);
+		return 1;
+	}
+	if(policy == NULL || vector == NULL)
+		return 1;
+	if(workers == 0)
+		workers = (uint32_t)sysconf(_SC_NPROCESSORS_ONLN);
+	if(workers > count)
+		workers = count;
+
+	/* Largest traces first, so the last traces taken are the short ones */
+	order = (uint32_t *)malloc(count * sizeof(uint32_t));
+	sizes = (uint64_t *)malloc(count * sizeof(uint64_t));
+	shared_size = sizeof(vt_eval_shared_t) + (size_t)count * sizeof(vt_eval_trace_t);
+	shared = (vt_eval_shared_t *)mmap(NULL, shared_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if(order == NULL || sizes == NULL || shared == MAP_FAILED)
+	{
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+	for(i = 0; i < count; i++)
+	{
+		sizes[i] = (stat(paths[i], &st) == 0) ? (uint64_t)st.st_size : 0U;
+		for(j = i; j > 0 && sizes[order[j - 1]] < sizes[i]; j--)
+		{
+			order[j] = order[j - 1];
+		}
+		order[j] = i;
+	}
+
+	t0 = _vt_eval_now_s();
+	running = 0;
+	for(i = 0; i < workers; i++)
+	{
+		if(_vt_eval_spawn(shared, order, count, paths, &options, policy, vector) < 0)
+			break;
+		running++;
+	}
+	if(running == 0)
+	{
+		perror("fork");
+		return 1;
+	}
+
+	/* Print the traces in list order as they complete */
+	printed = 0;
+	while(running > 0)
+	{
+		while(printed < count && VT_ATOMIC_LOAD(&shared->traces[printed].state) >= VT_EVAL_DONE)
+		{
+			_vt_eval_print_trace(paths[printed], &shared->traces[printed]);
+			printed++;
+		}
+		fflush(stdout);
+
+		pid = waitpid(-1, &wstatus, WNOHANG);
+		if(pid == 0)
+		{
+			usleep(VT_EVAL_POLL_US);
+			continue;
+		}
+		if(pid < 0)
+			break;
+		running--;
+		if(WIFEXITED(wstatus) && WEXITSTATUS(wstatus) == 0)
+			continue;
+
+		/* The trace of a crashed worker failed, a new worker takes the rest of the work order */
+		for(i = 0; i < count; i++)
+		{
+			if(shared->traces[i].worker == pid && shared->traces[i].state == VT_EVAL_RUNNING)
+				shared->traces[i].state = VT_EVAL_FAILED;
+		}
+		if(VT_ATOMIC_LOAD(&shared->next) < count && _vt_eval_spawn(shared, order, count, paths, &options, policy, vector) > 0)
+			running++;
+	}
+	for(; printed < count; printed++)
+	{
+		_vt_eval_print_trace(paths[printed], &shared->traces[printed]);
+	}
+
+	failed = _vt_eval_summary(shared, count, _vt_eval_now_s() - t0);
+
+	munmap(shared, shared_size);
+	for(i = 0; i < count; i++)
+	{
+		free(paths[i]);
+	}
+	free(paths);
+	free(order);
+	free(sizes);
+	free(policy_file);
+	free(vector_file);
+
+	return (failed == 0) ? 0 : 1;
+}
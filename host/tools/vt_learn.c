@@ -0,0 +1,807 @@
+/*
+ * vt_learn.c
+ *
+ * Host tool: learn a policy and a vector from recorded traffic (candump log or Vector ASC, see vt_trace.h) and write
+ * them as car_policy_data.c and car_vector_data.c.
+ *
+ *   vt_learn [-o dir] [-t us_per_tick] [-c channel] [-q quantile] [-f tolerance] [-m min_pairs]
+ *            [-P base_policy.bin] [-V base_vector.bin] [-B] trace...
+ *
+ * The traces are read once, in order, without being loaded: every Id keeps its frame counts per window and a sketch
+ * of its intervals, every transition between two consecutive Ids goes to a hash set. Both tables are fixed, so memory
+ * does not grow with the length of the traces; Ids and transitions beyond them are counted and reported.
+ *
+ * car_policy, big endian, as generated for the shipped car:
+ *   u32 total length, u32 version (1), u32 count
+ *   count timing records, by Id:
+ *     u32 rule id (0x1000 + Id), u32 Id, u32 reserved (0), u16 min interval (slot ticks),
+ *     u32 max interval (slot ticks), f32 tolerance, u32 periodic, u8 min frames per window,
+ *     u32 max frames per window
+ *   u32 count
+ *   count category records, one per timing record:
+ *     u32 Id, u32 Id, u8 0, 8 x (u16 n, n x u32 category bits), u16 6
+ *   u32 1
+ *
+ * car_vector, big endian:
+ *   u32 total length, u16 n, n x u32 Id (first seen first), u16 x 3, u16 pairs, pairs x (u32 from, u32 to), u32
+ *
+ * The traffic gives the timing records, the Ids and the transitions. The category records and the fields of the
+ * vector that do not follow from traffic are taken from the base policy and vector, car_policy and car_vector by
+ * default: an Id without category record in the base gets an empty one.
+ *
+ * An Id gets a timing record when it is seen in every complete window of VT_LEARN_WINDOW_US. Intervals are bounded by
+ * the -q and 1 - q quantiles of the sketch, 0 by default for the exact minimum and maximum. An Id is periodic when
+ * its p10 to p90 jitter is within 1 - tolerance of its period.
+ */
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_fw_if.h"
+#include "vt_trace.h"
+
+/*------------------------------------------------------------------*
+ *                          Define Macro                            *
+ *------------------------------------------------------------------*/
+/*! Monitoring window of the core, VT_XMINUTE_TIME */
+#define VT_LEARN_WINDOW_US      60000000ULL
+
+/*! Ids of car_vector, VT_VECTOR_MAX_CAN_ID */
+#define VT_LEARN_VECTOR_IDS     48U
+
+/*! Distinct Ids tracked, a power of 2 */
+#define VT_LEARN_MAX_IDS        2048U
+
+/*! Distinct transitions tracked, a power of 2 */
+#define VT_LEARN_MAX_PAIRS      65536U
+
+/*! Interval sketch: 2^VT_LEARN_SUB_BITS buckets per power of 2, relative error below 1 / 2^VT_LEARN_SUB_BITS */
+#define VT_LEARN_SUB_BITS       6U
+#define VT_LEARN_SUB            (1U << VT_LEARN_SUB_BITS)
+#define VT_LEARN_BUCKETS        ((33U - VT_LEARN_SUB_BITS) << VT_LEARN_SUB_BITS)
+
+#define VT_LEARN_POLICY_VERSION 1U
+#define VT_LEARN_RULE_BASE      0x1000U
+#define VT_LEARN_TOLERANCE      0.8f
+#define VT_LEARN_CATEGORIES     8U
+#define VT_LEARN_CATEGORY_END   6U
+
+#define VT_LEARN_PATH_LEN       4096U
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief Traffic of one Id.
+ */
+typedef struct _vt_learn_id_t
+{
+	uint32_t id;
+	uint32_t order;                             /*!< first seen first */
+	uint64_t frames;
+	uint64_t last_us;                           /*!< time of the previous frame of the current trace */
+	uint32_t trace;                             /*!< trace of last_us, from 1 */
+	uint32_t min_us;
+	uint32_t max_us;
+	uint32_t window_frames;                     /*!< frames in the current window */
+	uint32_t windows;                           /*!< complete windows with frames */
+	uint32_t window_min;
+	uint32_t window_max;
+	uint64_t intervals;
+	uint32_t buckets[VT_LEARN_BUCKETS];         /*!< interval sketch, microseconds */
+}vt_learn_id_t;
+
+typedef struct _vt_learn_pair_t
+{
+	uint32_t from;
+	uint32_t to;
+	uint32_t count;
+}vt_learn_pair_t;
+
+typedef struct _vt_learn_buff_t
+{
+	uint8_t *data;
+	uint32_t len;
+	uint32_t size;
+}vt_learn_buff_t;
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+static vt_learn_id_t *learn_ids;
+static uint16_t learn_id_slots[VT_LEARN_MAX_IDS * 2U];    /*!< index + 1 in learn_ids, 0 for free */
+static uint32_t learn_id_count;
+static uint64_t learn_id_lost;
+
+static vt_learn_pair_t *learn_pairs;                      /*!< first seen first */
+static uint32_t learn_pair_slots[VT_LEARN_MAX_PAIRS * 2U];/*!< index + 1 in learn_pairs, 0 for free */
+static uint32_t learn_pair_count;
+static uint64_t learn_pair_lost;
+
+static uint32_t learn_windows;                            /*!< complete windows of every trace */
+static uint64_t learn_frames;
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+static uint32_t _vt_learn_hash(uint32_t a, uint32_t b)
+{
+	uint32_t h = (a * 0x9E3779B1U) ^ (b * 0x85EBCA77U);
+
+	return h ^ (h >> 16);
+}
+
+/*!
+ * @brief  This API will get the sketch bucket of an interval.
+ * @param [in]   us - is interval in microseconds.
+ * @return       bucket.
+ */
+static uint32_t _vt_learn_bucket(uint32_t us)
+{
+	uint32_t e;
+
+	if(us < VT_LEARN_SUB)
+		return us;
+	e = 31U - (uint32_t)__builtin_clz(us);
+	return ((e - VT_LEARN_SUB_BITS + 1U) << VT_LEARN_SUB_BITS) + ((us >> (e - VT_LEARN_SUB_BITS)) & (VT_LEARN_SUB - 1U));
+}
+
+/*!
+ * @brief  This API will get the lowest interval of a sketch bucket.
+ * @param [in]   bucket - is bucket.
+ * @return       microseconds.
+ */
+static uint64_t _vt_learn_bucket_us(uint32_t bucket)
+{
+	uint32_t e;
+
+	if(bucket < VT_LEARN_SUB)
+		return bucket;
+	e = (bucket >> VT_LEARN_SUB_BITS) + VT_LEARN_SUB_BITS - 1U;
+	return (uint64_t)(VT_LEARN_SUB + (bucket & (VT_LEARN_SUB - 1U))) << (e - VT_LEARN_SUB_BITS);
+}
+
+/*!
+ * @brief  This API will get a quantile of the intervals of an Id, clamped to the exact minimum and maximum.
+ * @param [in]   *entry - pointer to vt_learn_id_t structure.
+ * @param [in]   q - is quantile in [0, 1].
+ * @return       microseconds.
+ */
+static uint32_t _vt_learn_quantile(const vt_learn_id_t *entry, double q)
+{
+	uint64_t rank, seen = 0, us;
+	uint32_t i;
+
+	if(entry->intervals == 0)
+		return 0;
+	if(q <= 0.0)
+		return entry->min_us;
+	if(q >= 1.0)
+		return entry->max_us;
+
+	rank = (uint64_t)(q * (double)(entry->intervals - 1U));
+	for(i = 0; i < VT_LEARN_BUCKETS; i++)
+	{
+		seen += entry->buckets[i];
+		if(seen > rank)
+			break;
+	}
+	if(i >= VT_LEARN_BUCKETS)
+		return entry->max_us;
+
+	/* Middle of the bucket */
+	us = (_vt_learn_bucket_us(i) + ((i + 1U < VT_LEARN_BUCKETS) ? _vt_learn_bucket_us(i + 1U) : 0xFFFFFFFFULL)) / 2U;
+	if(us < entry->min_us)
+		us = entry->min_us;
+	if(us > entry->max_us)
+		us = entry->max_us;
+	return (uint32_t)us;
+}
+
+/*!
+ * @brief  This API will find the entry of an Id, added when seen first.
+ * @param [in]   id - is CAN Id.
+ * @return       pointer to vt_learn_id_t structure, or NULL when the table is full.
+ */
+static vt_learn_id_t *_vt_learn_id(uint32_t id)
+{
+	uint32_t slot = _vt_learn_hash(id, 0) & (VT_LEARN_MAX_IDS * 2U - 1U);
+	vt_learn_id_t *entry;
+
+	while(learn_id_slots[slot] != 0)
+	{
+		entry = &learn_ids[learn_id_slots[slot] - 1U];
+		if(entry->id == id)
+			return entry;
+		slot = (slot + 1U) & (VT_LEARN_MAX_IDS * 2U - 1U);
+	}
+	if(learn_id_count >= VT_LEARN_MAX_IDS)
+	{
+		learn_id_lost++;
+		return NULL;
+	}
+
+	entry = &learn_ids[learn_id_count];
+	memset(entry, 0, sizeof(vt_learn_id_t));
+	entry->id = id;
+	entry->order = learn_id_count;
+	entry->min_us = 0xFFFFFFFFUL;
+	entry->window_min = 0xFFFFFFFFUL;
+	learn_id_slots[slot] = (uint16_t)(++learn_id_count);
+	return entry;
+}
+
+/*!
+ * @brief  This API will count a transition between two consecutive Ids.
+ * @param [in]   from - is CAN Id of the previous frame.
+ * @param [in]   to - is CAN Id of the frame.
+ * @return       none.
+ */
+static void _vt_learn_pair(uint32_t from, uint32_t to)
+{
+	uint32_t slot = _vt_learn_hash(from, to) & (VT_LEARN_MAX_PAIRS * 2U - 1U);
+	vt_learn_pair_t *pair;
+
+	while(learn_pair_slots[slot] != 0)
+	{
+		pair = &learn_pairs[learn_pair_slots[slot] - 1U];
+		if(pair->from == from && pair->to == to)
+		{
+			pair->count++;
+			return;
+		}
+		slot = (slot + 1U) & (VT_LEARN_MAX_PAIRS * 2U - 1U);
+	}
+	if(learn_pair_count >= VT_LEARN_MAX_PAIRS)
+	{
+		learn_pair_lost++;
+		return;
+	}
+
+	pair = &learn_pairs[learn_pair_count];
+	pair->from = from;
+	pair->to = to;
+	pair->count = 1;
+	learn_pair_slots[slot] = ++learn_pair_count;
+}
+
+/*!
+ * @brief  This API will close windows: the frames of every Id in the window go to its minimum and maximum.
+ * @param [in]   count - is windows to close, the ones after the first are empty.
+ * @return       none.
+ */
+static void _vt_learn_close_windows(uint64_t count)
+{
+	vt_learn_id_t *entry;
+	uint32_t i;
+
+	for(i = 0; i < learn_id_count; i++)
+	{
+		entry = &learn_ids[i];
+		if(entry->window_frames == 0)
+			continue;
+		if(entry->window_frames < entry->window_min)
+			entry->window_min = entry->window_frames;
+		if(entry->window_frames > entry->window_max)
+			entry->window_max = entry->window_frames;
+		entry->windows++;
+		entry->window_frames = 0;
+	}
+	learn_windows += (uint32_t)count;
+}
+
+/*!
+ * @brief  This API will learn the traffic of a trace. Windows start at its first frame, the last incomplete one is
+ *         dropped.
+ * @param [in]   *trace - pointer to vt_trace_t structure.
+ * @param [in]   index - is trace, from 1.
+ * @param [in]   *channel - pointer to channel name to learn, NULL for every channel.
+ * @return       VT_STATUS_SUCCESS at the end of the trace, or VT_STATUS_IO.
+ */
+static vt_status_t _vt_learn_trace(vt_trace_t *trace, uint32_t index, const char *channel)
+{
+	vt_trace_record_t record;
+	vt_learn_id_t *entry;
+	vt_status_t status;
+	uint64_t window_end = 0, interval;
+	uint32_t prev = 0, i;
+	uint8_t first = 1;
+
+	while((status = vt_trace_next(trace, &record)) == VT_STATUS_SUCCESS)
+	{
+		if(channel != NULL && strcmp(record.channel, channel) != 0)
+			continue;
+
+		if(first)
+			window_end = record.time_us + VT_LEARN_WINDOW_US;
+		else if(record.time_us >= window_end)
+		{
+			/* Windows without frames in a gap count as empty */
+			interval = (record.time_us - window_end) / VT_LEARN_WINDOW_US + 1U;
+			_vt_learn_close_windows(interval);
+			window_end += interval * VT_LEARN_WINDOW_US;
+		}
+		learn_frames++;
+
+		entry = _vt_learn_id(record.frame.msgId);
+		if(entry != NULL)
+		{
+			entry->frames++;
+			entry->window_frames++;
+			/* Time going backwards, e.g. between merged logs, gives no interval */
+			if(entry->trace == index && record.time_us >= entry->last_us)
+			{
+				interval = record.time_us - entry->last_us;
+				if(interval > 0xFFFFFFFFULL)
+					interval = 0xFFFFFFFFULL;
+				if((uint32_t)interval < entry->min_us)
+					entry->min_us = (uint32_t)interval;
+				if((uint32_t)interval > entry->max_us)
+					entry->max_us = (uint32_t)interval;
+				entry->buckets[_vt_learn_bucket((uint32_t)interval)]++;
+				entry->intervals++;
+			}
+			entry->trace = index;
+			entry->last_us = record.time_us;
+		}
+
+		if(!first)
+			_vt_learn_pair(prev, record.frame.msgId);
+		prev = record.frame.msgId;
+		first = 0;
+	}
+
+	for(i = 0; i < learn_id_count; i++)
+		learn_ids[i].window_frames = 0;
+
+	return (status == VT_STATUS_EMPTY) ? VT_STATUS_SUCCESS : status;
+}
+
+static int _vt_learn_cmp_id(const void *a, const void *b)
+{
+	const vt_learn_id_t *x = *(const vt_learn_id_t * const *)a;
+	const vt_learn_id_t *y = *(const vt_learn_id_t * const *)b;
+
+	return (x->id > y->id) - (x->id < y->id);
+}
+
+static int _vt_learn_cmp_frames(const void *a, const void *b)
+{
+	const vt_learn_id_t *x = *(const vt_learn_id_t * const *)a;
+	const vt_learn_id_t *y = *(const vt_learn_id_t * const *)b;
+
+	if(x->frames != y->frames)
+		return (x->frames < y->frames) ? 1 : -1;
+	return (x->order > y->order) - (x->order < y->order);
+}
+
+static int _vt_learn_cmp_order(const void *a, const void *b)
+{
+	const vt_learn_id_t *x = *(const vt_learn_id_t * const *)a;
+	const vt_learn_id_t *y = *(const vt_learn_id_t * const *)b;
+
+	return (x->order > y->order) - (x->order < y->order);
+}
+
+static void _vt_learn_put(vt_learn_buff_t *buff, uint32_t value, uint32_t bytes)
+{
+	if(buff->len + bytes > buff->size)
+	{
+		buff->size = (buff->size == 0) ? 4096U : (buff->size * 2U);
+		buff->data = (uint8_t *)realloc(buff->data, buff->size);
+		if(buff->data == NULL)
+		{
+			fprintf(stderr, "vt_learn: out of memory\n");
+			exit(1);
+		}
+	}
+	while(bytes-- > 0)
+		buff->data[buff->len++] = (uint8_t)(value >> (8U * bytes));
+}
+
+static uint32_t _vt_learn_get(const uint8_t *data, uint32_t bytes)
+{
+	uint32_t value = 0;
+
+	while(bytes-- > 0)
+		value = (value << 8) | *data++;
+	return value;
+}
+
+/*!
+ * @brief  This API will find the category record of an Id in a base policy.
+ * @param [in]   *policy - pointer to policy.
+ * @param [in]   id - is CAN Id.
+ * @param [out]  *len - pointer to length of the record.
+ * @return       pointer to record, or NULL when the Id has none.
+ */
+static const uint8_t *_vt_learn_base_category(const uint8_t *policy, uint32_t id, uint32_t *len)
+{
+	uint32_t total = _vt_learn_get(policy, 4);
+	uint32_t pos, count, start, i, k;
+
+	pos = 12U + _vt_learn_get(policy + 8, 4) * 31U;
+	count = _vt_learn_get(policy + pos, 4);
+	pos += 4U;
+	for(i = 0; i < count; i++)
+	{
+		start = pos;
+		pos += 9U;
+		for(k = 0; k < VT_LEARN_CATEGORIES && pos + 2U <= total; k++)
+			pos += 2U + _vt_learn_get(policy + pos, 2) * 4U;
+		pos += 2U;
+		if(pos > total)
+			break;
+		if(_vt_learn_get(policy + start, 4) == id)
+		{
+			*len = pos - start;
+			return policy + start;
+		}
+	}
+	return NULL;
+}
+
+/*!
+ * @brief  This API will build the policy.
+ * @param [out]  *buff - pointer to vt_learn_buff_t structure.
+ * @param [in]   **ids - pointer to Ids with a timing record, by Id.
+ * @param [in]   count - is Ids.
+ * @param [in]   *base - pointer to base policy, for the category records.
+ * @param [in]   tick_us - is microseconds per slot tick.
+ * @param [in]   q - is quantile of the interval bounds.
+ * @param [in]   tolerance - is tolerance of the timing records.
+ * @return       none.
+ */
+static void _vt_learn_policy(vt_learn_buff_t *buff, vt_learn_id_t **ids, uint32_t count, const uint8_t *base,
+                             uint32_t tick_us, double q, float tolerance)
+{
+	const uint8_t *category;
+	vt_learn_id_t *entry;
+	uint32_t i, k, len, lo, hi, p10, p50, p90, tol_bits;
+
+	memcpy(&tol_bits, &tolerance, sizeof(tol_bits));
+
+	_vt_learn_put(buff, 0, 4);
+	_vt_learn_put(buff, VT_LEARN_POLICY_VERSION, 4);
+	_vt_learn_put(buff, count, 4);
+	for(i = 0; i < count; i++)
+	{
+		entry = ids[i];
+		lo = _vt_learn_quantile(entry, q) / tick_us;
+		hi = (_vt_learn_quantile(entry, 1.0 - q) + tick_us - 1U) / tick_us;
+		p10 = _vt_learn_quantile(entry, 0.1);
+		p50 = _vt_learn_quantile(entry, 0.5);
+		p90 = _vt_learn_quantile(entry, 0.9);
+
+		_vt_learn_put(buff, VT_LEARN_RULE_BASE + entry->id, 4);
+		_vt_learn_put(buff, entry->id, 4);
+		_vt_learn_put(buff, 0, 4);
+		_vt_learn_put(buff, (lo > 0xFFFFU) ? 0xFFFFU : lo, 2);
+		_vt_learn_put(buff, hi, 4);
+		_vt_learn_put(buff, tol_bits, 4);
+		_vt_learn_put(buff, ((double)(p90 - p10) <= (1.0 - (double)tolerance) * (double)p50) ? 1U : 0U, 4);
+		_vt_learn_put(buff, (entry->window_min > 0xFFU) ? 0xFFU : entry->window_min, 1);
+		_vt_learn_put(buff, entry->window_max, 4);
+	}
+
+	_vt_learn_put(buff, count, 4);
+	for(i = 0; i < count; i++)
+	{
+		category = _vt_learn_base_category(base, ids[i]->id, &len);
+		if(category != NULL)
+		{
+			for(k = 0; k < len; k++)
+				_vt_learn_put(buff, category[k], 1);
+			continue;
+		}
+		_vt_learn_put(buff, ids[i]->id, 4);
+		_vt_learn_put(buff, ids[i]->id, 4);
+		_vt_learn_put(buff, 0, 1);
+		for(k = 0; k < VT_LEARN_CATEGORIES; k++)
+			_vt_learn_put(buff, 0, 2);
+		_vt_learn_put(buff, VT_LEARN_CATEGORY_END, 2);
+	}
+	_vt_learn_put(buff, 1, 4);
+
+	buff->data[0] = (uint8_t)(buff->len >> 24);
+	buff->data[1] = (uint8_t)(buff->len >> 16);
+	buff->data[2] = (uint8_t)(buff->len >> 8);
+	buff->data[3] = (uint8_t)buff->len;
+}
+
+/*!
+ * @brief  This API will build the vector.
+ * @param [out]  *buff - pointer to vt_learn_buff_t structure.
+ * @param [in]   **ids - pointer to Ids of the vector, first seen first.
+ * @param [in]   count - is Ids.
+ * @param [in]   *base - pointer to base vector, for the fields that do not follow from traffic.
+ * @param [in]   min_pairs - is transitions seen at least this often.
+ * @return       transitions.
+ */
+static uint32_t _vt_learn_vector(vt_learn_buff_t *buff, vt_learn_id_t **ids, uint32_t count, const uint8_t *base,
+                                 uint32_t min_pairs)
+{
+	const uint8_t *fields = base + 6U + _vt_learn_get(base + 4, 2) * 4U;
+	uint32_t i, k, pairs = 0, pairs_pos;
+	uint8_t from, to;
+
+	_vt_learn_put(buff, 0, 4);
+	_vt_learn_put(buff, count, 2);
+	for(i = 0; i < count; i++)
+		_vt_learn_put(buff, ids[i]->id, 4);
+	for(k = 0; k < 3U; k++)
+		_vt_learn_put(buff, _vt_learn_get(fields + 2U * k, 2), 2);
+	pairs_pos = buff->len;
+	_vt_learn_put(buff, 0, 2);
+
+	for(i = 0; i < learn_pair_count; i++)
+	{
+		if(learn_pairs[i].count < min_pairs || pairs >= 0xFFFFU)
+			continue;
+		from = to = 0;
+		for(k = 0; k < count; k++)
+		{
+			from |= (ids[k]->id == learn_pairs[i].from);
+			to |= (ids[k]->id == learn_pairs[i].to);
+		}
+		if(!from || !to)
+			continue;
+		_vt_learn_put(buff, learn_pairs[i].from, 4);
+		_vt_learn_put(buff, learn_pairs[i].to, 4);
+		pairs++;
+	}
+	_vt_learn_put(buff, _vt_learn_get(fields + 8U + _vt_learn_get(fields + 6, 2) * 8U, 4), 4);
+
+	buff->data[pairs_pos] = (uint8_t)(pairs >> 8);
+	buff->data[pairs_pos + 1U] = (uint8_t)pairs;
+	buff->data[0] = (uint8_t)(buff->len >> 24);
+	buff->data[1] = (uint8_t)(buff->len >> 16);
+	buff->data[2] = (uint8_t)(buff->len >> 8);
+	buff->data[3] = (uint8_t)buff->len;
+	return pairs;
+}
+
+/*!
+ * @brief  This API will write data as car_policy_data.c or car_vector_data.c, byte for byte as the shipped ones.
+ * @param [in]   *dir - pointer to directory.
+ * @param [in]   *name - pointer to "policy" or "vector".
+ * @param [in]   *buff - pointer to vt_learn_buff_t structure.
+ * @param [in]   binary - is 1 to also write car_<name>.bin.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_IO.
+ */
+static vt_status_t _vt_learn_write(const char *dir, const char *name, const vt_learn_buff_t *buff, uint8_t binary)
+{
+	char path[VT_LEARN_PATH_LEN];
+	uint8_t vector = (strcmp(name, "vector") == 0);
+	FILE *out;
+	uint32_t i, fields;
+	int ok;
+
+	snprintf(path, sizeof(path), "%s/car_%s_data.c", dir, name);
+	out = fopen(path, "wb");
+	if(out == NULL)
+	{
+		perror(path);
+		return VT_STATUS_IO;
+	}
+	fprintf(out, "/*\r* Generate %s C file\r*/\r\r#include <stdint.h>\r\rconst uint8_t car_%s[] = {%s",
+	        vector ? "Vector" : "Rule", name, vector ? "\r" : "");
+	/* The vector puts wider gaps after the u16 fields before the transitions */
+	fields = vector ? (6U + (uint32_t)_vt_learn_get(buff->data + 4, 2) * 4U) : 0U;
+	for(i = 0; i < buff->len; i++)
+	{
+		fprintf(out, "0x%02x", buff->data[i]);
+		if(i + 1U == buff->len)
+			fputs(vector ? " " : "", out);
+		else if(!vector)
+			fputc(',', out);
+		else if(i >= fields && i < fields + 8U && ((i - fields) & 1U) != 0)
+			fputs(",     ", out);
+		else
+			fputs(", ", out);
+	}
+	fputs("};\r", out);
+	ok = (fclose(out) == 0);
+
+	if(ok && binary)
+	{
+		snprintf(path, sizeof(path), "%s/car_%s.bin", dir, name);
+		out = fopen(path, "wb");
+		ok = (out != NULL && fwrite(buff->data, 1, buff->len, out) == buff->len);
+		if(out != NULL)
+			ok = (fclose(out) == 0) && ok;
+	}
+	if(!ok)
+	{
+		perror(path);
+		return VT_STATUS_IO;
+	}
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will read a base policy or vector, and check its length.
+ * @param [in]   *path - pointer to file name.
+ * @return       pointer to content to free(), or NULL with an error printed.
+ */
+static uint8_t *_vt_learn_load(const char *path)
+{
+	FILE *in;
+	uint8_t *buff = NULL;
+	long size;
+
+	in = fopen(path, "rb");
+	if(in == NULL)
+	{
+		perror(path);
+		return NULL;
+	}
+	if(fseek(in, 0, SEEK_END) == 0 && (size = ftell(in)) >= 4 && fseek(in, 0, SEEK_SET) == 0)
+	{
+		buff = (uint8_t *)malloc((size_t)size);
+		if(buff != NULL && (fread(buff, 1, (size_t)size, in) != (size_t)size || _vt_learn_get(buff, 4) != (uint32_t)size))
+		{
+			free(buff);
+			buff = NULL;
+		}
+	}
+	fclose(in);
+	if(buff == NULL)
+		fprintf(stderr, "%s: cannot read, or not a policy or vector\n", path);
+	return buff;
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+int main(int argc, char *argv[])
+{
+	vt_trace_t trace;
+	vt_status_t status;
+	vt_learn_buff_t policy = {NULL, 0, 0};
+	vt_learn_buff_t vector = {NULL, 0, 0};
+	vt_learn_id_t **sorted;
+	vt_learn_id_t *entry;
+	const uint8_t *base_policy = car_policy;
+	const uint8_t *base_vector = car_vector;
+	uint8_t *policy_file = NULL;
+	uint8_t *vector_file = NULL;
+	const char *dir = ".";
+	const char *channel = NULL;
+	uint32_t tick_us = 200U;
+	uint32_t min_pairs = 1;
+	uint32_t traces = 0, rules = 0, ids, pairs, i;
+	float tolerance = VT_LEARN_TOLERANCE;
+	double q = 0.0;
+	uint8_t binary = 0;
+	int ret = 0;
+
+	for(i = 1; i < (uint32_t)argc; i++)
+	{
+		if(strcmp(argv[i], "-o") == 0 && (i + 1U) < (uint32_t)argc)
+			dir = argv[++i];
+		else if(strcmp(argv[i], "-t") == 0 && (i + 1U) < (uint32_t)argc)
+			tick_us = (uint32_t)atoi(argv[++i]);
+		else if(strcmp(argv[i], "-c") == 0 && (i + 1U) < (uint32_t)argc)
+			channel = argv[++i];
+		else if(strcmp(argv[i], "-q") == 0 && (i + 1U) < (uint32_t)argc)
+			q = atof(argv[++i]);
+		else if(strcmp(argv[i], "-f") == 0 && (i + 1U) < (uint32_t)argc)
+			tolerance = (float)atof(argv[++i]);
+		else if(strcmp(argv[i], "-m") == 0 && (i + 1U) < (uint32_t)argc)
+			min_pairs = (uint32_t)atoi(argv[++i]);
+		else if(strcmp(argv[i], "-P") == 0 && (i + 1U) < (uint32_t)argc)
+			base_policy = policy_file = _vt_learn_load(argv[++i]);
+		else if(strcmp(argv[i], "-V") == 0 && (i + 1U) < (uint32_t)argc)
+			base_vector = vector_file = _vt_learn_load(argv[++i]);
+		else if(strcmp(argv[i], "-B") == 0)
+			binary = 1;
+		else if(argv[i][0] == '-' && argv[i][1] != '\0')
+			break;
+		else
+			traces++;
+	}
+	if(i < (uint32_t)argc || traces == 0 || tick_us == 0 || q < 0.0 || q >= 0.5)
+	{
+		fprintf(stderr, "usage: %s [-o dir] [-t us_per_tick] [-c channel] [-q quantile] [-f tolerance] [-m min_pairs] "
+		        "[-P base_policy.bin] [-V base_vector.bin] [-B] trace...\n", argv[0]);
+		return 1;
+	}
+	if(base_policy == NULL || base_vector == NULL)
+		return 1;
+
+	learn_ids = (vt_learn_id_t *)malloc(VT_LEARN_MAX_IDS * sizeof(vt_learn_id_t));
+	learn_pairs = (vt_learn_pair_t *)malloc(VT_LEARN_MAX_PAIRS * sizeof(vt_learn_pair_t));
+	sorted = (vt_learn_id_t **)malloc(VT_LEARN_MAX_IDS * sizeof(vt_learn_id_t *));
+	if(learn_ids == NULL || learn_pairs == NULL || sorted == NULL)
+	{
+		fprintf(stderr, "vt_learn: out of memory\n");
+		return 1;
+	}
+
+	/* One pass over every trace, in order */
+	traces = 0;
+	for(i = 1; i < (uint32_t)argc; i++)
+	{
+		if(argv[i][0] == '-' && argv[i][1] != '\0')
+		{
+			if(strcmp(argv[i], "-B") != 0)
+				i++;
+			continue;
+		}
+		status = vt_trace_open(&trace, argv[i]);
+		if(status != VT_STATUS_SUCCESS)
+		{
+			fprintf(stderr, "%s: cannot open (%d)\n", argv[i], (int)status);
+			ret = 1;
+			continue;
+		}
+		status = _vt_learn_trace(&trace, ++traces, channel);
+		if(status != VT_STATUS_SUCCESS)
+		{
+			fprintf(stderr, "%s: read error after line %lu\n", argv[i], (unsigned long)trace.lines);
+			ret = 1;
+		}
+		fprintf(stderr, "%s: lines %lu frames %lu skipped %lu errors %lu\n", argv[i], (unsigned long)trace.lines,
+		        (unsigned long)trace.frames, (unsigned long)trace.skipped, (unsigned long)trace.errors);
+		vt_trace_close(&trace);
+	}
+	if(learn_windows == 0)
+	{
+		fprintf(stderr, "vt_learn: %llu frames, no complete window of %llu s\n", (unsigned long long)learn_frames,
+		        VT_LEARN_WINDOW_US / 1000000ULL);
+		return 1;
+	}
+
+	/* Timing records: Ids seen in every window, by Id */
+	for(i = 0; i < learn_id_count; i++)
+	{
+		entry = &learn_ids[i];
+		if(entry->windows == learn_windows && entry->intervals > 0)
+			sorted[rules++] = entry;
+	}
+	qsort(sorted, rules, sizeof(vt_learn_id_t *), _vt_learn_cmp_id);
+	_vt_learn_policy(&policy, sorted, rules, base_policy, tick_us, q, tolerance);
+
+	fprintf(stderr, "%-10s %10s %10s %10s %10s %8s %8s %6s %6s %s\n", "id", "frames", "period_ms", "p10_ms", "p90_ms",
+	        "min_tck", "max_tck", "w_min", "w_max", "periodic");
+	for(i = 0; i < rules; i++)
+	{
+		entry = sorted[i];
+		fprintf(stderr, "0x%-8lx %10llu %10.3f %10.3f %10.3f %8lu %8lu %6lu %6lu %u\n", (unsigned long)entry->id,
+		        (unsigned long long)entry->frames, _vt_learn_quantile(entry, 0.5) / 1000.0,
+		        _vt_learn_quantile(entry, 0.1) / 1000.0, _vt_learn_quantile(entry, 0.9) / 1000.0,
+		        (unsigned long)_vt_learn_get(policy.data + 12U + i * 31U + 12U, 2),
+		        (unsigned long)_vt_learn_get(policy.data + 12U + i * 31U + 14U, 4),
+		        (unsigned long)entry->window_min, (unsigned long)entry->window_max,
+		        (unsigned)policy.data[12U + i * 31U + 25U]);
+	}
+
+	/* Vector: the most frequent Ids, first seen first */
+	for(i = 0; i < learn_id_count; i++)
+		sorted[i] = &learn_ids[i];
+	qsort(sorted, learn_id_count, sizeof(vt_learn_id_t *), _vt_learn_cmp_frames);
+	ids = (learn_id_count < VT_LEARN_VECTOR_IDS) ? learn_id_count : VT_LEARN_VECTOR_IDS;
+	qsort(sorted, ids, sizeof(vt_learn_id_t *), _vt_learn_cmp_order);
+	pairs = _vt_learn_vector(&vector, sorted, ids, base_vector, min_pairs);
+
+	if(_vt_learn_write(dir, "policy", &policy, binary) != VT_STATUS_SUCCESS ||
+	   _vt_learn_write(dir, "vector", &vector, binary) != VT_STATUS_SUCCESS)
+		ret = 1;
+
+	fprintf(stderr, "learn: %u traces %llu frames %lu windows, %lu ids (%llu frames of lost ids), %lu pairs (%llu lost)\n",
+	        traces, (unsigned long long)learn_frames, (unsigned long)learn_windows, (unsigned long)learn_id_count,
+	        (unsigned long long)learn_id_lost, (unsigned long)learn_pair_count, (unsigned long long)learn_pair_lost);
+	fprintf(stderr, "learn: policy %lu rules %lu bytes, vector %lu ids %lu pairs %lu bytes\n", (unsigned long)rules,
+	        (unsigned long)policy.len, (unsigned long)ids, (unsigned long)pairs, (unsigned long)vector.len);
+
+	free(policy.data);
+	free(vector.data);
+	free(sorted);
+	free(learn_pairs);
+	free(learn_ids);
+	free(policy_file);
+	free(vector_file);
+
+	return ret;
+}
@@ -0,0 +1,216 @@
+/*
+ * vt_replay.c
+ *
+ * Host tool: replay a recorded trace (candump log or Vector ASC, see vt_trace.h) through the firewall core as fast
+ * as possible.
+ *
+ *   vt_replay [-t us_per_tick] [-b frames_per_process] [-c channel] [-p policy.bin -v vector.bin] [-q] trace
+ *
+ * The core runs on the virtual clock of vt_trace_replay.h, vt_fw_process() runs after every -b frames (1 by default).
+ * Every detection is printed with the time of the virtual clock, and the byte offset and line of the last frame
+ * received before it.
+ * Frames per second and counters are printed to stderr at the end.
+ */
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include <time.h>
+#include "vt_fw_if.h"
+#include "vt_trace_replay.h"
+#include "vt_rate.h"
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef enum _vt_replay_event_t
+{
+	VT_REPLAY_TRAFFIC_STATUS = 0,
+	VT_REPLAY_VECTOR,
+	VT_REPLAY_BLACKLIST,
+	VT_REPLAY_MONITOR,
+	VT_REPLAY_EVENT_TYPES
+}vt_replay_event_t;
+
+/*------------------------------------------------------------------*
+ *                        Private Data Types                        *
+ *------------------------------------------------------------------*/
+static const char *event_names[VT_REPLAY_EVENT_TYPES] = {"traffic_status", "vector", "blacklist", "monitor"};
+
+static vt_trace_replay_t replay;
+static uint8_t replay_quiet;
+static uint32_t replay_events[VT_REPLAY_EVENT_TYPES];
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+static double _vt_replay_now_s(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000.0;
+}
+
+/*!
+ * @brief  This API will print the start of an event line with the position of the current frame.
+ * @param [in]   type - is vt_replay_event_t.
+ * @return       none.
+ */
+static void _vt_replay_event_head(vt_replay_event_t type)
+{
+	replay_events[type]++;
+	if(replay_quiet)
+		return;
+
+	/* Time of the virtual clock, position of the last frame received */
+	printf("%s t=%.6f offset=%llu line=%lu", event_names[type], (double)vt_trace_replay_time_us(&replay) / 1000000.0,
+	       (unsigned long long)replay.current.offset, (unsigned long)replay.current.line);
+}
+
+static void _vt_replay_traffic_status(vt_car_status_t car_status, float slot_rate, float pattern_rate, uint32_t count_id)
+{
+	/* Rates as the agent reports them */
+	vt_rate_t slot = vt_rate_from_float(slot_rate);
+	vt_rate_t pattern = vt_rate_from_float(pattern_rate);
+
+	_vt_replay_event_head(VT_REPLAY_TRAFFIC_STATUS);
+	if(!replay_quiet)
+		printf(" car_status=%d slot_rate=%lu.%04lu pattern_rate=%lu.%04lu count=%lu\n", (int)car_status,
+		       VT_RATE_WHOLE(slot), VT_RATE_FRAC(slot), VT_RATE_WHOLE(pattern), VT_RATE_FRAC(pattern),
+		       (unsigned long)count_id);
+}
+
+static vt_status_t _vt_replay_vector(vt_vector_result_t *vector_t)
+{
+	if(vector_t == NULL)
+		return VT_STATUS_NULL;
+
+	_vt_replay_event_head(VT_REPLAY_VECTOR);
+	if(!replay_quiet)
+		printf(" matched_flag=%u matched_rate=%lu.%04lu in_rl=%lu in_rt=%lu all=%lu\n", vector_t->matched_flag,
+		       VT_RATE_WHOLE(vt_rate_from_float(vector_t->matched_rate)),
+		       VT_RATE_FRAC(vt_rate_from_float(vector_t->matched_rate)), (unsigned long)vector_t->count_vector_in_rl,
+		       (unsigned long)vector_t->count_vector_in_rt, (unsigned long)vector_t->count_all_vector);
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will print a blacklist or monitor detection.
+ * @param [in]   type - is VT_REPLAY_BLACKLIST or VT_REPLAY_MONITOR.
+ * @param [in]   *detail_result - pointer to vt_fw_detail_result_t structure.
+ * @return       status.
+ */
+static vt_status_t _vt_replay_detail(vt_replay_event_t type, vt_fw_detail_result_t *detail_result)
+{
+	int len;
+
+	if(detail_result == NULL)
+		return VT_STATUS_NULL;
+	if(detail_result->matched_type == VT_UNMATCHED_BIT)
+		return VT_STATUS_SUCCESS;
+
+	_vt_replay_event_head(type);
+	if(replay_quiet)
+		return VT_STATUS_SUCCESS;
+
+	len = (int)strnlen(detail_result->detail, sizeof(detail_result->detail));
+	while(len > 0 && (detail_result->detail[len - 1] == '\n' || detail_result->detail[len - 1] == '\r'))
+		len--;
+	printf(" matched_type=%u %.*s\n", detail_result->matched_type, len, detail_result->detail);
+	return VT_STATUS_SUCCESS;
+}
+
+static vt_status_t _vt_replay_blacklist(vt_fw_detail_result_t *detail_result)
+{
+	return _vt_replay_detail(VT_REPLAY_BLACKLIST, detail_result);
+}
+
+static vt_status_t _vt_replay_monitor(vt_fw_detail_result_t *detail_result)
+{
+	return _vt_replay_detail(VT_REPLAY_MONITOR, detail_result);
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+int main(int argc, char *argv[])
+{
+	vt_trace_t trace;
+	vt_status_t status;
+	const uint8_t *policy = car_policy;
+	const uint8_t *vector = car_vector;
+	uint8_t *policy_file = NULL;
+	uint8_t *vector_file = NULL;
+	const char *path = NULL;
+	const char *channel = NULL;
+	uint32_t tick_us = VT_TRACE_REPLAY_TICK_US;
+	uint32_t batch = 1;
+	double t0, elapsed, trace_s;
+	int i;
+
+	for(i = 1; i < argc; i++)
+	{
+		if(strcmp(argv[i], "-t") == 0 && (i + 1) < argc)
+			tick_us = (uint32_t)atoi(argv[++i]);
+		else if(strcmp(argv[i], "-b") == 0 && (i + 1) < argc)
+			batch = (uint32_t)atoi(argv[++i]);
+		else if(strcmp(argv[i], "-c") == 0 && (i + 1) < argc)
+			channel = argv[++i];
+		else if(strcmp(argv[i], "-p") == 0 && (i + 1) < argc)
+			policy = policy_file = vt_trace_replay_load(argv[++i]);
+		else if(strcmp(argv[i], "-v") == 0 && (i + 1) < argc)
+			vector = vector_file = vt_trace_replay_load(argv[++i]);
+		else if(strcmp(argv[i], "-q") == 0)
+			replay_quiet = 1;
+		else if(argv[i][0] == '-' && argv[i][1] != '\0')
+			break;
+		else
+			path = argv[i];
+	}
+	if(i < argc || path == NULL || vt_trace_replay_init(&replay, tick_us, batch, channel) != VT_STATUS_SUCCESS)
+	{
+		fprintf(stderr, "usage: %s [-t us_per_tick] [-b frames_per_process] [-c channel] "
+		        "[-p policy.bin -v vector.bin] [-q] trace|-\n", argv[0]);
+		return 1;
+	}
+	if(policy == NULL || vector == NULL)
+		return 1;
+
+	status = vt_trace_open(&trace, path);
+	if(status != VT_STATUS_SUCCESS)
+	{
+		fprintf(stderr, "%s: cannot open (%d)\n", path, (int)status);
+		return 1;
+	}
+
+	vt_fw_init(policy, vector);
+	vt_fw_set_slot_time_unit((uint16_t)tick_us);
+	vt_fw_install_vector_callback(_vt_replay_vector);
+	vt_fw_install_traffic_status_callback(_vt_replay_traffic_status);
+	vt_fw_install_blacklist_callback(_vt_replay_blacklist);
+	vt_fw_install_monitor_callback(_vt_replay_monitor);
+
+	t0 = _vt_replay_now_s();
+	status = vt_trace_replay_run(&replay, &trace);
+	elapsed = _vt_replay_now_s() - t0;
+	trace_s = (double)vt_trace_replay_time_us(&replay) / 1000000.0;
+
+	if(status != VT_STATUS_SUCCESS)
+		fprintf(stderr, "%s: read error after line %lu\n", path, (unsigned long)trace.lines);
+	fflush(stdout);
+	fprintf(stderr, "replay: %llu frames in %.3f s, %.0f frames/s, trace %.3f s, %.1fx real time\n",
+	        (unsigned long long)replay.frames, elapsed, (elapsed > 0.0) ? ((double)replay.frames / elapsed) : 0.0, trace_s,
+	        (elapsed > 0.0) ? (trace_s / elapsed) : 0.0);
+	fprintf(stderr, "replay: lines %lu skipped %lu errors %lu, events traffic_status %lu vector %lu blacklist %lu monitor %lu\n",
+	        (unsigned long)trace.lines, (unsigned long)trace.skipped, (unsigned long)trace.errors,
+	        (unsigned long)replay_events[VT_REPLAY_TRAFFIC_STATUS], (unsigned long)replay_events[VT_REPLAY_VECTOR],
+	        (unsigned long)replay_events[VT_REPLAY_BLACKLIST], (unsigned long)replay_events[VT_REPLAY_MONITOR]);
+
+	vt_fw_close();
+	vt_trace_close(&trace);
+	free(policy_file);
+	free(vector_file);
+
+	return (status == VT_STATUS_SUCCESS) ? 0 : 1;
+}
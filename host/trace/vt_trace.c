@@ -0,0 +1,517 @@
+/*
+ * vt_trace.c
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "vt_trace.h"
+
+/*------------------------------------------------------------------*
+ *                          Define Macro                            *
+ *------------------------------------------------------------------*/
+#define VT_TRACE_STD_ID_MAX     0x7FFUL
+#define VT_TRACE_EXT_ID_MAX     0x1FFFFFFFUL
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief Result of the parsers of a line.
+ */
+typedef enum _vt_trace_parse_t
+{
+	VT_TRACE_FRAME = 0,                         /*!< record is filled */
+	VT_TRACE_SKIP,                              /*!< not a classic data frame */
+	VT_TRACE_ERROR                              /*!< malformed frame */
+}vt_trace_parse_t;
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will get the next token of a line.
+ * @param [in]   *p - pointer to current position.
+ * @param [in]   *end - pointer to end of line.
+ * @param [out]  **tok - pointer to token.
+ * @param [out]  *len - length of token, 0 at the end of the line.
+ * @return       position after the token.
+ */
+static const char *_vt_trace_token(const char *p, const char *end, const char **tok, uint32_t *len)
+{
+	while(p < end && (*p == ' ' || *p == '\t'))
+		p++;
+	*tok = p;
+	while(p < end && *p != ' ' && *p != '\t')
+		p++;
+	*len = (uint32_t)(p - *tok);
+	return p;
+}
+
+/*!
+ * @brief  This API will compare a token with a keyword.
+ * @param [in]   *tok - pointer to token.
+ * @param [in]   len - length of token.
+ * @param [in]   *keyword - pointer to keyword.
+ * @return       1 if equal, 0 otherwise.
+ */
+static int _vt_trace_is(const char *tok, uint32_t len, const char *keyword)
+{
+	return (strlen(keyword) == len) && (memcmp(tok, keyword, len) == 0);
+}
+
+/*!
+ * @brief  This API will get the value of a hexadecimal digit.
+ * @param [in]   c - is character.
+ * @return       value, or -1 if c is not a hexadecimal digit.
+ */
+static int _vt_trace_hex_digit(char c)
+{
+	if(c >= '0' && c <= '9')
+		return c - '0';
+	if(c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if(c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
+
+/*!
+ * @brief  This API will parse an unsigned number.
+ * @param [in]   *tok - pointer to token.
+ * @param [in]   len - length of token, at most 8 digits.
+ * @param [in]   radix - is 10 or 16.
+ * @param [out]  *value - pointer to value.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_INVALID.
+ */
+static vt_status_t _vt_trace_number(const char *tok, uint32_t len, uint32_t radix, uint32_t *value)
+{
+	uint32_t i;
+	int digit;
+
+	if(len == 0 || len > 8)
+		return VT_STATUS_INVALID;
+
+	*value = 0;
+	for(i = 0; i < len; i++)
+	{
+		digit = _vt_trace_hex_digit(tok[i]);
+		if(digit < 0 || (uint32_t)digit >= radix)
+			return VT_STATUS_INVALID;
+		*value = *value * radix + (uint32_t)digit;
+	}
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will parse a timestamp in seconds with up to 9 decimals, without going through a double.
+ * @param [in]   *tok - pointer to token.
+ * @param [in]   len - length of token.
+ * @param [out]  *us - pointer to microseconds.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_INVALID.
+ */
+static vt_status_t _vt_trace_time(const char *tok, uint32_t len, uint64_t *us)
+{
+	uint64_t seconds = 0;
+	uint64_t fraction = 0;
+	uint32_t i = 0;
+	uint32_t digits = 0;
+
+	while(i < len && tok[i] >= '0' && tok[i] <= '9')
+	{
+		seconds = seconds * 10U + (uint64_t)(tok[i] - '0');
+		i++;
+	}
+	if(i == 0 || i > 12)
+		return VT_STATUS_INVALID;
+
+	if(i < len && tok[i] == '.')
+	{
+		for(i++; i < len && tok[i] >= '0' && tok[i] <= '9'; i++)
+		{
+			/* Below a microsecond is dropped */
+			if(digits < 6)
+			{
+				fraction = fraction * 10U + (uint64_t)(tok[i] - '0');
+				digits++;
+			}
+		}
+	}
+	if(i != len)
+		return VT_STATUS_INVALID;
+
+	for(; digits < 6; digits++)
+	{
+		fraction *= 10U;
+	}
+	*us = seconds * 1000000U + fraction;
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will copy a channel name to a record.
+ * @param [out]  *record - pointer to vt_trace_record_t structure.
+ * @param [in]   *tok - pointer to name.
+ * @param [in]   len - length of name.
+ * @return       none.
+ */
+static void _vt_trace_channel(vt_trace_record_t *record, const char *tok, uint32_t len)
+{
+	if(len >= VT_TRACE_CHANNEL_LEN)
+		len = VT_TRACE_CHANNEL_LEN - 1U;
+	memcpy(record->channel, tok, len);
+	record->channel[len] = '\0';
+}
+
+/*!
+ * @brief  This API will parse a line of a candump log: (1436509052.249713) can0 123#11223344
+ * @param [in]   *p - pointer to line.
+ * @param [in]   *end - pointer to end of line.
+ * @param [out]  *record - pointer to vt_trace_record_t structure.
+ * @return       vt_trace_parse_t.
+ */
+static vt_trace_parse_t _vt_trace_parse_candump(const char *p, const char *end, vt_trace_record_t *record)
+{
+	const char *tok;
+	const char *hash;
+	uint32_t len, id;
+	int hi, lo;
+
+	/* Timestamp */
+	tok = ++p;
+	while(p < end && *p != ')')
+		p++;
+	if(p == end || _vt_trace_time(tok, (uint32_t)(p - tok), &record->time_us) != VT_STATUS_SUCCESS)
+		return VT_TRACE_ERROR;
+
+	/* Interface */
+	p = _vt_trace_token(p + 1, end, &tok, &len);
+	if(len == 0)
+		return VT_TRACE_ERROR;
+	_vt_trace_channel(record, tok, len);
+
+	/* Id#data */
+	_vt_trace_token(p, end, &tok, &len);
+	hash = memchr(tok, '#', len);
+	if(hash == NULL || _vt_trace_number(tok, (uint32_t)(hash - tok), 16, &id) != VT_STATUS_SUCCESS)
+		return VT_TRACE_ERROR;
+	/* Error frames carry the error class in an 8 digit Id with bit 29 set */
+	if(id > VT_TRACE_EXT_ID_MAX)
+		return VT_TRACE_SKIP;
+	record->frame.msgId = id;
+
+	p = hash + 1;
+	end = tok + len;
+	/* Remote frame, or CAN FD frame with ## */
+	if(p < end && (*p == 'R' || *p == 'r' || *p == '#'))
+		return VT_TRACE_SKIP;
+
+	record->frame.dataLen = 0;
+	while(p < end)
+	{
+		if(*p == '.')
+		{
+			p++;
+			continue;
+		}
+		if((end - p) < 2 || record->frame.dataLen >= VT_MAX_DATA_BYTE_LENGTH)
+			return VT_TRACE_ERROR;
+		hi = _vt_trace_hex_digit(p[0]);
+		lo = _vt_trace_hex_digit(p[1]);
+		if(hi < 0 || lo < 0)
+			return VT_TRACE_ERROR;
+		record->frame.data[record->frame.dataLen++] = (uint8_t)((hi << 4) | lo);
+		p += 2;
+	}
+
+	return VT_TRACE_FRAME;
+}
+
+/*!
+ * @brief  This API will parse a line of a Vector ASC file: 0.015991 1  123x  Rx   d 8 00 01 02 03 04 05 06 07
+ *         Header lines setting the number base and the timestamp mode are applied to the trace.
+ * @param [in]   *trace - pointer to vt_trace_t structure.
+ * @param [in]   *p - pointer to line.
+ * @param [in]   *end - pointer to end of line.
+ * @param [out]  *record - pointer to vt_trace_record_t structure.
+ * @return       vt_trace_parse_t.
+ */
+static vt_trace_parse_t _vt_trace_parse_asc(vt_trace_t *trace, const char *p, const char *end, vt_trace_record_t *record)
+{
+	const char *tok;
+	const char *channel;
+	uint32_t len, channel_len, id, dlc, byte, i;
+	uint64_t time_us;
+
+	p = _vt_trace_token(p, end, &tok, &len);
+	if(len == 0)
+		return VT_TRACE_SKIP;
+
+	if(_vt_trace_time(tok, len, &time_us) != VT_STATUS_SUCCESS)
+	{
+		/* base hex|dec  timestamps absolute|relative */
+		if(_vt_trace_is(tok, len, "base"))
+		{
+			p = _vt_trace_token(p, end, &tok, &len);
+			trace->asc_decimal = (uint8_t)_vt_trace_is(tok, len, "dec");
+			p = _vt_trace_token(p, end, &tok, &len);
+			p = _vt_trace_token(p, end, &tok, &len);
+			trace->asc_relative = (uint8_t)_vt_trace_is(tok, len, "relative");
+		}
+		return VT_TRACE_SKIP;
+	}
+
+	if(trace->asc_relative)
+		time_us += trace->last_us;
+	trace->last_us = time_us;
+	record->time_us = time_us;
+
+	/* Channel, events of other buses (CANFD, LIN...) have a name here */
+	p = _vt_trace_token(p, end, &channel, &channel_len);
+	if(_vt_trace_number(channel, channel_len, 10, &id) != VT_STATUS_SUCCESS)
+		return VT_TRACE_SKIP;
+	_vt_trace_channel(record, channel, channel_len);
+
+	/* Id, extended with a trailing x, or an event name (ErrorFrame, Statistic:...) */
+	p = _vt_trace_token(p, end, &tok, &len);
+	if(len > 1 && (tok[len - 1] == 'x' || tok[len - 1] == 'X'))
+		len--;
+	if(_vt_trace_number(tok, len, trace->asc_decimal ? 10 : 16, &id) != VT_STATUS_SUCCESS)
+		return VT_TRACE_SKIP;
+	if(id > VT_TRACE_EXT_ID_MAX)
+		return VT_TRACE_ERROR;
+	record->frame.msgId = id;
+
+	p = _vt_trace_token(p, end, &tok, &len);
+	if(!_vt_trace_is(tok, len, "Rx") && !_vt_trace_is(tok, len, "Tx"))
+		return VT_TRACE_SKIP;
+
+	p = _vt_trace_token(p, end, &tok, &len);
+	if(_vt_trace_is(tok, len, "r"))
+		return VT_TRACE_SKIP;
+	if(!_vt_trace_is(tok, len, "d"))
+		return VT_TRACE_ERROR;
+
+	p = _vt_trace_token(p, end, &tok, &len);
+	if(_vt_trace_number(tok, len, 16, &dlc) != VT_STATUS_SUCCESS || dlc > VT_MAX_DATA_BYTE_LENGTH)
+		return VT_TRACE_ERROR;
+
+	for(i = 0; i < dlc; i++)
+	{
+		p = _vt_trace_token(p, end, &tok, &len);
+		if(_vt_trace_number(tok, len, trace->asc_decimal ? 10 : 16, &byte) != VT_STATUS_SUCCESS || byte > 0xFFU)
+			return VT_TRACE_ERROR;
+		record->frame.data[i] = (uint8_t)byte;
+	}
+	record->frame.dataLen = (uint8_t)dlc;
+
+	return VT_TRACE_FRAME;
+}
+
+/*!
+ * @brief  This API will get the next line of a trace. A streamed trace is refilled when no full line is left in
+ *         the buffer.
+ * @param [in]   *trace - pointer to vt_trace_t structure.
+ * @param [out]  **line - pointer to line, without the line terminator.
+ * @param [out]  *len - length of line.
+ * @param [out]  *offset - trace offset of line.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_EMPTY or VT_STATUS_IO.
+ */
+static vt_status_t _vt_trace_line(vt_trace_t *trace, const char **line, uint32_t *len, uint64_t *offset)
+{
+	const char *start;
+	const char *nl;
+	uint64_t avail;
+	ssize_t n;
+
+	for(;;)
+	{
+		start = trace->data + trace->pos;
+		avail = trace->size - trace->pos;
+		nl = (avail > 0) ? (const char *)memchr(start, '\n', avail) : NULL;
+
+		/* A line longer than the buffer is returned in pieces, which do not parse */
+		if(nl == NULL && trace->eof == 0 && avail < VT_TRACE_STREAM_BUFF)
+		{
+			memmove(trace->buff, start, avail);
+			trace->base += trace->pos;
+			trace->pos = 0;
+			trace->size = avail;
+
+			n = read(trace->fd, trace->buff + avail, VT_TRACE_STREAM_BUFF - avail);
+			if(n < 0)
+			{
+				if(errno == EINTR)
+					continue;
+				return VT_STATUS_IO;
+			}
+			if(n == 0)
+				trace->eof = 1;
+			trace->size += (uint64_t)n;
+			continue;
+		}
+
+		if(avail == 0)
+			return VT_STATUS_EMPTY;
+
+		*line = start;
+		*offset = trace->base + trace->pos;
+		*len = (nl != NULL) ? (uint32_t)(nl - start) : (uint32_t)avail;
+		trace->pos += *len + ((nl != NULL) ? 1U : 0U);
+		if(*len > 0 && start[*len - 1] == '\r')
+			(*len)--;
+		trace->lines++;
+		return VT_STATUS_SUCCESS;
+	}
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will open a trace.
+ * @param [out]  *trace - pointer to vt_trace_t structure.
+ * @param [in]   *path - pointer to file name, "-" for stdin.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL, VT_STATUS_IO or VT_STATUS_NO_MEM.
+ */
+vt_status_t vt_trace_open(vt_trace_t *trace, const char *path)
+{
+	struct stat st;
+
+	if(trace == NULL || path == NULL)
+		return VT_STATUS_NULL;
+
+	memset(trace, 0, sizeof(vt_trace_t));
+	trace->fd = (strcmp(path, "-") == 0) ? STDIN_FILENO : open(path, O_RDONLY);
+	if(trace->fd < 0 || fstat(trace->fd, &st) != 0)
+	{
+		vt_trace_close(trace);
+		return VT_STATUS_IO;
+	}
+
+	if(S_ISREG(st.st_mode) && st.st_size > 0)
+	{
+		trace->map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, trace->fd, 0);
+		if(trace->map == MAP_FAILED)
+		{
+			trace->map = NULL;
+		}
+		else
+		{
+			madvise(trace->map, (size_t)st.st_size, MADV_SEQUENTIAL);
+			trace->data = (const char *)trace->map;
+			trace->size = (uint64_t)st.st_size;
+			trace->eof = 1;
+			return VT_STATUS_SUCCESS;
+		}
+	}
+
+	/* Pipes, and files that cannot be mapped */
+	trace->buff = (char *)malloc(VT_TRACE_STREAM_BUFF);
+	if(trace->buff == NULL)
+	{
+		vt_trace_close(trace);
+		return VT_STATUS_NO_MEM;
+	}
+	trace->data = trace->buff;
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will read the next CAN data frame of a trace.
+ * @param [in]   *trace - pointer to vt_trace_t structure.
+ * @param [out]  *record - pointer to vt_trace_record_t structure.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_EMPTY at the end of the trace, or VT_STATUS_IO.
+ */
+vt_status_t vt_trace_next(vt_trace_t *trace, vt_trace_record_t *record)
+{
+	const char *line;
+	const char *p;
+	const char *end;
+	uint32_t len;
+	uint64_t offset;
+	vt_status_t status;
+	vt_trace_parse_t parse;
+
+	for(;;)
+	{
+		status = _vt_trace_line(trace, &line, &len, &offset);
+		if(status != VT_STATUS_SUCCESS)
+			return status;
+
+		p = line;
+		end = line + len;
+		while(p < end && (*p == ' ' || *p == '\t'))
+			p++;
+
+		if(p == end || *p == '#' || (*p == '/' && (end - p) > 1 && p[1] == '/'))
+			parse = VT_TRACE_SKIP;
+		else if(*p == '(')
+			parse = _vt_trace_parse_candump(p, end, record);
+		else
+			parse = _vt_trace_parse_asc(trace, p, end, record);
+
+		if(parse == VT_TRACE_SKIP)
+		{
+			trace->skipped++;
+			continue;
+		}
+		if(parse == VT_TRACE_ERROR)
+		{
+			trace->errors++;
+			continue;
+		}
+
+		record->offset = offset;
+		record->line = trace->lines;
+		trace->frames++;
+		return VT_STATUS_SUCCESS;
+	}
+}
+
+/*!
+ * @brief  This API will get the size of a trace.
+ * @param [in]   *trace - pointer to vt_trace_t structure.
+ * @return       size in bytes, 0 when the trace is streamed.
+ */
+uint64_t vt_trace_size(const vt_trace_t *trace)
+{
+	return (trace->map != NULL) ? trace->size : 0U;
+}
+
+/*!
+ * @brief  This API will close a trace.
+ * @param [in]   *trace - pointer to vt_trace_t structure.
+ * @return       none.
+ */
+void vt_trace_close(vt_trace_t *trace)
+{
+	if(trace == NULL)
+		return;
+
+	if(trace->map != NULL)
+		munmap(trace->map, (size_t)trace->size);
+	free(trace->buff);
+	if(trace->fd > STDIN_FILENO)
+		close(trace->fd);
+
+	trace->map = NULL;
+	trace->buff = NULL;
+	trace->data = NULL;
+	trace->fd = -1;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,108 @@
+/*
+ * vt_trace.h
+ *
+ * Host tools: read recorded CAN traffic, candump log files (candump -l / -L) and Vector ASC files.
+ * Regular files are memory-mapped, pipes and stdin ("-") are streamed through a line buffer.
+ * The format is detected per line, so concatenated logs of both formats are read too.
+ */
+
+#ifndef VT_TRACE_H_
+#define VT_TRACE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_fw_if.h"
+
+/*------------------------------------------------------------------*
+ *                          Define macro                            *
+ *------------------------------------------------------------------*/
+/*! Size of the line buffer of a streamed trace, longer lines are skipped */
+#ifndef VT_TRACE_STREAM_BUFF
+#define VT_TRACE_STREAM_BUFF    (64U * 1024U)
+#endif
+
+/*! Size of the channel name of a record, longer names are truncated */
+#define VT_TRACE_CHANNEL_LEN    16U
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief Frame read from a trace.
+ */
+typedef struct _vt_trace_record_t
+{
+	uint64_t time_us;                           /*!< candump: since the epoch, ASC: since the start of measurement */
+	uint64_t offset;                            /*!< byte offset of the line in the trace */
+	uint32_t line;                              /*!< line number, from 1 */
+	char channel[VT_TRACE_CHANNEL_LEN];         /*!< candump: interface name, ASC: channel number */
+	vt_can_frame_t frame;                       /*!< msgId above 0x7FF is an extended Id */
+}vt_trace_record_t;
+
+/*!
+ * @brief Open trace. Members are private to vt_trace.c except the counters.
+ */
+typedef struct _vt_trace_t
+{
+	int fd;
+	void *map;                                  /*!< mapped file, NULL when streamed */
+	char *buff;                                 /*!< line buffer of a streamed trace */
+	const char *data;
+	uint64_t size;                              /*!< bytes valid in data */
+	uint64_t pos;                               /*!< next line in data */
+	uint64_t base;                              /*!< trace offset of data[0] */
+	uint64_t last_us;                           /*!< time of the previous ASC event, for relative timestamps */
+	uint8_t eof;
+	uint8_t asc_decimal;                        /*!< ASC "base dec" */
+	uint8_t asc_relative;                       /*!< ASC "timestamps relative" */
+
+	uint32_t lines;                             /*!< lines read */
+	uint32_t frames;                            /*!< records returned */
+	uint32_t skipped;                           /*!< headers, comments and events that are not a classic data frame */
+	uint32_t errors;                            /*!< lines that look like a frame but do not parse */
+}vt_trace_t;
+
+/*------------------------------------------------------------------*
+ *                       Function Prototypes                        *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will open a trace.
+ * @param [out]  *trace - pointer to vt_trace_t structure.
+ * @param [in]   *path - pointer to file name, "-" for stdin.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL, VT_STATUS_IO or VT_STATUS_NO_MEM.
+ */
+vt_status_t vt_trace_open(vt_trace_t *trace, const char *path);
+
+/*!
+ * @brief  This API will read the next CAN data frame of a trace. Remote frames, error frames and CAN FD frames
+ *         are counted as skipped.
+ * @param [in]   *trace - pointer to vt_trace_t structure.
+ * @param [out]  *record - pointer to vt_trace_record_t structure.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_EMPTY at the end of the trace, or VT_STATUS_IO.
+ */
+vt_status_t vt_trace_next(vt_trace_t *trace, vt_trace_record_t *record);
+
+/*!
+ * @brief  This API will get the size of a trace.
+ * @param [in]   *trace - pointer to vt_trace_t structure.
+ * @return       size in bytes, 0 when the trace is streamed.
+ */
+uint64_t vt_trace_size(const vt_trace_t *trace);
+
+/*!
+ * @brief  This API will close a trace.
+ * @param [in]   *trace - pointer to vt_trace_t structure.
+ * @return       none.
+ */
+void vt_trace_close(vt_trace_t *trace);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VT_TRACE_H_ */
@@ -0,0 +1,154 @@
+/*
+ * vt_trace_replay.c
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_trace_replay.h"
+
+/*------------------------------------------------------------------*
+ *                        Private Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will move the virtual clock of the core to a trace time, as the PIT and RTC interrupts would.
+ * @param [in]   *replay - pointer to vt_trace_replay_t structure.
+ * @param [in]   time_us - is trace time in microseconds.
+ * @return       none.
+ */
+static void _vt_trace_replay_advance(vt_trace_replay_t *replay, uint64_t time_us)
+{
+	uint64_t target;
+
+	if(time_us <= replay->t0)
+		return;
+
+	target = (time_us - replay->t0) / replay->tick_us;
+	while(replay->ticks < target)
+	{
+		vt_fw_increase_slot_tick_count();
+		replay->ticks++;
+		if(++replay->second_ticks >= (1000000U / replay->tick_us))
+		{
+			replay->second_ticks = 0;
+			vt_fw_increase_system_time();
+			vt_fw_process();
+		}
+	}
+}
+
+/*------------------------------------------------------------------*
+ *                         Public Functions                         *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will initialize a replay.
+ * @param [out]  *replay - pointer to vt_trace_replay_t structure.
+ * @param [in]   tick_us - is microseconds per slot tick, as given to vt_fw_set_slot_time_unit().
+ * @param [in]   batch - is frames received between two vt_fw_process(), 1 to process every frame.
+ * @param [in]   *channel - pointer to channel name to replay, NULL for every channel.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL or VT_STATUS_INVALID.
+ */
+vt_status_t vt_trace_replay_init(vt_trace_replay_t *replay, uint32_t tick_us, uint32_t batch, const char *channel)
+{
+	if(replay == NULL)
+		return VT_STATUS_NULL;
+	if(tick_us == 0 || tick_us > 1000000U || batch == 0)
+		return VT_STATUS_INVALID;
+
+	memset(replay, 0, sizeof(vt_trace_replay_t));
+	replay->tick_us = tick_us;
+	replay->batch = batch;
+	replay->channel = channel;
+
+	return VT_STATUS_SUCCESS;
+}
+
+/*!
+ * @brief  This API will feed every frame of a trace to the firewall core.
+ * @param [in]   *replay - pointer to vt_trace_replay_t structure.
+ * @param [in]   *trace - pointer to vt_trace_t structure.
+ * @return       VT_STATUS_SUCCESS at the end of the trace, or VT_STATUS_IO.
+ */
+vt_status_t vt_trace_replay_run(vt_trace_replay_t *replay, vt_trace_t *trace)
+{
+	vt_trace_record_t record;
+	vt_status_t status;
+
+	while((status = vt_trace_next(trace, &record)) == VT_STATUS_SUCCESS)
+	{
+		if(replay->channel != NULL && strcmp(record.channel, replay->channel) != 0)
+			continue;
+
+		if(replay->frames == 0)
+			replay->t0 = record.time_us;
+		_vt_trace_replay_advance(replay, record.time_us);
+
+		replay->current = record;
+		vt_fw_rcv_msg(record.frame.msgId, record.frame.dataLen, record.frame.data);
+		replay->frames++;
+		if(++replay->pending >= replay->batch)
+		{
+			replay->pending = 0;
+			vt_fw_process();
+		}
+	}
+
+	if(replay->pending > 0)
+	{
+		replay->pending = 0;
+		vt_fw_process();
+	}
+
+	return (status == VT_STATUS_EMPTY) ? VT_STATUS_SUCCESS : status;
+}
+
+/*!
+ * @brief  This API will get the time of the virtual clock.
+ * @param [in]   *replay - pointer to vt_trace_replay_t structure.
+ * @return       microseconds since the first frame.
+ */
+uint64_t vt_trace_replay_time_us(const vt_trace_replay_t *replay)
+{
+	return replay->ticks * replay->tick_us;
+}
+
+/*!
+ * @brief  This API will read a whole file.
+ * @param [in]   *path - pointer to file name.
+ * @return       pointer to content to free(), or NULL with an error printed.
+ */
+uint8_t *vt_trace_replay_load(const char *path)
+{
+	FILE *in;
+	uint8_t *buff = NULL;
+	long size;
+
+	in = fopen(path, "rb");
+	if(in == NULL)
+	{
+		perror(path);
+		return NULL;
+	}
+	if(fseek(in, 0, SEEK_END) == 0 && (size = ftell(in)) > 0 && fseek(in, 0, SEEK_SET) == 0)
+	{
+		buff = (uint8_t *)malloc((size_t)size);
+		if(buff != NULL && fread(buff, 1, (size_t)size, in) != (size_t)size)
+		{
+			free(buff);
+			buff = NULL;
+		}
+	}
+	fclose(in);
+	if(buff == NULL)
+		fprintf(stderr, "%s: cannot read\n", path);
+	return buff;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,87 @@
+/*
+ * vt_trace_replay.h
+ *
+ * Host tools: feed a trace to the firewall core on a virtual clock. The slot tick and the system time of the core
+ * follow the timestamps of the trace, so a trace replays as fast as the host runs the core.
+ *
+ * The core keeps its state in globals: one replay per process, with vt_fw_init() and the callbacks set up by the
+ * caller.
+ */
+
+#ifndef VT_TRACE_REPLAY_H_
+#define VT_TRACE_REPLAY_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_trace.h"
+
+/*------------------------------------------------------------------*
+ *                          Define macro                            *
+ *------------------------------------------------------------------*/
+/*! Slot tick of the agent, VT_PIT_PERIOD */
+#define VT_TRACE_REPLAY_TICK_US 200U
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef struct _vt_trace_replay_t
+{
+	uint32_t tick_us;                           /*!< microseconds per slot tick */
+	uint32_t batch;                             /*!< frames received between two vt_fw_process() */
+	const char *channel;                        /*!< replay this channel only, NULL for every channel */
+
+	vt_trace_record_t current;                  /*!< last frame handed to the core, detections are attributed to it */
+	uint64_t t0;                                /*!< time of the first frame */
+	uint64_t ticks;                             /*!< slot ticks of the virtual clock */
+	uint64_t frames;                            /*!< frames handed to the core */
+	uint32_t second_ticks;
+	uint32_t pending;
+}vt_trace_replay_t;
+
+/*------------------------------------------------------------------*
+ *                       Function Prototypes                        *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will initialize a replay.
+ * @param [out]  *replay - pointer to vt_trace_replay_t structure.
+ * @param [in]   tick_us - is microseconds per slot tick, as given to vt_fw_set_slot_time_unit().
+ * @param [in]   batch - is frames received between two vt_fw_process(), 1 to process every frame.
+ * @param [in]   *channel - pointer to channel name to replay, NULL for every channel.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL or VT_STATUS_INVALID.
+ */
+vt_status_t vt_trace_replay_init(vt_trace_replay_t *replay, uint32_t tick_us, uint32_t batch, const char *channel);
+
+/*!
+ * @brief  This API will feed every frame of a trace to the firewall core. vt_fw_process() runs after every batch of
+ *         frames and at every second of trace time, so windows close during gaps of the trace as on target.
+ *         Time going backwards, e.g. between merged logs, holds the virtual clock.
+ * @param [in]   *replay - pointer to vt_trace_replay_t structure.
+ * @param [in]   *trace - pointer to vt_trace_t structure.
+ * @return       VT_STATUS_SUCCESS at the end of the trace, or VT_STATUS_IO.
+ */
+vt_status_t vt_trace_replay_run(vt_trace_replay_t *replay, vt_trace_t *trace);
+
+/*!
+ * @brief  This API will get the time of the virtual clock.
+ * @param [in]   *replay - pointer to vt_trace_replay_t structure.
+ * @return       microseconds since the first frame.
+ */
+uint64_t vt_trace_replay_time_us(const vt_trace_replay_t *replay);
+
+/*!
+ * @brief  This API will read a whole file, e.g. policy or vector data for vt_fw_init().
+ * @param [in]   *path - pointer to file name.
+ * @return       pointer to content to free(), or NULL with an error printed.
+ */
+uint8_t *vt_trace_replay_load(const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VT_TRACE_REPLAY_H_ */
@@ -0,0 +1,96 @@
+/*
+ * vt_aggr.h
+ */
+
+#ifndef VT_AGGR_H_
+#define VT_AGGR_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_event.h"
+
+/*------------------------------------------------------------------*
+ *                          Define macro                            *
+ *------------------------------------------------------------------*/
+/*! Number of (rule, CAN Id) keys tracked at the same time, must be a power of 2 */
+#ifndef VT_AGGR_TABLE_SIZE
+#define VT_AGGR_TABLE_SIZE 64U
+#endif
+
+/*! Slots looked at per hit, bounds the cost of a hit */
+#ifndef VT_AGGR_MAX_PROBE
+#define VT_AGGR_MAX_PROBE 8U
+#endif
+
+/*! Slots checked for an expired interval per call of vt_aggr_flush() */
+#ifndef VT_AGGR_FLUSH_SLOTS
+#define VT_AGGR_FLUSH_SLOTS 8U
+#endif
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef struct _vt_aggr_stats_t
+{
+	uint32_t hits;                  /*!< blacklist and monitor hits seen */
+	uint32_t suppressed;            /*!< hits folded into a summary instead of being reported */
+	uint32_t summaries;             /*!< summary records pushed */
+	uint32_t overflow;              /*!< hits reported directly because the table had no room */
+}vt_aggr_stats_t;
+
+/*------------------------------------------------------------------*
+ *                       Function Prototypes                        *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will create the aggregation table with storage carved from an arena.
+ * @param [in]   arena - is arena of a subsystem.
+ * @param [in]   interval - is summary interval in slot ticks.
+ * @param [in]   ticks_per_second - is number of slot ticks per second, used for the peak rate.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_INVALID or VT_STATUS_NO_MEM.
+ */
+vt_status_t vt_aggr_init(vt_arena_id_t arena, uint32_t interval, uint32_t ticks_per_second);
+
+/*!
+ * @brief  This API will change the summary interval. Keys already tracked use it from their next interval.
+ * @param [in]   interval - is summary interval in slot ticks.
+ * @return       none.
+ */
+void vt_aggr_set_interval(uint32_t interval);
+
+/*!
+ * @brief  This API will account a blacklist or monitor record. The first hit of a (rule, CAN Id) key is reported
+ *         at once, later hits are counted until the interval of the key expires. The table is not protected, it must
+ *         be called from the same context as vt_aggr_flush(): the agent folds the records as it takes them out of the
+ *         event ring in the main loop, never in the callbacks the RX interrupts run.
+ * @param [in]   *event - pointer to vt_event_t structure of type VT_EVENT_BLACKLIST or VT_EVENT_MONITOR.
+ * @return       VT_STATUS_SUCCESS if the record must be reported,
+ *               VT_STATUS_EXIST if it is folded into the summary of its key,
+ *               or VT_STATUS_FULL if the table has no room, the record must be reported.
+ */
+vt_status_t vt_aggr_hit(const vt_event_t *event);
+
+/*!
+ * @brief  This API will push a VT_EVENT_SUMMARY record for each key whose interval expired and forget keys without
+ *         hits for a whole interval. Only VT_AGGR_FLUSH_SLOTS slots are checked per call.
+ * @param [in]   now - is current slot tick count.
+ * @return       none.
+ */
+void vt_aggr_flush(uint32_t now);
+
+/*!
+ * @brief  This API will get counters of the aggregation stage.
+ * @param [out]  *stats - pointer to vt_aggr_stats_t structure.
+ * @return       none.
+ */
+void vt_aggr_get_stats(vt_aggr_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VT_AGGR_H_ */
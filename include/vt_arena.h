@@ -0,0 +1,98 @@
+/*
+ * vt_arena.h
+ */
+
+#ifndef VT_ARENA_H_
+#define VT_ARENA_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_fw_if.h"
+
+/*------------------------------------------------------------------*
+ *                          Define macro                            *
+ *------------------------------------------------------------------*/
+/*! Alignment of every block carved from an arena */
+#define VT_ARENA_ALIGN 8U
+
+/*
+ * Define VT_ARENA_HEAP in the target build to serve the C library heap (_sbrk) from VT_ARENA_CORE.
+ * The firewall core library then allocates only from the memory handed over at init.
+ */
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef enum _vt_arena_id_t
+{
+	VT_ARENA_CORE = 0,      /*!< heap of the firewall core library (see VT_ARENA_HEAP) */
+	VT_ARENA_RULES,         /*!< rule staging tables */
+	VT_ARENA_QUEUE,         /*!< forward and tx queues */
+	VT_ARENA_STATE,         /*!< per CAN ID state */
+	VT_ARENA_EVENT,         /*!< event reporting ring */
+	VT_ARENA_MAX
+}vt_arena_id_t;
+
+typedef struct _vt_arena_stats_t
+{
+	uint32_t size;          /*!< size of the arena in bytes */
+	uint32_t used;          /*!< bytes currently carved from the arena */
+	uint32_t high_water;    /*!< maximum of used since the arena was initialized */
+	uint32_t failed;        /*!< number of allocations refused with VT_STATUS_NO_MEM */
+}vt_arena_stats_t;
+
+/*------------------------------------------------------------------*
+ *                       Function Prototypes                        *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will hand a caller-provided memory block to a subsystem arena. It should be called once at init.
+ * @param [in]   id - is arena of a subsystem.
+ * @param [in]   *buff - pointer to memory block.
+ * @param [in]   size - size of memory block in bytes.
+ * @return       status.
+ */
+vt_status_t vt_arena_init(vt_arena_id_t id, void *buff, uint32_t size);
+
+/*!
+ * @brief  This API will carve a block from an arena. Blocks are never freed one by one.
+ * @param [in]   id - is arena of a subsystem.
+ * @param [in]   size - size of block in bytes.
+ * @param [out]  **ptr - pointer to the block, NULL when the allocation fails.
+ * @return       VT_STATUS_SUCCESS,
+ *               VT_STATUS_UNREADY if the arena is not initialized,
+ *               or VT_STATUS_NO_MEM if the arena is exhausted or sealed.
+ */
+vt_status_t vt_arena_alloc(vt_arena_id_t id, uint32_t size, void **ptr);
+
+/*!
+ * @brief  This API will release every block of an arena. The high-water mark is kept.
+ * @param [in]   id - is arena of a subsystem.
+ * @return       none.
+ */
+void vt_arena_reset(vt_arena_id_t id);
+
+/*!
+ * @brief  This API will seal an arena at the end of init. Any later allocation returns VT_STATUS_NO_MEM.
+ * @param [in]   id - is arena of a subsystem.
+ * @return       none.
+ */
+void vt_arena_seal(vt_arena_id_t id);
+
+/*!
+ * @brief  This API will get used bytes and high-water mark of an arena.
+ * @param [in]   id - is arena of a subsystem.
+ * @param [out]  *stats - pointer to vt_arena_stats_t structure.
+ * @return       status.
+ */
+vt_status_t vt_arena_get_stats(vt_arena_id_t id, vt_arena_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VT_ARENA_H_ */
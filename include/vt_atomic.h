@@ -0,0 +1,35 @@
+/*
+ * vt_atomic.h
+ */
+
+#ifndef VT_ATOMIC_H_
+#define VT_ATOMIC_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include <stdint.h>
+
+/*------------------------------------------------------------------*
+ *                          Define macro                            *
+ *------------------------------------------------------------------*/
+/*
+ * Lock-free primitives shared by interrupt handlers and the main loop. They map to the GCC __atomic builtins,
+ * which the e200 toolchain implements with lwarx/stwcx. and the host compilers natively.
+ */
+#define VT_ATOMIC_LOAD(ptr)                 __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define VT_ATOMIC_STORE(ptr, val)           __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#define VT_ATOMIC_ADD(ptr, val)             __atomic_fetch_add((ptr), (val), __ATOMIC_RELAXED)
+#define VT_ATOMIC_EXCHANGE(ptr, val)        __atomic_exchange_n((ptr), (val), __ATOMIC_ACQ_REL)
+#define VT_ATOMIC_CAS(ptr, expected, val)   __atomic_compare_exchange_n((ptr), (expected), (val), 0, \
+                                                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VT_ATOMIC_H_ */
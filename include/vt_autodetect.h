@@ -0,0 +1,111 @@
+/*
+ * vt_autodetect.h
+ *
+ * Bitrate detection of the CAN ports without blocking. A port being detected listens at one candidate bitrate
+ * after the other, in listen-only mode so a wrong guess never disturbs the bus. vt_rcv_callback(), which vt_init_can()
+ * also installs as the error callback, hands its events here instead of to the firewall: a frame received fixes the
+ * bitrate, VT_AUTODETECT_ERRORS error events reject the candidate at once, and a candidate with neither is given up
+ * at its deadline, VT_AUTODETECT_RATE_MS after it started. vt_autodetect_process() moves every port on from the main
+ * loop, so ports are detected in parallel and the firewall runs on the ports already detected in the meantime. On a
+ * quiet bus the candidates are tried again and again until a frame comes.
+ */
+
+#ifndef VT_AUTODETECT_H_
+#define VT_AUTODETECT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_can.h"
+
+/*------------------------------------------------------------------*
+ *                          Define macro                            *
+ *------------------------------------------------------------------*/
+/*! Time a candidate bitrate listens for a frame */
+#ifndef VT_AUTODETECT_RATE_MS
+#define VT_AUTODETECT_RATE_MS 100U
+#endif
+
+/*! Error events rejecting a candidate bitrate before its deadline */
+#ifndef VT_AUTODETECT_ERRORS
+#define VT_AUTODETECT_ERRORS 2U
+#endif
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef enum _vt_autodetect_state_t
+{
+	VT_AUTODETECT_IDLE = 0,         /*!< not detected, the port runs as vt_init_can() set it */
+	VT_AUTODETECT_PROBING,          /*!< listening at a candidate bitrate */
+	VT_AUTODETECT_DONE              /*!< detected, the port runs at the bitrate found */
+}vt_autodetect_state_t;
+
+typedef struct _vt_autodetect_stats_t
+{
+	uint8_t state;                  /*!< vt_autodetect_state_t */
+	uint8_t bitrate;                /*!< vt_can_bitrate_type_t, VT_BITRATE_UNKNOWN until detected */
+	uint32_t candidates;            /*!< candidate bitrates tried, the current one included */
+	uint32_t rejected;              /*!< candidates given up on error events */
+	uint32_t timeouts;              /*!< candidates given up at their deadline */
+	uint32_t ticks;                 /*!< slot ticks from vt_autodetect_start() to the detection */
+}vt_autodetect_stats_t;
+
+/*------------------------------------------------------------------*
+ *                       Function Prototypes                        *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will start the detection of a port initialized with vt_init_can(), instances below
+ *         VT_MAX_CAN_NUMBER: it listens at the first candidate bitrate from now on.
+ * @param [in]   inst_can - CAN number (e.g: 0, 1, 2).
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_INVALID or VT_STATUS_ERROR.
+ */
+vt_status_t vt_autodetect_start(uint8_t inst_can);
+
+/*!
+ * @brief  This API will take an event of a port, from vt_rcv_callback().
+ * @param [in]   inst_can - CAN number (e.g: 0, 1, 2).
+ * @param [in]   eventType - is type of the event.
+ * @return       1 if the port is being detected and the event was taken, 0 otherwise.
+ */
+uint8_t vt_autodetect_event(uint8_t inst_can, flexcan_event_type_t eventType);
+
+/*!
+ * @brief  This API will move every port being detected on, from the main loop. A port whose bitrate is found runs
+ *         in normal mode at that bitrate when this call returns.
+ * @param [in]   deadline - is slot tick count the caller wakes up at, e.g. of vt_fw_process_until_idle().
+ * @return       the earlier of deadline and the deadline of the candidates listening.
+ */
+uint32_t vt_autodetect_process(uint32_t deadline);
+
+/*!
+ * @brief  This API will get the bitrate of a port.
+ * @param [in]   inst_can - CAN number (e.g: 0, 1, 2).
+ * @return       vt_can_bitrate_type_t, VT_BITRATE_UNKNOWN while the port is being detected.
+ */
+vt_can_bitrate_type_t vt_autodetect_get_bitrate(uint8_t inst_can);
+
+/*!
+ * @brief  This API will check a port is being detected, so it can neither send nor take part in the firewall.
+ * @param [in]   inst_can - CAN number (e.g: 0, 1, 2).
+ * @return       1 if it is, 0 otherwise.
+ */
+uint8_t vt_autodetect_probing(uint8_t inst_can);
+
+/*!
+ * @brief  This API will get the state of the detection of a port.
+ * @param [in]   inst_can - CAN number (e.g: 0, 1, 2).
+ * @param [out]  *stats - pointer to vt_autodetect_stats_t structure.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL or VT_STATUS_INVALID.
+ */
+vt_status_t vt_autodetect_get_stats(uint8_t inst_can, vt_autodetect_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VT_AUTODETECT_H_ */
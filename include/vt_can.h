@@ -16,6 +16,7 @@ extern "C" {
 #include "flexcan_driver.h"
 #include "vt_led.h"
 #include "vt_fw_if.h"
+#include "vt_can_stats.h"
 
 /*------------------------------------------------------------------*
  *                          Define Macro                            *
@@ -83,7 +84,7 @@ void vt_rcv_callback(uint8_t instance, flexcan_event_type_t eventType, flexcan_s
  * @brief  This API will initialize a CAN port.
  * @param [in]      inst_can - CAN number (e.g: 0, 1, 2).
  * @param [in]      bitrate - is a CAN bit rate in vt_can_bitrate_type_t (e.g: VT_BITRATE_125, VT_BITRATE_500).
- * @param [in]      callback - callback function.
+ * @param [in]      callback - callback function, of the events and of the errors.
  * @param [in]      *callbackParam - pointer to parameter.
  * @return          STATUS_SUCCESS, STATUS_FLEXCAN_MB_OUT_OF_RANGE,
  *                  or STATUS_ERROR.
@@ -99,6 +100,16 @@ status_t vt_init_can(uint8_t inst_can, vt_can_bitrate_type_t bitrate, flexcan_ca
  */
 status_t vt_re_init_can(uint8_t inst_can, vt_can_bitrate_type_t bitrate);
 
+/*!
+ * @brief  This API will re-initialize a CAN port in normal or listen-only mode.
+ * @param [in]      inst_can - CAN number (e.g: 0, 1, 2).
+ * @param [in]      bitrate - is a CAN bit rate in vt_can_bitrate_type_t (e.g: VT_BITRATE_125, VT_BITRATE_500).
+ * @param [in]      listen_only - 1 to neither acknowledge nor send, 0 for normal mode.
+ * @return          STATUS_SUCCESS, STATUS_FLEXCAN_MB_OUT_OF_RANGE,
+ *                  or STATUS_ERROR.
+ */
+status_t vt_re_init_can_mode(uint8_t inst_can, vt_can_bitrate_type_t bitrate, uint8_t listen_only);
+
 /*!
  * @brief  This API will set a bit-rate to CAN.
  * @param [in]      inst_can - CAN number (e.g: 0, 1, 2).
@@ -164,6 +175,22 @@ status_t vt_send_can_msg(uint8_t inst_can, flexcan_msgbuff_t *msgbuff, flexcan_m
  */
 int vt_add_can_id_to_rxfifo_filter(uint32_t value);
 
+/*!
+ * @brief  This API will start a bulk load of Rxfifo filter table. The next calls of vt_add_can_id_to_rxfifo_filter
+ *          append the can id without sorting until vt_commit_rxfifo_filter_bulk_load is called. A can id already
+ *          in the table is not appended again, its position is returned.
+ * @param [in]      none .
+ * @return          none
+ */
+void vt_begin_rxfifo_filter_bulk_load(void);
+
+/*!
+ * @brief  This API will finish a bulk load of Rxfifo filter table. The table is sorted once and the unused entries
+ *          are filled with the last can id.
+ * @param [in]      none .
+ * @return          number of can id in Rxfifo table
+ */
+int vt_commit_rxfifo_filter_bulk_load(void);
 
 /*!
  * @brief  This API will clear all can id of Rxfifo table.
@@ -186,6 +213,21 @@ void vt_start_rcv(uint8_t inst_can);
  */
 void vt_update_can_led(void);
 
+/*!
+ * @brief  This API will get counters of a CAN port.
+ * @param [in]      inst_can - CAN number (e.g: 0, 1, 2).
+ * @param [out]     *stats - pointer to vt_can_stats_t structure.
+ * @return          VT_STATUS_SUCCESS, VT_STATUS_NULL or VT_STATUS_INVALID.
+ */
+vt_status_t vt_can_get_stats(uint8_t inst_can, vt_can_stats_t *stats);
+
+/*!
+ * @brief  This API will count a transmission aborted or refused by the driver.
+ * @param [in]      inst_can - CAN number (e.g: 0, 1, 2).
+ * @return          none.
+ */
+void vt_can_count_tx_abort(uint8_t inst_can);
+
 /*------------------------------------------------------------------*
  *                Test Function and Examples                        *
  *------------------------------------------------------------------*/
@@ -0,0 +1,40 @@
+/*
+ * vt_can_stats.h
+ */
+
+#ifndef VT_CAN_STATS_H_
+#define VT_CAN_STATS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include <stdint.h>
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+/*
+ * Kept apart from vt_can.h so vt_fw_oem.h can embed it: vt_can.h includes vt_fw_oem.h through vt_led.h.
+ */
+/*!
+ * @brief Counters of a CAN port. They are updated from the FlexCAN interrupt and the main loop without locks.
+ */
+typedef struct _vt_can_stats_t
+{
+	uint32_t rx_frames;             /*!< frames read from the RxFIFO */
+	uint32_t tx_frames;             /*!< transmissions completed */
+	uint32_t rx_fifo_overflow;      /*!< FLEXCAN_EVENT_RXFIFO_OVERFLOW, frames lost by the controller */
+	uint32_t rx_fifo_warning;       /*!< FLEXCAN_EVENT_RXFIFO_WARNING, RxFIFO almost full */
+	uint32_t tx_aborts;             /*!< transmissions aborted or refused by the driver */
+	uint32_t errors;                /*!< FLEXCAN_EVENT_ERROR */
+}vt_can_stats_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VT_CAN_STATS_H_ */
@@ -0,0 +1,188 @@
+/*
+ * vt_event.h
+ */
+
+#ifndef VT_EVENT_H_
+#define VT_EVENT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_fw_if.h"
+#include "vt_arena.h"
+#include "vt_fw_result.h"
+#include "vt_probe.h"
+#include "vt_rate.h"
+
+/*------------------------------------------------------------------*
+ *                          Define macro                            *
+ *------------------------------------------------------------------*/
+/*! Number of records in the event ring, must be a power of 2 */
+#ifndef VT_EVENT_RING_SIZE
+#define VT_EVENT_RING_SIZE 32U
+#endif
+
+/*!
+ * Traffic status of malicious traffic. The agent tested it before this header existed but vt_fw_if.h does not
+ * define it. The value is an assumption, the next one after VT_CAR_UNKOWN_STAT, to confirm with the vendor of the
+ * firewall core; a core header defining it takes precedence.
+ */
+#ifndef VT_CAR_ABNORMAL_MALICIOUS
+#define VT_CAR_ABNORMAL_MALICIOUS ((vt_car_status_t)6)
+#endif
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef enum _vt_event_type_t
+{
+	VT_EVENT_NONE = 0,
+	VT_EVENT_TRAFFIC_STATUS,
+	VT_EVENT_VECTOR,
+	VT_EVENT_BLACKLIST,
+	VT_EVENT_MONITOR,
+	VT_EVENT_DROPPED,
+	VT_EVENT_SUMMARY,
+	VT_EVENT_PROBE,
+	VT_EVENT_MISSING
+}vt_event_type_t;
+
+typedef struct _vt_event_traffic_t
+{
+	vt_car_status_t car_status;
+	vt_rate_t slot_rate;
+	vt_rate_t pattern_rate;
+	uint32_t count_frames;
+}vt_event_traffic_t;
+
+/*!
+ * @brief Vector match of a window, vt_vector_result_t with a fixed-point rate.
+ */
+typedef struct _vt_event_vector_t
+{
+	uint32_t count_vector_in_rl;
+	uint32_t count_vector_in_rt;
+	uint32_t count_all_vector;
+	vt_rate_t matched_rate;
+	uint8_t matched_flag;
+}vt_event_vector_t;
+
+/*!
+ * @brief Repeated hits of one (rule, CAN Id) key folded over a summary interval, see vt_aggr.h.
+ */
+typedef struct _vt_event_summary_t
+{
+	uint32_t rule_id;
+	uint32_t can_id;
+	uint32_t count;                 /*!< hits folded into the summary */
+	uint32_t first_ts;              /*!< slot tick count of the first folded hit */
+	uint32_t last_ts;               /*!< slot tick count of the last folded hit */
+	uint32_t peak_rate;             /*!< hits per second of the busiest second */
+	uint8_t rule_type;              /*!< vt_fw_rule_type_t */
+}vt_event_summary_t;
+
+/*!
+ * @brief Latency of a hot-path probe, see vt_probe.h.
+ */
+typedef struct _vt_event_probe_t
+{
+	uint32_t count;
+	uint32_t min_ns;
+	uint32_t max_ns;
+	uint32_t p99_ns;
+	uint8_t probe;                  /*!< vt_probe_id_t */
+}vt_event_probe_t;
+
+/*!
+ * @brief Periodic Id silent for longer than its timeout, see vt_missing.h.
+ */
+typedef struct _vt_event_missing_t
+{
+	uint32_t can_id;
+	uint32_t last_ts;               /*!< slot tick count of the last frame */
+	uint32_t timeout;               /*!< slot ticks */
+}vt_event_missing_t;
+
+/*!
+ * @brief Fixed-size record pushed by the firewall callbacks and formatted later by the drain.
+ */
+typedef struct _vt_event_t
+{
+	uint8_t type;                   /*!< vt_event_type_t */
+	uint32_t time_stamp;            /*!< slot tick count when the event was pushed */
+	union
+	{
+		vt_event_traffic_t traffic;
+		vt_event_vector_t vector;
+		vt_fw_match_result_t result;    /*!< VT_EVENT_BLACKLIST and VT_EVENT_MONITOR */
+		uint32_t dropped;           /*!< number of records dropped, VT_EVENT_DROPPED only */
+		vt_event_summary_t summary;
+		vt_event_probe_t probe;
+		vt_event_missing_t missing;
+	} u;
+}vt_event_t;
+
+typedef struct _vt_event_stats_t
+{
+	uint32_t pushed;                /*!< records accepted by the ring */
+	uint32_t dropped;               /*!< records refused because the ring was full */
+	uint32_t sent;                  /*!< records handed to the transport */
+}vt_event_stats_t;
+
+/*------------------------------------------------------------------*
+ *                       Function Prototypes                        *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will create the event ring with storage carved from an arena.
+ * @param [in]   arena - is arena of a subsystem.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_NO_MEM.
+ */
+vt_status_t vt_event_init(vt_arena_id_t arena);
+
+/*!
+ * @brief  This API will push a record to the event ring. It never blocks and can be called from interrupt
+ *         handlers and from the main loop at the same time.
+ * @param [in]   *event - pointer to vt_event_t structure.
+ * @return       VT_STATUS_SUCCESS, or VT_STATUS_FULL when the record is dropped.
+ */
+vt_status_t vt_event_push(const vt_event_t *event);
+
+/*!
+ * @brief  This API will get the oldest record from the event ring. Only one consumer is allowed.
+ * @param [out]  *event - pointer to vt_event_t structure.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_EMPTY.
+ */
+vt_status_t vt_event_pop(vt_event_t *event);
+
+/*!
+ * @brief  This API will count a record as handed to the transport.
+ * @param [in]   none.
+ * @return       none.
+ */
+void vt_event_mark_sent(void);
+
+/*!
+ * @brief  This API will get counters of the event ring.
+ * @param [out]  *stats - pointer to vt_event_stats_t structure.
+ * @return       none.
+ */
+void vt_event_get_stats(vt_event_stats_t *stats);
+
+/*!
+ * @brief  This API will format an event record to a string.
+ * @param [in]   *event - pointer to vt_event_t structure.
+ * @param [out]  *st - pointer to string buffer.
+ * @param [in]   len - size of string buffer.
+ * @return       length of string.
+ */
+int vt_event_format(const vt_event_t *event, char *st, int len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VT_EVENT_H_ */
@@ -0,0 +1,161 @@
+/*
+ * vt_fw_ctx.h
+ *
+ * Firewall contexts: the agent side of the firewall per CAN bus. A context owns a set of buses, the frames of those
+ * buses go to the firewall through it, and it has its own callbacks and counters. The default context owns every bus
+ * no other context has claimed, so an agent that never opens a context behaves as before.
+ *
+ * The firewall core (libvtAgent) is a single instance with one policy, one vector and one set of time windows. The
+ * contexts share it:
+ *   - a detection raised while vt_fw_ctx_can_msg_is_malicious() checks a frame goes to the context of that frame
+ *     only. A detection of the time windows of vt_fw_process() is not tied to a bus and goes to the default context.
+ *   - the traffic status and the vector result are of the whole core, so they have one global callback each.
+ *     window_frames tells how many frames of the last window came from the buses of a context.
+ */
+
+#ifndef VT_FW_CTX_H_
+#define VT_FW_CTX_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_fw_if.h"
+
+/*------------------------------------------------------------------*
+ *                          Define macro                            *
+ *------------------------------------------------------------------*/
+/*! Buses a context can own, the FlexCAN instances 0 to 2 */
+#define VT_FW_CTX_BUSES     3U
+
+/*! Contexts, the default one included */
+#ifndef VT_FW_CTX_MAX
+#define VT_FW_CTX_MAX       VT_FW_CTX_BUSES
+#endif
+
+/*! Bus mask of a single bus */
+#define VT_FW_CTX_BUS(bus)  (1UL << (bus))
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef struct _vt_fw_ctx_t vt_fw_ctx_t;
+
+typedef struct _vt_fw_ctx_stats_t
+{
+	uint32_t bus_mask;              /*!< buses owned by the context */
+	uint32_t rx_frames;             /*!< frames handed to the firewall */
+	uint32_t malicious_frames;      /*!< frames found malicious */
+	uint32_t window_frames;         /*!< frames of the buses of the context in the last window */
+	uint32_t blacklist_hits;        /*!< blacklist detections delivered */
+	uint32_t monitor_hits;          /*!< monitor detections delivered */
+}vt_fw_ctx_stats_t;
+
+/*------------------------------------------------------------------*
+ *                       Function Prototypes                        *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will reset every context and route the callbacks of the firewall core to them. Call it after
+ *         vt_fw_init(), the default context then owns every bus and no callback is installed.
+ * @param [in]   none.
+ * @return       none.
+ */
+void vt_fw_ctx_init(void);
+
+/*!
+ * @brief  This API will get the default context.
+ * @param [in]   none.
+ * @return       pointer to vt_fw_ctx_t structure.
+ */
+vt_fw_ctx_t *vt_fw_ctx_default(void);
+
+/*!
+ * @brief  This API will open a context owning a set of buses, taken from the default context.
+ * @param [in]   bus_mask - is set of buses, VT_FW_CTX_BUS(bus) ORed.
+ * @return       pointer to vt_fw_ctx_t structure, NULL if the mask is empty, a bus is owned by another context
+ *               or every context is in use.
+ */
+vt_fw_ctx_t *vt_fw_ctx_open(uint32_t bus_mask);
+
+/*!
+ * @brief  This API will close a context, its buses go back to the default context.
+ * @param [in]   *ctx - pointer to vt_fw_ctx_t structure.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL or VT_STATUS_INVALID for the default context.
+ */
+vt_status_t vt_fw_ctx_close(vt_fw_ctx_t *ctx);
+
+/*!
+ * @brief  This API will get the context owning a bus.
+ * @param [in]   bus - is CAN number (e.g: 0, 1, 2), buses past VT_FW_CTX_BUSES belong to the default context.
+ * @return       pointer to vt_fw_ctx_t structure.
+ */
+vt_fw_ctx_t *vt_fw_ctx_of_bus(uint8_t bus);
+
+/*!
+ * @brief  This API will add a CAN message of a bus of the context to the firewall queue.
+ * @param [in]   *ctx - pointer to vt_fw_ctx_t structure.
+ * @param [in]   id - is CAN ID.
+ * @param [in]   len - length of data buffer.
+ * @param [in]   *databuff - a pointer to data array.
+ * @return       none.
+ */
+void vt_fw_ctx_rcv_msg(vt_fw_ctx_t *ctx, uint32_t id, uint8_t len, uint8_t *databuff);
+
+/*!
+ * @brief  This API will check a CAN message of a bus of the context against the malicious frames. Detections the
+ *         firewall core raises during the check go to this context.
+ * @param [in]   *ctx - pointer to vt_fw_ctx_t structure.
+ * @param [in]   msgId - is CAN ID.
+ * @param [in]   dataLen - length of data buffer.
+ * @param [in]   *databuff - a pointer to data array.
+ * @return       1 if malicious, 0 otherwise.
+ */
+uint8_t vt_fw_ctx_can_msg_is_malicious(vt_fw_ctx_t *ctx, uint32_t msgId, uint8_t dataLen, uint8_t *databuff);
+
+/*!
+ * @brief  This API will install the vector callback, global to every context: the vector is of the whole core.
+ * @param [in]   callback - callback function, NULL removes it.
+ * @return       none.
+ */
+void vt_fw_ctx_install_global_vector_callback(vt_fw_vector_callback callback);
+
+/*!
+ * @brief  This API will install the traffic status callback, global to every context: the time windows are of the
+ *         whole core.
+ * @param [in]   callback - callback function, NULL removes it.
+ * @return       none.
+ */
+void vt_fw_ctx_install_global_traffic_status_callback(vt_fw_traffic_status_callback callback);
+
+/*!
+ * @brief  This API will install the blacklist callback of a context.
+ * @param [in]   *ctx - pointer to vt_fw_ctx_t structure.
+ * @param [in]   callback - callback function, NULL removes it.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_NULL.
+ */
+vt_status_t vt_fw_ctx_install_blacklist_callback(vt_fw_ctx_t *ctx, vt_fw_blacklist_callback callback);
+
+/*!
+ * @brief  This API will install the monitor callback of a context.
+ * @param [in]   *ctx - pointer to vt_fw_ctx_t structure.
+ * @param [in]   callback - callback function, NULL removes it.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_NULL.
+ */
+vt_status_t vt_fw_ctx_install_monitor_callback(vt_fw_ctx_t *ctx, vt_fw_monitor_callback callback);
+
+/*!
+ * @brief  This API will get counters of a context.
+ * @param [in]   *ctx - pointer to vt_fw_ctx_t structure.
+ * @param [out]  *stats - pointer to vt_fw_ctx_stats_t structure.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_NULL.
+ */
+vt_status_t vt_fw_ctx_get_stats(vt_fw_ctx_t *ctx, vt_fw_ctx_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VT_FW_CTX_H_ */
@@ -0,0 +1,150 @@
+/*
+ * vt_fw_dual.h
+ *
+ * Dual core deployment, built in with VT_FW_DUAL_CORE (see vt_fw_oem.h). The CAN core takes the FlexCAN interrupts
+ * and forwards, the firewall core runs the firewall:
+ *   - the RX interrupt of the CAN core hands each frame to the firewall core through the frame channel;
+ *   - the main loop of the firewall core checks the frames against the malicious frames, feeds them to the
+ *     firewall, and hands each one back with its verdict through the verdict channel, then runs vt_fw_process()
+ *     and vt_fw_oem_report_process();
+ *   - the CAN core forwards the frames of clean verdicts and drops the malicious ones.
+ * A frame is forwarded one channel round trip later than on a single core. A frame finding the frame channel full
+ * is neither checked nor forwarded.
+ *
+ * vt_fw_oem_init() runs once before either core takes frames. The PIT and RTC interrupts go to the firewall core,
+ * which owns the slot ticks and the windows. vt_fw_dual_verdict_process() shares the forward queues with the FlexCAN interrupts, so it
+ * runs at their priority on the CAN core: vt_rcv_callback() calls it on every RX and TX complete, and the software
+ * interrupt the firewall core raises with VT_FW_DUAL_NOTIFY() calls it so the last verdicts leave when the bus
+ * goes quiet.
+ *
+ * The channels have a single producer and a single consumer, but on the CAN core each end is taken by the interrupts
+ * of every FlexCAN instance. An interrupt of one instance preempting the other in the middle of vt_ipc_push() or
+ * vt_ipc_pop() would write or take the same slot twice, so the CAN core holds VT_FW_DUAL_LOCK() around its end of
+ * each channel. It is a few loads and stores long, the frame copies stay outside of it.
+ *
+ * The firewall core sleeps in vt_osal_wait(), which only its own interrupts end. vt_fw_oem_signal() raises
+ * VT_FW_DUAL_WAKE() for the frames of the CAN core, and the words both cores write, the wakeup counters and the slot
+ * ticks, are placed with VT_IPC_SHARED like the channels.
+ */
+
+#ifndef VT_FW_DUAL_H_
+#define VT_FW_DUAL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_ipc.h"
+#include "vt_probe.h"
+#include "vt_can.h"
+#include "vt_osal.h"
+
+/*------------------------------------------------------------------*
+ *                          Define macro                            *
+ *------------------------------------------------------------------*/
+/*! Number of frames of each channel, a power of 2 */
+#ifndef VT_FW_DUAL_CHANNEL_SIZE
+#define VT_FW_DUAL_CHANNEL_SIZE 256U
+#endif
+
+/*! Raise the verdict interrupt of the CAN core, e.g. a software-settable interrupt of the INTC */
+#ifndef VT_FW_DUAL_NOTIFY
+#define VT_FW_DUAL_NOTIFY()     do {} while(0)
+#endif
+
+/*! Raise the wakeup interrupt of the firewall core, a software-settable interrupt of the INTC routed to it (SSCIRn)
+ *  whose handler calls vt_osal_signal_from_isr(). No default on target, the interrupts of one process are threads on
+ *  host */
+#ifndef VT_FW_DUAL_WAKE
+#if !defined(__PPC__) && !defined(__powerpc__)
+#define VT_FW_DUAL_WAKE()       vt_osal_signal_from_isr()
+#endif
+#endif
+
+/*! Critical section of the CAN core around its end of the channels, against the interrupts of the other FlexCAN
+ *  instances. The host mock takes the FlexCAN callbacks on one thread */
+#ifndef VT_FW_DUAL_LOCK
+#if defined(__PPC__) || defined(__powerpc__)
+#include "interrupt_manager.h"
+#define VT_FW_DUAL_LOCK()       INT_SYS_DisableIRQGlobal()
+#define VT_FW_DUAL_UNLOCK()     INT_SYS_EnableIRQGlobal()
+#else
+#define VT_FW_DUAL_LOCK()       do {} while(0)
+#define VT_FW_DUAL_UNLOCK()     do {} while(0)
+#endif
+#endif
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef struct _vt_fw_dual_stats_t
+{
+	uint32_t frames;                /*!< frames handed to the firewall core */
+	uint32_t dropped;               /*!< frames lost because the frame channel was full */
+	uint32_t checked;               /*!< frames checked by the firewall core */
+	uint32_t verdicts;              /*!< verdicts taken by the CAN core */
+	uint32_t malicious;             /*!< verdicts of malicious frames, not forwarded */
+	uint32_t frame_depth;           /*!< frames waiting in the frame channel */
+	uint32_t frame_high_water;      /*!< maximum depth of the frame channel */
+	uint32_t verdict_high_water;    /*!< maximum depth of the verdict channel */
+	vt_probe_stats_t round_trip;    /*!< RX interrupt to verdict, in ns */
+}vt_fw_dual_stats_t;
+
+/*------------------------------------------------------------------*
+ *                       Function Prototypes                        *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will empty both channels and clear the counters.
+ * @param [in]   none.
+ * @return       none.
+ */
+void vt_fw_dual_init(void);
+
+/*!
+ * @brief  This API will hand a received frame to the firewall core, in the RX interrupt of the CAN core.
+ * @param [in]   instance - is CAN number (e.g: 0, 1, 2).
+ * @param [in]   *msg - is pointer to flexcan message.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_FULL.
+ */
+vt_status_t vt_fw_dual_rx(uint8_t instance, const flexcan_msgbuff_t *msg);
+
+/*!
+ * @brief  This API will check the frames of the frame channel and hand back their verdicts, in the main loop of the
+ *         firewall core before vt_fw_process(), vt_fw_process_until_idle() calls it. It stops when the verdict
+ *         channel is full.
+ * @param [in]   max_frames - is maximum number of frames to check.
+ * @return       number of frames checked.
+ */
+uint32_t vt_fw_dual_fw_process(uint32_t max_frames);
+
+/*!
+ * @brief  This API will take the verdicts and forward the clean frames, on the CAN core at the priority of the
+ *         FlexCAN interrupts.
+ * @param [in]   none.
+ * @return       number of verdicts taken.
+ */
+uint32_t vt_fw_dual_verdict_process(void);
+
+/*!
+ * @brief  This API will get the number of frames handed to the firewall core whose verdict the CAN core has not taken
+ *         yet, on the CAN core.
+ * @param [in]   none.
+ * @return       number of frames.
+ */
+uint32_t vt_fw_dual_pending(void);
+
+/*!
+ * @brief  This API will get counters of the channels. The round trip histogram is read on the CAN core.
+ * @param [out]  *stats - pointer to vt_fw_dual_stats_t structure.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_NULL.
+ */
+vt_status_t vt_fw_dual_get_stats(vt_fw_dual_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VT_FW_DUAL_H_ */
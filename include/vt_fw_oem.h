@@ -13,6 +13,17 @@ extern "C" {
  *                           Includes                               *
  *------------------------------------------------------------------*/
 #include "vt_fw_if.h"
+#include "vt_fw_rules.h"
+#include "vt_arena.h"
+#include "vt_queue.h"
+#include "vt_event.h"
+#include "vt_wire.h"
+#include "vt_aggr.h"
+#include "vt_missing.h"
+#include "vt_ratelimit.h"
+#include "vt_can_stats.h"
+#include "vt_probe.h"
+#include "vt_latency.h"
 #include "vt_rtc.h"
 #include "vt_timer.h"
 #include "vt_can.h"
@@ -26,9 +37,86 @@ extern "C" {
 
 #define VT_MAX_CAN_NUMBER 2
 
+/*! 1: FlexCAN interrupts and forwarding on one core, the firewall on another (see vt_fw_dual.h), 0: one core */
+#ifndef VT_FW_DUAL_CORE
+#define VT_FW_DUAL_CORE 0
+#endif
+
+/*! Number of messages in the forward queue of each CAN port */
+#define VT_FW_TX_QUEUE_SIZE 256
+
+/*! Size in bytes of the memory handed to each subsystem arena at init, VT_ARENA_CORE only with VT_ARENA_HEAP */
+#ifndef VT_ARENA_CORE_SIZE
+#define VT_ARENA_CORE_SIZE  (32U * 1024U)
+#endif
+#ifndef VT_ARENA_RULES_SIZE
+#define VT_ARENA_RULES_SIZE (4U * 1024U)
+#endif
+#ifndef VT_ARENA_QUEUE_SIZE
+#define VT_ARENA_QUEUE_SIZE (VT_MAX_CAN_NUMBER * VT_FW_TX_QUEUE_SIZE * sizeof(vt_msgbuff_t) + 64U)
+#endif
+#ifndef VT_ARENA_STATE_SIZE
+#define VT_ARENA_STATE_SIZE (20U * 1024U)
+#endif
+#ifndef VT_ARENA_EVENT_SIZE
+#define VT_ARENA_EVENT_SIZE (VT_EVENT_RING_SIZE * (sizeof(vt_event_t) + 8U))
+#endif
+
+/*! Size of the formatted report handed to the UART */
+#define VT_REPORT_BUFFER_SIZE 256
+
+/*! Interval of the summary of repeated blacklist and monitor hits */
+#ifndef VT_AGGR_INTERVAL_MS
+#define VT_AGGR_INTERVAL_MS 1000U
+#endif
+
+/*! Period of the probe histogram reports, used when VT_PROBE_ENABLE is 1 */
+#ifndef VT_PROBE_REPORT_MS
+#define VT_PROBE_REPORT_MS 10000U
+#endif
+
+/*! Longest time vt_fw_process() is left uncalled on an idle bus, the deadline of vt_fw_process_until_idle() */
+#ifndef VT_FW_IDLE_PROCESS_MS
+#define VT_FW_IDLE_PROCESS_MS 10U
+#endif
+
+/*! Execution budget of a vt_fw_process_until_idle() call */
+#ifndef VT_FW_PROCESS_BUDGET_US
+#define VT_FW_PROCESS_BUDGET_US 100U
+#endif
+
+/*! 1: send events as framed binary records (see vt_wire.h), 0: send them as text */
+#ifndef VT_REPORT_BINARY
+#define VT_REPORT_BINARY 1
+#endif
+
 /*------------------------------------------------------------------*
  *                Define Enumeration and Structure                  *
  *------------------------------------------------------------------*/
+typedef struct _vt_fw_port_stats_t
+{
+	vt_can_stats_t can;
+	uint32_t queue_depth;           /*!< messages waiting in the tx queue of the port */
+	uint32_t queue_high_water;      /*!< maximum depth of the tx queue */
+	uint32_t queue_dropped;         /*!< messages lost because the tx queue was full */
+}vt_fw_port_stats_t;
+
+/*!
+ * @brief Counters of the agent. Per rule hit counts are read with vt_fw_get_rule_info().
+ */
+typedef struct _vt_fw_stats_t
+{
+	vt_fw_port_stats_t port[VT_MAX_CAN_NUMBER];
+	vt_event_stats_t event;
+	vt_aggr_stats_t aggr;
+	vt_missing_stats_t missing;
+	vt_ratelimit_stats_t ratelimit;
+	uint32_t rule_hits;             /*!< blacklist and monitor hits traced back to a committed rule */
+	uint32_t unknown_hits;          /*!< blacklist and monitor hits of no committed rule */
+	uint32_t windows;               /*!< traffic status windows reported by the firewall */
+	uint32_t window_frames;         /*!< frames of the last window */
+	uint32_t total_window_frames;   /*!< frames of all windows, wraps around */
+}vt_fw_stats_t;
 
 /*------------------------------------------------------------------*
  *                     Define Callback Functions                    *
@@ -46,20 +134,70 @@ extern "C" {
  *                       Function Prototypes                        *
  *------------------------------------------------------------------*/
 /*!
- * @brief  This API will initialize firewall.
+ * @brief  This API will initialize firewall. It stops at the first subsystem that cannot get its memory, the agent
+ *         must not run then.
+ * @param [in]   none.
+ * @return       VT_STATUS_SUCCESS, or the status of the first subsystem that failed, e.g. VT_STATUS_NO_MEM.
+ */
+vt_status_t vt_fw_oem_init(void);
+
+/*!
+ * @brief  This API will format and send out pending events. It never blocks, put it in main loop or in a
+ *         low priority task of the RTOS. It flushes the summaries of repeated hits, so it must run in the same
+ *         context as vt_fw_process().
+ * @param [in]   none.
+ * @return       none.
+ */
+void vt_fw_oem_report_process(void);
+
+/*!
+ * @brief  This API will run vt_fw_process() once, then the reporting in slices until max_us is spent: summaries of
+ *         the aggregation table VT_AGGR_FLUSH_SLOTS slots at a time, a whole sweep at most, and records packed for
+ *         the UART one at a time. The window evaluation of the core runs to completion within vt_fw_process(), its
+ *         callbacks only push records, so a call lasts max_us plus one slice at most unless vt_fw_process() alone
+ *         takes longer. Work left over is done by the next call.
+ * @param [in]   max_us - is budget in microseconds.
+ * @return       VT_STATUS_SUCCESS, or VT_STATUS_TIMEOUT if the budget ran out with work left.
+ */
+vt_status_t vt_fw_process_budget(uint32_t max_us);
+
+/*!
+ * @brief  This API will run the firewall until the work signalled by vt_fw_oem_signal() is done: one vt_fw_process()
+ *         per frame received, or one for a timer, then the reporting, again while frames keep coming. The budget
+ *         VT_FW_PROCESS_BUDGET_US is checked after every vt_fw_process(), the frames and reporting left when it is
+ *         spent are done by the next call. Use it in the firewall task instead of a polling loop, then sleep in
+ *         vt_osal_wait() until the deadline:
+ *             vt_osal_wait(vt_timer_us_until(vt_fw_process_until_idle()));
  * @param [in]   none.
+ * @return       deadline in slot ticks: now when the budget ran out, the UART when records wait for it, the next
+ *               probe report, and VT_FW_IDLE_PROCESS_MS at the latest. On an idle bus summaries of vt_aggr.h are flushed at that pace.
+ */
+uint32_t vt_fw_process_until_idle(void);
+
+/*!
+ * @brief  This API will wake the firewall task, from an interrupt. vt_rcv_callback() calls it for each frame and
+ *         the RTC alarm for each window.
+ * @param [in]   frames - is number of frames handed to the firewall, 0 for a timer.
  * @return       none.
  */
-void vt_fw_oem_init(void);
+void vt_fw_oem_signal(uint32_t frames);
+
+/*!
+ * @brief  This API will get counters of the agent. Counters are lock-free and always enabled.
+ * @param [out]  *stats - pointer to vt_fw_stats_t structure.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_NULL.
+ */
+vt_status_t vt_fw_get_stats(vt_fw_stats_t *stats);
 
 #ifdef USING_GATEWAY
 /*!
  * @brief  This API will add CAN message to forward queue.
  * @param [in]      instant - CAN number (e.g: 0, 1, 2).
  * @param [in]      *msg - is pointer to flexcan message.
+ * @param [in]      time_stamp - is vt_probe_now() taken in the RX interrupt, carried to the TX complete.
  * @return       none.
  */
-void vt_fw_oem_add_message_to_forward_queue(uint8_t instant, flexcan_msgbuff_t *msg);
+void vt_fw_oem_add_message_to_forward_queue(uint8_t instant, flexcan_msgbuff_t *msg, uint32_t time_stamp);
 
 /*!
  * @brief  This API will get and send out a CAN message to a CAN bus.
@@ -0,0 +1,75 @@
+/*
+ * vt_fw_result.h
+ */
+
+#ifndef VT_FW_RESULT_H_
+#define VT_FW_RESULT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_fw_if.h"
+#include "vt_fw_rules.h"
+
+/*------------------------------------------------------------------*
+ *                          Define macro                            *
+ *------------------------------------------------------------------*/
+/*! rule_id when the detection cannot be traced back to a committed rule */
+#define VT_FW_RULE_ID_NONE      0xFFFFFFFFUL
+/*! can_id when the firewall core did not report the CAN Id */
+#define VT_FW_CAN_ID_NONE       0xFFFFFFFFUL
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief Structured blacklist or monitor detection. Text is rendered only by vt_fw_format_result(). The firewall
+ *        core reports neither the payload nor the frame count of a detection, only the rule and the CAN Id.
+ */
+typedef struct _vt_fw_match_result_t
+{
+	uint32_t rule_id;                           /*!< see vt_fw_find_rule(), VT_FW_RULE_ID_NONE if unknown */
+	uint32_t can_id;                            /*!< CAN Id of the frame, VT_FW_CAN_ID_NONE if unknown */
+	uint32_t time_stamp;                        /*!< slot tick count of the detection */
+	uint16_t min_val;                           /*!< lower bound of the rule */
+	uint16_t max_val;                           /*!< upper bound of the rule */
+	uint8_t rule_type;                          /*!< vt_fw_rule_type_t */
+	uint8_t matched_bit;                        /*!< VT_FRAME_BIT, VT_RANGE_BIT or VT_PATTERN_BIT */
+}vt_fw_match_result_t;
+
+/*------------------------------------------------------------------*
+ *                       Function Prototypes                        *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will get the display name of a rule type.
+ * @param [in]   rule_type - is vt_fw_rule_type_t.
+ * @return       name, "Unknown rule" if rule_type is out of range.
+ */
+const char *vt_fw_rule_name(uint8_t rule_type);
+
+/*!
+ * @brief  This API will get the CAN Id of a detection. The firewall core reports it only in the text of the detail,
+ *         as its first hexadecimal number "0x...".
+ * @param [in]   *detail_result - pointer to vt_fw_detail_result_t structure.
+ * @return       CAN Id, or VT_FW_CAN_ID_NONE if the detail has no CAN Id.
+ */
+uint32_t vt_fw_detail_can_id(const vt_fw_detail_result_t *detail_result);
+
+/*!
+ * @brief  This API will format a structured result to a string.
+ * @param [in]   *result - pointer to vt_fw_match_result_t structure.
+ * @param [out]  *st - pointer to string buffer.
+ * @param [in]   len - size of string buffer.
+ * @return       length of string.
+ */
+int vt_fw_format_result(const vt_fw_match_result_t *result, char *st, int len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VT_FW_RESULT_H_ */
@@ -0,0 +1,183 @@
+/*
+ * vt_fw_rules.h
+ */
+
+#ifndef VT_FW_RULES_H_
+#define VT_FW_RULES_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_fw_if.h"
+
+/*------------------------------------------------------------------*
+ *                          Define macro                            *
+ *------------------------------------------------------------------*/
+/*! Number of rules that can be staged between begin and commit */
+#ifndef VT_FW_BULK_MAX_RULES
+#define VT_FW_BULK_MAX_RULES 64
+#endif
+
+/*! Number of CAN frames that can be staged for frame and pattern rules */
+#ifndef VT_FW_BULK_MAX_FRAMES
+#define VT_FW_BULK_MAX_FRAMES 96
+#endif
+
+/*! Number of committed rules kept in the lookup index, carved from VT_ARENA_STATE at the first commit */
+#ifndef VT_FW_RULE_INDEX_SIZE
+#define VT_FW_RULE_INDEX_SIZE VT_FW_BULK_MAX_RULES
+#endif
+
+/*! Number of CAN Id intervals of the lookup index: one per rule, per CAN Id of a pattern, two per rule out of a range */
+#ifndef VT_FW_RULE_KEY_SIZE
+#define VT_FW_RULE_KEY_SIZE (VT_FW_RULE_INDEX_SIZE + VT_FW_BULK_MAX_FRAMES)
+#endif
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef enum _vt_fw_rule_type_t
+{
+	VT_RULE_MALICIOUS_FRAME = 0,
+	VT_RULE_BLACKLIST_RANGE,
+	VT_RULE_MONITOR_FRAME,
+	VT_RULE_MONITOR_PATTERN,
+	VT_RULE_MONITOR_RANGE
+}vt_fw_rule_type_t;
+
+/*!
+ * @brief Committed rule as kept in the lookup index. Frame and pattern rules have from_id == to_id, the CAN Id of
+ *        their first frame.
+ */
+typedef struct _vt_fw_rule_info_t
+{
+	uint32_t from_id;
+	uint32_t to_id;
+	uint16_t min_val;
+	uint16_t max_val;
+	uint32_t hits;           /*!< detections traced back to the rule, see vt_fw_count_rule_hit() */
+	uint8_t type;            /*!< vt_fw_rule_type_t */
+	uint8_t id_operator;     /*!< range rules, 0: in range ids, 1: not in range ids */
+}vt_fw_rule_info_t;
+
+/*------------------------------------------------------------------*
+ *                       Function Prototypes                        *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will start a bulk load of firewall rules. Rules added after this call are appended unsorted
+ *         to a staging table and are only handed to the firewall core by vt_fw_commit_bulk_load().
+ *         The staging table is carved from VT_ARENA_RULES and released at commit.
+ * @param [in]   none.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_BUSY, VT_STATUS_UNREADY or VT_STATUS_NO_MEM.
+ */
+vt_status_t vt_fw_begin_bulk_load(void);
+
+/*!
+ * @brief  This API will stage a malicious CAN frame for the black list.
+ * @param [in]   msgId - is CAN Id.
+ * @param [in]   dataLen - length of data.
+ * @param [in]	 *databuff - is data buffer.
+ * @return       status
+ */
+vt_status_t vt_fw_bulk_add_malicious_can_frame(uint32_t msgId, uint8_t dataLen, uint8_t *databuff);
+
+/*!
+ * @brief  This API will stage a range from CAN ID to CAN ID for the black list.
+ * @param [in]   fromId - is CAN Id.
+ * @param [in]   toId - is CAN Id.
+ * @param [in]	 operator - 0: in range ids, 1: not in range ids.
+ * @return       status
+ */
+vt_status_t vt_fw_bulk_blacklist_add_range_can_id(uint32_t fromId, uint32_t toId, uint8_t operator);
+
+/*!
+ * @brief  This API will stage a CAN frame for the monitor frame list.
+ * @param [in]   msgId - is CAN Id.
+ * @param [in]   dataLen - length of data.
+ * @param [in]	 *databuff - is data buffer.
+ * @param [in]	 operator - 0: in range of minimum and maximum, 1: not in range of minimum and maximum.
+ * @param [in]   min_val - is minimum of occurrence CAN frame.
+ * @param [in]   max_val - is maximum of occurrence CAN frame.
+ * @return        status
+ */
+vt_status_t vt_fw_bulk_monitor_add_can_frame(uint32_t msgId, uint8_t dataLen, uint8_t *databuff, uint8_t operator, uint16_t min_val,  uint16_t max_val);
+
+/*!
+ * @brief  This API will stage a pattern of CAN frame for the monitor pattern list.
+ * @param [in]   *frames - pointer to CAN frame array .
+ * @param [in]	 ele_size - is size of element array in a pattern.
+ * @param [in]	 operator - 0: in range of minimum and maximum, 1: not in range of minimum and maximum.
+ * @param [in]   min_val - is minimum of occurrence pattern.
+ * @param [in]   max_val - is maximum of occurrence pattern.
+ * @return        status
+ */
+vt_status_t vt_fw_bulk_monitor_add_pattern(vt_can_frame_t *frames, uint8_t ele_size, uint8_t operator, uint16_t min_val,  uint16_t max_val);
+
+/*!
+ * @brief  This API will stage a range from CAN ID to CAN ID for the monitor range list.
+ * @param [in]	 id_operator - 0: in range id, 1: not in range id.
+ * @param [in]   fromId - is CAN Id.
+ * @param [in]   toId - is CAN Id.
+ * @param [in]	 operator - 0: in range of minimum and maximum, 1: not in range of minimum and maximum.
+ * @param [in]   min_val - is minimum of occurrence range ID.
+ * @param [in]   max_val - is maximum of occurrence range ID.
+ * @return       status
+ */
+vt_status_t vt_fw_bulk_monitor_add_ids_to_range_list(uint8_t id_operator, uint32_t fromId, uint32_t toId, uint8_t operator, uint16_t min_val,  uint16_t max_val);
+
+/*!
+ * @brief  This API will finish a bulk load. The staging table is sorted once by rule type and CAN ID, duplicated
+ *         rules are dropped and the rules left are registered to the firewall core in ascending CAN ID order. The
+ *         core has no bulk API: each rule left still costs one call of vt_fw_add_*() or vt_fw_monitor_add_*().
+ *         Each rule registered gets the next rule Id, Ids of earlier commits do not change.
+ * @param [in]   none.
+ * @return       VT_STATUS_SUCCESS, the first error status returned by the firewall core, VT_STATUS_NO_MEM if the
+ *               lookup index cannot be carved from VT_ARENA_STATE, or VT_STATUS_FULL past VT_FW_RULE_INDEX_SIZE
+ *               or VT_FW_RULE_KEY_SIZE.
+ */
+vt_status_t vt_fw_commit_bulk_load(void);
+
+/*!
+ * @brief  This API will find the committed rule of a type that covers a CAN Id, in O(log N) of the lookup keys.
+ *         A pattern covers the CAN Ids of all its frames, a range rule with id_operator 1 the CAN Ids out of its
+ *         range. Of overlapping rules the one starting at the lowest CAN Id is found. Rules added straight to the
+ *         firewall core with vt_fw_add_*() are not in the index, the agent adds its rules with the bulk load.
+ * @param [in]   type - is vt_fw_rule_type_t.
+ * @param [in]   can_id - is CAN Id.
+ * @param [out]  *rule_id - pointer to rule Id.
+ * @param [out]  *info - pointer to vt_fw_rule_info_t structure, may be NULL.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL or VT_STATUS_UNMATCHED.
+ */
+vt_status_t vt_fw_find_rule(vt_fw_rule_type_t type, uint32_t can_id, uint32_t *rule_id, vt_fw_rule_info_t *info);
+
+/*!
+ * @brief  This API will count a detection of a committed rule. It is lock-free and can be called from interrupt handlers.
+ * @param [in]   rule_id - is rule Id returned by vt_fw_find_rule().
+ * @return       none.
+ */
+void vt_fw_count_rule_hit(uint32_t rule_id);
+
+/*!
+ * @brief  This API will get the number of rules in the lookup index.
+ * @param [in]   none.
+ * @return       number of rules, rule Ids go from 0 to this number - 1 in the order the rules were registered.
+ */
+uint32_t vt_fw_get_rule_count(void);
+
+/*!
+ * @brief  This API will get a committed rule and its hit count.
+ * @param [in]   rule_id - is rule Id.
+ * @param [out]  *info - pointer to vt_fw_rule_info_t structure.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL or VT_STATUS_INVALID.
+ */
+vt_status_t vt_fw_get_rule_info(uint32_t rule_id, vt_fw_rule_info_t *info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VT_FW_RULES_H_ */
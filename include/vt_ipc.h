@@ -0,0 +1,119 @@
+/*
+ * vt_ipc.h
+ *
+ * Inter-core frame channel: a ring of CAN frames in memory shared by two cores, with one producer core and one
+ * consumer core and no lock. The producer owns head, the consumer owns tail, each on its own cache line, and each
+ * side keeps a copy of the index of the other side so it reads it only when the copy says the ring is full or empty.
+ *
+ * The e200 cores of the MPC5748G do not snoop each other's data cache: place the channel and its storage in SRAM
+ * the SMPU maps cache-inhibited for both cores (VT_IPC_SHARED). Indexes are published with VT_ATOMIC_STORE, whose
+ * release barrier orders the frame before the index.
+ */
+
+#ifndef VT_IPC_H_
+#define VT_IPC_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_fw_if.h"
+
+/*------------------------------------------------------------------*
+ *                          Define macro                            *
+ *------------------------------------------------------------------*/
+/*! Cache line of the cores sharing a channel: 32 bytes on the e200z4, 64 bytes on host */
+#ifndef VT_IPC_CACHE_LINE
+#if defined(__PPC__) || defined(__powerpc__)
+#define VT_IPC_CACHE_LINE   32U
+#else
+#define VT_IPC_CACHE_LINE   64U
+#endif
+#endif
+
+/*! Placement of channels and storage, e.g. __attribute__((section(".shared_ram"))) of the linker file */
+#ifndef VT_IPC_SHARED
+#define VT_IPC_SHARED
+#endif
+
+#define VT_IPC_ALIGNED      __attribute__((aligned(VT_IPC_CACHE_LINE)))
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief Frame crossing cores, with the port it was received on and the verdict of the firewall.
+ */
+typedef struct _vt_ipc_frame_t
+{
+	vt_can_frame_t frame;
+	uint32_t time_stamp;            /*!< vt_probe_now() of the RX interrupt */
+	uint8_t instance;               /*!< FlexCAN instance the frame was received on */
+	uint8_t verdict;                /*!< 1 if malicious, set by the firewall core */
+}vt_ipc_frame_t;
+
+typedef struct _vt_ipc_channel_t
+{
+	/* Producer */
+	volatile uint32_t head VT_IPC_ALIGNED;
+	uint32_t tail_cache;            /*!< last tail read by the producer */
+	uint32_t high_water;            /*!< maximum depth seen by the producer */
+	uint32_t dropped;               /*!< frames refused because the channel was full */
+	/* Consumer */
+	volatile uint32_t tail VT_IPC_ALIGNED;
+	uint32_t head_cache;            /*!< last head read by the consumer */
+	/* Read only after init */
+	vt_ipc_frame_t *buff VT_IPC_ALIGNED;
+	uint32_t mask;                  /*!< number of frames - 1 */
+}vt_ipc_channel_t;
+
+/*------------------------------------------------------------------*
+ *                       Function Prototypes                        *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will create an empty channel, before either core uses it.
+ * @param [in]   *channel - pointer to vt_ipc_channel_t structure.
+ * @param [in]   *buff - pointer to storage of size frames.
+ * @param [in]   size - is number of frames, a power of 2.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL or VT_STATUS_INVALID.
+ */
+vt_status_t vt_ipc_init(vt_ipc_channel_t *channel, vt_ipc_frame_t *buff, uint32_t size);
+
+/*!
+ * @brief  This API will add a frame to the channel, on the producer core.
+ * @param [in]   *channel - pointer to vt_ipc_channel_t structure.
+ * @param [in]   *frame - pointer to vt_ipc_frame_t structure.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_FULL.
+ */
+vt_status_t vt_ipc_push(vt_ipc_channel_t *channel, const vt_ipc_frame_t *frame);
+
+/*!
+ * @brief  This API will get the oldest frame of the channel, on the consumer core.
+ * @param [in]   *channel - pointer to vt_ipc_channel_t structure.
+ * @param [out]  *frame - pointer to vt_ipc_frame_t structure.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_EMPTY.
+ */
+vt_status_t vt_ipc_pop(vt_ipc_channel_t *channel, vt_ipc_frame_t *frame);
+
+/*!
+ * @brief  This API will get the number of frames the producer can add without refusal, on the producer core.
+ * @param [in]   *channel - pointer to vt_ipc_channel_t structure.
+ * @return       number of free frames.
+ */
+uint32_t vt_ipc_space(vt_ipc_channel_t *channel);
+
+/*!
+ * @brief  This API will get the number of frames in the channel, from either core.
+ * @param [in]   *channel - pointer to vt_ipc_channel_t structure.
+ * @return       number of frames.
+ */
+uint32_t vt_ipc_count(const vt_ipc_channel_t *channel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VT_IPC_H_ */
@@ -0,0 +1,121 @@
+/*
+ * vt_latency.h
+ */
+
+#ifndef VT_LATENCY_H_
+#define VT_LATENCY_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_fw_if.h"
+#include "vt_arena.h"
+#include "vt_probe.h"
+
+/*------------------------------------------------------------------*
+ *                          Define macro                            *
+ *------------------------------------------------------------------*/
+/*! 1: time forwarded frames from the RX interrupt to the TX complete of the egress port */
+#ifndef VT_LATENCY_ENABLE
+#define VT_LATENCY_ENABLE 1
+#endif
+
+/*! Number of priority classes, taken from the 3 most significant bits of the CAN Id */
+#define VT_LATENCY_PRIORITY_CLASSES 8U
+
+/*! Priority argument of vt_latency_get_stats() selecting every class of a port */
+#define VT_LATENCY_ALL_PRIORITIES 0xFFU
+
+/*! Number of worst-case frames kept per port, 0 disables the trace */
+#ifndef VT_LATENCY_TRACE_SIZE
+#define VT_LATENCY_TRACE_SIZE 8U
+#endif
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief Forwarded frame kept by the outlier trace.
+ */
+typedef struct _vt_latency_trace_t
+{
+	uint32_t ticks;                 /*!< ingress to egress in ticks of the probe clock, see vt_probe_to_ns() */
+	uint32_t can_id;
+	uint32_t time_stamp;            /*!< slot tick count when the transmission completed */
+	uint32_t queue_depth;           /*!< messages still waiting in the tx queue of the port at that time */
+	uint8_t priority;               /*!< priority class of can_id */
+}vt_latency_trace_t;
+
+/*------------------------------------------------------------------*
+ *                       Function Prototypes                        *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will create the histograms and traces of the egress ports with storage carved from an arena.
+ * @param [in]   arena - is arena of a subsystem.
+ * @param [in]   ports - is number of CAN ports.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_INVALID or VT_STATUS_NO_MEM.
+ */
+vt_status_t vt_latency_init(vt_arena_id_t arena, uint8_t ports);
+
+/*!
+ * @brief  This API will get the priority class of a CAN Id, 0 is the highest priority.
+ * @param [in]   can_id - is CAN Id, Ids above 0x7FF are taken as extended.
+ * @return       priority class.
+ */
+uint8_t vt_latency_priority(uint32_t can_id);
+
+/*!
+ * @brief  This API will remember the frame handed to the transmit mailbox of a port. Call it before the send, so
+ *         the TX complete interrupt cannot run ahead of it.
+ * @param [in]   port - is egress CAN number.
+ * @param [in]   can_id - is CAN Id of the frame.
+ * @param [in]   ingress - is vt_probe_now() taken when the frame was received.
+ * @return       none.
+ */
+void vt_latency_tx_start(uint8_t port, uint32_t can_id, uint32_t ingress);
+
+/*!
+ * @brief  This API will account the frame in flight on a port to the histograms and to the trace. It must be called
+ *         from the TX complete interrupt of the port only.
+ * @param [in]   port - is egress CAN number.
+ * @param [in]   queue_depth - is number of messages waiting in the tx queue of the port.
+ * @param [in]   time_stamp - is current slot tick count.
+ * @return       none.
+ */
+void vt_latency_tx_complete(uint8_t port, uint32_t queue_depth, uint32_t time_stamp);
+
+/*!
+ * @brief  This API will get the latency histogram of a port, with min, max, p50 and p99 in nanoseconds.
+ * @param [in]   port - is egress CAN number.
+ * @param [in]   priority - is priority class, or VT_LATENCY_ALL_PRIORITIES.
+ * @param [out]  *stats - pointer to vt_probe_stats_t structure.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL, VT_STATUS_UNREADY or VT_STATUS_INVALID.
+ */
+vt_status_t vt_latency_get_stats(uint8_t port, uint8_t priority, vt_probe_stats_t *stats);
+
+/*!
+ * @brief  This API will get the worst frames of a port, the slowest first.
+ * @param [in]   port - is egress CAN number.
+ * @param [out]  *trace - pointer to array of vt_latency_trace_t structure.
+ * @param [in]   max - is number of elements of the array.
+ * @param [out]  *count - number of frames copied.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL, VT_STATUS_UNREADY or VT_STATUS_INVALID.
+ */
+vt_status_t vt_latency_get_trace(uint8_t port, vt_latency_trace_t *trace, uint32_t max, uint32_t *count);
+
+/*!
+ * @brief  This API will clear the histograms and the trace of a port.
+ * @param [in]   port - is egress CAN number.
+ * @return       none.
+ */
+void vt_latency_reset(uint8_t port);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VT_LATENCY_H_ */
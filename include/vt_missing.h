@@ -0,0 +1,90 @@
+/*
+ * vt_missing.h
+ *
+ * Missing-frame detection, e.g. an ECU silenced by a suspension attack. Every periodic Id of car_policy (a timing
+ * record with periodic set) must be seen again within VT_MISSING_INTERVALS times its max interval. The RX path only
+ * stamps the entry of the Id; the deadline of each Id is a timer of a vt_wheel.h wheel owned by the main loop, so
+ * vt_missing_process() only touches Ids whose deadline passed: an Id seen since is armed again from its last frame,
+ * a silent one is reported once with a VT_EVENT_MISSING record until it is seen again, or at each deadline while the
+ * event ring is full. On a healthy bus each Id costs one expiry per timeout, whatever the number of Ids.
+ */
+
+#ifndef VT_MISSING_H_
+#define VT_MISSING_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_event.h"
+#include "vt_wheel.h"
+
+/*------------------------------------------------------------------*
+ *                          Define macro                            *
+ *------------------------------------------------------------------*/
+/*! Number of periodic Ids tracked, must be a power of 2 */
+#ifndef VT_MISSING_MAX_IDS
+#define VT_MISSING_MAX_IDS 64U
+#endif
+
+/*! Max intervals of an Id without frame before it is missing */
+#ifndef VT_MISSING_INTERVALS
+#define VT_MISSING_INTERVALS 2U
+#endif
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef struct _vt_missing_stats_t
+{
+	uint32_t ids;                   /*!< periodic Ids tracked */
+	uint32_t untracked;             /*!< periodic Ids of the policy beyond VT_MISSING_MAX_IDS */
+	uint32_t expired;               /*!< deadlines passed, most of them for Ids seen since */
+	uint32_t missing;               /*!< VT_EVENT_MISSING records pushed */
+	uint32_t resumed;               /*!< missing Ids seen again */
+}vt_missing_stats_t;
+
+/*------------------------------------------------------------------*
+ *                       Function Prototypes                        *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will create the table of the periodic Ids of a policy with storage carved from an arena, and arm
+ *         the deadline of each one. Ids never seen are not reported.
+ * @param [in]   arena - is arena of a subsystem.
+ * @param [in]   *policy - pointer to the policy, see car_policy.
+ * @param [in]   now - is current slot tick count.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL, VT_STATUS_UNSUPPORTED, VT_STATUS_INVALID or VT_STATUS_NO_MEM.
+ */
+vt_status_t vt_missing_init(vt_arena_id_t arena, const uint8_t *policy, uint32_t now);
+
+/*!
+ * @brief  This API will stamp a received frame, from the RX interrupt or the main loop.
+ * @param [in]   can_id - is CAN Id.
+ * @param [in]   now - is current slot tick count.
+ * @return       none.
+ */
+void vt_missing_rcv(uint32_t can_id, uint32_t now);
+
+/*!
+ * @brief  This API will check the Ids whose deadline passed and push a VT_EVENT_MISSING record for each silent one,
+ *         in the main loop.
+ * @param [in]   now - is current slot tick count.
+ * @return       none.
+ */
+void vt_missing_process(uint32_t now);
+
+/*!
+ * @brief  This API will get counters of the missing-frame detection.
+ * @param [out]  *stats - pointer to vt_missing_stats_t structure.
+ * @return       none.
+ */
+void vt_missing_get_stats(vt_missing_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VT_MISSING_H_ */
@@ -0,0 +1,78 @@
+/*
+ * vt_osal.h
+ *
+ * Wakeup of the firewall task: interrupts signal it, and it sleeps in vt_osal_wait() until a signal or a timeout
+ * instead of spinning. Signals do not count, any number of them before a wait wakes it once. One port is built in
+ * with VT_OSAL:
+ *   - VT_OSAL_BAREMETAL: a flag and the e200 wait instruction, the PIT interrupt wakes the core every slot tick so
+ *     timeouts are rounded up to slot ticks;
+ *   - VT_OSAL_FREERTOS: a direct to task notification of the task that called vt_osal_init();
+ *   - VT_OSAL_PTHREAD: a condition variable on CLOCK_MONOTONIC, the default on host.
+ */
+
+#ifndef VT_OSAL_H_
+#define VT_OSAL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_fw_if.h"
+
+/*------------------------------------------------------------------*
+ *                          Define macro                            *
+ *------------------------------------------------------------------*/
+#define VT_OSAL_BAREMETAL       0
+#define VT_OSAL_FREERTOS        1
+#define VT_OSAL_PTHREAD         2
+
+#ifndef VT_OSAL
+#if defined(__PPC__) || defined(__powerpc__)
+#define VT_OSAL                 VT_OSAL_BAREMETAL
+#else
+#define VT_OSAL                 VT_OSAL_PTHREAD
+#endif
+#endif
+
+/*! Timeout of vt_osal_wait() waiting for a signal only */
+#define VT_OSAL_WAIT_FOREVER    0xFFFFFFFFU
+
+/*------------------------------------------------------------------*
+ *                       Function Prototypes                        *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will prepare the wakeup, in the task that waits.
+ * @param [in]   none.
+ * @return       none.
+ */
+void vt_osal_init(void);
+
+/*!
+ * @brief  This API will wake the waiting task, from a task.
+ * @param [in]   none.
+ * @return       none.
+ */
+void vt_osal_signal(void);
+
+/*!
+ * @brief  This API will wake the waiting task, from an interrupt.
+ * @param [in]   none.
+ * @return       none.
+ */
+void vt_osal_signal_from_isr(void);
+
+/*!
+ * @brief  This API will sleep until a signal or a timeout. A signal given since the previous wait returns at once.
+ * @param [in]   timeout_us - is timeout in microseconds, or VT_OSAL_WAIT_FOREVER.
+ * @return       VT_STATUS_SUCCESS if signalled, VT_STATUS_TIMEOUT otherwise.
+ */
+vt_status_t vt_osal_wait(uint32_t timeout_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VT_OSAL_H_ */
@@ -0,0 +1,104 @@
+/*
+ * vt_policy.h
+ *
+ * Reader of the timing records of car_policy, shared by the subsystems keyed by the Ids of the policy. The policy is
+ * big endian (see host/tools/vt_learn.c): a header of the total length, the version and the number of timing
+ * records, then the records of VT_POLICY_RECORD_SIZE bytes. vt_policy_get_timing() checks the header before a record
+ * is read.
+ *
+ * vt_policy_index_t maps the Ids to the table of the caller: an open addressing hash of twice the size of the table,
+ * Fibonacci hashed and probed linearly, so it is never more than half full and a lookup is O(1). It is built in
+ * init and only read afterwards, from any context.
+ */
+
+#ifndef VT_POLICY_H_
+#define VT_POLICY_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_fw_if.h"
+#include "vt_arena.h"
+
+/*------------------------------------------------------------------*
+ *                          Define macro                            *
+ *------------------------------------------------------------------*/
+#define VT_POLICY_VERSION           1U
+#define VT_POLICY_HEADER_SIZE       12U
+#define VT_POLICY_RECORD_SIZE       31U
+
+/*! Offsets of the fields of a timing record */
+#define VT_POLICY_RECORD_ID         4U
+#define VT_POLICY_RECORD_MAX        14U
+/*! f32 tolerance, read by the core only */
+#define VT_POLICY_RECORD_TOLERANCE  18U
+#define VT_POLICY_RECORD_PERIODIC   22U
+#define VT_POLICY_RECORD_MAX_FRAMES 27U
+
+/*! Index of no entry */
+#define VT_POLICY_NONE              0xFFFFU
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef struct _vt_policy_index_t
+{
+	uint32_t *keys;                 /*!< CAN Id of each slot */
+	uint16_t *slots;                /*!< entry of the table of the caller, VT_POLICY_NONE when empty */
+	uint32_t mask;                  /*!< slots minus 1 */
+}vt_policy_index_t;
+
+/*------------------------------------------------------------------*
+ *                       Function Prototypes                        *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will read a big endian word of the policy.
+ * @param [in]   *buff - pointer to the word.
+ * @return       the word.
+ */
+uint32_t vt_policy_get_u32(const uint8_t *buff);
+
+/*!
+ * @brief  This API will check the header of a policy and find its timing records.
+ * @param [in]   *policy - pointer to the policy, see car_policy.
+ * @param [out]  **records - pointer to the first timing record.
+ * @param [out]  *count - number of timing records.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL, VT_STATUS_UNSUPPORTED or VT_STATUS_INVALID.
+ */
+vt_status_t vt_policy_get_timing(const uint8_t *policy, const uint8_t **records, uint32_t *count);
+
+/*!
+ * @brief  This API will create an empty index of a table with storage carved from an arena.
+ * @param [out]  *index - pointer to vt_policy_index_t structure.
+ * @param [in]   arena - is arena of a subsystem.
+ * @param [in]   max_ids - is number of entries of the table, a power of 2 below VT_POLICY_NONE / 2.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL, VT_STATUS_INVALID or VT_STATUS_NO_MEM.
+ */
+vt_status_t vt_policy_index_create(vt_policy_index_t *index, vt_arena_id_t arena, uint32_t max_ids);
+
+/*!
+ * @brief  This API will add the entry of a CAN Id not in the index yet, in init.
+ * @param [in]   *index - pointer to vt_policy_index_t structure.
+ * @param [in]   can_id - is CAN Id.
+ * @param [in]   entry - is index of the entry in the table, below max_ids.
+ * @return       none.
+ */
+void vt_policy_index_add(vt_policy_index_t *index, uint32_t can_id, uint16_t entry);
+
+/*!
+ * @brief  This API will find the entry of a CAN Id.
+ * @param [in]   *index - pointer to vt_policy_index_t structure.
+ * @param [in]   can_id - is CAN Id.
+ * @return       index of the entry in the table, or VT_POLICY_NONE.
+ */
+uint16_t vt_policy_index_find(const vt_policy_index_t *index, uint32_t can_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VT_POLICY_H_ */
@@ -0,0 +1,187 @@
+/*
+ * vt_probe.h
+ */
+
+#ifndef VT_PROBE_H_
+#define VT_PROBE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_fw_if.h"
+#if !defined(__PPC__) && !defined(__powerpc__)
+#include <time.h>
+#endif
+
+/*------------------------------------------------------------------*
+ *                          Define macro                            *
+ *------------------------------------------------------------------*/
+/*! 1: build the hot-path probes in, 0: every probe macro expands to nothing */
+#ifndef VT_PROBE_ENABLE
+#define VT_PROBE_ENABLE 0
+#endif
+
+/*! Frequency of the probe clock: the e200 timebase runs at the core clock, the host clock counts nanoseconds */
+#ifndef VT_PROBE_TICK_HZ
+#if defined(__PPC__) || defined(__powerpc__)
+#define VT_PROBE_TICK_HZ 160000000UL
+#else
+#define VT_PROBE_TICK_HZ 1000000000UL
+#endif
+#endif
+
+/*! Number of log2 buckets, bucket b counts durations in [2^(b-1), 2^b) ticks, bucket 0 counts 0 */
+#define VT_PROBE_BUCKETS 33U
+
+#if VT_PROBE_ENABLE
+/*! Start a probe: declares a local holding the start time */
+#define VT_PROBE_START(var)      uint32_t var = vt_probe_now()
+/*! Stop a probe and account the duration to a histogram */
+#define VT_PROBE_END(id, var)    vt_probe_record((id), vt_probe_now() - (var))
+#else
+#define VT_PROBE_START(var)
+#define VT_PROBE_END(id, var)
+#endif
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef enum _vt_probe_id_t
+{
+	VT_PROBE_RCV_CALLBACK = 0,      /*!< vt_rcv_callback */
+	VT_PROBE_FW_RCV_MSG,            /*!< vt_fw_rcv_msg */
+	VT_PROBE_FW_IS_MALICIOUS,       /*!< vt_fw_can_msg_is_malicious */
+	VT_PROBE_FW_PROCESS,            /*!< vt_fw_process */
+	VT_PROBE_PIT_IRQ,               /*!< PIT_Ch0_IRQHandler */
+	VT_PROBE_MAX
+}vt_probe_id_t;
+
+/*!
+ * @brief Log2 histogram of durations in ticks of the probe clock. A histogram may be recorded from several
+ *        interrupts and the main loop, every word is updated atomically.
+ */
+typedef struct _vt_probe_hist_t
+{
+	uint32_t count;
+	uint32_t min;
+	uint32_t max;
+	uint32_t buckets[VT_PROBE_BUCKETS];
+}vt_probe_hist_t;
+
+typedef struct _vt_probe_stats_t
+{
+	uint32_t count;                 /*!< durations recorded */
+	uint32_t min_ns;
+	uint32_t max_ns;
+	uint32_t p50_ns;                /*!< upper edge of the bucket holding the median */
+	uint32_t p99_ns;                /*!< upper edge of the bucket holding the 99th percentile */
+	uint32_t buckets[VT_PROBE_BUCKETS];
+}vt_probe_stats_t;
+
+/*------------------------------------------------------------------*
+ *                       Function Prototypes                        *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will read the probe clock. Differences are valid for durations up to 2^32 ticks.
+ * @param [in]   none.
+ * @return       tick count.
+ */
+static inline uint32_t vt_probe_now(void)
+{
+#if defined(__PPC__) || defined(__powerpc__)
+	uint32_t tbl;
+
+	/* TBL, readable from user mode */
+	__asm__ volatile ("mfspr %0, 268" : "=r" (tbl));
+	return tbl;
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+#endif
+}
+
+/*!
+ * @brief  This API will start the probe clock. On target it enables the timebase, it is a no-op on host.
+ * @param [in]   none.
+ * @return       none.
+ */
+void vt_probe_clock_init(void);
+
+/*!
+ * @brief  This API will clear every histogram and start the timebase on target.
+ * @param [in]   none.
+ * @return       none.
+ */
+void vt_probe_init(void);
+
+/*!
+ * @brief  This API will clear a histogram.
+ * @param [out]  *hist - pointer to vt_probe_hist_t structure.
+ * @return       none.
+ */
+void vt_probe_hist_reset(vt_probe_hist_t *hist);
+
+/*!
+ * @brief  This API will account a duration to a histogram.
+ * @param [in]   *hist - pointer to vt_probe_hist_t structure.
+ * @param [in]   ticks - is duration in ticks of the probe clock.
+ * @return       none.
+ */
+void vt_probe_hist_record(vt_probe_hist_t *hist, uint32_t ticks);
+
+/*!
+ * @brief  This API will get a histogram with min, max, p50 and p99 in nanoseconds.
+ * @param [in]   *hist - pointer to vt_probe_hist_t structure.
+ * @param [out]  *stats - pointer to vt_probe_stats_t structure.
+ * @return       none.
+ */
+void vt_probe_hist_get_stats(const vt_probe_hist_t *hist, vt_probe_stats_t *stats);
+
+/*!
+ * @brief  This API will convert ticks of the probe clock to nanoseconds, saturated to 32 bits.
+ * @param [in]   ticks - is ticks.
+ * @return       nanoseconds.
+ */
+uint32_t vt_probe_to_ns(uint32_t ticks);
+
+/*!
+ * @brief  This API will account a duration to the histogram of a probe, from any context.
+ * @param [in]   id - is probe.
+ * @param [in]   ticks - is duration in ticks of the probe clock.
+ * @return       none.
+ */
+void vt_probe_record(vt_probe_id_t id, uint32_t ticks);
+
+/*!
+ * @brief  This API will get the histogram of a probe with min, max, p50 and p99 in nanoseconds.
+ * @param [in]   id - is probe.
+ * @param [out]  *stats - pointer to vt_probe_stats_t structure.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL or VT_STATUS_INVALID.
+ */
+vt_status_t vt_probe_get_stats(vt_probe_id_t id, vt_probe_stats_t *stats);
+
+/*!
+ * @brief  This API will clear the histogram of a probe.
+ * @param [in]   id - is probe.
+ * @return       none.
+ */
+void vt_probe_reset(vt_probe_id_t id);
+
+/*!
+ * @brief  This API will get the display name of a probe.
+ * @param [in]   id - is probe.
+ * @return       name.
+ */
+const char *vt_probe_name(uint8_t id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VT_PROBE_H_ */
@@ -0,0 +1,74 @@
+/*
+ * vt_queue.h
+ */
+
+#ifndef VT_QUEUE_H_
+#define VT_QUEUE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_fw_if.h"
+#include "vt_arena.h"
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief CAN message queue with one producer and one consumer (e.g. RX interrupt of a port and TX complete
+ *        interrupt of the other port). The storage is carved from an arena at init.
+ */
+typedef struct _vt_msg_queue_t
+{
+	vt_msgbuff_t *buff;              /*!< storage of size elements */
+	uint32_t size;                   /*!< number of elements */
+	volatile uint32_t head;          /*!< written by producer only */
+	volatile uint32_t tail;          /*!< written by consumer only */
+	uint32_t high_water;             /*!< maximum depth seen by producer */
+	uint32_t dropped;                /*!< messages refused because the queue was full */
+}vt_msg_queue_t;
+
+/*------------------------------------------------------------------*
+ *                       Function Prototypes                        *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will create a message queue with storage carved from an arena.
+ * @param [in]   *queue - pointer to vt_msg_queue_t structure.
+ * @param [in]   arena - is arena of a subsystem.
+ * @param [in]   size - is number of messages.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_NO_MEM.
+ */
+vt_status_t vt_queue_create(vt_msg_queue_t *queue, vt_arena_id_t arena, uint32_t size);
+
+/*!
+ * @brief  This API will add a CAN message to the queue.
+ * @param [in]   *queue - pointer to vt_msg_queue_t structure.
+ * @param [in]   *msg - pointer to message.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_FULL.
+ */
+vt_status_t vt_queue_push(vt_msg_queue_t *queue, const vt_msgbuff_t *msg);
+
+/*!
+ * @brief  This API will get the oldest CAN message from the queue.
+ * @param [in]   *queue - pointer to vt_msg_queue_t structure.
+ * @param [out]  *msg - pointer to message.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_EMPTY.
+ */
+vt_status_t vt_queue_pop(vt_msg_queue_t *queue, vt_msgbuff_t *msg);
+
+/*!
+ * @brief  This API will get number of messages in the queue.
+ * @param [in]   *queue - pointer to vt_msg_queue_t structure.
+ * @return       number of messages.
+ */
+uint32_t vt_queue_count(const vt_msg_queue_t *queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VT_QUEUE_H_ */
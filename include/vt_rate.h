@@ -0,0 +1,90 @@
+/*
+ * vt_rate.h
+ *
+ * Rates of the agent (slot, pattern and vector matched rates) in fixed-point, 1.0 is VT_RATE_ONE. The core hands
+ * them over as float; vt_rate_from_float() converts with integer operations only, so the callbacks reachable from
+ * interrupts touch no floating-point register and the host and the target get the same bits. The scale is the one
+ * of the wire format, the records are sent as they are.
+ *
+ * The policy is not converted. Every timing record of car_policy holds an f32 tolerance, VT_POLICY_RECORD_TOLERANCE,
+ * the IEEE-754 bits vt_learn writes. The agent never reads it: the closed core does, in its window evaluation, so the
+ * field is part of the policy format of the core and stays float.
+ */
+
+#ifndef VT_RATE_H_
+#define VT_RATE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include <stdint.h>
+#include <string.h>
+
+/*------------------------------------------------------------------*
+ *                          Define macro                            *
+ *------------------------------------------------------------------*/
+/*! Rate 1.0, a unit is 0.01% */
+#define VT_RATE_ONE             10000U
+/*! Largest rate, larger ones saturate */
+#define VT_RATE_MAX             0xFFFFU
+
+/*! Rate num/den, for constants */
+#define VT_RATE(num, den)       ((vt_rate_t)(((num) * VT_RATE_ONE) / (den)))
+
+/*! Whole and fractional parts of a rate in percent, printed with "%lu.%02lu%%" */
+#define VT_RATE_PERCENT(rate)       ((unsigned long)((rate) / (VT_RATE_ONE / 100U)))
+#define VT_RATE_PERCENT_FRAC(rate)  ((unsigned long)((rate) % (VT_RATE_ONE / 100U)))
+/*! Whole and fractional parts of a rate, printed with "%lu.%04lu" */
+#define VT_RATE_WHOLE(rate)         ((unsigned long)((rate) / VT_RATE_ONE))
+#define VT_RATE_FRAC(rate)          ((unsigned long)((rate) % VT_RATE_ONE))
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef uint16_t vt_rate_t;
+
+/*------------------------------------------------------------------*
+ *                       Function Prototypes                        *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will convert a rate of the core to fixed-point, rounded to nearest with ties up. Negative rates,
+ *         NaN and subnormals give 0, rates from VT_RATE_MAX / VT_RATE_ONE up and infinity give VT_RATE_MAX.
+ * @param [in]   rate - is rate as IEEE-754 single.
+ * @return       fixed-point rate.
+ */
+static inline vt_rate_t vt_rate_from_float(float rate)
+{
+	uint32_t bits;
+	uint32_t exponent;
+	uint64_t value;
+	int32_t shift;
+
+	/* Read the encoding, the value is never loaded into a floating-point register */
+	memcpy(&bits, &rate, sizeof(bits));
+	exponent = (bits >> 23) & 0xFFU;
+	if((bits & 0x80000000U) != 0 || exponent == 0)
+		return 0;
+	if(exponent == 0xFFU)
+		return ((bits & 0x007FFFFFU) != 0) ? 0 : VT_RATE_MAX;
+
+	/* rate = mantissa * 2^(exponent - 150) */
+	value = (uint64_t)((bits & 0x007FFFFFU) | 0x00800000U) * VT_RATE_ONE;
+	shift = 150 - (int32_t)exponent;
+	if(shift <= 0)
+		return VT_RATE_MAX;
+	if(shift > 63)
+		return 0;
+	value = (value + (1ULL << (shift - 1))) >> shift;
+
+	return (value > VT_RATE_MAX) ? VT_RATE_MAX : (vt_rate_t)value;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VT_RATE_H_ */
@@ -0,0 +1,130 @@
+/*
+ * vt_ratelimit.h
+ *
+ * Per-Id rate enforcement of the gateway. Each Id with a timing record in car_policy has a token bucket per ingress
+ * port, filled at VT_RATELIMIT_MARGIN times the max frames per window of the record and holding VT_RATELIMIT_BURST
+ * frames, so a flood on one bus never takes the budget of the same Id on another. A frame to forward takes a token
+ * of the bucket of its port. Without one it is dropped at once in VT_RATELIMIT_ENFORCE mode, or only counted in
+ * VT_RATELIMIT_MONITOR mode. The check is a hash probe and integer arithmetic in the RX interrupt, before the
+ * forward queue, so a flood is cut at its first frames instead of at the end of the traffic status window of the
+ * core. Ids without a timing record pass.
+ *
+ * The RX interrupts of the ports, and the verdict interrupts with VT_FW_DUAL_CORE, may preempt each other on the
+ * same bucket. A check marks the bucket busy while it updates it; one finding it busy cannot wait for the check it
+ * preempted, so its frame passes untouched and is counted as contended.
+ */
+
+#ifndef VT_RATELIMIT_H_
+#define VT_RATELIMIT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_fw_if.h"
+#include "vt_arena.h"
+
+/*------------------------------------------------------------------*
+ *                          Define macro                            *
+ *------------------------------------------------------------------*/
+/*! Number of Ids with a bucket, must be a power of 2 */
+#ifndef VT_RATELIMIT_MAX_IDS
+#define VT_RATELIMIT_MAX_IDS 64U
+#endif
+
+/*! Frames an Id may send back to back after a silence */
+#ifndef VT_RATELIMIT_BURST
+#define VT_RATELIMIT_BURST 4U
+#endif
+
+/*! Rate allowed, in multiples of the max frames per window of the policy */
+#ifndef VT_RATELIMIT_MARGIN
+#define VT_RATELIMIT_MARGIN 2U
+#endif
+
+/*! Window of the max frames of a timing record, the traffic status window of the core */
+#ifndef VT_RATELIMIT_WINDOW_MS
+#define VT_RATELIMIT_WINDOW_MS 60000U
+#endif
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef enum _vt_ratelimit_mode_t
+{
+	VT_RATELIMIT_ENFORCE = 0,       /*!< frames over the rate are dropped */
+	VT_RATELIMIT_MONITOR            /*!< frames over the rate are counted and forwarded */
+}vt_ratelimit_mode_t;
+
+/*!
+ * @brief Bucket of an Id, read with vt_ratelimit_get_info().
+ */
+typedef struct _vt_ratelimit_info_t
+{
+	uint32_t can_id;
+	uint32_t max_frames;            /*!< max frames per window of the policy */
+	uint32_t passed;                /*!< frames within the rate */
+	uint32_t dropped;               /*!< frames over the rate, forwarded anyway in monitor mode */
+}vt_ratelimit_info_t;
+
+typedef struct _vt_ratelimit_stats_t
+{
+	uint32_t ids;                   /*!< Ids with a bucket */
+	uint32_t untracked;             /*!< Ids of the policy beyond VT_RATELIMIT_MAX_IDS */
+	uint32_t passed;                /*!< frames of all buckets within the rate */
+	uint32_t dropped;               /*!< frames of all buckets over the rate */
+	uint32_t contended;             /*!< frames passed unchecked, their bucket was being updated */
+}vt_ratelimit_stats_t;
+
+/*------------------------------------------------------------------*
+ *                       Function Prototypes                        *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will create a full bucket for each Id of a policy with storage carved from an arena. The mode is
+ *         VT_RATELIMIT_ENFORCE.
+ * @param [in]   arena - is arena of a subsystem.
+ * @param [in]   *policy - pointer to the policy, see car_policy.
+ * @param [in]   now - is current slot tick count.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL, VT_STATUS_UNSUPPORTED, VT_STATUS_INVALID or VT_STATUS_NO_MEM.
+ */
+vt_status_t vt_ratelimit_init(vt_arena_id_t arena, const uint8_t *policy, uint32_t now);
+
+/*!
+ * @brief  This API will choose what happens to frames over the rate.
+ * @param [in]   mode - is vt_ratelimit_mode_t.
+ * @return       VT_STATUS_SUCCESS or VT_STATUS_INVALID.
+ */
+vt_status_t vt_ratelimit_set_mode(vt_ratelimit_mode_t mode);
+
+/*!
+ * @brief  This API will take a token of the bucket of a frame to forward, from the RX interrupt.
+ * @param [in]   port - is CAN number the frame was received on (e.g: 0, 1, 2).
+ * @param [in]   can_id - is CAN Id.
+ * @param [in]   now - is current slot tick count.
+ * @return       VT_STATUS_SUCCESS to forward the frame, VT_STATUS_FULL to drop it.
+ */
+vt_status_t vt_ratelimit_check(uint8_t port, uint32_t can_id, uint32_t now);
+
+/*!
+ * @brief  This API will get the bucket of an Id.
+ * @param [in]   index - is index of the bucket, below the ids of vt_ratelimit_stats_t.
+ * @param [out]  *info - pointer to vt_ratelimit_info_t structure.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_NULL or VT_STATUS_INVALID.
+ */
+vt_status_t vt_ratelimit_get_info(uint32_t index, vt_ratelimit_info_t *info);
+
+/*!
+ * @brief  This API will get counters of the rate enforcement.
+ * @param [out]  *stats - pointer to vt_ratelimit_stats_t structure.
+ * @return       none.
+ */
+void vt_ratelimit_get_stats(vt_ratelimit_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VT_RATELIMIT_H_ */
@@ -55,6 +55,20 @@ extern pit_channel_config_t vt_pit_ChnConfig0;
  */
 void vt_timer_init(uint32_t instance, pit_channel_config_t *channel_config);
 
+/*!
+ * @brief  This API will get number of slot ticks since the timer started. A tick is VT_PIT_PERIOD microsecond.
+ * @param [in]   none.
+ * @return       tick count.
+ */
+uint32_t vt_timer_get_ticks(void);
+
+/*!
+ * @brief  This API will get the time left until a slot tick count.
+ * @param [in]   tick - is slot tick count, e.g. a deadline of vt_fw_process_until_idle().
+ * @return       microseconds, 0 if the tick count has passed.
+ */
+uint32_t vt_timer_us_until(uint32_t tick);
+
 /*------------------------------------------------------------------*
  *                Test Function and Examples                        *
  *------------------------------------------------------------------*/
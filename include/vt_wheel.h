@@ -0,0 +1,111 @@
+/*
+ * vt_wheel.h
+ *
+ * Hierarchical timer wheel in slot ticks: VT_WHEEL_LEVELS wheels of VT_WHEEL_SLOTS slots, each slot of a level spans
+ * a whole turn of the level below. A timer is linked into the slot of its deadline in O(1), a level is moved down
+ * one slot at a time when the level below turns, and vt_wheel_advance() only touches the timers of the ticks it
+ * passes; runs of empty ticks of the first level are skipped with a bitmap of its occupied slots. Deadlines beyond VT_WHEEL_RANGE ticks wait in the last slot of the top level and are placed again.
+ *
+ * Timers are an array carved from an arena at create and linked by index; the caller keeps its own state in an array
+ * of the same size. A wheel is used from one context only.
+ */
+
+#ifndef VT_WHEEL_H_
+#define VT_WHEEL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_fw_if.h"
+#include "vt_arena.h"
+
+/*------------------------------------------------------------------*
+ *                          Define macro                            *
+ *------------------------------------------------------------------*/
+#define VT_WHEEL_SLOT_BITS      6U
+#define VT_WHEEL_SLOTS          (1U << VT_WHEEL_SLOT_BITS)
+#define VT_WHEEL_LEVELS         3U
+/*! Ticks ahead a deadline is placed exactly, 52 s with the 200 us slot tick */
+#define VT_WHEEL_RANGE          (1UL << (VT_WHEEL_SLOT_BITS * VT_WHEEL_LEVELS))
+
+/*! Index of no timer */
+#define VT_WHEEL_NONE           0xFFFFU
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef struct _vt_wheel_timer_t
+{
+	uint32_t deadline;              /*!< slot tick count */
+	uint16_t next;
+	uint16_t prev;
+	uint8_t slot;                   /*!< level * VT_WHEEL_SLOTS + slot of the level */
+	uint8_t armed;
+}vt_wheel_timer_t;
+
+typedef struct _vt_wheel_t
+{
+	vt_wheel_timer_t *timers;       /*!< storage of count timers */
+	uint16_t count;
+	uint32_t next_tick;             /*!< next tick vt_wheel_advance() expires */
+	uint16_t armed;                 /*!< timers armed */
+	uint32_t expired;               /*!< timers expired since init */
+	uint32_t cascaded;              /*!< timers moved down a level since init */
+	uint16_t heads[VT_WHEEL_LEVELS * VT_WHEEL_SLOTS + 1U];  /*!< lists of the slots, then the list being expired */
+	uint32_t pending[VT_WHEEL_SLOTS / 32U];                 /*!< occupied slots of the first level */
+}vt_wheel_t;
+
+/*!
+ * @brief Called for each timer whose deadline passed, unarmed. It may arm it again.
+ */
+typedef void (* vt_wheel_callback)(vt_wheel_t *wheel, uint16_t timer, uint32_t now);
+
+/*------------------------------------------------------------------*
+ *                       Function Prototypes                        *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will create a timer wheel with storage of its timers carved from an arena. No timer is armed.
+ * @param [in]   *wheel - pointer to vt_wheel_t structure.
+ * @param [in]   arena - is arena of a subsystem.
+ * @param [in]   count - is number of timers, below VT_WHEEL_NONE.
+ * @param [in]   now - is current slot tick count.
+ * @return       VT_STATUS_SUCCESS, VT_STATUS_INVALID or VT_STATUS_NO_MEM.
+ */
+vt_status_t vt_wheel_create(vt_wheel_t *wheel, vt_arena_id_t arena, uint16_t count, uint32_t now);
+
+/*!
+ * @brief  This API will arm a timer, or move it if it is armed. A deadline already passed expires with the next
+ *         tick.
+ * @param [in]   *wheel - pointer to vt_wheel_t structure.
+ * @param [in]   timer - is index of the timer.
+ * @param [in]   deadline - is slot tick count.
+ * @return       none.
+ */
+void vt_wheel_schedule(vt_wheel_t *wheel, uint16_t timer, uint32_t deadline);
+
+/*!
+ * @brief  This API will disarm a timer.
+ * @param [in]   *wheel - pointer to vt_wheel_t structure.
+ * @param [in]   timer - is index of the timer.
+ * @return       none.
+ */
+void vt_wheel_cancel(vt_wheel_t *wheel, uint16_t timer);
+
+/*!
+ * @brief  This API will expire the timers of every tick up to now, in order of their deadlines.
+ * @param [in]   *wheel - pointer to vt_wheel_t structure.
+ * @param [in]   now - is current slot tick count.
+ * @param [in]   callback - is called for each expired timer.
+ * @return       number of timers expired.
+ */
+uint32_t vt_wheel_advance(vt_wheel_t *wheel, uint32_t now, vt_wheel_callback callback);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VT_WHEEL_H_ */
@@ -0,0 +1,123 @@
+/*
+ * vt_wire.h
+ */
+
+#ifndef VT_WIRE_H_
+#define VT_WIRE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------------------------------------*
+ *                           Includes                               *
+ *------------------------------------------------------------------*/
+#include "vt_event.h"
+
+/*------------------------------------------------------------------*
+ *                          Define macro                            *
+ *------------------------------------------------------------------*/
+/*
+ * Frame on the wire: COBS(payload | CRC-16/CCITT-FALSE big-endian) followed by a 0x00 delimiter.
+ *
+ * Payload:
+ *   tag        u8      vt_event_type_t, VT_WIRE_TAG_ABSOLUTE set when the timestamp is absolute
+ *   timestamp  varint  slot ticks, absolute or delta to the previous frame
+ *   fields     per type, multi-byte integers are big-endian, varints are unsigned LEB128
+ *     VT_EVENT_TRAFFIC_STATUS  u8 car_status, u16 slot_rate, u16 pattern_rate, varint count_frames
+ *     VT_EVENT_VECTOR          u8 matched_flag, u16 matched_rate, varint in_rl, varint in_rt, varint all
+ *     VT_EVENT_BLACKLIST       u8 rule_type, u8 matched_bit, varint rule_id + 1, varint can_id + 1,
+ *                              u16 min_val, u16 max_val (unknown Ids wrap to 0)
+ *     VT_EVENT_MONITOR         same as VT_EVENT_BLACKLIST
+ *     VT_EVENT_DROPPED         varint dropped
+ *     VT_EVENT_SUMMARY         u8 rule_type, varint rule_id + 1, varint can_id + 1, varint count,
+ *                              varint timestamp - first_ts, varint last_ts - first_ts, varint peak_rate
+ *     VT_EVENT_PROBE           u8 probe, varint count, varint min_ns, varint max_ns, varint p99_ns
+ *     VT_EVENT_MISSING         varint can_id, varint timestamp - last_ts, varint timeout
+ *   Rates are vt_rate_t, fixed-point in units of 1/VT_RATE_ONE (see vt_rate.h).
+ */
+#define VT_WIRE_TAG_ABSOLUTE        0x80U
+#define VT_WIRE_TAG_TYPE_MASK       0x7FU
+
+/*! An absolute timestamp is sent every VT_WIRE_SYNC_INTERVAL frames so a late host can pick up the time base */
+#ifndef VT_WIRE_SYNC_INTERVAL
+#define VT_WIRE_SYNC_INTERVAL       64U
+#endif
+
+/*! Tag, timestamp, the largest record (VT_EVENT_SUMMARY, 31 bytes) and CRC */
+#define VT_WIRE_MAX_PAYLOAD         (1U + 5U + (1U + 6U * 5U) + 2U)
+/*! Worst case of a framed event: COBS adds one byte per 254, plus the leading code byte and the delimiter */
+#define VT_WIRE_MAX_FRAME           (VT_WIRE_MAX_PAYLOAD + (VT_WIRE_MAX_PAYLOAD / 254U) + 2U)
+
+/*------------------------------------------------------------------*
+ *                Define Enumeration and Structure                  *
+ *------------------------------------------------------------------*/
+typedef struct _vt_wire_encoder_t
+{
+	uint32_t time_stamp;            /*!< timestamp of the previous frame */
+	uint32_t count;                 /*!< frames encoded since init */
+}vt_wire_encoder_t;
+
+typedef struct _vt_wire_decoder_t
+{
+	uint8_t buff[VT_WIRE_MAX_FRAME];
+	uint32_t pos;
+	uint8_t overflow;               /*!< current frame is too long, drop it at the next delimiter */
+	uint8_t synced;                 /*!< an absolute timestamp has been received since the last frame lost */
+	uint32_t time_stamp;            /*!< timestamp of the previous frame */
+	uint32_t frames;                /*!< frames decoded */
+	uint32_t unsynced;              /*!< frames decoded on an unknown time base */
+	uint32_t crc_errors;            /*!< frames dropped because of a bad CRC */
+	uint32_t format_errors;         /*!< frames dropped because of a bad length or an unknown type */
+}vt_wire_decoder_t;
+
+/*------------------------------------------------------------------*
+ *                       Function Prototypes                        *
+ *------------------------------------------------------------------*/
+/*!
+ * @brief  This API will reset an encoder. The next frame carries an absolute timestamp.
+ * @param [in]   *enc - pointer to vt_wire_encoder_t structure.
+ * @return       none.
+ */
+void vt_wire_encoder_init(vt_wire_encoder_t *enc);
+
+/*!
+ * @brief  This API will encode an event record to a frame, delimiter included.
+ * @param [in]   *enc - pointer to vt_wire_encoder_t structure.
+ * @param [in]   *event - pointer to vt_event_t structure.
+ * @param [out]  *out - pointer to output buffer.
+ * @param [in]   len - size of output buffer.
+ * @param [out]  *size - length of the frame.
+ * @return       VT_STATUS_SUCCESS,
+ *               VT_STATUS_INVALID if the event type is unknown,
+ *               or VT_STATUS_SMALL_BUFF if the frame does not fit, the encoder is left unchanged.
+ */
+vt_status_t vt_wire_encode_event(vt_wire_encoder_t *enc, const vt_event_t *event, uint8_t *out, uint32_t len, uint32_t *size);
+
+/*!
+ * @brief  This API will reset a decoder.
+ * @param [in]   *dec - pointer to vt_wire_decoder_t structure.
+ * @return       none.
+ */
+void vt_wire_decoder_init(vt_wire_decoder_t *dec);
+
+/*!
+ * @brief  This API will feed one byte of the stream to a decoder.
+ * @param [in]   *dec - pointer to vt_wire_decoder_t structure.
+ * @param [in]   byte - is received byte.
+ * @param [out]  *event - pointer to vt_event_t structure, valid when VT_STATUS_SUCCESS is returned.
+ * @return       VT_STATUS_SUCCESS when a frame is decoded,
+ *               VT_STATUS_UNREADY when a frame is decoded but its timestamps are not known: it carries a delta and
+ *               no absolute timestamp came since the decoder was reset or a frame was lost. The timestamps are
+ *               off by the deltas missed until the next absolute one, every VT_WIRE_SYNC_INTERVAL frames,
+ *               VT_STATUS_EMPTY if more bytes are needed,
+ *               VT_STATUS_RCV_ERROR if the frame is dropped because of a bad CRC,
+ *               or VT_STATUS_INVALID if the frame is dropped because it is malformed.
+ */
+vt_status_t vt_wire_decode_byte(vt_wire_decoder_t *dec, uint8_t byte, vt_event_t *event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VT_WIRE_H_ */